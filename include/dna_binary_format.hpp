@@ -0,0 +1,760 @@
+#ifndef DNA_BINARY_FORMAT_HPP
+#define DNA_BINARY_FORMAT_HPP
+
+/**
+ * @file dna_binary_format.hpp
+ * @brief The .bin container (generate_binary_files): v2 writer, v1/v2 reader
+ *
+ * Bases are packed 2 bits each, 4 per byte, MSB first (A=00 T=01 G=10
+ * C=11; anything else is stored as A).
+ *
+ * Version 2 layout (little-endian):
+ *
+ * - A 64-byte BinaryFileHeader.
+ * - Chunks. Each holds up to chunkBases bases of one sequence: a 64-byte
+ *   BinaryChunkHeader (CRC32C of the packed bases), the packed bases, and
+ *   zero padding to the next 64-byte boundary. A sequence starts a new
+ *   chunk, so base b of a sequence is in its chunk b / chunkBases.
+ * - The index, written last: one BinarySequenceEntry per sequence, one
+ *   BinaryChunkEntry per chunk, the name table (names back to back, no
+ *   terminator), zero padding to 8 bytes, and a 64-byte BinaryFileTrailer
+ *   ending the file. Its CRC32C covers the index.
+ *
+ * A writer therefore needs no totals up front: chunks go out as they
+ * fill and only the index stays in memory (16 bytes per chunk, 32 per
+ * sequence, plus the names). A reader maps the file, finds the trailer
+ * at the end and seeks straight to any chunk. With --direct-io the file
+ * carries DirectWriter's padding and footer page after the trailer;
+ * DirectWriter::readLogicalSize() gives the trailer's position.
+ *
+ * Version 1 (read only) is a 68-byte header, a 272-byte record per
+ * sequence with the name truncated to 255 bytes, then the packed bases of
+ * every sequence back to back. It has no checksums.
+ *
+ * @version 1.0
+ * @date 2025-11-24
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dna_crc32c.hpp"
+#include "dna_direct_writer.hpp"
+
+namespace DNASerialProcessor {
+
+constexpr char BINARY_MAGIC[8] = {'I', 'N', 'C', 'H', 'R', 'S', 'I', 'L'};
+constexpr char BINARY_MAGIC_V1[8] = {'I', 'N', 'C', 'H', 'R', 'O', 'S', 'I'};   // Also seen in v1 files
+constexpr char BINARY_CHUNK_MAGIC[4] = {'D', 'N', 'A', 'K'};
+constexpr char BINARY_TRAILER_MAGIC[8] = {'I', 'N', 'C', 'H', 'R', 'I', 'D', 'X'};
+constexpr uint32_t BINARY_VERSION_1 = 1;
+constexpr uint32_t BINARY_VERSION_2 = 2;
+constexpr size_t BINARY_ALIGN = 64;                       // Chunk alignment
+constexpr uint32_t BINARY_DEFAULT_CHUNK_BASES = 1 << 20;  // 256 KB packed
+constexpr uint32_t BINARY_MIN_CHUNK_BASES = 256;          // Chunk sizes are multiples of this
+
+struct BinaryFileHeader {
+    char magic[8];
+    uint32_t version;           // BINARY_VERSION_2
+    uint32_t headerBytes;       // sizeof(BinaryFileHeader)
+    uint32_t chunkBases;        // Bases per full chunk
+    uint32_t chunkAlign;        // BINARY_ALIGN
+    uint8_t reserved[36];
+    uint32_t crc;               // CRC32C of the fields above
+};
+static_assert(sizeof(BinaryFileHeader) == 64, "header is 64 bytes on disk");
+
+struct BinaryChunkHeader {
+    char magic[4];
+    uint32_t crc;               // CRC32C of the packed bases
+    uint32_t sequence;
+    uint32_t bases;
+    uint64_t firstBase;         // Of the sequence
+    uint32_t bytes;             // Packed: (bases + 3) / 4
+    uint8_t reserved[36];
+};
+static_assert(sizeof(BinaryChunkHeader) == 64, "chunk header is 64 bytes on disk");
+
+struct BinarySequenceEntry {
+    uint64_t bases;
+    uint64_t firstChunk;
+    uint64_t nameOffset;        // In the name table
+    uint32_t nameLength;
+    uint32_t chunks;
+};
+static_assert(sizeof(BinarySequenceEntry) == 32, "sequence entry is 32 bytes on disk");
+
+struct BinaryChunkEntry {
+    uint64_t offset;            // Of its BinaryChunkHeader
+    uint32_t bases;
+    uint32_t crc;               // As in the chunk header
+};
+static_assert(sizeof(BinaryChunkEntry) == 16, "chunk entry is 16 bytes on disk");
+
+struct BinaryFileTrailer {
+    char magic[8];
+    uint64_t sequenceCount;
+    uint64_t chunkCount;
+    uint64_t totalBases;
+    uint64_t indexOffset;       // Of the first BinarySequenceEntry
+    uint64_t nameBytes;
+    uint32_t indexCrc;          // CRC32C of the entries and the name table
+    uint32_t version;           // BINARY_VERSION_2
+    uint32_t reserved;
+    uint32_t crc;               // CRC32C of the fields above
+};
+static_assert(sizeof(BinaryFileTrailer) == 64, "trailer is 64 bytes on disk");
+
+// Version 1
+struct BinaryHeaderV1 {
+    char magic[8];
+    uint32_t version;
+    uint64_t sequence_count;
+    uint64_t total_bases;
+    uint64_t compressed_size;
+    char reserved[32];
+} __attribute__((packed));
+
+struct SequenceInfoV1 {
+    uint64_t length;            // Bases
+    uint64_t offset;            // In the data section
+    char name[256];
+} __attribute__((packed));
+
+/**
+ * @brief 2-bit packing, shared by the writer and the reader
+ */
+class BasePacking {
+public:
+    static uint8_t code(char base) { return tables().codes[static_cast<uint8_t>(base)]; }
+
+    // The 4 bases of one packed byte
+    static const char* unpack(uint8_t byte) { return tables().bases[byte]; }
+
+    // Pack `count` bases into `packed`, starting at base `first` of it (bytes already zeroed)
+    static void pack(const char* bases, size_t count, uint8_t* packed, uint64_t first) {
+        const Tables& t = tables();
+        size_t i = 0;
+        for (; i < count && (first + i) % 4 != 0; i++) {
+            uint64_t at = first + i;
+            packed[at / 4] |= static_cast<uint8_t>(t.codes[static_cast<uint8_t>(bases[i])] << ((3 - at % 4) * 2));
+        }
+        uint8_t* out = packed + (first + i) / 4;
+        for (; i + 4 <= count; i += 4) {
+            *out++ = static_cast<uint8_t>(t.codes[static_cast<uint8_t>(bases[i])] << 6 |
+                                          t.codes[static_cast<uint8_t>(bases[i + 1])] << 4 |
+                                          t.codes[static_cast<uint8_t>(bases[i + 2])] << 2 |
+                                          t.codes[static_cast<uint8_t>(bases[i + 3])]);
+        }
+        for (size_t shift = 6; i < count; i++, shift -= 2) {
+            *out |= static_cast<uint8_t>(t.codes[static_cast<uint8_t>(bases[i])] << shift);
+        }
+    }
+
+    // Base `index` of packed bases, as its 2-bit code
+    static uint8_t at(const uint8_t* packed, uint64_t index) {
+        return (packed[index / 4] >> ((3 - index % 4) * 2)) & 3;
+    }
+
+    // Copy `count` packed bases from base `srcFirst` of `src` to base `dstFirst` of `dst` (bytes already zeroed)
+    static void copy(const uint8_t* src, uint64_t srcFirst, uint64_t count, uint8_t* dst, uint64_t dstFirst) {
+        for (; count > 0 && dstFirst % 4 != 0; count--, srcFirst++, dstFirst++) {
+            dst[dstFirst / 4] |= static_cast<uint8_t>(at(src, srcFirst) << ((3 - dstFirst % 4) * 2));
+        }
+        const uint8_t* in = src + srcFirst / 4;
+        uint8_t* out = dst + dstFirst / 4;
+        uint64_t bytes = count / 4;
+        unsigned shift = (srcFirst % 4) * 2;
+        if (shift == 0) {
+            std::memcpy(out, in, bytes);
+        } else {
+            for (uint64_t i = 0; i < bytes; i++) {
+                out[i] = static_cast<uint8_t>(in[i] << shift | in[i + 1] >> (8 - shift));
+            }
+        }
+        srcFirst += bytes * 4;
+        dstFirst += bytes * 4;
+        for (count -= bytes * 4; count > 0; count--, srcFirst++, dstFirst++) {
+            dst[dstFirst / 4] |= static_cast<uint8_t>(at(src, srcFirst) << ((3 - dstFirst % 4) * 2));
+        }
+    }
+
+private:
+    struct Tables {
+        uint8_t codes[256];
+        char bases[256][4];
+    };
+
+    static const Tables& tables() {
+        static const Tables t = [] {
+            Tables built{};
+            built.codes[static_cast<uint8_t>('T')] = built.codes[static_cast<uint8_t>('t')] = 1;
+            built.codes[static_cast<uint8_t>('G')] = built.codes[static_cast<uint8_t>('g')] = 2;
+            built.codes[static_cast<uint8_t>('C')] = built.codes[static_cast<uint8_t>('c')] = 3;
+            const char letters[4] = {'A', 'T', 'G', 'C'};
+            for (int byte = 0; byte < 256; byte++) {
+                for (int i = 0; i < 4; i++) built.bases[byte][i] = letters[(byte >> ((3 - i) * 2)) & 3];
+            }
+            return built;
+        }();
+        return t;
+    }
+};
+
+//=============================================================================
+// Binary File Writer
+//=============================================================================
+
+struct BinaryWriterConfig {
+    uint32_t chunkBases = BINARY_DEFAULT_CHUNK_BASES;   // Rounded up to BINARY_MIN_CHUNK_BASES
+    bool directIO = false;                              // Through DirectWriter
+    DirectWriterConfig direct;
+};
+
+/**
+ * @brief Writes a version 2 .bin file, one sequence at a time
+ *
+ * beginSequence(), any number of append() calls with its bases, then
+ * endSequence(); close() writes the index. Errors are sticky: every later
+ * call returns false and error() holds the errno. A file that was not
+ * closed has no trailer and does not open.
+ */
+class BinaryFileWriter {
+public:
+    explicit BinaryFileWriter(const BinaryWriterConfig& config = BinaryWriterConfig())
+        : config_(config), direct_(config.direct) {
+        uint32_t bases = std::max(config_.chunkBases, BINARY_MIN_CHUNK_BASES);
+        chunkBases_ = (bases + BINARY_MIN_CHUNK_BASES - 1) / BINARY_MIN_CHUNK_BASES * BINARY_MIN_CHUNK_BASES;
+    }
+
+    ~BinaryFileWriter() {
+        if (open_) close();
+    }
+
+    BinaryFileWriter(const BinaryFileWriter&) = delete;
+    BinaryFileWriter& operator=(const BinaryFileWriter&) = delete;
+
+    bool open(const std::string& path) {
+        if (open_) close();
+        sequences_.clear();
+        chunks_.clear();
+        names_.clear();
+        position_ = 0;
+        totalBases_ = 0;
+        packedBytes_ = 0;
+        error_ = 0;
+        inSequence_ = false;
+        chunk_.assign(sizeof(BinaryChunkHeader) + chunkBases_ / 4, 0);
+
+        if (config_.directIO) {
+            if (!direct_.open(path)) return fail(errno);
+        } else {
+            fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd_ < 0) return fail(errno);
+        }
+        open_ = true;
+
+        BinaryFileHeader header{};
+        std::memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+        header.version = BINARY_VERSION_2;
+        header.headerBytes = sizeof(BinaryFileHeader);
+        header.chunkBases = chunkBases_;
+        header.chunkAlign = BINARY_ALIGN;
+        header.crc = Crc32c::calculate(&header, offsetof(BinaryFileHeader, crc));
+        return emit(&header, sizeof(header));
+    }
+
+    bool beginSequence(const std::string& name) {
+        if (!open_ || error_ != 0) return false;
+        if (inSequence_) endSequence();
+        BinarySequenceEntry entry{};
+        entry.firstChunk = chunks_.size();
+        entry.nameOffset = names_.size();
+        entry.nameLength = static_cast<uint32_t>(std::min<size_t>(name.size(), UINT32_MAX));
+        names_.append(name, 0, entry.nameLength);
+        sequences_.push_back(entry);
+        fill_ = 0;
+        inSequence_ = true;
+        return true;
+    }
+
+    /**
+     * @brief Append bases (ASCII) to the current sequence; full chunks are written at once
+     */
+    bool append(const char* bases, size_t count) {
+        if (!inSequence_ || error_ != 0) return false;
+        uint8_t* packed = chunk_.data() + sizeof(BinaryChunkHeader);
+        while (count > 0) {
+            size_t n = std::min<size_t>(count, chunkBases_ - fill_);
+            BasePacking::pack(bases, n, packed, fill_);
+            fill_ += static_cast<uint32_t>(n);
+            bases += n;
+            count -= n;
+            if (fill_ == chunkBases_ && !flushChunk()) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Append `count` bases packed already (BasePacking order, from the top bits of packed[0])
+     */
+    bool appendPacked(const uint8_t* packed, uint64_t count) {
+        if (!inSequence_ || error_ != 0) return false;
+        uint8_t* chunk = chunk_.data() + sizeof(BinaryChunkHeader);
+        uint64_t from = 0;
+        while (count > 0) {
+            uint64_t n = std::min<uint64_t>(count, chunkBases_ - fill_);
+            BasePacking::copy(packed, from, n, chunk, fill_);
+            fill_ += static_cast<uint32_t>(n);
+            from += n;
+            count -= n;
+            if (fill_ == chunkBases_ && !flushChunk()) return false;
+        }
+        return true;
+    }
+
+    bool endSequence() {
+        if (!inSequence_) return false;
+        inSequence_ = false;
+        return flushChunk();
+    }
+
+    /**
+     * @brief Write the index and trailer, then close the file
+     * @return false if any write failed (or if not open)
+     */
+    bool close() {
+        if (!open_) return false;
+        if (inSequence_) endSequence();
+
+        uint64_t indexOffset = position_;
+        uint32_t indexCrc = Crc32c::extend(0, sequences_.data(), sequences_.size() * sizeof(BinarySequenceEntry));
+        indexCrc = Crc32c::extend(indexCrc, chunks_.data(), chunks_.size() * sizeof(BinaryChunkEntry));
+        indexCrc = Crc32c::extend(indexCrc, names_.data(), names_.size());
+        emit(sequences_.data(), sequences_.size() * sizeof(BinarySequenceEntry));
+        emit(chunks_.data(), chunks_.size() * sizeof(BinaryChunkEntry));
+        emit(names_.data(), names_.size());
+        static const uint8_t zeros[8] = {};
+        emit(zeros, (8 - position_ % 8) % 8);
+
+        BinaryFileTrailer trailer{};
+        std::memcpy(trailer.magic, BINARY_TRAILER_MAGIC, sizeof(trailer.magic));
+        trailer.sequenceCount = sequences_.size();
+        trailer.chunkCount = chunks_.size();
+        trailer.totalBases = totalBases_;
+        trailer.indexOffset = indexOffset;
+        trailer.nameBytes = names_.size();
+        trailer.indexCrc = indexCrc;
+        trailer.version = BINARY_VERSION_2;
+        trailer.crc = Crc32c::calculate(&trailer, offsetof(BinaryFileTrailer, crc));
+        emit(&trailer, sizeof(trailer));
+
+        if (config_.directIO) {
+            if (!direct_.close() && error_ == 0) fail(direct_.error() != 0 ? direct_.error() : EIO);
+        } else {
+            if (error_ == 0 && fdatasync(fd_) < 0) fail(errno);
+            ::close(fd_);
+            fd_ = -1;
+        }
+        open_ = false;
+        return error_ == 0;
+    }
+
+    uint64_t sequenceCount() const { return sequences_.size(); }
+    uint64_t chunkCount() const { return chunks_.size(); }
+    uint64_t totalBases() const { return totalBases_; }
+    uint64_t packedBytes() const { return packedBytes_; }
+    uint64_t size() const { return position_; }       // Bytes written, without DirectWriter's padding
+    uint32_t chunkBases() const { return chunkBases_; }
+    bool isDirect() const { return config_.directIO && direct_.isDirect(); }
+    int error() const { return error_; }
+
+private:
+    bool flushChunk() {
+        if (fill_ == 0) return error_ == 0;
+        BinarySequenceEntry& sequence = sequences_.back();
+        uint32_t bytes = (fill_ + 3) / 4;
+        uint8_t* packed = chunk_.data() + sizeof(BinaryChunkHeader);
+
+        BinaryChunkHeader header{};
+        std::memcpy(header.magic, BINARY_CHUNK_MAGIC, sizeof(header.magic));
+        header.crc = Crc32c::calculate(packed, bytes);
+        header.sequence = static_cast<uint32_t>(sequences_.size() - 1);
+        header.bases = fill_;
+        header.firstBase = sequence.bases;
+        header.bytes = bytes;
+        std::memcpy(chunk_.data(), &header, sizeof(header));
+
+        // A full chunk is a multiple of BINARY_ALIGN already; a sequence's last one is padded
+        size_t length = (sizeof(BinaryChunkHeader) + bytes + BINARY_ALIGN - 1) & ~(BINARY_ALIGN - 1);
+        chunks_.push_back({position_, fill_, header.crc});
+        bool ok = emit(chunk_.data(), length);
+
+        sequence.bases += fill_;
+        sequence.chunks++;
+        totalBases_ += fill_;
+        packedBytes_ += bytes;
+        std::memset(packed, 0, chunk_.size() - sizeof(BinaryChunkHeader));
+        fill_ = 0;
+        return ok;
+    }
+
+    bool emit(const void* data, size_t size) {
+        if (error_ != 0) return false;
+        if (config_.directIO) {
+            if (!direct_.write(data, size)) return fail(direct_.error() != 0 ? direct_.error() : EIO);
+        } else {
+            const char* p = static_cast<const char*>(data);
+            size_t done = 0;
+            while (done < size) {
+                ssize_t n = ::write(fd_, p + done, size - done);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return fail(n < 0 ? errno : EIO);
+                done += static_cast<size_t>(n);
+            }
+        }
+        position_ += size;
+        return true;
+    }
+
+    bool fail(int error) {
+        if (error_ == 0) error_ = error;
+        return false;
+    }
+
+    const BinaryWriterConfig config_;
+    uint32_t chunkBases_;
+    DirectWriter direct_;
+    int fd_ = -1;
+    bool open_ = false;
+    int error_ = 0;
+
+    std::vector<uint8_t> chunk_;          // Header, then the packed bases being filled
+    uint32_t fill_ = 0;                   // Bases in chunk_
+    bool inSequence_ = false;
+    uint64_t position_ = 0;
+    uint64_t totalBases_ = 0;
+    uint64_t packedBytes_ = 0;
+
+    std::vector<BinarySequenceEntry> sequences_;
+    std::vector<BinaryChunkEntry> chunks_;
+    std::string names_;
+};
+
+//=============================================================================
+// Binary File Reader
+//=============================================================================
+
+/**
+ * @brief Maps a .bin file (version 1 or 2) for random access
+ *
+ * open() checks the header, and for version 2 the trailer and the index
+ * CRC; it does not read the bases. validate() checks every chunk's CRC.
+ * Version 1 files have no checksums: open() checks that every sequence
+ * lies inside the file, and validate() has nothing more to check.
+ */
+class BinaryFileReader {
+public:
+    BinaryFileReader() = default;
+
+    ~BinaryFileReader() {
+        close();
+    }
+
+    BinaryFileReader(const BinaryFileReader&) = delete;
+    BinaryFileReader& operator=(const BinaryFileReader&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) < 0 || info.st_size < static_cast<off_t>(sizeof(BinaryFileHeader))) {
+            ::close(fd);
+            errno = EINVAL;
+            return false;
+        }
+        mappedSize_ = static_cast<size_t>(info.st_size);
+        void* mapped = mmap(nullptr, mappedSize_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+        base_ = static_cast<const uint8_t*>(mapped);
+
+        // Past DirectWriter's padding, if it wrote the file
+        uint64_t logical = mappedSize_;
+        size_ = DirectWriter::readLogicalSize(path, logical) ? logical : mappedSize_;
+
+        uint32_t version = 0;
+        std::memcpy(&version, base_ + sizeof(BINARY_MAGIC), sizeof(version));
+        bool magic = std::memcmp(base_, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+        bool ok = version == BINARY_VERSION_2
+            ? magic && openV2()
+            : version == BINARY_VERSION_1 && (magic || std::memcmp(base_, BINARY_MAGIC_V1, sizeof(BINARY_MAGIC_V1)) == 0) &&
+              openV1();
+        if (!ok) {
+            close();
+            errno = EINVAL;
+            return false;
+        }
+        version_ = version;
+        return true;
+    }
+
+    void close() {
+        if (base_ != nullptr) munmap(const_cast<uint8_t*>(base_), mappedSize_);
+        base_ = nullptr;
+        mappedSize_ = size_ = 0;
+        version_ = 0;
+        sequences_.clear();
+        chunks_ = nullptr;
+        names_ = nullptr;
+        chunkCount_ = 0;
+        totalBases_ = 0;
+        packedBytes_ = 0;
+    }
+
+    uint32_t version() const { return version_; }
+    bool checksummed() const { return version_ == BINARY_VERSION_2; }
+    uint64_t sequenceCount() const { return sequences_.size(); }
+    uint64_t chunkCount() const { return chunkCount_; }
+    uint64_t totalBases() const { return totalBases_; }
+    uint64_t packedBytes() const { return packedBytes_; }
+    uint64_t fileSize() const { return size_; }
+    uint32_t chunkBases() const { return chunkBases_; }
+
+    uint64_t length(uint64_t sequence) const { return sequences_[sequence].bases; }
+
+    std::string name(uint64_t sequence) const {
+        const Sequence& s = sequences_[sequence];
+        return std::string(names_ + s.nameOffset, s.nameLength);
+    }
+
+    /**
+     * @brief Decode `count` bases of `sequence` from base `first` on (clipped to its end)
+     */
+    bool bases(uint64_t sequence, uint64_t first, uint64_t count, std::string& out) const {
+        out.clear();
+        if (sequence >= sequences_.size()) return false;
+        const Sequence& s = sequences_[sequence];
+        if (first >= s.bases) return true;
+        count = std::min(count, s.bases - first);
+        out.resize(count);
+        char* p = &out[0];
+        while (count > 0) {
+            const uint8_t* packed;
+            uint64_t chunkFirst, chunkBases;
+            locate(s, first, packed, chunkFirst, chunkBases);
+            uint64_t at = first - chunkFirst;
+            uint64_t n = std::min(count, chunkBases - at);
+            unpack(packed, at, n, p);
+            p += n;
+            first += n;
+            count -= n;
+        }
+        return true;
+    }
+
+    // Version 2: where chunk `chunk` is, its bases and CRC
+    BinaryChunkEntry chunk(uint64_t chunk) const {
+        BinaryChunkEntry entry{};
+        if (chunk < chunkCount_) std::memcpy(&entry, chunks_ + chunk * sizeof(entry), sizeof(entry));
+        return entry;
+    }
+
+    std::string sequence(uint64_t sequence) const {
+        std::string out;
+        bases(sequence, 0, length(sequence), out);
+        return out;
+    }
+
+    /**
+     * @brief Check one chunk's header and CRC against the index (version 2)
+     */
+    bool chunkValid(uint64_t chunk) const {
+        if (version_ != BINARY_VERSION_2 || chunk >= chunkCount_) return false;
+        BinaryChunkEntry entry = this->chunk(chunk);
+        BinaryChunkHeader header;
+        std::memcpy(&header, base_ + entry.offset, sizeof(header));
+        uint32_t bytes = (entry.bases + 3) / 4;
+        return std::memcmp(header.magic, BINARY_CHUNK_MAGIC, sizeof(header.magic)) == 0 &&
+               header.bases == entry.bases && header.bytes == bytes && header.crc == entry.crc &&
+               Crc32c::calculate(base_ + entry.offset + sizeof(header), bytes) == entry.crc;
+    }
+
+    /**
+     * @brief Check every chunk on `threads` threads
+     * @param bad  if given, receives the failing chunk numbers in order
+     * @return chunks that failed
+     */
+    uint64_t validate(unsigned threads = 0, std::vector<uint64_t>* bad = nullptr) const {
+        if (version_ != BINARY_VERSION_2) return 0;
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<uint64_t>(threads, std::max<uint64_t>(chunkCount_, 1)));
+
+        // Threads take runs of chunks from a shared counter, so one slow range does not hold up the rest
+        constexpr uint64_t RUN = 16;
+        std::atomic<uint64_t> next{0};
+        std::vector<std::vector<uint64_t>> failed(threads);
+        auto check = [&](unsigned worker) {
+            uint64_t first;
+            while ((first = next.fetch_add(RUN)) < chunkCount_) {
+                for (uint64_t chunk = first; chunk < std::min(first + RUN, chunkCount_); chunk++) {
+                    if (!chunkValid(chunk)) failed[worker].push_back(chunk);
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        for (unsigned i = 1; i < threads; i++) pool.emplace_back(check, i);
+        check(0);
+        for (auto& thread : pool) thread.join();
+
+        std::vector<uint64_t> all;
+        for (const auto& list : failed) all.insert(all.end(), list.begin(), list.end());
+        std::sort(all.begin(), all.end());
+        if (bad) *bad = all;
+        return all.size();
+    }
+
+private:
+    struct Sequence {
+        uint64_t bases;
+        uint64_t firstChunk;       // v2; v1: offset of the packed bases in the file
+        uint64_t nameOffset;       // Into names_
+        uint32_t nameLength;
+    };
+
+    bool openV2() {
+        BinaryFileHeader header;
+        std::memcpy(&header, base_, sizeof(header));
+        if (header.crc != Crc32c::calculate(&header, offsetof(BinaryFileHeader, crc)) ||
+            header.chunkBases == 0 || header.chunkBases % 4 != 0 || size_ < sizeof(header) + sizeof(BinaryFileTrailer)) {
+            return false;
+        }
+        chunkBases_ = header.chunkBases;
+
+        BinaryFileTrailer trailer;
+        uint64_t trailerOffset = size_ - sizeof(trailer);
+        std::memcpy(&trailer, base_ + trailerOffset, sizeof(trailer));
+        if (std::memcmp(trailer.magic, BINARY_TRAILER_MAGIC, sizeof(trailer.magic)) != 0 ||
+            trailer.crc != Crc32c::calculate(&trailer, offsetof(BinaryFileTrailer, crc)) ||
+            trailer.sequenceCount > trailerOffset / sizeof(BinarySequenceEntry) ||
+            trailer.chunkCount > trailerOffset / sizeof(BinaryChunkEntry) || trailer.nameBytes > trailerOffset) {
+            return false;
+        }
+        uint64_t indexBytes = trailer.sequenceCount * sizeof(BinarySequenceEntry) +
+                              trailer.chunkCount * sizeof(BinaryChunkEntry) + trailer.nameBytes;
+        if (trailer.indexOffset < sizeof(header) || trailer.indexOffset + indexBytes > trailerOffset ||
+            Crc32c::calculate(base_ + trailer.indexOffset, indexBytes) != trailer.indexCrc) {
+            return false;
+        }
+        const uint8_t* entries = base_ + trailer.indexOffset;
+        chunks_ = entries + trailer.sequenceCount * sizeof(BinarySequenceEntry);
+        names_ = reinterpret_cast<const char*>(chunks_ + trailer.chunkCount * sizeof(BinaryChunkEntry));
+        chunkCount_ = trailer.chunkCount;
+
+        // Every chunk inside the data section, and every sequence's chunks adding up
+        for (uint64_t i = 0; i < chunkCount_; i++) {
+            BinaryChunkEntry chunk;
+            std::memcpy(&chunk, chunks_ + i * sizeof(chunk), sizeof(chunk));
+            if (chunk.bases > chunkBases_ || chunk.offset < sizeof(header) ||
+                chunk.offset + sizeof(BinaryChunkHeader) + (chunk.bases + 3) / 4 > trailer.indexOffset) {
+                return false;
+            }
+            packedBytes_ += (chunk.bases + 3) / 4;
+        }
+        sequences_.reserve(trailer.sequenceCount);
+        for (uint64_t i = 0; i < trailer.sequenceCount; i++) {
+            BinarySequenceEntry entry;
+            std::memcpy(&entry, entries + i * sizeof(entry), sizeof(entry));
+            uint64_t full = entry.bases / chunkBases_ + (entry.bases % chunkBases_ != 0);
+            if (entry.firstChunk + entry.chunks > chunkCount_ || entry.chunks != full ||
+                entry.nameOffset + entry.nameLength > trailer.nameBytes) {
+                return false;
+            }
+            sequences_.push_back({entry.bases, entry.firstChunk, entry.nameOffset, entry.nameLength});
+            totalBases_ += entry.bases;
+        }
+        return totalBases_ == trailer.totalBases;
+    }
+
+    bool openV1() {
+        BinaryHeaderV1 header;
+        if (size_ < sizeof(header)) return false;
+        std::memcpy(&header, base_, sizeof(header));
+        if (header.sequence_count > (size_ - sizeof(header)) / sizeof(SequenceInfoV1)) return false;
+        uint64_t data = sizeof(header) + header.sequence_count * sizeof(SequenceInfoV1);
+        const uint8_t* infos = base_ + sizeof(header);
+        names_ = reinterpret_cast<const char*>(infos);
+
+        sequences_.reserve(header.sequence_count);
+        for (uint64_t i = 0; i < header.sequence_count; i++) {
+            SequenceInfoV1 info;
+            std::memcpy(&info, infos + i * sizeof(info), sizeof(info));
+            uint64_t bytes = (info.length + 3) / 4;
+            if (info.offset > size_ - data || bytes > size_ - data - info.offset) return false;
+            uint64_t nameOffset = i * sizeof(SequenceInfoV1) + offsetof(SequenceInfoV1, name);
+            uint32_t nameLength = static_cast<uint32_t>(strnlen(info.name, sizeof(info.name)));
+            sequences_.push_back({info.length, data + info.offset, nameOffset, nameLength});
+            totalBases_ += info.length;
+            packedBytes_ += bytes;
+        }
+        return true;
+    }
+
+    // The chunk holding base `first` of `s`: its packed bases, first base and length
+    void locate(const Sequence& s, uint64_t first, const uint8_t*& packed,
+                uint64_t& chunkFirst, uint64_t& chunkBases) const {
+        if (version_ == BINARY_VERSION_1) {
+            packed = base_ + s.firstChunk;
+            chunkFirst = 0;
+            chunkBases = s.bases;
+            return;
+        }
+        uint64_t chunk = s.firstChunk + first / chunkBases_;
+        BinaryChunkEntry entry;
+        std::memcpy(&entry, chunks_ + chunk * sizeof(entry), sizeof(entry));
+        packed = base_ + entry.offset + sizeof(BinaryChunkHeader);
+        chunkFirst = first / chunkBases_ * chunkBases_;
+        chunkBases = entry.bases;
+    }
+
+    static void unpack(const uint8_t* packed, uint64_t first, uint64_t count, char* out) {
+        while (count > 0 && first % 4 != 0) {
+            *out++ = BasePacking::unpack(packed[first / 4])[first % 4];
+            first++;
+            count--;
+        }
+        const uint8_t* in = packed + first / 4;
+        for (; count >= 4; count -= 4, out += 4) std::memcpy(out, BasePacking::unpack(*in++), 4);
+        for (uint64_t i = 0; i < count; i++) *out++ = BasePacking::unpack(*in)[i];
+    }
+
+    const uint8_t* base_ = nullptr;
+    size_t mappedSize_ = 0;
+    uint64_t size_ = 0;                   // Logical
+    uint32_t version_ = 0;
+    uint32_t chunkBases_ = 0;
+
+    std::vector<Sequence> sequences_;
+    const uint8_t* chunks_ = nullptr;     // v2: BinaryChunkEntry array, in the mapping
+    const char* names_ = nullptr;         // v2: the name table; v1: the SequenceInfoV1 array
+    uint64_t chunkCount_ = 0;
+    uint64_t totalBases_ = 0;
+    uint64_t packedBytes_ = 0;
+};
+
+} // namespace DNASerialProcessor
+
+#endif // DNA_BINARY_FORMAT_HPP
@@ -0,0 +1,120 @@
+#ifndef DNA_CODEC_HPP
+#define DNA_CODEC_HPP
+
+/**
+ * @file dna_codec.hpp
+ * @brief 2-bit nucleotide codec shared by dna_client and dna_server
+ *
+ * Mapping (server / .ich format): A=00, C=01, G=10, T=11, N stored as A.
+ * Four bases per byte, first base in the two most significant bits; the
+ * last byte is zero-padded. Clients that pack with this codec produce
+ * exactly the bytes the server would have written, so packed records
+ * are stored without being re-encoded.
+ *
+ * @version 1.0
+ * @date 2025-11-24
+ */
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace DNASerialProcessor {
+
+class NucleotideCodec {
+public:
+    static constexpr size_t packedSize(uint64_t baseCount) {
+        return static_cast<size_t>((baseCount + 3) / 4);
+    }
+
+    /**
+     * @brief Validate and pack in a single pass
+     * @return false (and `out` unspecified) if a byte is not A/C/G/T/N
+     */
+    static bool pack(const char* seq, size_t len, std::string& out) {
+        out.resize(packedSize(len));
+        return packInto(seq, len, reinterpret_cast<uint8_t*>(&out[0]));
+    }
+
+    /**
+     * @brief Pack into caller-owned storage of packedSize(len) bytes
+     *
+     * Slices of one sequence can be packed independently (and in parallel)
+     * as long as every slice but the last starts and ends on a multiple of
+     * four bases, i.e. on a byte boundary of the output.
+     */
+    static bool packInto(const char* seq, size_t len, uint8_t* dst) {
+        const auto& table = encodeTable();
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(seq);
+
+        uint8_t invalid = 0;
+        size_t i = 0;
+        for (; i + 4 <= len; i += 4) {
+            uint8_t a = table[src[i]], b = table[src[i + 1]];
+            uint8_t c = table[src[i + 2]], d = table[src[i + 3]];
+            invalid |= a | b | c | d;
+            *dst++ = static_cast<uint8_t>(((a & 3) << 6) | ((b & 3) << 4) | ((c & 3) << 2) | (d & 3));
+        }
+        if (i < len) {
+            uint8_t byte = 0;
+            for (int shift = 6; i < len; i++, shift -= 2) {
+                uint8_t bits = table[src[i]];
+                invalid |= bits;
+                byte |= static_cast<uint8_t>((bits & 3) << shift);
+            }
+            *dst = byte;
+        }
+        return (invalid & INVALID) == 0;
+    }
+
+    static std::string pack(const std::string& sequence) {
+        std::string out;
+        pack(sequence.data(), sequence.size(), out);
+        return out;
+    }
+
+    /**
+     * @brief Decode `count` bases starting at packed byte 0 into `dst`
+     *
+     * Like packInto(), works on slices that start on a byte boundary.
+     */
+    static void unpackInto(const uint8_t* packed, size_t count, char* dst) {
+        static const char bases[4] = {'A', 'C', 'G', 'T'};
+        for (size_t i = 0; i < count; i++) {
+            dst[i] = bases[(packed[i / 4] >> (6 - (i % 4) * 2)) & 0b11];
+        }
+    }
+
+    static std::string unpack(const char* packed, uint64_t baseCount) {
+        static const char bases[4] = {'A', 'C', 'G', 'T'};
+        std::string sequence(baseCount, 'A');
+
+        for (uint64_t i = 0; i < baseCount; i++) {
+            uint8_t byte = static_cast<uint8_t>(packed[i / 4]);
+            sequence[i] = bases[(byte >> (6 - (i % 4) * 2)) & 0b11];
+        }
+        return sequence;
+    }
+
+private:
+    static constexpr uint8_t INVALID = 0x80;
+
+    static const std::array<uint8_t, 256>& encodeTable() {
+        static const std::array<uint8_t, 256> table = [] {
+            std::array<uint8_t, 256> t{};
+            t.fill(INVALID);
+            t['A'] = 0b00;
+            t['C'] = 0b01;
+            t['G'] = 0b10;
+            t['T'] = 0b11;
+            t['N'] = 0b00;  // N -> A
+            return t;
+        }();
+        return table;
+    }
+};
+
+} // namespace DNASerialProcessor
+
+#endif // DNA_CODEC_HPP
@@ -0,0 +1,582 @@
+#ifndef DNA_FASTA_CONVERTER_HPP
+#define DNA_FASTA_CONVERTER_HPP
+
+/**
+ * @file dna_fasta_converter.hpp
+ * @brief Pipelined FASTA -> .bin conversion of many files at once
+ *
+ * Each file being converted runs a three-stage pipeline:
+ *
+ * - Reader: reads blockBytes at a time, cut after the last complete line
+ *   (a sequence line longer than a block is split; a header line never is).
+ * - Parse + encode: a worker splits a block into header and base runs and
+ *   packs the bases 2 bits each. Workers come from one pool of `jobs`
+ *   threads shared by every file.
+ * - Writer: takes the parsed blocks back in file order and hands them to a
+ *   BinaryFileWriter (dna_binary_format.hpp), which shifts each run into
+ *   place, checksums the chunks and writes them.
+ *
+ * Up to maxOpenFiles files are in flight, each with its own reader and
+ * writer thread; those mostly wait on the disk. All files share a budget
+ * of maxBlocks blocks, so memory stays near maxBlocks * blockBytes
+ * however many files or bases there are. The output is byte-identical to
+ * a sequential conversion.
+ *
+ * As in the sequential converter, a header without bases is dropped, and
+ * bases before the first header form a sequence with an empty name.
+ *
+ * planConversions() names the outputs: x.fasta -> x.bin, unless two inputs
+ * would share that name (x.fa and x.fasta), in which case they keep their
+ * full name (x.fa.bin, x.fasta.bin).
+ *
+ * @version 1.0
+ * @date 2025-11-24
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dna_binary_format.hpp"
+
+namespace DNASerialProcessor {
+
+struct FastaConverterConfig {
+    unsigned jobs = 0;                  // Parse + encode threads, shared by all files; 0 = one per core
+    size_t blockBytes = 4 << 20;        // Input read per block
+    size_t maxBlocks = 0;               // In flight across all files; 0 = 2 * jobs + 2
+    size_t maxOpenFiles = 0;            // Converted at once; 0 = jobs
+    uint64_t progressMs = 500;          // Between Progress calls
+    BinaryWriterConfig writer;
+};
+
+/**
+ * @brief One file: what to convert, how far it got, and how it ended
+ */
+struct FastaConversion {
+    std::string input;
+    std::string output;
+    uint64_t inputBytes = 0;            // Size when it was opened
+    uint64_t bytesRead = 0;
+    uint64_t sequences = 0;
+    uint64_t bases = 0;
+    uint64_t packedBytes = 0;
+    uint64_t chunks = 0;
+    uint64_t outputBytes = 0;           // Without DirectWriter's padding
+    double seconds = 0.0;
+    bool done = false;
+    bool ok = false;
+    std::string error;                  // Set when !ok
+};
+
+class FastaConverter {
+public:
+    using Done = std::function<void(const FastaConversion&)>;
+    using Progress = std::function<void(const std::vector<FastaConversion>&)>;
+
+    explicit FastaConverter(const FastaConverterConfig& config = FastaConverterConfig()) : config_(config) {
+        if (config_.jobs == 0) config_.jobs = std::max(1u, std::thread::hardware_concurrency());
+        if (config_.maxBlocks == 0) config_.maxBlocks = 2 * config_.jobs + 2;
+        if (config_.maxOpenFiles == 0) config_.maxOpenFiles = config_.jobs;
+        config_.blockBytes = std::max<size_t>(config_.blockBytes, 4096);
+    }
+
+    FastaConverter(const FastaConverter&) = delete;
+    FastaConverter& operator=(const FastaConverter&) = delete;
+
+    /**
+     * @brief Convert every file (input and output set); returns when all are done
+     *
+     * A file whose output is one of the inputs, or repeats an earlier file's
+     * output, fails without touching that path.
+     *
+     * @param done      optional; called once per file as it finishes, one call at a time
+     * @param progress  optional; called every progressMs with the files in flight
+     * @return the files with their results, in the order given
+     */
+    std::vector<FastaConversion> convert(const std::vector<FastaConversion>& files, Done done = nullptr,
+                                         Progress progress = nullptr) {
+        files_.clear();
+        for (const auto& file : files) {
+            files_.emplace_back(new FileState());
+            files_.back()->result.input = file.input;
+            files_.back()->result.output = file.output;
+        }
+        rejectClashes();
+        nextFile_ = 0;
+        blocksFree_ = config_.maxBlocks;
+        stopping_ = false;
+        done_ = std::move(done);
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < config_.jobs; i++) workers.emplace_back([this] { work(); });
+        std::thread reporter;
+        if (progress) reporter = std::thread([this, &progress] { report(progress); });
+
+        std::vector<std::thread> runners;
+        size_t open = std::min(config_.maxOpenFiles, files_.size());
+        for (size_t i = 0; i < open; i++) runners.emplace_back([this] { runFiles(); });
+        for (auto& runner : runners) runner.join();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        taskReady_.notify_all();
+        stopped_.notify_all();
+        for (auto& worker : workers) worker.join();
+        if (reporter.joinable()) reporter.join();
+
+        std::vector<FastaConversion> results;
+        for (const auto& file : files_) results.push_back(file->result);
+        files_.clear();
+        freeBlocks_.clear();
+        return results;
+    }
+
+    const FastaConverterConfig& config() const { return config_; }
+
+private:
+    struct Event {
+        bool header;
+        std::string name;               // Header
+        uint64_t bases;                 // Run: bases, packed from packedOffset on
+        size_t packedOffset;
+    };
+
+    struct Block {
+        uint64_t number = 0;            // In its file
+        std::vector<char> text;
+        size_t length = 0;              // Of text in use
+        bool continuesLine = false;     // Starts inside a sequence line
+        std::vector<Event> events;
+        std::vector<uint8_t> packed;
+        bool parsed = false;
+    };
+
+    struct FileState {
+        FastaConversion result;
+        std::deque<std::unique_ptr<Block>> queue;    // Read, in file order; parsed or not
+        bool readDone = false;
+        bool failed = false;
+        std::string clash;              // Set before the run: the output is taken, the file is not converted
+        std::condition_variable changed;
+        std::chrono::steady_clock::time_point started;
+    };
+
+    struct Task {
+        FileState* file;
+        Block* block;
+    };
+
+    //=========================================================================
+    // Files
+    //=========================================================================
+
+    /**
+     * @brief Fail every file whose output is an input or an earlier file's output
+     *
+     * Two writers on one path would interleave their chunks, and a writer on
+     * an input would truncate it before it is read.
+     */
+    void rejectClashes() {
+        auto key = [](const std::string& path) { return std::filesystem::path(path).lexically_normal().string(); };
+        std::map<std::string, size_t> claimed;
+        for (size_t i = 0; i < files_.size(); i++) claimed.emplace(key(files_[i]->result.input), i);
+        for (size_t i = 0; i < files_.size(); i++) {
+            FastaConversion& result = files_[i]->result;
+            auto claim = claimed.emplace(key(result.output), i);
+            if (claim.second) continue;
+            const FastaConversion& owner = files_[claim.first->second]->result;
+            if (key(owner.input) == claim.first->first) {
+                files_[i]->clash = "output " + result.output + " would overwrite the input " + owner.input;
+            } else {
+                files_[i]->clash = "output " + result.output + " is also written for " + owner.input;
+            }
+        }
+    }
+
+    void runFiles() {
+        while (true) {
+            size_t index = nextFile_.fetch_add(1);
+            if (index >= files_.size()) return;
+            FileState& file = *files_[index];
+            file.started = std::chrono::steady_clock::now();
+
+            BinaryFileWriter writer(config_.writer);
+            if (!file.clash.empty()) {
+                finish(file, writer, file.clash, false);
+                continue;
+            }
+            int fd = ::open(file.result.input.c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat info;
+            if (fd < 0 || fstat(fd, &info) < 0) {
+                finish(file, writer, "cannot open " + file.result.input + ": " + strerror(errno));
+                if (fd >= 0) ::close(fd);
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                file.result.inputBytes = static_cast<uint64_t>(info.st_size);
+            }
+            if (!writer.open(file.result.output)) {
+                ::close(fd);
+                finish(file, writer, "cannot create " + file.result.output + ": " + strerror(writer.error()));
+                continue;
+            }
+
+            std::thread writing([&] { writeFile(file, writer); });
+            std::string error = readFile(file, fd);
+            ::close(fd);
+            writing.join();
+            if (error.empty() && !writer.close()) error = "writing " + file.result.output + ": " + strerror(writer.error());
+            if (error.empty() && writer.sequenceCount() == 0) error = "no sequences in " + file.result.input;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (error.empty() && file.failed) error = file.result.error;
+            }
+            finish(file, writer, error);
+        }
+    }
+
+    void finish(FileState& file, BinaryFileWriter& writer, const std::string& error, bool removeOutput = true) {
+        writer.close();
+        if (!error.empty() && removeOutput) unlink(file.result.output.c_str());
+        FastaConversion result;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            file.result.ok = error.empty();
+            file.result.error = error;
+            file.result.sequences = writer.sequenceCount();
+            file.result.bases = writer.totalBases();
+            file.result.packedBytes = writer.packedBytes();
+            file.result.chunks = writer.chunkCount();
+            file.result.outputBytes = writer.size();
+            file.result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - file.started).count();
+            file.result.done = true;
+            result = file.result;
+        }
+        if (done_) {
+            std::lock_guard<std::mutex> lock(doneMutex_);
+            done_(result);
+        }
+    }
+
+    //=========================================================================
+    // Reader
+    //=========================================================================
+
+    /**
+     * @return empty, or what went wrong
+     */
+    std::string readFile(FileState& file, int fd) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        std::vector<char> carry;            // Start of a line cut off by the previous block
+        bool carryContinues = false;        // carry continues a sequence line
+        uint64_t number = 0;
+        uint64_t offset = 0;
+        bool eof = false;
+        std::string error;
+
+        while (!eof && error.empty()) {
+            Block* block = acquireBlock(file);
+            if (block == nullptr) break;    // The writer failed
+            block->number = number++;
+            block->continuesLine = carryContinues;
+            block->length = carry.size();
+            if (block->text.size() < config_.blockBytes + carry.size()) block->text.resize(config_.blockBytes + carry.size());
+            if (!carry.empty()) std::memcpy(block->text.data(), carry.data(), carry.size());
+            carry.clear();
+
+            // Fill the block; a header line is never split, so it may grow past blockBytes
+            size_t lastNewline = SIZE_MAX;
+            while (true) {
+                while (block->length < block->text.size()) {
+                    ssize_t n = ::read(fd, block->text.data() + block->length, block->text.size() - block->length);
+                    if (n < 0 && errno == EINTR) continue;
+                    if (n < 0) {
+                        error = "reading " + file.result.input + ": " + strerror(errno);
+                        break;
+                    }
+                    if (n == 0) {
+                        eof = true;
+                        break;
+                    }
+                    block->length += static_cast<size_t>(n);
+                    offset += static_cast<uint64_t>(n);
+                }
+                const char* text = block->text.data();
+                const void* found = memrchr(text, '\n', block->length);
+                if (found != nullptr) lastNewline = static_cast<const char*>(found) - text;
+                bool inHeader = !block->continuesLine && block->length > 0 && text[0] == '>';
+                if (eof || !error.empty() || found != nullptr || !inHeader) break;
+                block->text.resize(block->text.size() * 2);
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                file.result.bytesRead = offset;
+            }
+            posix_fadvise(fd, 0, static_cast<off_t>(offset), POSIX_FADV_DONTNEED);
+
+            if (!eof && lastNewline != SIZE_MAX) {
+                // Whole lines only; the rest starts the next block
+                carry.assign(block->text.data() + lastNewline + 1, block->text.data() + block->length);
+                block->length = lastNewline + 1;
+                carryContinues = false;
+            } else {
+                carryContinues = !eof;      // A sequence line longer than the block
+            }
+            submit(file, block);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            file.readDone = true;
+            if (!error.empty() && !file.failed) {
+                file.failed = true;
+                file.result.error = error;
+            }
+        }
+        file.changed.notify_all();
+        return error;
+    }
+
+    // A block from the shared budget; null once the file failed
+    Block* acquireBlock(FileState& file) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        blockFreed_.wait(lock, [&] { return blocksFree_ > 0 || file.failed; });
+        if (file.failed) return nullptr;
+        blocksFree_--;
+        std::unique_ptr<Block> block;
+        if (!freeBlocks_.empty()) {
+            block = std::move(freeBlocks_.back());
+            freeBlocks_.pop_back();
+        } else {
+            block.reset(new Block());
+        }
+        block->events.clear();
+        block->parsed = false;
+        Block* raw = block.get();
+        file.queue.push_back(std::move(block));
+        return raw;
+    }
+
+    void releaseBlock(std::unique_ptr<Block> block) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            freeBlocks_.push_back(std::move(block));
+            blocksFree_++;
+        }
+        blockFreed_.notify_all();
+    }
+
+    //=========================================================================
+    // Parse + encode
+    //=========================================================================
+
+    void submit(FileState& file, Block* block) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back({&file, block});
+        }
+        taskReady_.notify_one();
+    }
+
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            taskReady_.wait(lock, [&] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;
+            Task task = tasks_.front();
+            tasks_.pop_front();
+            lock.unlock();
+
+            parse(*task.block);
+
+            lock.lock();
+            task.block->parsed = true;
+            task.file->changed.notify_all();
+        }
+    }
+
+    static void parse(Block& block) {
+        block.packed.clear();
+        const char* p = block.text.data();
+        const char* end = p + block.length;
+        bool lineStart = !block.continuesLine;
+        Event* run = nullptr;               // The base run being extended
+
+        while (p < end) {
+            const char* newline = static_cast<const char*>(memchr(p, '\n', end - p));
+            const char* lineEnd = newline ? newline : end;
+            size_t length = lineEnd - p;
+            if (length > 0 && p[length - 1] == '\r') length--;   // CRLF files
+
+            if (lineStart && length > 0 && p[0] == '>') {
+                block.events.push_back({true, std::string(p + 1, length - 1), 0, 0});
+                run = nullptr;
+            } else if (length > 0) {
+                if (run == nullptr) {
+                    block.events.push_back({false, std::string(), 0, block.packed.size()});
+                    run = &block.events.back();
+                }
+                block.packed.resize(run->packedOffset + (run->bases + length + 3) / 4, 0);
+                BasePacking::pack(p, length, block.packed.data() + run->packedOffset, run->bases);
+                run->bases += length;
+            }
+            lineStart = newline != nullptr;
+            p = newline ? newline + 1 : end;
+        }
+    }
+
+    //=========================================================================
+    // Writer
+    //=========================================================================
+
+    void writeFile(FileState& file, BinaryFileWriter& writer) {
+        std::string name;
+        bool inSequence = false;
+        bool ok = true;
+        while (true) {
+            std::unique_ptr<Block> block;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                file.changed.wait(lock, [&] {
+                    return (!file.queue.empty() && file.queue.front()->parsed) || (file.readDone && file.queue.empty());
+                });
+                if (file.queue.empty()) break;
+                block = std::move(file.queue.front());
+                file.queue.pop_front();
+            }
+
+            for (const Event& event : block->events) {
+                if (!ok) break;
+                if (event.header) {
+                    if (inSequence) ok = writer.endSequence();
+                    inSequence = false;
+                    name = event.name;
+                } else {
+                    if (!inSequence) ok = writer.beginSequence(name);
+                    inSequence = true;
+                    ok = ok && writer.appendPacked(block->packed.data() + event.packedOffset, event.bases);
+                }
+            }
+            releaseBlock(std::move(block));
+
+            if (!ok) {
+                // Stop the reader; blocks it already read are drained above
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!file.failed) {
+                    file.failed = true;
+                    file.result.error = "writing " + file.result.output + ": " + strerror(writer.error());
+                }
+                blockFreed_.notify_all();
+            }
+        }
+        if (inSequence && ok) writer.endSequence();
+    }
+
+    //=========================================================================
+    // Progress
+    //=========================================================================
+
+    void report(const Progress& progress) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            stopped_.wait_for(lock, std::chrono::milliseconds(config_.progressMs));
+            if (stopping_) break;
+            std::vector<FastaConversion> active;
+            for (const auto& file : files_) {
+                if (!file->result.done && file->result.inputBytes > 0) active.push_back(file->result);
+            }
+            lock.unlock();
+            progress(active);
+            lock.lock();
+        }
+    }
+
+    FastaConverterConfig config_;
+    Done done_;
+    std::vector<std::unique_ptr<FileState>> files_;
+    std::atomic<size_t> nextFile_{0};
+
+    std::mutex mutex_;                  // Everything below, and each FileState's queue and result
+    std::condition_variable taskReady_;
+    std::condition_variable blockFreed_;
+    std::condition_variable stopped_;
+    std::deque<Task> tasks_;
+    std::vector<std::unique_ptr<Block>> freeBlocks_;
+    size_t blocksFree_ = 0;
+    bool stopping_ = false;
+    std::mutex doneMutex_;
+};
+
+/**
+ * @brief The default output for a FASTA file: its extension replaced by .bin
+ */
+inline std::string binaryOutputPath(const std::string& input) {
+    return std::filesystem::path(input).replace_extension(".bin").string();
+}
+
+/**
+ * @brief One conversion per distinct input, with outputs that never collide
+ *
+ * An input given twice (or once as a file and once through its directory)
+ * is converted once. Inputs whose binaryOutputPath() would be shared with
+ * another input, or would be another input, write to input + ".bin"
+ * instead; that name is unique per input. Whatever still clashes,
+ * convert() rejects.
+ */
+inline std::vector<FastaConversion> planConversions(const std::vector<std::string>& inputs) {
+    std::vector<FastaConversion> files;
+    std::map<std::string, size_t> seen;
+    for (const auto& input : inputs) {
+        std::string key = std::filesystem::path(input).lexically_normal().string();
+        if (!seen.emplace(key, files.size()).second) continue;
+        FastaConversion file;
+        file.input = input;
+        file.output = binaryOutputPath(input);
+        files.push_back(file);
+    }
+
+    // A full name can only clash with another input's short name, so each pass settles at least one file
+    for (bool clashed = true; clashed;) {
+        clashed = false;
+        std::map<std::string, std::vector<size_t>> claims;
+        for (const auto& entry : seen) {
+            claims[entry.first].push_back(entry.second);
+        }
+        for (size_t i = 0; i < files.size(); i++) {
+            claims[std::filesystem::path(files[i].output).lexically_normal().string()].push_back(i);
+        }
+        for (const auto& claim : claims) {
+            if (claim.second.size() < 2) continue;
+            for (size_t i : claim.second) {
+                if (files[i].output == files[i].input + ".bin") continue;
+                files[i].output = files[i].input + ".bin";
+                clashed = true;
+            }
+        }
+    }
+    return files;
+}
+
+} // namespace DNASerialProcessor
+
+#endif // DNA_FASTA_CONVERTER_HPP
@@ -0,0 +1,269 @@
+#ifndef DNA_LATENCY_HISTOGRAM_HPP
+#define DNA_LATENCY_HISTOGRAM_HPP
+
+/**
+ * @file dna_latency_histogram.hpp
+ * @brief HDR-style latency histograms, including a lock-free per-thread variant
+ *
+ * LatencyHistogram uses log-linear buckets: 16 linear sub-buckets per power
+ * of two, so a reported percentile is within 6.25% of the true value, and
+ * 592 counters cover 1 ns to ~18 minutes. It is a plain value type for one
+ * thread.
+ *
+ * ConcurrentHistogram is for many threads recording into one histogram.
+ * Each thread gets its own shard of atomic buckets on first use. The owner
+ * thread updates them with relaxed load/store, with no read-modify-write,
+ * so record() never contends or takes a lock. snapshot() sums the shards.
+ *
+ * PipelineLatency keeps one ConcurrentHistogram per ingest stage
+ * (receive, parse, queue, validate, encode, store, commit) plus end to end.
+ *
+ * @version 1.0
+ * @date 2025-11-24
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace DNASerialProcessor {
+
+//=============================================================================
+// Latency Histogram
+//=============================================================================
+
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 4;
+    static constexpr int SUB_COUNT = 1 << SUB_BITS;
+    static constexpr int MAX_BITS = 40;
+    static constexpr int BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+    /**
+     * @brief Add `count` samples of `ns` (a batch stage is one sample per record)
+     */
+    void record(uint64_t ns, uint64_t count = 1) {
+        counts_[bucket(ns)] += count;
+        total_ += count;
+        sum_ += ns * count;
+        max_ = std::max(max_, ns);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < BUCKETS; i++) counts_[i] += other.counts_[i];
+        total_ += other.total_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    /**
+     * @brief Samples recorded since `earlier`, a previous snapshot of the same series
+     *
+     * max() stays the cumulative maximum: it cannot be taken apart.
+     */
+    LatencyHistogram since(const LatencyHistogram& earlier) const {
+        LatencyHistogram delta = *this;
+        for (int i = 0; i < BUCKETS; i++) delta.counts_[i] -= earlier.counts_[i];
+        delta.total_ -= earlier.total_;
+        delta.sum_ -= earlier.sum_;
+        return delta;
+    }
+
+    void reset() {
+        *this = LatencyHistogram();
+    }
+
+    uint64_t count() const { return total_; }
+    uint64_t max() const { return max_; }
+    uint64_t sum() const { return sum_; }
+
+    /**
+     * @brief Samples in buckets that end at or below `ns` (cumulative, for exporters)
+     */
+    uint64_t countAtOrBelow(uint64_t ns) const {
+        uint64_t below = 0;
+        for (int i = 0; i < BUCKETS - 1 && upperBound(i) <= ns; i++) below += counts_[i];
+        return below;
+    }
+
+    double mean() const {
+        return total_ == 0 ? 0.0 : static_cast<double>(sum_) / total_;
+    }
+
+    /**
+     * @brief Upper edge of the bucket holding the p-th percentile (0 < p <= 100)
+     */
+    uint64_t percentile(double p) const {
+        if (total_ == 0) return 0;
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p / 100.0 * total_ + 0.5));
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS - 1; i++) {
+            seen += counts_[i];
+            if (seen >= rank) return std::min(upperBound(i), max_);
+        }
+        return max_;   // Overflow bucket: everything past ~18 minutes
+    }
+
+    static int bucket(uint64_t ns) {
+        if (ns < SUB_COUNT) return static_cast<int>(ns);
+        int msb = 63 - __builtin_clzll(ns);
+        if (msb >= MAX_BITS) return BUCKETS - 1;
+        int group = msb - SUB_BITS + 1;
+        return group * SUB_COUNT + static_cast<int>((ns >> (msb - SUB_BITS)) - SUB_COUNT);
+    }
+
+private:
+    friend class ConcurrentHistogram;
+
+    static uint64_t upperBound(int index) {
+        int group = index / SUB_COUNT;
+        uint64_t sub = index % SUB_COUNT;
+        if (group == 0) return sub;
+        return ((SUB_COUNT + sub + 1) << (group - 1)) - 1;
+    }
+
+    uint64_t counts_[BUCKETS] = {};
+    uint64_t total_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t max_ = 0;
+};
+
+//=============================================================================
+// Concurrent Histogram (per-thread shards, merged on read)
+//=============================================================================
+
+/**
+ * @brief Histogram that any number of threads record into without locking
+ *
+ * A thread's first record() registers a shard under a mutex; after that the
+ * shard is found through a thread-local cache. The histogram must outlive
+ * the threads recording into it.
+ */
+class ConcurrentHistogram {
+public:
+    ConcurrentHistogram() : id_(nextId()) {}
+
+    ConcurrentHistogram(const ConcurrentHistogram&) = delete;
+    ConcurrentHistogram& operator=(const ConcurrentHistogram&) = delete;
+
+    void record(uint64_t ns, uint64_t count = 1) {
+        Shard& shard = localShard();
+        bump(shard.counts[LatencyHistogram::bucket(ns)], count);
+        bump(shard.sum, ns * count);
+        if (ns > shard.max.load(std::memory_order_relaxed)) {
+            shard.max.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Sum of all shards; samples recorded meanwhile may or may not be in it
+     */
+    LatencyHistogram snapshot() const {
+        LatencyHistogram merged;
+        std::lock_guard<std::mutex> lock(shardsMutex_);
+        for (const auto& shard : shards_) {
+            for (int i = 0; i < LatencyHistogram::BUCKETS; i++) {
+                uint64_t count = shard->counts[i].load(std::memory_order_relaxed);
+                merged.counts_[i] += count;
+                merged.total_ += count;   // From the buckets, so percentiles stay consistent
+            }
+            merged.sum_ += shard->sum.load(std::memory_order_relaxed);
+            merged.max_ = std::max(merged.max_, shard->max.load(std::memory_order_relaxed));
+        }
+        return merged;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> counts[LatencyHistogram::BUCKETS] = {};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+    };
+
+    // Single writer per shard: no lock prefix needed
+    static void bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    static uint64_t nextId() {
+        static std::atomic<uint64_t> ids{1};
+        return ids.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Shard& localShard() {
+        // IDs are never reused, so entries of destroyed histograms never match
+        thread_local std::vector<std::pair<uint64_t, Shard*>> cache;
+        for (const auto& entry : cache) {
+            if (entry.first == id_) return *entry.second;
+        }
+
+        Shard* shard = new Shard;
+        {
+            std::lock_guard<std::mutex> lock(shardsMutex_);
+            shards_.emplace_back(shard);
+        }
+        cache.emplace_back(id_, shard);
+        return *shard;
+    }
+
+    const uint64_t id_;
+    mutable std::mutex shardsMutex_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+//=============================================================================
+// Pipeline Stages
+//=============================================================================
+
+enum class PipelineStage : int {
+    RECEIVE = 0,   // One recv()/read() of client or port data
+    PARSE,         // Framing/splitting the received bytes into records
+    QUEUE,         // Record admitted until a worker picks it up
+    VALIDATE,      // Base extraction, nucleotide validation, CRC32
+    ENCODE,        // 2-bit Inchrosil packing
+    STORE,         // Storage write of the encoded records
+    COMMIT,        // Written until durable (fdatasync / group commit)
+    TOTAL,         // Record admitted until its result is known
+    COUNT
+};
+
+constexpr int PIPELINE_STAGES = static_cast<int>(PipelineStage::COUNT);
+
+inline const char* stageName(PipelineStage stage) {
+    static const char* const names[PIPELINE_STAGES] = {
+        "receive", "parse", "queue", "validate", "encode", "store", "commit", "total"
+    };
+    int index = static_cast<int>(stage);
+    return index >= 0 && index < PIPELINE_STAGES ? names[index] : "unknown";
+}
+
+/**
+ * @brief One ConcurrentHistogram per pipeline stage
+ */
+class PipelineLatency {
+public:
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void record(PipelineStage stage, uint64_t ns, uint64_t count = 1) {
+        stages_[static_cast<int>(stage)].record(ns, count);
+    }
+
+    LatencyHistogram snapshot(PipelineStage stage) const {
+        return stages_[static_cast<int>(stage)].snapshot();
+    }
+
+private:
+    ConcurrentHistogram stages_[PIPELINE_STAGES];
+};
+
+} // namespace DNASerialProcessor
+
+#endif // DNA_LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,1102 @@
+#ifndef DNA_METADATA_STORE_HPP
+#define DNA_METADATA_STORE_HPP
+
+/**
+ * @file dna_metadata_store.hpp
+ * @brief Embedded log-structured store for DNAMetadata records
+ *
+ * dna_server keeps a row per stored record here, where StorageManager
+ * planned a SQLite database. Metadata records are small and arrive
+ * append-heavy; a log-structured merge tree takes them at memory speed
+ * and still answers point and range queries:
+ *
+ * - put() appends the batch to a write-ahead log (`wal-00000001.log`) and
+ *   inserts it into a sorted in-memory memtable. Once the memtable holds
+ *   memtableBytes, a background thread writes it out as an immutable
+ *   sorted run (`meta-00000002.run`) and deletes its WAL.
+ * - A run is a sequence of ~4 KB prefix-compressed blocks, each with a
+ *   CRC32C, a block index (first key of every block) and a bloom filter
+ *   over its keys. Index and filter stay in memory; blocks are read
+ *   through mmap. A point lookup skips every run whose filter rules the
+ *   key out and decodes one block of the others.
+ * - Runs are leveled: when METADATA_MERGE_FANIN runs share a level, the
+ *   background thread merges them into one run on the next level, keeping
+ *   only the newest version of each key.
+ *
+ * Each record is stored under three keys: its sequence ID (the record),
+ * its timestamp and its client (both empty markers that point back at the
+ * ID). Range queries walk a marker range and read the records; a marker
+ * left behind by an overwritten record no longer matches and is skipped.
+ *
+ * Durability follows the WAL: with syncWrites every put() is fdatasync'ed
+ * before it returns; otherwise sync() makes everything so far durable.
+ * open() replays the WALs of memtables that never became runs; a torn
+ * WAL tail is ignored.
+ *
+ * @version 1.0
+ * @date 2025-11-24
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dna_crc32c.hpp"
+#include "dna_serial_processor.hpp"
+
+namespace DNASerialProcessor {
+
+constexpr char METADATA_RUN_MAGIC[8] = {'D', 'N', 'A', 'M', 'E', 'T', 'A', '\n'};
+constexpr uint32_t METADATA_RUN_VERSION = 1;
+constexpr size_t METADATA_BLOCK_BYTES = 4096;             // Target block size before its CRC
+constexpr size_t METADATA_MEMTABLE_BYTES = 4 << 20;       // Written out as a run when reached
+constexpr size_t METADATA_MERGE_FANIN = 4;                // Runs on one level before they merge
+constexpr size_t METADATA_BLOOM_BITS_PER_KEY = 10;        // ~1% false positives
+constexpr uint32_t METADATA_BLOOM_HASHES = 7;
+
+struct MetadataStoreConfig {
+    size_t memtableBytes = METADATA_MEMTABLE_BYTES;
+    bool syncWrites = false;    // fdatasync the WAL before put() returns
+};
+
+struct MetadataRunHeader {
+    char magic[8];              // METADATA_RUN_MAGIC
+    uint32_t version;
+    uint32_t level;             // 0: written from a memtable; n + 1: merged from level n
+    uint64_t entries;
+    uint64_t indexOffset;       // Block index, then the bloom filter, end the file
+    uint32_t indexBytes;
+    uint32_t indexCrc;
+    uint32_t bloomBytes;
+    uint32_t bloomCrc;
+    uint32_t blocks;
+    uint32_t reserved[2];
+    uint32_t crc;               // CRC32C of the fields above
+};
+
+static_assert(sizeof(MetadataRunHeader) == 64, "run header is 64 bytes");
+
+//=============================================================================
+// Encoding
+//=============================================================================
+
+namespace MetadataEncoding {
+
+inline void putVarint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+inline bool getVarint(const char*& p, const char* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+inline bool getBytes(const char*& p, const char* end, std::string& out) {
+    uint64_t size;
+    if (!getVarint(p, end, size) || size > static_cast<uint64_t>(end - p)) return false;
+    out.assign(p, size);
+    p += size;
+    return true;
+}
+
+// Big-endian, so byte order is numeric order inside keys
+inline void putOrdered(std::string& out, uint64_t v) {
+    for (int shift = 56; shift >= 0; shift -= 8) out.push_back(static_cast<char>(v >> shift));
+}
+
+inline uint64_t getOrdered(const char* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = (v << 8) | static_cast<uint8_t>(p[i]);
+    return v;
+}
+
+// A field that fills its array unterminated loses its last byte, as in a C string
+inline size_t fieldSize(const char* field, size_t capacity) {
+    return strnlen(field, capacity - 1);
+}
+
+inline void putField(std::string& out, const char* field, size_t capacity) {
+    size_t size = fieldSize(field, capacity);
+    putVarint(out, size);
+    out.append(field, size);
+}
+
+inline bool getField(const char*& p, const char* end, char* field, size_t capacity) {
+    uint64_t size;
+    if (!getVarint(p, end, size) || size >= capacity || size > static_cast<uint64_t>(end - p)) return false;
+    std::memcpy(field, p, size);
+    field[size] = '\0';
+    p += size;
+    return true;
+}
+
+inline std::string encode(const DNAMetadata& record) {
+    std::string out;
+    putField(out, record.sequenceId, sizeof(record.sequenceId));
+    putField(out, record.description, sizeof(record.description));
+    putField(out, record.format, sizeof(record.format));
+    putField(out, record.clientId, sizeof(record.clientId));
+    putVarint(out, record.originalLength);
+    putVarint(out, record.encodedLength);
+    putVarint(out, record.timestamp);
+    putVarint(out, record.crc32);
+    out.append(reinterpret_cast<const char*>(record.sha256), sizeof(record.sha256));
+    return out;
+}
+
+inline bool decode(const std::string& value, DNAMetadata& record) {
+    const char* p = value.data();
+    const char* end = p + value.size();
+    uint64_t crc;
+    if (!getField(p, end, record.sequenceId, sizeof(record.sequenceId)) ||
+        !getField(p, end, record.description, sizeof(record.description)) ||
+        !getField(p, end, record.format, sizeof(record.format)) ||
+        !getField(p, end, record.clientId, sizeof(record.clientId)) ||
+        !getVarint(p, end, record.originalLength) || !getVarint(p, end, record.encodedLength) ||
+        !getVarint(p, end, record.timestamp) || !getVarint(p, end, crc) ||
+        end - p != static_cast<ptrdiff_t>(sizeof(record.sha256))) {
+        return false;
+    }
+    record.crc32 = static_cast<uint32_t>(crc);
+    std::memcpy(record.sha256, p, sizeof(record.sha256));
+    return true;
+}
+
+// Key spaces: 'R' + sequence ID -> record; markers map time and client to the ID
+inline std::string recordKey(const std::string& sequenceId) {
+    return "R" + sequenceId;
+}
+
+inline std::string timeKey(uint64_t timestamp, const std::string& sequenceId) {
+    std::string key("T");
+    putOrdered(key, timestamp);
+    return key + sequenceId;
+}
+
+inline std::string clientPrefix(const std::string& clientId) {
+    return "C" + clientId + '\0';
+}
+
+inline std::string clientKey(const std::string& clientId, uint64_t timestamp, const std::string& sequenceId) {
+    std::string key = clientPrefix(clientId);
+    putOrdered(key, timestamp);
+    return key + sequenceId;
+}
+
+inline uint64_t keyHash(const std::string& key) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : key) hash = (hash ^ c) * 0x100000001b3ull;
+    hash ^= hash >> 33;   // FNV-1a leaves the high bits weak for short keys
+    hash *= 0xff51afd7ed558ccdull;
+    return hash ^ (hash >> 33);
+}
+
+} // namespace MetadataEncoding
+
+//=============================================================================
+// Run Files
+//=============================================================================
+
+/**
+ * @brief Writes keys in ascending order as blocks, then the block index and the bloom filter
+ */
+class MetadataRunWriter {
+public:
+    explicit MetadataRunWriter(size_t expectedKeys)
+        : bloom_((std::max<size_t>(expectedKeys, 1) * METADATA_BLOOM_BITS_PER_KEY + 63) / 64 * 8, '\0') {}
+
+    bool open(const std::string& path, uint32_t level) {
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        level_ = level;
+        offset_ = sizeof(MetadataRunHeader);
+        ok_ = fd_ >= 0;
+        return ok_;
+    }
+
+    void add(const std::string& key, const std::string& value) {
+        using namespace MetadataEncoding;
+        if (block_.empty()) {
+            putVarint(index_, key.size());
+            index_ += key;
+            previous_.clear();
+        }
+        size_t shared = 0;
+        size_t limit = std::min(previous_.size(), key.size());
+        while (shared < limit && previous_[shared] == key[shared]) shared++;
+        putVarint(block_, shared);
+        putVarint(block_, key.size() - shared);
+        putVarint(block_, value.size());
+        block_.append(key, shared, std::string::npos);
+        block_ += value;
+        previous_ = key;
+
+        uint64_t hash = keyHash(key);
+        uint64_t bits = bloom_.size() * 8;
+        uint64_t step = (hash >> 32) | 1;
+        for (uint32_t i = 0; i < METADATA_BLOOM_HASHES; i++, hash += step) {
+            bloom_[(hash % bits) >> 3] |= static_cast<char>(1 << (hash % bits & 7));
+        }
+        entries_++;
+        if (block_.size() >= METADATA_BLOCK_BYTES) endBlock();
+    }
+
+    bool close() {
+        if (fd_ < 0) return false;
+        if (!block_.empty()) endBlock();
+
+        MetadataRunHeader header{};
+        std::memcpy(header.magic, METADATA_RUN_MAGIC, sizeof(METADATA_RUN_MAGIC));
+        header.version = METADATA_RUN_VERSION;
+        header.level = level_;
+        header.entries = entries_;
+        header.indexOffset = offset_;
+        header.indexBytes = static_cast<uint32_t>(index_.size());
+        header.indexCrc = Crc32c::calculate(index_.data(), index_.size());
+        header.bloomBytes = static_cast<uint32_t>(bloom_.size());
+        header.bloomCrc = Crc32c::calculate(bloom_.data(), bloom_.size());
+        header.blocks = blocks_;
+        header.crc = Crc32c::calculate(&header, offsetof(MetadataRunHeader, crc));
+
+        ok_ = ok_ && writeAt(index_.data(), index_.size(), offset_) &&
+              writeAt(bloom_.data(), bloom_.size(), offset_ + index_.size()) &&
+              writeAt(&header, sizeof(header), 0) && fdatasync(fd_) == 0;
+        ::close(fd_);
+        fd_ = -1;
+        return ok_;
+    }
+
+private:
+    void endBlock() {
+        uint32_t crc = Crc32c::calculate(block_.data(), block_.size());
+        block_.append(reinterpret_cast<const char*>(&crc), sizeof(crc));
+        MetadataEncoding::putVarint(index_, offset_);
+        MetadataEncoding::putVarint(index_, block_.size());
+        ok_ = ok_ && writeAt(block_.data(), block_.size(), offset_);
+        offset_ += block_.size();
+        blocks_++;
+        block_.clear();
+    }
+
+    bool writeAt(const void* data, size_t size, uint64_t offset) {
+        const char* p = static_cast<const char*>(data);
+        size_t done = 0;
+        while (done < size) {
+            ssize_t n = pwrite(fd_, p + done, size - done, offset + done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    int fd_ = -1;
+    bool ok_ = false;
+    uint32_t level_ = 0;
+    uint64_t offset_ = 0;
+    uint64_t entries_ = 0;
+    uint32_t blocks_ = 0;
+    std::string block_;
+    std::string previous_;
+    std::string index_;     // Per block: first key, offset, size (with CRC)
+    std::string bloom_;
+};
+
+/**
+ * @brief An open run: block index and bloom filter in memory, blocks through mmap
+ */
+class MetadataRun {
+public:
+    using Entries = std::vector<std::pair<std::string, std::string>>;
+
+    ~MetadataRun() {
+        if (base_) munmap(const_cast<char*>(base_), size_);
+    }
+
+    /**
+     * @return nullptr if the file is not a complete run
+     */
+    static std::shared_ptr<MetadataRun> open(const std::string& path, uint32_t number) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return nullptr;
+        auto run = std::shared_ptr<MetadataRun>(new MetadataRun);
+        run->path_ = path;
+        run->number_ = number;
+
+        struct stat info;
+        MetadataRunHeader& header = run->header_;
+        bool ok = fstat(fd, &info) == 0 &&
+                  pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                  std::memcmp(header.magic, METADATA_RUN_MAGIC, sizeof(METADATA_RUN_MAGIC)) == 0 &&
+                  header.version == METADATA_RUN_VERSION &&
+                  header.crc == Crc32c::calculate(&header, offsetof(MetadataRunHeader, crc)) &&
+                  header.indexOffset + header.indexBytes + header.bloomBytes ==
+                      static_cast<uint64_t>(info.st_size);
+        if (ok) {
+            run->size_ = static_cast<size_t>(info.st_size);
+            void* mapped = mmap(nullptr, run->size_, PROT_READ, MAP_SHARED, fd, 0);
+            ok = mapped != MAP_FAILED;
+            if (ok) run->base_ = static_cast<const char*>(mapped);
+        }
+        ok = ok && run->loadIndex();
+        close(fd);
+        return ok ? run : nullptr;
+    }
+
+    bool mayContain(const std::string& key) const {
+        uint64_t hash = MetadataEncoding::keyHash(key);
+        uint64_t bits = bloom_.size() * 8;
+        if (bits == 0) return false;
+        uint64_t step = (hash >> 32) | 1;
+        for (uint32_t i = 0; i < METADATA_BLOOM_HASHES; i++, hash += step) {
+            if (!(bloom_[(hash % bits) >> 3] & (1 << (hash % bits & 7)))) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief The block that would hold `key` (0 if it sorts before every block)
+     */
+    size_t blockFor(const std::string& key) const {
+        auto after = std::upper_bound(blocks_.begin(), blocks_.end(), key,
+            [](const std::string& target, const Block& block) { return target < block.firstKey; });
+        return after == blocks_.begin() ? 0 : (after - blocks_.begin()) - 1;
+    }
+
+    bool get(const std::string& key, std::string& value) const {
+        if (blocks_.empty() || key < blocks_.front().firstKey) return false;
+        Entries entries;
+        if (!decodeBlock(blockFor(key), entries)) return false;
+        auto it = std::lower_bound(entries.begin(), entries.end(), key,
+            [](const std::pair<std::string, std::string>& entry, const std::string& target) {
+                return entry.first < target;
+            });
+        if (it == entries.end() || it->first != key) return false;
+        value = std::move(it->second);
+        return true;
+    }
+
+    /**
+     * @brief Decode block `block` into `out` (replacing its contents)
+     * @return false if the block fails its CRC
+     */
+    bool decodeBlock(size_t block, Entries& out) const {
+        using namespace MetadataEncoding;
+        out.clear();
+        const Block& where = blocks_[block];
+        const char* p = base_ + where.offset;
+        const char* end = p + where.bytes - sizeof(uint32_t);
+        uint32_t crc;
+        std::memcpy(&crc, end, sizeof(crc));
+        if (crc != Crc32c::calculate(p, end - p)) return false;
+
+        std::string key;
+        while (p < end) {
+            uint64_t shared, unshared, valueSize;
+            if (!getVarint(p, end, shared) || !getVarint(p, end, unshared) || !getVarint(p, end, valueSize) ||
+                shared > key.size() || unshared + valueSize > static_cast<uint64_t>(end - p)) {
+                return false;
+            }
+            key.resize(shared);
+            key.append(p, unshared);
+            p += unshared;
+            out.emplace_back(key, std::string(p, valueSize));
+            p += valueSize;
+        }
+        return true;
+    }
+
+    const MetadataRunHeader& header() const { return header_; }
+    uint32_t number() const { return number_; }
+    const std::string& path() const { return path_; }
+    size_t blocks() const { return blocks_.size(); }
+    size_t fileBytes() const { return size_; }
+    size_t residentBytes() const { return header_.indexBytes + bloom_.size(); }
+
+private:
+    struct Block {
+        std::string firstKey;
+        uint64_t offset;
+        uint32_t bytes;
+    };
+
+    MetadataRun() = default;
+
+    bool loadIndex() {
+        using namespace MetadataEncoding;
+        const char* p = base_ + header_.indexOffset;
+        const char* end = p + header_.indexBytes;
+        if (Crc32c::calculate(p, header_.indexBytes) != header_.indexCrc ||
+            Crc32c::calculate(end, header_.bloomBytes) != header_.bloomCrc) {
+            return false;
+        }
+        bloom_.assign(end, header_.bloomBytes);
+        while (p < end) {
+            Block block;
+            uint64_t bytes;
+            if (!getBytes(p, end, block.firstKey) || !getVarint(p, end, block.offset) || !getVarint(p, end, bytes) ||
+                bytes < sizeof(uint32_t) || block.offset + bytes > header_.indexOffset) {
+                return false;
+            }
+            block.bytes = static_cast<uint32_t>(bytes);
+            blocks_.push_back(std::move(block));
+        }
+        return blocks_.size() == header_.blocks;
+    }
+
+    std::string path_;
+    uint32_t number_ = 0;
+    MetadataRunHeader header_{};
+    std::vector<Block> blocks_;
+    std::string bloom_;
+    const char* base_ = nullptr;
+    size_t size_ = 0;
+};
+
+//=============================================================================
+// Metadata Store
+//=============================================================================
+
+class MetadataStore {
+public:
+    struct Stats {
+        uint64_t puts = 0;
+        size_t runs = 0;
+        uint64_t runEntries = 0;
+        uint64_t fileBytes = 0;
+        uint64_t residentBytes = 0;    // Block indexes and bloom filters
+        size_t memtableBytes = 0;
+        uint64_t flushes = 0;
+        uint64_t merges = 0;
+        uint64_t bloomSkips = 0;       // Run reads a filter saved
+    };
+
+    explicit MetadataStore(const MetadataStoreConfig& config = MetadataStoreConfig())
+        : config_(config) {}
+
+    ~MetadataStore() {
+        close();
+    }
+
+    MetadataStore(const MetadataStore&) = delete;
+    MetadataStore& operator=(const MetadataStore&) = delete;
+
+    /**
+     * @brief Load the runs in `directory` (created if needed) and replay its WALs
+     */
+    bool open(const std::string& directory) {
+        close();
+        directory_ = directory;
+        if (mkdir(directory.c_str(), 0755) < 0 && errno != EEXIST) return false;
+
+        DIR* dir = opendir(directory.c_str());
+        if (!dir) return false;
+        std::vector<std::pair<uint32_t, std::string>> runs, wals;
+        while (struct dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            unsigned number;
+            if (name.size() == 17 && sscanf(entry->d_name, "meta-%8u.run", &number) == 1 &&
+                name.compare(13, 4, ".run") == 0) {
+                runs.emplace_back(number, directory + "/" + name);
+            } else if (name.size() == 16 && sscanf(entry->d_name, "wal-%8u.log", &number) == 1 &&
+                       name.compare(12, 4, ".log") == 0) {
+                wals.emplace_back(number, directory + "/" + name);
+            } else if (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0) {
+                unlink((directory + "/" + name).c_str());   // Run write cut short by a crash
+            }
+        }
+        closedir(dir);
+        std::sort(runs.begin(), runs.end());
+        std::sort(wals.begin(), wals.end());
+
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            runs_.clear();
+            memtable_.clear();
+            memtableBytes_ = 0;
+            memtableWals_.clear();
+            for (const auto& file : runs) {
+                nextFile_ = std::max(nextFile_, file.first + 1);
+                if (auto run = MetadataRun::open(file.second, file.first)) runs_.push_back(run);
+            }
+            sortRuns();
+            for (const auto& file : wals) {
+                nextFile_ = std::max(nextFile_, file.first + 1);
+                if (replay(file.second) > 0) {
+                    memtableWals_.push_back(file.first);
+                } else {
+                    unlink(file.second.c_str());   // Opened after the last flush, never written
+                }
+            }
+        }
+        if (!openWal()) return false;
+
+        stopping_ = false;
+        thread_ = std::thread([this] { run(); });
+        return true;
+    }
+
+    /**
+     * @brief Write the memtable out as a run and stop the background thread
+     */
+    void close() {
+        if (!thread_.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(flushMutex_);
+            stopping_ = true;
+        }
+        flushWake_.notify_one();
+        thread_.join();
+        if (walFd_ >= 0) {
+            ::close(walFd_);
+            walFd_ = -1;
+        }
+    }
+
+    bool put(const DNAMetadata& record) {
+        return put(&record, 1);
+    }
+
+    /**
+     * @brief Store records (a record with an existing sequence ID replaces it)
+     *
+     * The batch is one WAL write: after a crash all of it is back or none.
+     */
+    bool put(const DNAMetadata* records, size_t count) {
+        using namespace MetadataEncoding;
+        std::vector<std::pair<std::string, std::string>> entries;
+        entries.reserve(3 * count);
+        for (size_t i = 0; i < count; i++) {
+            const DNAMetadata& record = records[i];
+            std::string id(record.sequenceId, fieldSize(record.sequenceId, sizeof(record.sequenceId)));
+            std::string client(record.clientId, fieldSize(record.clientId, sizeof(record.clientId)));
+            entries.emplace_back(recordKey(id), encode(record));
+            entries.emplace_back(timeKey(record.timestamp, id), std::string());
+            entries.emplace_back(clientKey(client, record.timestamp, id), std::string());
+        }
+
+        std::string frame(2 * sizeof(uint32_t), '\0');
+        putVarint(frame, entries.size());
+        for (const auto& entry : entries) {
+            putVarint(frame, entry.first.size());
+            frame += entry.first;
+            putVarint(frame, entry.second.size());
+            frame += entry.second;
+        }
+        uint32_t length = static_cast<uint32_t>(frame.size() - 2 * sizeof(uint32_t));
+        uint32_t crc = Crc32c::calculate(frame.data() + 2 * sizeof(uint32_t), length);
+        std::memcpy(&frame[0], &length, sizeof(length));
+        std::memcpy(&frame[sizeof(uint32_t)], &crc, sizeof(crc));
+
+        // WAL order is memtable order: one writer at a time
+        std::lock_guard<std::mutex> writing(putMutex_);
+        if (!appendWal(frame) || (config_.syncWrites && fdatasync(walFd_) != 0)) return false;
+        bool full;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            for (auto& entry : entries) insert(std::move(entry.first), std::move(entry.second));
+            full = memtableBytes_ >= config_.memtableBytes && !frozen_;
+            if (full) freeze();
+        }
+        puts_.fetch_add(count, std::memory_order_relaxed);
+        if (full) {
+            if (!openWal()) return false;
+            wakeFlusher();
+        }
+        return true;
+    }
+
+    /**
+     * @brief fdatasync the WAL: every put() so far survives a crash
+     */
+    bool sync() {
+        std::lock_guard<std::mutex> writing(putMutex_);
+        return walFd_ >= 0 && fdatasync(walFd_) == 0;
+    }
+
+    /**
+     * @brief Point lookup by sequence ID
+     */
+    bool get(const std::string& sequenceId, DNAMetadata& record) const {
+        std::string value;
+        return read(MetadataEncoding::recordKey(sequenceId), value) &&
+               MetadataEncoding::decode(value, record);
+    }
+
+    /**
+     * @brief Records with from <= timestamp <= to, in timestamp order
+     * @return number of records passed to fn(const DNAMetadata&)
+     */
+    template<typename Fn>
+    size_t byTimestamp(uint64_t from, uint64_t to, Fn fn) const {
+        std::string low("T"), high("T");
+        MetadataEncoding::putOrdered(low, from);
+        MetadataEncoding::putOrdered(high, to);
+        high.push_back('\xff');   // Past every sequence ID at `to`
+        return markers(low, high, 1, std::string(), fn);
+    }
+
+    /**
+     * @brief Records of one client with from <= timestamp <= to, in timestamp order
+     */
+    template<typename Fn>
+    size_t byClient(const std::string& clientId, uint64_t from, uint64_t to, Fn fn) const {
+        std::string prefix = MetadataEncoding::clientPrefix(clientId);
+        std::string low = prefix, high = prefix;
+        MetadataEncoding::putOrdered(low, from);
+        MetadataEncoding::putOrdered(high, to);
+        high.push_back('\xff');
+        return markers(low, high, prefix.size(), clientId, fn);
+    }
+
+    /**
+     * @brief Write the memtable as a run now, then merge (normally the background thread does both)
+     */
+    bool flush() {
+        while (true) {
+            {
+                std::lock_guard<std::mutex> writing(putMutex_);
+                bool fresh = false;
+                {
+                    std::unique_lock<std::shared_mutex> lock(mutex_);
+                    if (!frozen_) {
+                        if (memtable_.empty()) break;
+                        freeze();
+                        fresh = true;
+                    }
+                }
+                if (fresh && !openWal()) return false;
+            }
+            std::lock_guard<std::mutex> compacting(compactMutex_);
+            if (!flushFrozen()) return false;
+        }
+        std::lock_guard<std::mutex> compacting(compactMutex_);
+        return mergeLevels();
+    }
+
+    Stats stats() const {
+        Stats stats;
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        stats.puts = puts_.load(std::memory_order_relaxed);
+        stats.runs = runs_.size();
+        for (const auto& run : runs_) {
+            stats.runEntries += run->header().entries;
+            stats.fileBytes += run->fileBytes();
+            stats.residentBytes += run->residentBytes();
+        }
+        stats.memtableBytes = memtableBytes_ + (frozen_ ? frozen_->bytes : 0);
+        stats.flushes = flushes_.load(std::memory_order_relaxed);
+        stats.merges = merges_.load(std::memory_order_relaxed);
+        stats.bloomSkips = bloomSkips_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    const std::string& directory() const { return directory_; }
+
+private:
+    using Table = std::map<std::string, std::string>;
+
+    struct Frozen {
+        Table table;
+        size_t bytes;
+        std::vector<uint32_t> wals;   // Deleted once the run is installed
+    };
+
+    static std::string filePath(const std::string& directory, const char* format, uint32_t number) {
+        char name[32];
+        snprintf(name, sizeof(name), format, number);
+        return directory + "/" + name;
+    }
+
+    // Newest first: lower levels are newer, and on one level higher numbers are
+    void sortRuns() {
+        std::sort(runs_.begin(), runs_.end(), [](const std::shared_ptr<MetadataRun>& a,
+                                                  const std::shared_ptr<MetadataRun>& b) {
+            if (a->header().level != b->header().level) return a->header().level < b->header().level;
+            return a->number() > b->number();
+        });
+    }
+
+    // Caller holds mutex_ exclusively
+    void insert(std::string key, std::string value) {
+        size_t bytes = key.size() + value.size() + 64;   // Map node overhead, roughly
+        auto it = memtable_.find(key);
+        if (it != memtable_.end()) {
+            memtableBytes_ -= it->first.size() + it->second.size() + 64;
+            it->second = std::move(value);
+        } else {
+            memtable_.emplace(std::move(key), std::move(value));
+        }
+        memtableBytes_ += bytes;
+    }
+
+    // Caller holds mutex_ exclusively (and putMutex_, or is open())
+    void freeze() {
+        frozen_ = std::make_shared<Frozen>(Frozen{std::move(memtable_), memtableBytes_, std::move(memtableWals_)});
+        memtable_.clear();
+        memtableBytes_ = 0;
+        memtableWals_.clear();
+    }
+
+    bool read(const std::string& key, std::string& value) const {
+        std::shared_ptr<const Frozen> frozen;
+        std::vector<std::shared_ptr<MetadataRun>> runs;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto it = memtable_.find(key);
+            if (it != memtable_.end()) {
+                value = it->second;
+                return true;
+            }
+            frozen = frozen_;
+            runs = runs_;
+        }
+        if (frozen) {
+            auto it = frozen->table.find(key);
+            if (it != frozen->table.end()) {
+                value = it->second;
+                return true;
+            }
+        }
+        for (const auto& run : runs) {
+            if (!run->mayContain(key)) {
+                bloomSkips_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            if (run->get(key, value)) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Walk the markers in [low, high) and pass on the records that still match
+     */
+    template<typename Fn>
+    size_t markers(const std::string& low, const std::string& high, size_t prefix, const std::string& clientId,
+                   Fn& fn) const {
+        // Markers carry no values, so the union of every source's keys is enough
+        std::vector<std::string> keys;
+        std::shared_ptr<const Frozen> frozen;
+        std::vector<std::shared_ptr<MetadataRun>> runs;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            for (auto it = memtable_.lower_bound(low); it != memtable_.end() && it->first < high; ++it) {
+                keys.push_back(it->first);
+            }
+            frozen = frozen_;
+            runs = runs_;
+        }
+        if (frozen) {
+            for (auto it = frozen->table.lower_bound(low); it != frozen->table.end() && it->first < high; ++it) {
+                keys.push_back(it->first);
+            }
+        }
+        MetadataRun::Entries entries;
+        for (const auto& run : runs) {
+            for (size_t block = run->blockFor(low); block < run->blocks(); block++) {
+                if (!run->decodeBlock(block, entries)) continue;
+                bool past = false;
+                for (const auto& entry : entries) {
+                    if (entry.first >= high) {
+                        past = true;
+                        break;
+                    }
+                    if (entry.first >= low) keys.push_back(entry.first);
+                }
+                if (past) break;
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        size_t count = 0;
+        DNAMetadata record;
+        for (const std::string& key : keys) {
+            uint64_t timestamp = MetadataEncoding::getOrdered(key.data() + prefix);
+            if (!get(key.substr(prefix + 8), record) || record.timestamp != timestamp ||
+                (prefix > 1 && clientId != record.clientId)) {
+                continue;   // Left behind by a record that was replaced since
+            }
+            fn(static_cast<const DNAMetadata&>(record));
+            count++;
+        }
+        return count;
+    }
+
+    // Caller holds putMutex_ (or is open())
+    bool openWal() {
+        if (walFd_ >= 0) ::close(walFd_);
+        uint32_t number;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            number = nextFile_++;
+            memtableWals_.push_back(number);
+        }
+        walFd_ = ::open(filePath(directory_, "wal-%08u.log", number).c_str(),
+                        O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+        if (walFd_ < 0) return false;
+        syncDirectory();
+        return true;
+    }
+
+    bool appendWal(const std::string& frame) {
+        size_t done = 0;
+        while (done < frame.size()) {
+            ssize_t n = ::write(walFd_, frame.data() + done, frame.size() - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Re-insert a WAL's batches; stops at the first torn or corrupt frame
+     * @return batches replayed (caller holds mutex_ exclusively)
+     */
+    size_t replay(const std::string& path) {
+        using namespace MetadataEncoding;
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return 0;
+        std::string contents;
+        char buffer[1 << 16];
+        ssize_t n;
+        while ((n = ::read(fd, buffer, sizeof(buffer))) > 0) contents.append(buffer, n);
+        ::close(fd);
+
+        size_t batches = 0;
+        const char* p = contents.data();
+        const char* end = p + contents.size();
+        while (end - p >= static_cast<ptrdiff_t>(2 * sizeof(uint32_t))) {
+            uint32_t length, crc;
+            std::memcpy(&length, p, sizeof(length));
+            std::memcpy(&crc, p + sizeof(uint32_t), sizeof(crc));
+            const char* frame = p + 2 * sizeof(uint32_t);
+            if (length > static_cast<uint64_t>(end - frame) || Crc32c::calculate(frame, length) != crc) break;
+            const char* frameEnd = frame + length;
+            uint64_t count;
+            getVarint(frame, frameEnd, count);
+            std::string key, value;
+            for (uint64_t i = 0; i < count && getBytes(frame, frameEnd, key) && getBytes(frame, frameEnd, value); i++) {
+                insert(std::move(key), std::move(value));
+            }
+            p = frameEnd;
+            batches++;
+        }
+        return batches;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(flushMutex_);
+        while (true) {
+            flushWake_.wait(lock, [&] { return stopping_ || hasFrozen(); });
+            bool stopping = stopping_;
+            lock.unlock();
+            if (stopping) {
+                flush();
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> compacting(compactMutex_);
+                flushFrozen();
+                mergeLevels();
+            }
+            lock.lock();
+        }
+    }
+
+    void wakeFlusher() {
+        std::lock_guard<std::mutex> lock(flushMutex_);
+        flushWake_.notify_one();
+    }
+
+    bool hasFrozen() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return frozen_ != nullptr;
+    }
+
+    // Caller holds compactMutex_
+    bool flushFrozen() {
+        std::shared_ptr<const Frozen> frozen;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            frozen = frozen_;
+        }
+        if (!frozen) return true;
+
+        std::shared_ptr<MetadataRun> run = writeRun(0, frozen->table.size(), [&](MetadataRunWriter& writer) {
+            for (const auto& entry : frozen->table) writer.add(entry.first, entry.second);
+        });
+        if (!run) return false;   // Stays frozen (still readable, WAL kept); retried on the next flush
+
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            runs_.push_back(run);
+            sortRuns();
+            frozen_.reset();
+        }
+        for (uint32_t wal : frozen->wals) unlink(filePath(directory_, "wal-%08u.log", wal).c_str());
+        flushes_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Merge while some level has METADATA_MERGE_FANIN runs (caller holds compactMutex_)
+     */
+    bool mergeLevels() {
+        while (true) {
+            std::vector<std::shared_ptr<MetadataRun>> inputs;   // Newest first
+            uint32_t level = 0;
+            uint64_t entries = 0;
+            {
+                std::shared_lock<std::shared_mutex> lock(mutex_);
+                for (level = 0; level < 64 && inputs.empty(); level++) {
+                    std::vector<std::shared_ptr<MetadataRun>> same;
+                    for (const auto& run : runs_) {
+                        if (run->header().level == level) same.push_back(run);
+                    }
+                    if (same.size() >= METADATA_MERGE_FANIN) inputs = same;
+                }
+            }
+            if (inputs.empty()) return true;
+            for (const auto& input : inputs) entries += input->header().entries;
+
+            std::shared_ptr<MetadataRun> merged = writeRun(level, entries, [&](MetadataRunWriter& writer) {
+                mergeRuns(inputs, writer);
+            });
+            if (!merged) return false;
+            {
+                std::unique_lock<std::shared_mutex> lock(mutex_);
+                runs_.erase(std::remove_if(runs_.begin(), runs_.end(), [&](const std::shared_ptr<MetadataRun>& run) {
+                    return std::find(inputs.begin(), inputs.end(), run) != inputs.end();
+                }), runs_.end());
+                runs_.push_back(merged);
+                sortRuns();
+            }
+            for (const auto& input : inputs) unlink(input->path().c_str());
+            merges_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // k-way merge; on equal keys the newest input's value wins
+    static void mergeRuns(const std::vector<std::shared_ptr<MetadataRun>>& inputs, MetadataRunWriter& writer) {
+        struct Cursor {
+            const MetadataRun* run;
+            size_t block;
+            size_t next;
+            MetadataRun::Entries entries;
+
+            bool valid() const { return next < entries.size(); }
+            const std::string& key() const { return entries[next].first; }
+            void advance() {
+                if (++next < entries.size()) return;
+                next = 0;
+                entries.clear();
+                while (entries.empty() && ++block < run->blocks()) run->decodeBlock(block, entries);
+            }
+        };
+        std::vector<Cursor> cursors;
+        for (const auto& run : inputs) {
+            Cursor cursor{run.get(), 0, 0, {}};
+            if (run->blocks() > 0 && !run->decodeBlock(0, cursor.entries)) cursor.advance();
+            cursors.push_back(std::move(cursor));
+        }
+
+        while (true) {
+            Cursor* lowest = nullptr;   // First of equals: cursors are newest first
+            for (Cursor& cursor : cursors) {
+                if (cursor.valid() && (!lowest || cursor.key() < lowest->key())) lowest = &cursor;
+            }
+            if (!lowest) return;
+            std::string key = lowest->key();
+            writer.add(key, lowest->entries[lowest->next].second);
+            for (Cursor& cursor : cursors) {
+                if (cursor.valid() && cursor.key() == key) cursor.advance();
+            }
+        }
+    }
+
+    template<typename Fill>
+    std::shared_ptr<MetadataRun> writeRun(uint32_t level, uint64_t expectedKeys, Fill fill) {
+        uint32_t number;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            number = nextFile_++;
+        }
+        std::string path = filePath(directory_, "meta-%08u.run", number);
+        std::string temporary = path + ".tmp";
+        MetadataRunWriter writer(expectedKeys);
+        if (!writer.open(temporary, level)) return nullptr;
+        fill(writer);
+        if (!writer.close() || rename(temporary.c_str(), path.c_str()) < 0) {
+            unlink(temporary.c_str());
+            return nullptr;
+        }
+        syncDirectory();
+        return MetadataRun::open(path, number);
+    }
+
+    void syncDirectory() const {
+        int fd = ::open(directory_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) return;
+        fsync(fd);
+        ::close(fd);
+    }
+
+    const MetadataStoreConfig config_;
+    std::string directory_;
+
+    // Writers: WAL append and memtable insert in one order
+    std::mutex putMutex_;
+    int walFd_ = -1;
+
+    // Tables: memtable, the frozen memtable being written, runs (newest first)
+    mutable std::shared_mutex mutex_;
+    Table memtable_;
+    size_t memtableBytes_ = 0;
+    std::vector<uint32_t> memtableWals_;
+    std::shared_ptr<const Frozen> frozen_;
+    std::vector<std::shared_ptr<MetadataRun>> runs_;
+    uint32_t nextFile_ = 1;
+
+    // Background flush and compaction
+    std::mutex flushMutex_;
+    std::condition_variable flushWake_;
+    bool stopping_ = false;
+    std::thread thread_;
+    std::mutex compactMutex_;   // One writer of run files: the thread or flush()
+    std::atomic<uint64_t> puts_{0};
+    std::atomic<uint64_t> flushes_{0};
+    std::atomic<uint64_t> merges_{0};
+    mutable std::atomic<uint64_t> bloomSkips_{0};
+};
+
+} // namespace DNASerialProcessor
+
+#endif // DNA_METADATA_STORE_HPP
@@ -0,0 +1,282 @@
+#ifndef DNA_METRICS_HPP
+#define DNA_METRICS_HPP
+
+/**
+ * @file dna_metrics.hpp
+ * @brief Metrics export: sliding-window rates, Prometheus text format, HTTP listener
+ *
+ * - SlidingRate turns a monotonically growing counter into a per-second
+ *   rate over the last N seconds by sampling it, so the hot path keeps
+ *   incrementing plain atomics and never sees the meter.
+ * - MetricsWriter renders counters, gauges and LatencyHistograms in the
+ *   Prometheus text exposition format (version 0.0.4).
+ * - MetricsHttpServer is a one-thread HTTP/1.0 listener on its own port:
+ *   GET /metrics returns the text produced by the render callback. It
+ *   also calls a tick callback once a second to feed the meters.
+ *
+ * @version 1.0
+ * @date 2025-11-24
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "dna_latency_histogram.hpp"
+
+namespace DNASerialProcessor {
+
+constexpr int METRICS_TICK_MS = 1000;            // Meter sampling period
+constexpr size_t METRICS_MAX_REQUEST = 8192;     // Request bytes read before answering
+constexpr int METRICS_IO_TIMEOUT_MS = 1000;      // Per-request read/write timeout
+
+// Prometheus histogram bucket edges for latencies, in seconds
+constexpr double METRICS_LATENCY_BUCKETS[] = {
+    0.00001, 0.00005, 0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1.0, 5.0, 10.0
+};
+
+//=============================================================================
+// Sliding Window Rate
+//=============================================================================
+
+/**
+ * @brief Per-second rate of a cumulative counter over a trailing window
+ *
+ * Not thread-safe: one thread samples and reads it.
+ */
+class SlidingRate {
+public:
+    explicit SlidingRate(double windowSeconds) : window_(windowSeconds) {}
+
+    void sample(uint64_t total, double nowSeconds) {
+        samples_.emplace_back(nowSeconds, total);
+        // Keep one sample at or before the window start as the baseline
+        while (samples_.size() > 2 && samples_[1].first <= nowSeconds - window_) {
+            samples_.pop_front();
+        }
+    }
+
+    /**
+     * @brief Average rate between the oldest kept sample and the newest one
+     *
+     * Until the window has filled, this is the rate since the first sample.
+     */
+    double perSecond() const {
+        if (samples_.size() < 2) return 0.0;
+        double elapsed = samples_.back().first - samples_.front().first;
+        if (elapsed <= 0.0) return 0.0;
+        return (samples_.back().second - samples_.front().second) / elapsed;
+    }
+
+    double window() const { return window_; }
+
+private:
+    double window_;
+    std::deque<std::pair<double, uint64_t>> samples_;   // (time, counter value)
+};
+
+//=============================================================================
+// Prometheus Text Format
+//=============================================================================
+
+class MetricsWriter {
+public:
+    /**
+     * @brief # HELP / # TYPE lines; once per metric name, before its samples
+     */
+    void header(const char* name, const char* type, const char* help) {
+        out_ += "# HELP "; out_ += name; out_ += ' '; out_ += help; out_ += '\n';
+        out_ += "# TYPE "; out_ += name; out_ += ' '; out_ += type; out_ += '\n';
+    }
+
+    /**
+     * @param labels  e.g. `worker="0",shard="1"` (no braces), or empty
+     */
+    void value(const char* name, double v, const std::string& labels = "") {
+        out_ += name;
+        if (!labels.empty()) {
+            out_ += '{'; out_ += labels; out_ += '}';
+        }
+        out_ += ' ';
+        out_ += format(v);
+        out_ += '\n';
+    }
+
+    /**
+     * @brief `name_bucket`/`_sum`/`_count` samples of a nanosecond histogram, in seconds
+     *
+     * Bucket counts come from the histogram's own buckets, so an edge is
+     * accurate to the histogram's 6.25% resolution.
+     */
+    void histogram(const char* name, const LatencyHistogram& h, const std::string& labels = "") {
+        std::string prefix = labels.empty() ? "" : labels + ",";
+        std::string bucket = std::string(name) + "_bucket";
+        for (double edge : METRICS_LATENCY_BUCKETS) {
+            value(bucket.c_str(), static_cast<double>(h.countAtOrBelow(static_cast<uint64_t>(edge * 1e9))),
+                  prefix + "le=\"" + format(edge) + "\"");
+        }
+        value(bucket.c_str(), static_cast<double>(h.count()), prefix + "le=\"+Inf\"");
+        value((std::string(name) + "_sum").c_str(), h.sum() / 1e9, labels);
+        value((std::string(name) + "_count").c_str(), static_cast<double>(h.count()), labels);
+    }
+
+    const std::string& str() const { return out_; }
+
+private:
+    // Counters print as integers; rates and edges with enough digits to round-trip what we mean
+    static std::string format(double v) {
+        char buffer[32];
+        if (v == static_cast<double>(static_cast<int64_t>(v))) {
+            snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(v));
+        } else {
+            snprintf(buffer, sizeof(buffer), "%.9g", v);
+        }
+        return buffer;
+    }
+
+    std::string out_;
+};
+
+//=============================================================================
+// HTTP Listener
+//=============================================================================
+
+class MetricsHttpServer {
+public:
+    using Renderer = std::function<std::string()>;
+    using Ticker = std::function<void()>;
+
+    MetricsHttpServer(int port, Renderer render, Ticker tick)
+        : port_(port), render_(std::move(render)), tick_(std::move(tick)) {}
+
+    ~MetricsHttpServer() {
+        stop();
+    }
+
+    MetricsHttpServer(const MetricsHttpServer&) = delete;
+    MetricsHttpServer& operator=(const MetricsHttpServer&) = delete;
+
+    bool start() {
+        listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listenFd_ < 0) return false;
+
+        int opt = 1;
+        struct sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = INADDR_ANY;
+        address.sin_port = htons(port_);
+        if (setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+            bind(listenFd_, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+            listen(listenFd_, 16) < 0) {
+            close(listenFd_);
+            listenFd_ = -1;
+            return false;
+        }
+
+        running_ = true;
+        thread_ = std::thread([this] { serve(); });
+        return true;
+    }
+
+    void stop() {
+        if (!running_.exchange(false)) return;
+        if (thread_.joinable()) thread_.join();
+        close(listenFd_);
+        listenFd_ = -1;
+    }
+
+    uint64_t requestsServed() const { return requests_.load(std::memory_order_relaxed); }
+
+private:
+    void serve() {
+        auto nextTick = std::chrono::steady_clock::now();
+        while (running_) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= nextTick) {
+                tick_();
+                nextTick = now + std::chrono::milliseconds(METRICS_TICK_MS);
+            }
+
+            int timeout = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                nextTick - std::chrono::steady_clock::now()).count());
+            struct pollfd pfd{listenFd_, POLLIN, 0};
+            if (poll(&pfd, 1, std::max(timeout, 0)) <= 0) continue;
+
+            int client = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0) continue;
+            handle(client);
+            close(client);
+        }
+    }
+
+    /**
+     * @brief One request per connection; scrapers reconnect every interval anyway
+     */
+    void handle(int client) {
+        struct timeval timeout{METRICS_IO_TIMEOUT_MS / 1000, (METRICS_IO_TIMEOUT_MS % 1000) * 1000};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        // Only the request line matters; stop at the end of the headers
+        std::string request;
+        char buffer[1024];
+        while (request.size() < METRICS_MAX_REQUEST && request.find("\r\n\r\n") == std::string::npos &&
+               request.find("\n\n") == std::string::npos) {
+            ssize_t n = recv(client, buffer, sizeof(buffer), 0);
+            if (n <= 0) break;
+            request.append(buffer, n);
+        }
+
+        std::string status = "200 OK";
+        std::string type = "text/plain; version=0.0.4; charset=utf-8";
+        std::string body;
+        if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 14, "GET /metrics?") == 0) {
+            body = render_();
+        } else if (request.compare(0, 4, "GET ") == 0) {
+            status = "404 Not Found";
+            type = "text/plain; charset=utf-8";
+            body = "Metrics are at /metrics\n";
+        } else {
+            status = "405 Method Not Allowed";
+            type = "text/plain; charset=utf-8";
+        }
+        requests_.fetch_add(1, std::memory_order_relaxed);
+
+        std::string response = "HTTP/1.0 " + status + "\r\nContent-Type: " + type +
+                               "\r\nContent-Length: " + std::to_string(body.size()) +
+                               "\r\nConnection: close\r\n\r\n" + body;
+        size_t sent = 0;
+        while (sent < response.size()) {
+            ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            sent += n;
+        }
+    }
+
+    int port_;
+    int listenFd_ = -1;
+    Renderer render_;
+    Ticker tick_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> requests_{0};
+    std::thread thread_;
+};
+
+} // namespace DNASerialProcessor
+
+#endif // DNA_METRICS_HPP
@@ -0,0 +1,929 @@
+#ifndef DNA_RECORD_INDEX_HPP
+#define DNA_RECORD_INDEX_HPP
+
+/**
+ * @file dna_record_index.hpp
+ * @brief Persistent sorted index of stored records by ID, name and checksum
+ *
+ * Implements StorageConfig::enableIndexing for the segment log. Each
+ * stored record yields up to three IndexEntry keys (its ID, a 64-bit hash
+ * of its sequence name, its CRC32) pointing at its LogLocation.
+ *
+ * - New entries go into an in-memory memtable. Once it holds
+ *   memtableEntries, it is frozen and a background thread writes it out
+ *   as a sorted run file (`index-00000001.run`, ...).
+ * - A run is a sequence of blocks of INDEX_BLOCK_ENTRIES entries, each
+ *   delta- and varint-compressed, followed by a fence table with the
+ *   first key of every block. Only the fence table is kept in memory
+ *   (about 0.25 bytes per entry); blocks are read from an mmap of the
+ *   file. A lookup binary-searches each run's fences and decodes one or
+ *   two blocks.
+ * - Runs are leveled: when INDEX_MERGE_FANIN runs share a level, they are
+ *   merged into one run on the next level. A run therefore takes part in
+ *   O(log n) merges, and a lookup touches O(log n) runs.
+ *
+ * Each run records a log position, covered(): every record before it is
+ * in that run or an older one. The owner says where the log stands
+ * (followLog(), normally SegmentLog::published()), and a memtable takes
+ * that position when it is frozen. checkpointIndex() writes the memtable
+ * with every log checkpoint and records the position in it. A restart
+ * re-adds only the records after that (catchUpIndex()): none after a
+ * clean close(), the log's tail since the last checkpoint after a crash.
+ *
+ * Name keys are hashes: callers compare the stored record's name to rule
+ * out a collision.
+ *
+ * @version 1.0
+ * @date 2025-11-24
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dna_crc32c.hpp"
+#include "dna_segment_log.hpp"
+
+namespace DNASerialProcessor {
+
+constexpr char INDEX_MAGIC[8] = {'D', 'N', 'A', 'I', 'D', 'X', '\r', '\n'};
+constexpr uint32_t INDEX_VERSION = 2;                // 2: covered is an exact log position
+constexpr size_t INDEX_HEADER_SIZE = 64;
+constexpr size_t INDEX_BLOCK_ENTRIES = 128;          // Entries per compressed block (one fence each)
+constexpr size_t INDEX_MEMTABLE_ENTRIES = 1 << 16;   // Frozen and written as a run when reached
+constexpr size_t INDEX_MERGE_FANIN = 4;              // Runs on one level before they merge
+
+enum class IndexKind : uint8_t {
+    ID = 1,
+    NAME = 2,        // 64-bit hash of the sequence name (indexNameHash)
+    CHECKSUM = 3     // CRC32 of the bases, as in the record's Inchrosil header
+};
+
+struct IndexEntry {
+    IndexKind kind;
+    uint64_t key;
+    uint64_t id;
+    LogLocation where;
+
+    // Key order; equal keys oldest first by log position
+    bool operator<(const IndexEntry& other) const {
+        if (kind != other.kind) return kind < other.kind;
+        if (key != other.key) return key < other.key;
+        if (where.segment != other.where.segment) return where.segment < other.where.segment;
+        return where.offset < other.where.offset;
+    }
+
+    bool operator==(const IndexEntry& other) const {
+        return kind == other.kind && key == other.key && where.segment == other.where.segment &&
+               where.offset == other.where.offset;
+    }
+};
+
+struct IndexFileHeader {
+    char magic[8];             // INDEX_MAGIC
+    uint32_t version;
+    uint32_t level;            // 0: written from a memtable; n + 1: merged from level n
+    uint64_t entries;
+    uint64_t blocks;
+    uint64_t fenceOffset;      // Fence table: `blocks` IndexFence records
+    uint32_t coveredSegment;   // Every record before (coveredSegment, coveredOffset) is in this run or an older one
+    uint32_t fenceCrc;         // CRC32C of the fence table
+    uint64_t coveredOffset;
+    uint32_t reserved;
+    uint32_t crc;              // CRC32C of the fields above
+};
+
+static_assert(sizeof(IndexFileHeader) == INDEX_HEADER_SIZE, "index header is 64 bytes");
+
+struct IndexFence {
+    uint8_t kind;              // First entry of the block
+    uint8_t pad[3];
+    uint32_t entries;
+    uint64_t key;
+    uint64_t offset;           // Of the block in the file
+    uint32_t bytes;            // Block size, its trailing CRC32C included
+    uint32_t reserved;
+};
+
+static_assert(sizeof(IndexFence) == 32, "fence is 32 bytes");
+
+/**
+ * @brief FNV-1a: the NAME key of a sequence name
+ */
+inline uint64_t indexNameHash(const char* name, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ static_cast<uint8_t>(name[i])) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+//=============================================================================
+// Run Files
+//=============================================================================
+
+/**
+ * @brief Writes sorted entries as blocks, then the fence table and the header
+ */
+class IndexRunWriter {
+public:
+    bool open(const std::string& path, uint32_t level) {
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) return false;
+        level_ = level;
+        offset_ = INDEX_HEADER_SIZE;
+        ok_ = true;
+        return true;
+    }
+
+    /**
+     * @brief Entries must arrive in IndexEntry order; equal neighbours are dropped
+     */
+    void add(const IndexEntry& entry) {
+        if (entries_ > 0 && entry == last_) return;
+        if (inBlock_ == 0) {
+            fences_.push_back({static_cast<uint8_t>(entry.kind), {}, 0, entry.key, offset_, 0, 0});
+            prevKind_ = 0;
+            prevKey_ = 0;
+        }
+        block_.push_back(static_cast<char>(entry.kind));
+        putVarint(static_cast<uint8_t>(entry.kind) == prevKind_ ? entry.key - prevKey_ : entry.key);
+        putVarint(entry.id);
+        putVarint(entry.where.segment);
+        putVarint(entry.where.offset);
+        putVarint(entry.where.length);
+        prevKind_ = static_cast<uint8_t>(entry.kind);
+        prevKey_ = entry.key;
+        last_ = entry;
+        entries_++;
+        if (++inBlock_ == INDEX_BLOCK_ENTRIES) endBlock();
+    }
+
+    /**
+     * @brief Finish the file and make it durable
+     */
+    bool close() {
+        if (fd_ < 0) return false;
+        if (inBlock_ > 0) endBlock();
+
+        IndexFileHeader header{};
+        std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        header.version = INDEX_VERSION;
+        header.level = level_;
+        header.entries = entries_;
+        header.blocks = fences_.size();
+        header.fenceOffset = offset_;
+        header.coveredSegment = covered_.segment;
+        header.coveredOffset = covered_.offset;
+        header.fenceCrc = Crc32c::calculate(fences_.data(), fences_.size() * sizeof(IndexFence));
+        header.crc = Crc32c::calculate(&header, offsetof(IndexFileHeader, crc));
+
+        ok_ = ok_ && writeAt(fences_.data(), fences_.size() * sizeof(IndexFence), offset_) &&
+              writeAt(&header, sizeof(header), 0) && fdatasync(fd_) == 0;
+        ::close(fd_);
+        fd_ = -1;
+        return ok_;
+    }
+
+    /**
+     * @brief Log position the run covers up to (the largest one given)
+     */
+    void cover(const LogLocation& upTo) {
+        if (logBefore(covered_, upTo)) covered_ = upTo;
+    }
+
+    uint64_t entries() const { return entries_; }
+
+private:
+    void putVarint(uint64_t v) {
+        while (v >= 0x80) {
+            block_.push_back(static_cast<char>(v | 0x80));
+            v >>= 7;
+        }
+        block_.push_back(static_cast<char>(v));
+    }
+
+    void endBlock() {
+        uint32_t crc = Crc32c::calculate(block_.data(), block_.size());
+        block_.append(reinterpret_cast<const char*>(&crc), sizeof(crc));
+        IndexFence& fence = fences_.back();
+        fence.entries = static_cast<uint32_t>(inBlock_);
+        fence.bytes = static_cast<uint32_t>(block_.size());
+        ok_ = ok_ && writeAt(block_.data(), block_.size(), offset_);
+        offset_ += block_.size();
+        block_.clear();
+        inBlock_ = 0;
+    }
+
+    bool writeAt(const void* data, size_t size, uint64_t offset) {
+        const char* p = static_cast<const char*>(data);
+        size_t done = 0;
+        while (done < size) {
+            ssize_t n = pwrite(fd_, p + done, size - done, offset + done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    int fd_ = -1;
+    bool ok_ = false;
+    uint32_t level_ = 0;
+    uint64_t offset_ = 0;
+    uint64_t entries_ = 0;
+    size_t inBlock_ = 0;
+    uint8_t prevKind_ = 0;
+    uint64_t prevKey_ = 0;
+    IndexEntry last_{};
+    LogLocation covered_;
+    std::string block_;
+    std::vector<IndexFence> fences_;
+};
+
+/**
+ * @brief An open run: fence table in memory, blocks through mmap
+ */
+class IndexRun {
+public:
+    ~IndexRun() {
+        if (base_) munmap(const_cast<char*>(base_), size_);
+    }
+
+    /**
+     * @return nullptr if the file is not a complete run
+     */
+    static std::shared_ptr<IndexRun> open(const std::string& path, uint32_t number) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return nullptr;
+        auto run = std::shared_ptr<IndexRun>(new IndexRun);
+        run->path_ = path;
+        run->number_ = number;
+
+        struct stat info;
+        bool ok = fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= INDEX_HEADER_SIZE &&
+                  pread(fd, &run->header_, sizeof(run->header_), 0) == INDEX_HEADER_SIZE;
+        const IndexFileHeader& header = run->header_;
+        ok = ok && std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+             header.version == INDEX_VERSION &&
+             header.crc == Crc32c::calculate(&header, offsetof(IndexFileHeader, crc)) &&
+             header.fenceOffset + header.blocks * sizeof(IndexFence) == static_cast<uint64_t>(info.st_size);
+        if (ok) {
+            run->fences_.resize(header.blocks);
+            size_t bytes = header.blocks * sizeof(IndexFence);
+            ok = (bytes == 0 || pread(fd, run->fences_.data(), bytes, header.fenceOffset) ==
+                                    static_cast<ssize_t>(bytes)) &&
+                 Crc32c::calculate(run->fences_.data(), bytes) == header.fenceCrc;
+        }
+        if (ok && header.fenceOffset > INDEX_HEADER_SIZE) {
+            run->size_ = header.fenceOffset;
+            void* mapped = mmap(nullptr, run->size_, PROT_READ, MAP_SHARED, fd, 0);
+            ok = mapped != MAP_FAILED;
+            if (ok) {
+                run->base_ = static_cast<const char*>(mapped);
+                madvise(mapped, run->size_, MADV_RANDOM);
+            }
+        }
+        close(fd);
+        return ok ? run : nullptr;
+    }
+
+    /**
+     * @brief Append every entry with this key to `out`
+     */
+    void find(IndexKind kind, uint64_t key, std::vector<IndexEntry>& out) const {
+        // The last block starting before the key may hold its first entries
+        auto after = std::upper_bound(fences_.begin(), fences_.end(), std::make_pair(kind, key),
+            [](const std::pair<IndexKind, uint64_t>& target, const IndexFence& fence) {
+                return target < std::make_pair(static_cast<IndexKind>(fence.kind), fence.key);
+            });
+        size_t block = after == fences_.begin() ? 0 : (after - fences_.begin()) - 1;
+        // Fence keys equal to the target: step back, the key may start in an earlier block
+        while (block > 0 && static_cast<IndexKind>(fences_[block].kind) == kind && fences_[block].key == key) {
+            block--;
+        }
+
+        std::vector<IndexEntry> entries;
+        for (; block < fences_.size(); block++) {
+            if (!decodeBlock(block, entries)) continue;   // Damaged: the other runs may still know the key
+            bool past = false;
+            for (const IndexEntry& entry : entries) {
+                if (entry.kind == kind && entry.key == key) {
+                    out.push_back(entry);
+                } else if (std::make_pair(entry.kind, entry.key) > std::make_pair(kind, key)) {
+                    past = true;
+                    break;
+                }
+            }
+            if (past) return;
+        }
+    }
+
+    /**
+     * @brief Decode block `block` into `out` (replacing its contents)
+     * @return false if the block fails its CRC
+     */
+    bool decodeBlock(size_t block, std::vector<IndexEntry>& out) const {
+        out.clear();
+        const IndexFence& fence = fences_[block];
+        if (fence.bytes < sizeof(uint32_t) || fence.offset + fence.bytes > size_) return false;
+        const char* p = base_ + fence.offset;
+        const char* end = p + fence.bytes - sizeof(uint32_t);
+        uint32_t crc;
+        std::memcpy(&crc, end, sizeof(crc));
+        if (crc != Crc32c::calculate(p, end - p)) return false;
+
+        uint8_t prevKind = 0;
+        uint64_t prevKey = 0;
+        out.reserve(fence.entries);
+        while (p < end) {
+            IndexEntry entry;
+            uint8_t kind = static_cast<uint8_t>(*p++);
+            uint64_t key, segment, length;
+            if (!getVarint(p, end, key) || !getVarint(p, end, entry.id) || !getVarint(p, end, segment) ||
+                !getVarint(p, end, entry.where.offset) || !getVarint(p, end, length)) {
+                return false;
+            }
+            entry.kind = static_cast<IndexKind>(kind);
+            entry.key = kind == prevKind ? prevKey + key : key;
+            entry.where.segment = static_cast<uint32_t>(segment);
+            entry.where.length = static_cast<uint32_t>(length);
+            prevKind = kind;
+            prevKey = entry.key;
+            out.push_back(entry);
+        }
+        return true;
+    }
+
+    const IndexFileHeader& header() const { return header_; }
+    uint32_t number() const { return number_; }
+    const std::string& path() const { return path_; }
+    size_t blocks() const { return fences_.size(); }
+    size_t fenceBytes() const { return fences_.size() * sizeof(IndexFence); }
+    uint64_t fileBytes() const { return header_.fenceOffset + fenceBytes(); }
+
+private:
+    IndexRun() = default;
+
+    static bool getVarint(const char*& p, const char* end, uint64_t& v) {
+        v = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7) {
+            uint8_t byte = static_cast<uint8_t>(*p++);
+            v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    std::string path_;
+    uint32_t number_ = 0;
+    IndexFileHeader header_{};
+    std::vector<IndexFence> fences_;
+    const char* base_ = nullptr;
+    size_t size_ = 0;
+};
+
+//=============================================================================
+// Record Index
+//=============================================================================
+
+class RecordIndex {
+public:
+    struct Stats {
+        size_t runs = 0;
+        uint64_t runEntries = 0;       // Duplicates across runs included
+        uint64_t fileBytes = 0;
+        uint64_t fenceBytes = 0;       // Resident part of the runs
+        size_t memtableEntries = 0;
+        uint64_t flushes = 0;
+        uint64_t merges = 0;
+    };
+
+    explicit RecordIndex(size_t memtableEntries = INDEX_MEMTABLE_ENTRIES)
+        : memtableLimit_(std::max<size_t>(memtableEntries, 1)) {}
+
+    ~RecordIndex() {
+        close();
+    }
+
+    RecordIndex(const RecordIndex&) = delete;
+    RecordIndex& operator=(const RecordIndex&) = delete;
+
+    /**
+     * @brief Load the runs in `directory` (created if needed)
+     * @param readOnly  no flush thread, no cleanup: for lookups beside a running writer
+     */
+    bool open(const std::string& directory, bool readOnly = false) {
+        close();
+        directory_ = directory;
+        readOnly_ = readOnly;
+        if (!readOnly && mkdir(directory.c_str(), 0755) < 0 && errno != EEXIST) return false;
+
+        DIR* dir = opendir(directory.c_str());
+        if (!dir) return false;
+        std::vector<std::pair<uint32_t, std::string>> found;
+        while (struct dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            unsigned number;
+            char tail;
+            if (sscanf(entry->d_name, "index-%8u.ru%c", &number, &tail) == 2 && tail == 'n') {
+                if (name.size() == 18) {
+                    found.emplace_back(number, directory + "/" + name);
+                } else if (!readOnly && name.size() > 18) {
+                    unlink((directory + "/" + name).c_str());   // .tmp left by a crash mid-write
+                }
+            }
+        }
+        closedir(dir);
+        std::sort(found.begin(), found.end());
+
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        runs_.clear();
+        covered_ = LogLocation{};
+        logPosition_ = nullptr;
+        bool lost = false;
+        for (const auto& file : found) {
+            nextRun_ = std::max(nextRun_, file.first + 1);
+            auto run = IndexRun::open(file.second, file.first);
+            if (!run) {
+                // Merged away beside a reader, or damaged (or an older version): its entries come back
+                // only if the whole log is re-added
+                if (access(file.second.c_str(), F_OK) != 0) continue;
+                lost = true;
+                if (!readOnly) unlink(file.second.c_str());
+                continue;
+            }
+            const IndexFileHeader& header = run->header();
+            LogLocation covered{header.coveredSegment, 0, header.coveredOffset};
+            if (logBefore(covered_, covered)) covered_ = covered;
+            runs_.push_back(run);
+        }
+        if (lost) covered_ = LogLocation{};
+        lock.unlock();
+
+        if (!readOnly) {
+            stopping_ = false;
+            thread_ = std::thread([this] { run(); });
+        }
+        return true;
+    }
+
+    /**
+     * @brief Write the memtable out and stop the flush thread
+     */
+    void close() {
+        if (!thread_.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(flushMutex_);
+            stopping_ = true;
+        }
+        flushWake_.notify_one();
+        thread_.join();
+    }
+
+    void add(const IndexEntry& entry) {
+        add(&entry, 1);
+    }
+
+    void add(const IndexEntry* entries, size_t count) {
+        bool full;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            memtable_.insert(entries, entries + count);
+            full = memtable_.size() >= memtableLimit_ && !frozen_;
+            if (full) freeze();
+        }
+        if (full) wakeFlusher();
+    }
+
+    /**
+     * @brief Every stored location of `key`, oldest first
+     */
+    std::vector<IndexEntry> find(IndexKind kind, uint64_t key) const {
+        std::vector<IndexEntry> found;
+        std::shared_ptr<const std::set<IndexEntry>> frozen;
+        std::vector<std::shared_ptr<IndexRun>> runs;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            collect(memtable_, kind, key, found);
+            frozen = frozen_;
+            runs = runs_;
+        }
+        if (frozen) collect(*frozen, kind, key, found);
+        for (const auto& run : runs) run->find(kind, key, found);
+
+        std::sort(found.begin(), found.end());
+        found.erase(std::unique(found.begin(), found.end()), found.end());
+        return found;
+    }
+
+    /**
+     * @brief Newest location of record `id`
+     */
+    bool locate(uint64_t id, LogLocation& out) const {
+        std::vector<IndexEntry> found = find(IndexKind::ID, id);
+        if (found.empty()) return false;
+        out = found.back().where;
+        return true;
+    }
+
+    /**
+     * @brief Where the log is complete up to: every record before the position it returns has been add()ed
+     *
+     * Called when a memtable is frozen, under the index's lock. Set it once
+     * the records already in the log are added; until then runs keep the
+     * covered() they opened with.
+     */
+    using LogPosition = std::function<LogLocation()>;
+    void followLog(LogPosition position) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        logPosition_ = std::move(position);
+    }
+
+    /**
+     * @brief Every record before this log position is in the runs; re-add from here after a restart
+     */
+    LogLocation covered() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return covered_;
+    }
+
+    /**
+     * @brief Write the memtable as a run now (normally the flush thread does it)
+     */
+    bool flush() {
+        std::lock_guard<std::mutex> writing(writeMutex_);
+        // The frozen memtable, then the memtable as it is now; what is added meanwhile waits for the next flush
+        for (int pass = 0; pass < 2; pass++) {
+            {
+                std::unique_lock<std::shared_mutex> lock(mutex_);
+                if (!frozen_) {
+                    if (memtable_.empty()) {
+                        // Nothing left in memory: the runs hold everything the log had published
+                        if (logPosition_) {
+                            LogLocation position = logPosition_();
+                            if (logBefore(covered_, position)) covered_ = position;
+                        }
+                        break;
+                    }
+                    freeze();
+                }
+            }
+            if (!flushFrozen()) return false;
+        }
+        return mergeLevels();
+    }
+
+    Stats stats() const {
+        Stats stats;
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        stats.runs = runs_.size();
+        for (const auto& run : runs_) {
+            stats.runEntries += run->header().entries;
+            stats.fileBytes += run->fileBytes();
+            stats.fenceBytes += run->fenceBytes();
+        }
+        stats.memtableEntries = memtable_.size() + (frozen_ ? frozen_->size() : 0);
+        stats.flushes = flushes_.load(std::memory_order_relaxed);
+        stats.merges = merges_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    const std::string& directory() const { return directory_; }
+
+    static std::string runPath(const std::string& directory, uint32_t number) {
+        char name[32];
+        snprintf(name, sizeof(name), "index-%08u.run", number);
+        return directory + "/" + name;
+    }
+
+private:
+    static void collect(const std::set<IndexEntry>& entries, IndexKind kind, uint64_t key,
+                        std::vector<IndexEntry>& out) {
+        IndexEntry low{kind, key, 0, LogLocation{}};
+        for (auto it = entries.lower_bound(low); it != entries.end() && it->kind == kind && it->key == key; ++it) {
+            out.push_back(*it);
+        }
+    }
+
+    // Caller holds mutex_ exclusively
+    void freeze() {
+        frozen_ = std::make_shared<const std::set<IndexEntry>>(std::move(memtable_));
+        frozenCovers_ = logPosition_ ? logPosition_() : covered_;
+        memtable_.clear();
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(flushMutex_);
+        while (true) {
+            flushWake_.wait(lock, [&] { return stopping_ || hasFrozen(); });
+            bool stopping = stopping_;
+            lock.unlock();
+            if (stopping) {
+                flush();
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> writing(writeMutex_);
+                flushFrozen();
+                mergeLevels();
+            }
+            lock.lock();
+        }
+    }
+
+    // Under flushMutex_, so the thread cannot miss it between its check and its wait
+    void wakeFlusher() {
+        std::lock_guard<std::mutex> lock(flushMutex_);
+        flushWake_.notify_one();
+    }
+
+    bool hasFrozen() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return frozen_ != nullptr;
+    }
+
+    // Caller holds writeMutex_
+    bool flushFrozen() {
+        std::shared_ptr<const std::set<IndexEntry>> frozen;
+        LogLocation covers;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            frozen = frozen_;
+            covers = frozenCovers_;
+        }
+        if (!frozen) return true;
+
+        std::shared_ptr<IndexRun> run = writeRun(0, [&](IndexRunWriter& writer) {
+            for (const IndexEntry& entry : *frozen) writer.add(entry);
+            writer.cover(covers);
+        });
+        if (!run) return false;   // Kept frozen (still searchable); retried on the next flush
+
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        install(run, {});
+        frozen_.reset();
+        flushes_.fetch_add(1, std::memory_order_relaxed);
+        bool full = memtable_.size() >= memtableLimit_;
+        if (full) freeze();
+        lock.unlock();
+        if (full) wakeFlusher();
+        return true;
+    }
+
+    /**
+     * @brief Merge while some level has INDEX_MERGE_FANIN runs (caller holds writeMutex_)
+     */
+    bool mergeLevels() {
+        while (true) {
+            std::vector<std::shared_ptr<IndexRun>> inputs;
+            uint32_t level = 0;
+            {
+                std::shared_lock<std::shared_mutex> lock(mutex_);
+                for (level = 0; level < 64 && inputs.empty(); level++) {
+                    std::vector<std::shared_ptr<IndexRun>> same;
+                    for (const auto& run : runs_) {
+                        if (run->header().level == level) same.push_back(run);
+                    }
+                    if (same.size() >= INDEX_MERGE_FANIN) inputs = same;
+                }
+            }
+            if (inputs.empty()) return true;
+
+            std::shared_ptr<IndexRun> merged = writeRun(level, [&](IndexRunWriter& writer) {
+                mergeRuns(inputs, writer);
+                for (const auto& input : inputs) {
+                    writer.cover({input->header().coveredSegment, 0, input->header().coveredOffset});
+                }
+            });
+            if (!merged) return false;
+            {
+                std::unique_lock<std::shared_mutex> lock(mutex_);
+                install(merged, inputs);
+            }
+            for (const auto& input : inputs) unlink(input->path().c_str());
+            merges_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // k-way merge of the inputs' blocks; the writer drops duplicates
+    static void mergeRuns(const std::vector<std::shared_ptr<IndexRun>>& inputs, IndexRunWriter& writer) {
+        struct Cursor {
+            const IndexRun* run;
+            size_t block = 0;
+            size_t next = 0;
+            std::vector<IndexEntry> entries;
+
+            bool valid() const { return next < entries.size(); }
+            const IndexEntry& entry() const { return entries[next]; }
+            void advance() {
+                if (++next < entries.size()) return;
+                next = 0;
+                entries.clear();
+                while (entries.empty() && ++block < run->blocks()) run->decodeBlock(block, entries);
+            }
+        };
+        std::vector<Cursor> cursors;
+        for (const auto& run : inputs) {
+            Cursor cursor{run.get(), 0, 0, {}};
+            if (run->blocks() > 0) run->decodeBlock(0, cursor.entries);
+            if (cursor.entries.empty() && run->blocks() > 0) {
+                cursor.next = 0;
+                cursor.advance();
+            }
+            cursors.push_back(std::move(cursor));
+        }
+
+        // Fan-in is small: a linear minimum beats a heap here
+        while (true) {
+            Cursor* lowest = nullptr;
+            for (Cursor& cursor : cursors) {
+                if (cursor.valid() && (!lowest || cursor.entry() < lowest->entry())) lowest = &cursor;
+            }
+            if (!lowest) return;
+            writer.add(lowest->entry());
+            lowest->advance();
+        }
+    }
+
+    template<typename Fill>
+    std::shared_ptr<IndexRun> writeRun(uint32_t level, Fill fill) {
+        uint32_t number;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            number = nextRun_++;
+        }
+        std::string path = runPath(directory_, number);
+        std::string temporary = path + ".tmp";
+        IndexRunWriter writer;
+        if (!writer.open(temporary, level)) return nullptr;
+        fill(writer);
+        if (!writer.close() || rename(temporary.c_str(), path.c_str()) < 0) {
+            unlink(temporary.c_str());
+            return nullptr;
+        }
+        syncDirectory();
+        return IndexRun::open(path, number);
+    }
+
+    // Caller holds mutex_ exclusively
+    void install(const std::shared_ptr<IndexRun>& run, const std::vector<std::shared_ptr<IndexRun>>& replaced) {
+        runs_.erase(std::remove_if(runs_.begin(), runs_.end(), [&](const std::shared_ptr<IndexRun>& old) {
+            return std::find(replaced.begin(), replaced.end(), old) != replaced.end();
+        }), runs_.end());
+        runs_.push_back(run);
+        LogLocation covered{run->header().coveredSegment, 0, run->header().coveredOffset};
+        if (logBefore(covered_, covered)) covered_ = covered;
+    }
+
+    void syncDirectory() const {
+        int fd = ::open(directory_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) return;
+        fsync(fd);
+        ::close(fd);
+    }
+
+    const size_t memtableLimit_;
+    std::string directory_;
+    bool readOnly_ = false;
+
+    // Tables: memtable, the frozen memtable being written, runs
+    mutable std::shared_mutex mutex_;
+    std::set<IndexEntry> memtable_;
+    std::shared_ptr<const std::set<IndexEntry>> frozen_;
+    std::vector<std::shared_ptr<IndexRun>> runs_;
+    LogLocation covered_;
+    LogLocation frozenCovers_;          // The log position frozen_ was taken at
+    LogPosition logPosition_;
+    uint32_t nextRun_ = 1;
+
+    // Flush thread
+    std::mutex flushMutex_;
+    std::condition_variable flushWake_;
+    bool stopping_ = false;
+    std::thread thread_;
+    std::mutex writeMutex_;   // One writer of run files: the thread or flush()
+    std::atomic<uint64_t> flushes_{0};
+    std::atomic<uint64_t> merges_{0};
+};
+
+//=============================================================================
+// Inchrosil Records
+//=============================================================================
+
+/**
+ * @brief Index keys of one stored Inchrosil record (header text, then packed bases)
+ *
+ * Reads the `Name:` and `Checksum:` lines of the header; a record without
+ * a name gets no NAME entry.
+ * @return number of entries written to `out` (at most 3)
+ */
+inline size_t inchrosilIndexEntries(uint64_t id, const char* payload, size_t size, const LogLocation& where,
+                                    IndexEntry* out) {
+    size_t count = 0;
+    out[count++] = {IndexKind::ID, id, id, where};
+
+    const char* end = payload + size;
+    for (const char* line = payload; line < end;) {
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (!newline) break;
+        size_t length = newline - line;
+        if (length == 3 && std::memcmp(line, "---", 3) == 0) break;   // Header ends; bases follow
+        if (length > 6 && std::memcmp(line, "Name: ", 6) == 0) {
+            out[count++] = {IndexKind::NAME, indexNameHash(line + 6, length - 6), id, where};
+        } else if (length > 12 && std::memcmp(line, "Checksum: 0x", 12) == 0) {
+            out[count++] = {IndexKind::CHECKSUM, std::strtoull(line + 12, nullptr, 16), id, where};
+        }
+        line = newline + 1;
+    }
+    return count;
+}
+
+/**
+ * @brief Index a batch just published to the log (a SegmentLog::onPublish hook body)
+ */
+inline void indexLogBatch(RecordIndex& index, const SegmentLog::Reservation& where, const LogBatch& batch) {
+    std::vector<IndexEntry> entries(3 * batch.entries().size());
+    size_t count = 0;
+    for (const LogBatch::Entry& entry : batch.entries()) {
+        LogLocation location{where.segment->index, entry.length, where.offset + entry.offset};
+        const char* payload = batch.buffer().data() + entry.offset + sizeof(LogRecordHeader);
+        count += inchrosilIndexEntries(entry.id, payload, entry.length, location, &entries[count]);
+    }
+    index.add(entries.data(), count);
+}
+
+/**
+ * @brief First log position an opened index may be missing
+ *
+ * The later of covered() and `checkpointed`, the position the log's last
+ * checkpoint recorded for it (checkpointIndex()). A checkpoint only vouches
+ * for runs that exist: without runs the whole log is missing.
+ */
+inline LogLocation indexResumePoint(const RecordIndex& index, const LogLocation& checkpointed) {
+    LogLocation from = index.covered();
+    if (index.stats().runs > 0 && logBefore(from, checkpointed)) from = checkpointed;
+    return from;
+}
+
+/**
+ * @brief Bring an opened index up to `log`, then keep it there
+ *
+ * Re-adds the records from indexResumePoint() on, which the runs do not
+ * hold: the log's tail since the last checkpoint, or nothing after a clean
+ * shutdown. Then it indexes every batch the log publishes and follows its
+ * position. Call it before the first append.
+ * @return records re-added
+ */
+inline uint64_t catchUpIndex(RecordIndex& index, SegmentLog& log) {
+    uint64_t added = SegmentLog::scanDirectory(log.directory(), indexResumePoint(index, log.recovery().indexed),
+        [&](uint64_t id, const char* payload, size_t size, LogLocation where) {
+            IndexEntry entries[3];
+            index.add(entries, inchrosilIndexEntries(id, payload, size, where, entries));
+        });
+    log.onPublish([&index](const SegmentLog::Reservation& where, const LogBatch& batch) {
+        indexLogBatch(index, where, batch);
+    });
+    index.followLog([&log] { return log.published(); });
+    return added;
+}
+
+/**
+ * @brief SegmentLog::checkpoint() that also makes `index` durable and records how far
+ *
+ * Writes the memtable as a run first, so a restart re-adds only what the
+ * log took after this checkpoint. `index` may be null (no indexing).
+ */
+inline bool checkpointIndex(SegmentLog& log, RecordIndex* index, uint64_t counter,
+                            SegmentLog::Checkpoint* written = nullptr) {
+    LogLocation indexed;
+    if (index) {
+        if (!index->flush()) return false;
+        indexed = index->covered();
+    }
+    return log.checkpoint(counter, written, indexed);
+}
+
+} // namespace DNASerialProcessor
+
+#endif // DNA_RECORD_INDEX_HPP
@@ -0,0 +1,306 @@
+#ifndef DNA_RECV_BUFFER_HPP
+#define DNA_RECV_BUFFER_HPP
+
+/**
+ * @file dna_recv_buffer.hpp
+ * @brief Reference-counted receive blocks so records never leave the socket buffer
+ *
+ * - RecvBlock: one heap block (header + bytes) with an atomic reference count
+ * - BufferSlice: a record's bytes inside a block; holds a reference, so the
+ *   block stays alive until the worker that owns the record is done with it
+ * - ReceiveBuffer: per-connection view of the current block; recv() writes
+ *   straight into it and parsers consume spans from the front
+ * - RecvBlockPool: thread-safe cache of standard-size blocks; whichever
+ *   thread drops the last reference puts the block back
+ *
+ * A record is copied only when it straddles the end of a block: its prefix
+ * moves to a fresh block sized for the whole record (doubling for unknown
+ * lengths), so every byte is relocated O(1) times on average.
+ *
+ * @version 1.0
+ * @date 2025-11-24
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "dna_mpmc_queue.hpp"
+
+namespace DNASerialProcessor {
+
+constexpr size_t RECV_BLOCK_SIZE = 65536;      // Standard (pooled) block
+constexpr size_t RECV_MIN_READ = 4096;         // Start a new block below this much free space
+constexpr size_t RECV_POOL_BLOCKS = 256;       // Cached blocks (16 MB)
+
+class RecvBlockPool;
+
+//=============================================================================
+// Block
+//=============================================================================
+
+struct RecvBlock {
+    std::atomic<uint32_t> refs{1};
+    size_t capacity;
+    RecvBlockPool* pool;
+
+    RecvBlock(size_t cap, RecvBlockPool* owner) : capacity(cap), pool(owner) {}
+
+    char* data() { return reinterpret_cast<char*>(this + 1); }
+
+    static RecvBlock* allocate(size_t capacity, RecvBlockPool* pool) {
+        void* memory = std::malloc(sizeof(RecvBlock) + capacity);
+        if (!memory) throw std::bad_alloc();
+        return new (memory) RecvBlock(capacity, pool);
+    }
+
+    static void destroy(RecvBlock* block) {
+        block->~RecvBlock();
+        std::free(block);
+    }
+
+    void retain() {
+        refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool unique() const {
+        return refs.load(std::memory_order_acquire) == 1;
+    }
+
+    inline void release();
+};
+
+//=============================================================================
+// Pool
+//=============================================================================
+
+class RecvBlockPool {
+public:
+    explicit RecvBlockPool(size_t blockSize = RECV_BLOCK_SIZE, size_t cached = RECV_POOL_BLOCKS)
+        : blockSize_(blockSize), free_(cached) {}
+
+    ~RecvBlockPool() {
+        RecvBlock* block;
+        while (free_.tryPop(block)) {
+            RecvBlock::destroy(block);
+        }
+    }
+
+    RecvBlockPool(const RecvBlockPool&) = delete;
+    RecvBlockPool& operator=(const RecvBlockPool&) = delete;
+
+    size_t blockSize() const { return blockSize_; }
+    size_t cached() const { return free_.size(); }
+
+    /**
+     * @brief A block with at least `minCapacity` bytes and one reference
+     */
+    RecvBlock* acquire(size_t minCapacity = 0) {
+        if (minCapacity > blockSize_) {
+            return RecvBlock::allocate(minCapacity, this);   // Oversized: freed on release
+        }
+        RecvBlock* block;
+        if (free_.tryPop(block)) {
+            block->refs.store(1, std::memory_order_relaxed);
+            return block;
+        }
+        return RecvBlock::allocate(blockSize_, this);
+    }
+
+    void recycle(RecvBlock* block) {
+        if (block->capacity != blockSize_ || !free_.tryPush(std::move(block))) {
+            RecvBlock::destroy(block);
+        }
+    }
+
+private:
+    const size_t blockSize_;
+    BoundedMPMCQueue<RecvBlock*> free_;
+};
+
+inline void RecvBlock::release() {
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        if (pool) {
+            pool->recycle(this);
+        } else {
+            destroy(this);
+        }
+    }
+}
+
+//=============================================================================
+// Slice
+//=============================================================================
+
+/**
+ * @brief Bytes of one record, kept alive by a reference on their block
+ */
+class BufferSlice {
+public:
+    BufferSlice() = default;
+
+    BufferSlice(RecvBlock* block, const char* data, size_t length)
+        : block_(block), data_(data), length_(length) {
+        if (block_) block_->retain();
+    }
+
+    BufferSlice(const BufferSlice& other) : BufferSlice(other.block_, other.data_, other.length_) {}
+
+    BufferSlice(BufferSlice&& other) noexcept
+        : block_(other.block_), data_(other.data_), length_(other.length_) {
+        other.block_ = nullptr;
+        other.data_ = nullptr;
+        other.length_ = 0;
+    }
+
+    BufferSlice& operator=(BufferSlice other) noexcept {
+        std::swap(block_, other.block_);
+        std::swap(data_, other.data_);
+        std::swap(length_, other.length_);
+        return *this;
+    }
+
+    ~BufferSlice() {
+        if (block_) block_->release();
+    }
+
+    const char* data() const { return data_; }
+    size_t size() const { return length_; }
+    bool empty() const { return length_ == 0; }
+
+    /**
+     * @brief Narrower view of the same block (no copy)
+     */
+    BufferSlice sub(size_t offset, size_t length) const {
+        return BufferSlice(block_, data_ + offset, length);
+    }
+
+    void reset() {
+        *this = BufferSlice();
+    }
+
+private:
+    RecvBlock* block_ = nullptr;
+    const char* data_ = nullptr;
+    size_t length_ = 0;
+};
+
+//=============================================================================
+// Per-connection receive buffer
+//=============================================================================
+
+class ReceiveBuffer {
+public:
+    explicit ReceiveBuffer(RecvBlockPool& pool) : pool_(pool) {}
+
+    ~ReceiveBuffer() {
+        if (block_) block_->release();
+    }
+
+    ReceiveBuffer(const ReceiveBuffer&) = delete;
+    ReceiveBuffer& operator=(const ReceiveBuffer&) = delete;
+
+    // Unconsumed bytes, always contiguous
+    const char* data() const { return block_ ? block_->data() + begin_ : nullptr; }
+    size_t size() const { return end_ - begin_; }
+    bool empty() const { return begin_ == end_; }
+
+    /**
+     * @brief Writable space for the next recv, at least `minSpace` bytes
+     */
+    char* prepareWrite(size_t minSpace, size_t& available) {
+        if (block_ && empty() && block_->unique()) {
+            begin_ = end_ = 0;   // Last record released since consume()
+        }
+        if (!block_ || block_->capacity - end_ < minSpace) {
+            // Keep the partial record contiguous: it moves once, into a block
+            // with room for it to double
+            size_t needed = std::max(size() * 2, size() + minSpace);
+            relocate(std::max(needed, pool_.blockSize()));
+        }
+        available = block_->capacity - end_;
+        return block_->data() + end_;
+    }
+
+    void commitWrite(size_t length) {
+        end_ += length;
+    }
+
+    void append(const char* src, size_t length) {
+        size_t available;
+        char* dst = prepareWrite(length, available);
+        std::memcpy(dst, src, length);
+        commitWrite(length);
+    }
+
+    /**
+     * @brief Drop `length` bytes from the front (records already sliced out)
+     */
+    void consume(size_t length) {
+        begin_ += length;
+        if (begin_ == end_ && block_ && block_->unique()) {
+            begin_ = end_ = 0;   // No slice refers to the block: reuse it from the start
+        }
+    }
+
+    /**
+     * @brief Make room for a record of `total` bytes starting at data()
+     *
+     * Called when a frame header announces its length, so the rest of the
+     * frame lands after the prefix instead of forcing a second relocation.
+     */
+    void reserveContiguous(size_t total) {
+        if (block_ && block_->capacity - begin_ >= total) return;
+        relocate(std::max(total, pool_.blockSize()));
+    }
+
+    /**
+     * @brief Reference-counted view of [ptr, ptr + length), which must lie in data()
+     */
+    BufferSlice slice(const char* ptr, size_t length) const {
+        return BufferSlice(block_, ptr, length);
+    }
+
+    /**
+     * @brief Hand the block back when nothing is buffered and no record uses it
+     */
+    void releaseIfIdle() {
+        if (block_ && empty() && block_->unique()) {
+            block_->release();
+            block_ = nullptr;
+            begin_ = end_ = 0;
+        }
+    }
+
+    // Bytes moved between blocks so far (partial records at block boundaries)
+    uint64_t relocatedBytes() const { return relocated_; }
+
+private:
+    void relocate(size_t capacity) {
+        RecvBlock* fresh = pool_.acquire(capacity);
+        size_t pending = size();
+        if (pending > 0) {
+            std::memcpy(fresh->data(), block_->data() + begin_, pending);
+            relocated_ += pending;
+        }
+        if (block_) block_->release();   // Slices already handed out keep it alive
+        block_ = fresh;
+        begin_ = 0;
+        end_ = pending;
+    }
+
+    RecvBlockPool& pool_;
+    RecvBlock* block_ = nullptr;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    uint64_t relocated_ = 0;
+};
+
+} // namespace DNASerialProcessor
+
+#endif // DNA_RECV_BUFFER_HPP
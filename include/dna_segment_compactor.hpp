@@ -0,0 +1,457 @@
+#ifndef DNA_SEGMENT_COMPACTOR_HPP
+#define DNA_SEGMENT_COMPACTOR_HPP
+
+/**
+ * @file dna_segment_compactor.hpp
+ * @brief Background recompression of cold log segments (StorageConfig::compressOld)
+ *
+ * Sealed segments untouched for minAgeSeconds are rewritten in the
+ * compacted layout (dna_segment_log.hpp):
+ *
+ * - Records with a byte-identical payload earlier in the segment are
+ *   stored once. Their relocation entries share the original's block entry.
+ * - The remaining records are coded in blocks of about blockBytes
+ *   (SequenceBlockCoder, dna_sequence_coder.hpp). Every block is decoded
+ *   and checked before it is written. A cold read decodes its block up to
+ *   the record, at a few MB/s, so blocks stay small: 16 KB by default,
+ *   COMPACTION_MAX_BLOCK_BYTES at most.
+ * - The rewrite goes to `segment-N.seg.tmp`, is synced, then renamed over
+ *   the original (SegmentLog::replaceSegment). A crash before the rename
+ *   leaves the original untouched; SegmentLog::open() removes the
+ *   temporary.
+ *
+ * Record locations do not change, so neither the log's index nor the
+ * record index (dna_record_index.hpp) needs rewriting.
+ *
+ * The compactor thread runs at nice 19 in the idle I/O class. It also
+ * paces itself: after each block it sleeps until the segment's bytes
+ * (read + written) fit ioBytesPerSecond and its CPU time fits cpuPercent
+ * of one core.
+ *
+ * @version 1.0
+ * @date 2025-11-24
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dna_crc32c.hpp"
+#include "dna_segment_log.hpp"
+#include "dna_sequence_coder.hpp"
+
+namespace DNASerialProcessor {
+
+constexpr size_t COMPACTION_MAX_BLOCK_BYTES = 64 << 10;
+
+struct CompactionConfig {
+    uint64_t minAgeSeconds = 3600;        // Since the segment's last write
+    uint64_t intervalMs = 60000;          // Between looks for cold segments
+    size_t blockBytes = 16 << 10;         // Records coded together; a cold read decodes up to one block
+    uint64_t ioBytesPerSecond = 8 << 20;  // Read + written, per segment rewrite
+    uint32_t cpuPercent = 25;             // Of one core
+    bool lowPriority = true;              // nice 19 and the idle I/O class for the thread
+};
+
+/**
+ * @brief Result of one segment rewrite
+ */
+struct CompactionReport {
+    uint32_t segment = 0;
+    uint64_t records = 0;
+    uint64_t duplicates = 0;              // Stored once, shared with an earlier record
+    uint64_t blocks = 0;
+    uint64_t bytesBefore = 0;
+    uint64_t bytesAfter = 0;
+    double seconds = 0.0;
+
+    uint64_t bytesSaved() const { return bytesBefore > bytesAfter ? bytesBefore - bytesAfter : 0; }
+};
+
+class SegmentCompactor {
+public:
+    struct Stats {
+        uint64_t segments = 0;
+        uint64_t records = 0;
+        uint64_t duplicates = 0;
+        uint64_t bytesBefore = 0;
+        uint64_t bytesAfter = 0;
+        uint64_t failures = 0;
+
+        uint64_t bytesSaved() const { return bytesBefore > bytesAfter ? bytesBefore - bytesAfter : 0; }
+    };
+
+    using Done = std::function<void(const CompactionReport&)>;
+
+    /**
+     * @param done  optional; called on the compacting thread after each swap
+     */
+    explicit SegmentCompactor(SegmentLog& log, const CompactionConfig& config = CompactionConfig(),
+                              Done done = nullptr)
+        : log_(log), config_(config), done_(std::move(done)) {
+        config_.blockBytes = std::min(config_.blockBytes, COMPACTION_MAX_BLOCK_BYTES);
+    }
+
+    ~SegmentCompactor() {
+        stop();
+    }
+
+    SegmentCompactor(const SegmentCompactor&) = delete;
+    SegmentCompactor& operator=(const SegmentCompactor&) = delete;
+
+    void start() {
+        stopping_ = false;
+        thread_ = std::thread([this] { run(); });
+    }
+
+    /**
+     * @brief End the thread; a rewrite in progress is abandoned (its original stays)
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    /**
+     * @brief Rewrite every cold sealed segment now, on the calling thread
+     * @return segments compacted
+     */
+    size_t compactCold() {
+        size_t compacted = 0;
+        for (const auto& segment : log_.sealedSegments()) {
+            if (stopping()) break;
+            if (segment->compacted() || !isCold(*segment) || incompressible(segment->index)) continue;
+            CompactionReport report;
+            if (compactSegment(segment->index, report)) compacted++;
+        }
+        return compacted;
+    }
+
+    /**
+     * @brief Rewrite sealed segment `index` in the compacted layout and swap it in
+     *
+     * False if the segment is not sealed, has writes in flight, holds no
+     * records, would not shrink, or the rewrite failed or was stopped; the
+     * original then stays.
+     */
+    bool compactSegment(uint32_t index, CompactionReport& report) {
+        report = CompactionReport();
+        report.segment = index;
+        if (!log_.settled(index)) return false;
+        auto started = std::chrono::steady_clock::now();
+        std::string path = SegmentLog::segmentPath(log_.directory(), index);
+        std::string temporary = path + ".tmp";
+
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return fail();
+        struct stat info;
+        if (fstat(fd, &info) < 0 || static_cast<size_t>(info.st_size) < SEGMENT_HEADER_SIZE) {
+            close(fd);
+            return fail();
+        }
+        size_t size = static_cast<size_t>(info.st_size);
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) return fail();
+
+        Rewrite rewrite(config_);
+        rewrite.base = static_cast<const char*>(mapped);
+        rewrite.size = size;
+        bool written = rewrite.open(temporary, index) && write(rewrite) && rewrite.finish();
+        munmap(mapped, size);
+
+        report.records = rewrite.relocated.size();
+        report.duplicates = rewrite.duplicates;
+        report.blocks = rewrite.blocks;
+        report.bytesBefore = size;
+        report.bytesAfter = rewrite.position;
+        bool shrinks = report.records > 0 && report.bytesAfter < report.bytesBefore;
+        if (!written || !shrinks || !log_.replaceSegment(index, temporary)) {
+            unlink(temporary.c_str());
+            if (written && !shrinks) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                incompressible_.push_back(index);   // Not retried by this compactor
+                return false;
+            }
+            return fail();
+        }
+        report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.segments++;
+            stats_.records += report.records;
+            stats_.duplicates += report.duplicates;
+            stats_.bytesBefore += report.bytesBefore;
+            stats_.bytesAfter += report.bytesAfter;
+        }
+        if (done_) done_(report);
+        return true;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    const CompactionConfig& config() const { return config_; }
+
+private:
+    /**
+     * @brief The compacted file being written, and what goes into its table
+     */
+    struct Rewrite {
+        explicit Rewrite(const CompactionConfig& config) : config(config) {}
+
+        ~Rewrite() {
+            if (fd >= 0) close(fd);
+        }
+
+        bool open(const std::string& path, uint32_t index) {
+            segment = index;
+            fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            position = SEGMENT_HEADER_SIZE;   // Header last, once the table is known
+            return fd >= 0;
+        }
+
+        bool append(const std::string& data) {
+            if (!writeAt(data.data(), data.size(), position)) return false;
+            position += data.size();
+            return true;
+        }
+
+        bool writeAt(const void* data, size_t size, uint64_t offset) {
+            const char* p = static_cast<const char*>(data);
+            size_t done = 0;
+            while (done < size) {
+                ssize_t n = pwrite(fd, p + done, size - done, offset + done);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return false;
+                done += static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        // Table, then the header; synced before the caller renames the file
+        bool finish() {
+            if (relocated.empty()) return true;   // Nothing to compact
+            size_t bytes = relocated.size() * sizeof(CompactedRecord);
+            uint64_t tableOffset = position;
+            if (!writeAt(relocated.data(), bytes, tableOffset)) return false;
+            position += bytes;
+
+            SegmentFileHeader header{};
+            std::memcpy(&header, base, sizeof(header));   // Keeps the segment number and creation time
+            header.version = SEGMENT_COMPACTED_VERSION;
+            header.tableOffset = tableOffset;
+            header.tableEntries = static_cast<uint32_t>(relocated.size());
+            header.tableCrc = Crc32c::calculate(relocated.data(), bytes);
+            header.originalBytes = size;
+            if (!writeAt(&header, sizeof(header), 0)) return false;
+            while (fdatasync(fd) < 0) {
+                if (errno != EINTR) return false;
+            }
+            return true;
+        }
+
+        const CompactionConfig& config;
+        uint32_t segment = 0;
+        int fd = -1;
+        uint64_t position = 0;
+        const char* base = nullptr;       // The original, mapped
+        size_t size = 0;
+
+        std::vector<CompactedRecord> relocated;
+        std::vector<size_t> sourceOf;     // Per relocation entry: the entry whose payload it shares
+        std::vector<size_t> pending;      // Entries of the block being filled
+        std::vector<SequenceBlockCoder::Record> records;
+        size_t pendingBytes = 0;
+        uint64_t duplicates = 0;
+        uint64_t blocks = 0;
+        uint64_t bytesRead = 0;
+    };
+
+    bool write(Rewrite& rewrite) {
+        SegmentFileHeader header;
+        std::memcpy(&header, rewrite.base, sizeof(header));
+        if (std::memcmp(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0 ||
+            header.version != SEGMENT_VERSION) {
+            return false;   // Compacted already, or not a segment
+        }
+
+        Pacer pacer(config_);
+        // Payload CRC32C and length -> first entry with that payload
+        std::unordered_multimap<uint64_t, size_t> seen;
+        bool ok = true;
+        SegmentLog::walkMapped(rewrite.base, rewrite.size,
+            [&](const LogRecordHeader& record, uint64_t offset, const char* payload) {
+                if (!ok) return;
+                size_t entry = rewrite.relocated.size();
+                rewrite.relocated.push_back({offset, record.id, 0, record.length, 0});
+                rewrite.sourceOf.push_back(entry);
+                rewrite.bytesRead += logRecordSize(record.length);
+
+                uint64_t key = (static_cast<uint64_t>(Crc32c::calculate(payload, record.length)) << 32) ^
+                               record.length;
+                auto range = seen.equal_range(key);
+                for (auto it = range.first; it != range.second; ++it) {
+                    const CompactedRecord& original = rewrite.relocated[it->second];
+                    if (original.length == record.length &&
+                        std::memcmp(rewrite.base + original.offset + sizeof(LogRecordHeader), payload,
+                                    record.length) == 0) {
+                        rewrite.sourceOf[entry] = it->second;
+                        rewrite.duplicates++;
+                        return;
+                    }
+                }
+                seen.emplace(key, entry);
+
+                rewrite.pending.push_back(entry);
+                rewrite.records.push_back({payload, record.length});
+                rewrite.pendingBytes += record.length;
+                if (rewrite.pendingBytes >= config_.blockBytes) {
+                    ok = writeBlock(rewrite) && pacer.pace(rewrite.bytesRead + rewrite.position, *this);
+                }
+            });
+        if (!ok || !writeBlock(rewrite)) return false;
+
+        for (size_t i = 0; i < rewrite.relocated.size(); i++) {
+            const CompactedRecord& source = rewrite.relocated[rewrite.sourceOf[i]];
+            rewrite.relocated[i].block = source.block;
+            rewrite.relocated[i].entry = source.entry;
+        }
+        return true;
+    }
+
+    // Code the pending records as one block record, checked by decoding it back
+    bool writeBlock(Rewrite& rewrite) {
+        if (rewrite.pending.empty()) return true;
+        LogBatch block;
+        block.begin(rewrite.relocated[rewrite.pending.front()].id);
+        size_t start = block.size();
+        SequenceBlockCoder::encode(rewrite.records, block.buffer());
+        std::vector<std::string> decoded;
+        if (!SequenceBlockCoder::decode(block.buffer().data() + start, block.size() - start,
+                                        rewrite.records.size() - 1, decoded)) {
+            return false;
+        }
+        block.end(LOG_RECORD_BLOCK);
+
+        uint64_t offset = rewrite.position;
+        if (!rewrite.append(block.buffer())) return false;
+        for (size_t i = 0; i < rewrite.pending.size(); i++) {
+            rewrite.relocated[rewrite.pending[i]].block = offset;
+            rewrite.relocated[rewrite.pending[i]].entry = static_cast<uint32_t>(i);
+        }
+        rewrite.pending.clear();
+        rewrite.records.clear();
+        rewrite.pendingBytes = 0;
+        rewrite.blocks++;
+        return true;
+    }
+
+    /**
+     * @brief Sleeps so a rewrite stays within its I/O and CPU budget
+     */
+    class Pacer {
+    public:
+        explicit Pacer(const CompactionConfig& config)
+            : config_(config), started_(std::chrono::steady_clock::now()), cpuStarted_(threadCpuSeconds()) {}
+
+        // `bytes` read and written so far; false once the compactor is stopping
+        bool pace(uint64_t bytes, SegmentCompactor& compactor) {
+            double ioSeconds = config_.ioBytesPerSecond > 0
+                ? static_cast<double>(bytes) / static_cast<double>(config_.ioBytesPerSecond) : 0.0;
+            double cpuSeconds = config_.cpuPercent > 0 && config_.cpuPercent < 100
+                ? (threadCpuSeconds() - cpuStarted_) * 100.0 / config_.cpuPercent : 0.0;
+            auto until = started_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(std::max(ioSeconds, cpuSeconds)));
+            std::unique_lock<std::mutex> lock(compactor.mutex_);
+            compactor.wake_.wait_until(lock, until, [&] { return compactor.stopping_; });
+            return !compactor.stopping_;
+        }
+
+    private:
+        static double threadCpuSeconds() {
+            struct timespec now;
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+            return static_cast<double>(now.tv_sec) + now.tv_nsec / 1e9;
+        }
+
+        const CompactionConfig& config_;
+        std::chrono::steady_clock::time_point started_;
+        double cpuStarted_;
+    };
+
+    bool isCold(const LogSegment& segment) const {
+        struct stat info;
+        if (stat(segment.path.c_str(), &info) < 0) return false;
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        return now.tv_sec - info.st_mtime >= static_cast<int64_t>(config_.minAgeSeconds);
+    }
+
+    bool incompressible(uint32_t index) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::find(incompressible_.begin(), incompressible_.end(), index) != incompressible_.end();
+    }
+
+    bool stopping() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stopping_;
+    }
+
+    bool fail() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!stopping_) stats_.failures++;
+        return false;
+    }
+
+    void run() {
+        if (config_.lowPriority) {
+            pid_t thread = static_cast<pid_t>(syscall(SYS_gettid));
+            setpriority(PRIO_PROCESS, static_cast<id_t>(thread), 19);
+            syscall(SYS_ioprio_set, 1 /* IOPRIO_WHO_PROCESS */, thread, 3 << 13 /* IOPRIO_CLASS_IDLE */);
+        }
+        while (!stopping()) {
+            compactCold();
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait_for(lock, std::chrono::milliseconds(config_.intervalMs), [&] { return stopping_; });
+        }
+    }
+
+    SegmentLog& log_;
+    CompactionConfig config_;
+    Done done_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread thread_;
+    Stats stats_;
+    std::vector<uint32_t> incompressible_;
+};
+
+} // namespace DNASerialProcessor
+
+#endif // DNA_SEGMENT_COMPACTOR_HPP
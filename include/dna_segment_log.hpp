@@ -0,0 +1,1330 @@
+#ifndef DNA_SEGMENT_LOG_HPP
+#define DNA_SEGMENT_LOG_HPP
+
+/**
+ * @file dna_segment_log.hpp
+ * @brief Append-only segmented record log for the server's storage
+ *
+ * Records go into a directory of segment files (`segment-00000001.seg`, ...)
+ * instead of one file per write: an append reserves a byte range at the
+ * tail of the current segment and writes a whole batch there with one
+ * pwrite(), so storage costs no open/close or directory update per record.
+ * Once a segment reaches its size limit, the next append starts a new one.
+ *
+ * Segment layout: a 64-byte SegmentFileHeader, then records. Each record is
+ * a 24-byte LogRecordHeader (id, payload length, CRC32C of both and of the
+ * payload) followed by the payload, padded to 8 bytes so every header is
+ * aligned.
+ *
+ * Appends from several threads write disjoint ranges concurrently. A record
+ * becomes visible to read() once its write completed (publish()), so
+ * readers never see a half-written payload.
+ *
+ * open() rebuilds the in-memory id -> (segment, offset) index by scanning
+ * the segments. A record that fails its CRC is skipped and the scan resyncs
+ * on the next valid header; a torn tail of the newest segment is truncated.
+ * An id stored twice resolves to the later record.
+ *
+ * checkpoint() bounds that scan. It writes a record table
+ * (`segment-N.idx`) once per sealed segment, and a `checkpoint` file with
+ * the open segment's table up to the point where every append before it
+ * has been published, plus a counter of the caller's (the next record ID)
+ * and the position its record index covers (dna_record_index.hpp).
+ * open() then loads the tables and scans only what was appended after
+ * them: the log's tail since the last checkpoint.
+ *
+ * Durability is the caller's choice (SyncPolicy): no syncing, group commit
+ * (GroupCommitter: one fdatasync per window of appends, with callbacks run
+ * once the records are on stable storage), or an fdatasync per append.
+ *
+ * A sealed segment may be replaced by a compacted one (SegmentCompactor,
+ * dna_segment_compactor.hpp). Its records are coded in blocks
+ * (dna_sequence_coder.hpp), and a relocation table maps each record's
+ * original offset to its block. Every LogLocation handed out before the
+ * swap therefore stays valid, and read(), readAt() and the scans return
+ * the same payloads as before. read() keeps the last LOG_BLOCK_CACHE_ENTRIES
+ * decoded blocks, so neighbouring cold records decode once.
+ *
+ * @version 1.0
+ * @date 2025-11-24
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dna_crc32c.hpp"
+#include "dna_sequence_coder.hpp"
+
+namespace DNASerialProcessor {
+
+constexpr char SEGMENT_MAGIC[8] = {'D', 'N', 'A', 'S', 'E', 'G', '\r', '\n'};
+constexpr uint32_t SEGMENT_VERSION = 1;
+constexpr uint32_t SEGMENT_COMPACTED_VERSION = 2;       // Coded blocks and a relocation table
+constexpr size_t SEGMENT_HEADER_SIZE = 64;
+constexpr size_t SEGMENT_DEFAULT_BYTES = 64 << 20;      // 64 MB
+constexpr size_t SEGMENT_MIN_BYTES = 64 << 10;
+constexpr uint32_t LOG_RECORD_MAGIC = 0x52414E44;       // "DNAR"
+constexpr size_t LOG_RECORD_ALIGN = 8;
+constexpr uint32_t LOG_RECORD_BLOCK = 1;                // flags: the payload is a SequenceBlockCoder block
+constexpr size_t LOG_BLOCK_CACHE_ENTRIES = 32;          // Decoded compacted blocks kept by read()
+constexpr char RECORD_TABLE_MAGIC[8] = {'D', 'N', 'A', 'T', 'B', 'L', '\r', '\n'};
+constexpr uint32_t RECORD_TABLE_VERSION = 1;
+
+// When appended records are made durable
+enum class SyncPolicy {
+    NONE,      // Never sync: the page cache decides (a crash can lose acknowledged records)
+    BATCH,     // Group commit: one fdatasync per window of appends
+    RECORD     // fdatasync after every append
+};
+
+inline const char* syncPolicyName(SyncPolicy policy) {
+    switch (policy) {
+        case SyncPolicy::BATCH:  return "batch";
+        case SyncPolicy::RECORD: return "record";
+        default:                 return "none";
+    }
+}
+
+// A group commit window closes at whichever limit is reached first
+struct GroupCommitConfig {
+    size_t maxRecords = 512;
+    uint64_t maxDelayUs = 500;         // Since the window's first append
+    size_t maxBytes = 4 << 20;
+};
+
+struct SegmentFileHeader {
+    char magic[8];             // SEGMENT_MAGIC
+    uint32_t version;
+    uint32_t headerSize;       // SEGMENT_HEADER_SIZE: records start here
+    uint64_t segment;          // Sequence number, as in the file name
+    uint64_t createdNs;        // Wall clock
+    uint64_t tableOffset;      // Compacted: relocation table (CompactedRecord, by original offset)
+    uint32_t tableEntries;
+    uint32_t tableCrc;         // CRC32C of the table
+    uint64_t originalBytes;    // Compacted: file size before compaction
+    uint8_t reserved[8];
+};
+
+static_assert(sizeof(SegmentFileHeader) == SEGMENT_HEADER_SIZE, "segment header is 64 bytes");
+
+struct LogRecordHeader {
+    uint32_t magic;            // LOG_RECORD_MAGIC
+    uint32_t crc;              // CRC32C of id, length, flags and the payload
+    uint64_t id;
+    uint32_t length;           // Payload bytes, without padding
+    uint32_t flags;            // Reserved, 0
+};
+
+static_assert(sizeof(LogRecordHeader) == 24, "record header is 24 bytes");
+
+struct LogLocation {
+    uint32_t segment = 0;
+    uint32_t length = 0;       // Payload bytes
+    uint64_t offset = 0;       // Of the LogRecordHeader in the segment file
+};
+
+/**
+ * @brief Log order: `a` is earlier in the log than `b` (lengths are ignored)
+ */
+inline bool logBefore(const LogLocation& a, const LogLocation& b) {
+    return a.segment < b.segment || (a.segment == b.segment && a.offset < b.offset);
+}
+
+/**
+ * @brief Where a compacted segment keeps the record that was at `offset`
+ *
+ * Duplicate payloads share a block entry.
+ */
+struct CompactedRecord {
+    uint64_t offset;           // Original offset: the record's LogLocation
+    uint64_t id;
+    uint64_t block;            // Offset of the LOG_RECORD_BLOCK record holding the payload
+    uint32_t length;           // Payload bytes
+    uint32_t entry;            // Index in the block
+};
+
+static_assert(sizeof(CompactedRecord) == 32, "relocation entry is 32 bytes");
+
+/**
+ * @brief Header of a record table: `segment-N.idx` for a sealed segment, `checkpoint` for the open one
+ */
+struct RecordTableHeader {
+    char magic[8];             // RECORD_TABLE_MAGIC
+    uint32_t version;
+    uint32_t segment;          // Whose records the table lists
+    uint64_t segmentNs;        // The segment's createdNs: a table of an older file by that name is ignored
+    uint64_t end;              // Every record before this offset is listed; recovery scans on from here
+    uint64_t entries;
+    uint64_t counter;          // checkpoint: the caller's counter (SegmentLog::checkpoint)
+    uint32_t crc;              // CRC32C of the entries
+    uint32_t indexedSegment;   // checkpoint: the caller's record index holds every record before
+    uint64_t indexedOffset;    // (indexedSegment, indexedOffset); 0 without an index
+};
+
+static_assert(sizeof(RecordTableHeader) == 64, "record table header is 64 bytes");
+
+struct RecordTableEntry {
+    uint64_t id;
+    uint64_t offset;
+    uint32_t length;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(RecordTableEntry) == 24, "record table entry is 24 bytes");
+
+inline size_t logRecordSize(size_t payload) {
+    return (sizeof(LogRecordHeader) + payload + LOG_RECORD_ALIGN - 1) & ~(LOG_RECORD_ALIGN - 1);
+}
+
+//=============================================================================
+// Log Batch
+//=============================================================================
+
+/**
+ * @brief Framed records built in memory, appended to the log in one write
+ *
+ * Either add() a finished payload, or begin() a record, append its payload
+ * to buffer() in place and end() it; the header is filled in at end().
+ */
+class LogBatch {
+public:
+    struct Entry {
+        uint64_t id;
+        size_t offset;         // Of the record header in the batch
+        uint32_t length;
+    };
+
+    void begin(uint64_t id) {
+        open_ = buffer_.size();
+        openId_ = id;
+        buffer_.resize(open_ + sizeof(LogRecordHeader));
+    }
+
+    void end(uint32_t flags = 0) {
+        LogRecordHeader header;
+        header.magic = LOG_RECORD_MAGIC;
+        header.id = openId_;
+        header.length = static_cast<uint32_t>(buffer_.size() - open_ - sizeof(LogRecordHeader));
+        header.flags = flags;
+        header.crc = checksum(header, buffer_.data() + open_ + sizeof(LogRecordHeader));
+        std::memcpy(&buffer_[open_], &header, sizeof(header));
+        buffer_.resize(open_ + logRecordSize(header.length), '\0');
+        entries_.push_back({openId_, open_, header.length});
+    }
+
+    void add(uint64_t id, const void* payload, size_t size, uint32_t flags = 0) {
+        begin(id);
+        buffer_.append(static_cast<const char*>(payload), size);
+        end(flags);
+    }
+
+    std::string& buffer() { return buffer_; }
+    const std::string& buffer() const { return buffer_; }
+    const std::vector<Entry>& entries() const { return entries_; }
+    size_t size() const { return buffer_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+    void clear() {
+        buffer_.clear();
+        entries_.clear();
+    }
+
+    /**
+     * @brief The record CRC: header fields after `crc`, then the payload
+     */
+    static uint32_t checksum(const LogRecordHeader& header, const void* payload) {
+        uint32_t crc = Crc32c::calculate(&header.id, sizeof(header) - offsetof(LogRecordHeader, id));
+        return Crc32c::extend(crc, payload, header.length);
+    }
+
+private:
+    std::string buffer_;
+    std::vector<Entry> entries_;
+    size_t open_ = 0;
+    uint64_t openId_ = 0;
+};
+
+//=============================================================================
+// Segment Log
+//=============================================================================
+
+/**
+ * @brief One segment file; appends in flight hold a reference so it stays open
+ */
+struct LogSegment {
+    uint32_t index = 0;
+    int fd = -1;
+    std::string path;
+    std::vector<CompactedRecord> relocated;   // Compacted segments: by original offset
+    uint64_t createdNs = 0;                   // From its SegmentFileHeader
+    std::vector<RecordTableEntry> published;  // Until its table is written (SegmentLog::checkpoint)
+    bool tabled = false;                      // Has `segment-N.idx` or a relocation table
+
+    bool compacted() const { return !relocated.empty(); }
+
+    ~LogSegment() {
+        if (fd >= 0) close(fd);
+    }
+};
+
+class SegmentLog {
+public:
+    /**
+     * @brief Byte range an append may write; publish() it once written
+     */
+    struct Reservation {
+        std::shared_ptr<LogSegment> segment;
+        uint64_t offset = 0;
+    };
+
+    struct RecoveryStats {
+        uint32_t segments = 0;
+        uint64_t records = 0;
+        uint64_t skippedBytes = 0;     // Corrupt or torn bytes passed over
+        uint64_t truncatedBytes = 0;   // Torn tail cut off the newest segment
+        uint64_t tabledRecords = 0;    // Of `records`: loaded from tables, not scanned
+        uint64_t scannedBytes = 0;     // Segment bytes read past the tables: the tail replayed
+        uint64_t maxId = 0;
+        uint64_t counter = 0;          // From the last checkpoint(); 0 without one
+        LogLocation indexed;           // Likewise: where the caller's record index was complete up to
+    };
+
+    /**
+     * @brief What a checkpoint() wrote
+     */
+    struct Checkpoint {
+        uint32_t segment = 0;          // Covered up to (segment, offset)
+        uint64_t offset = 0;
+        uint64_t entries = 0;          // In the checkpoint file
+        uint32_t tables = 0;           // `segment-N.idx` files written
+    };
+
+    explicit SegmentLog(size_t segmentBytes = SEGMENT_DEFAULT_BYTES)
+        : segmentBytes_(std::max(segmentBytes, SEGMENT_MIN_BYTES)) {}
+
+    SegmentLog(const SegmentLog&) = delete;
+    SegmentLog& operator=(const SegmentLog&) = delete;
+
+    /**
+     * @brief Create `directory` if needed, index its segments and open the newest for appends
+     */
+    bool open(const std::string& directory) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        directory_ = directory;
+        if (!makeDirectories(directory)) return false;
+
+        std::vector<uint32_t> found;
+        if (!listSegments(directory, found)) return false;
+        removeTemporaries();
+
+        RecordTableHeader checkpoint{};
+        std::vector<RecordTableEntry> entries;
+        if (!loadTable(directory + "/checkpoint", checkpoint, entries)) {
+            checkpoint = RecordTableHeader{};
+            entries.clear();
+        }
+        recovery_.counter = checkpoint.counter;
+        recovery_.indexed = LogLocation{checkpoint.indexedSegment, 0, checkpoint.indexedOffset};
+        for (size_t i = 0; i < found.size(); i++) {
+            bool covered = checkpoint.segment == found[i];
+            if (!recoverSegment(found[i], i + 1 == found.size(), covered ? &checkpoint : nullptr,
+                                covered ? &entries : nullptr)) {
+                return false;
+            }
+        }
+        if (!current_ && !rollOver(found.empty() ? 1 : found.back() + 1)) return false;
+        return true;
+    }
+
+    /**
+     * @brief Reserve, write and publish a batch
+     * @param where  receives the range written, e.g. to sync its segment
+     */
+    bool append(const LogBatch& batch, Reservation* where = nullptr) {
+        if (batch.empty()) return true;
+        Reservation reserved;
+        if (!reserve(batch.size(), reserved)) return false;
+
+        const char* data = batch.buffer().data();
+        size_t written = 0;
+        while (written < batch.size()) {
+            ssize_t n = pwrite(reserved.segment->fd, data + written, batch.size() - written,
+                               reserved.offset + written);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                abandon(reserved);   // The hole is skipped as corrupt on recovery
+                return false;
+            }
+            written += static_cast<size_t>(n);
+        }
+        publish(reserved, batch);
+        if (where) *where = std::move(reserved);
+        return true;
+    }
+
+    /**
+     * @brief Make everything written to `segment` so far durable
+     */
+    static bool sync(const LogSegment& segment) {
+        while (fdatasync(segment.fd) < 0) {
+            if (errno != EINTR) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Claim `bytes` at the tail, starting a new segment if they do not fit
+     *
+     * A batch larger than a whole segment gets a segment of its own.
+     */
+    bool reserve(size_t bytes, Reservation& out) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (!current_) return false;
+        if (tail_ + bytes > segmentBytes_ && tail_ > SEGMENT_HEADER_SIZE &&
+            !rollOver(current_->index + 1)) {
+            return false;
+        }
+        out.segment = current_;
+        out.offset = tail_;
+        tail_ += bytes;
+        bytesAppended_ += bytes;
+        inFlight_.insert({current_->index, out.offset});
+        return true;
+    }
+
+    /**
+     * @brief Make a written batch's records visible to readers
+     */
+    void publish(const Reservation& where, const LogBatch& batch) {
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            LogSegment& segment = *where.segment;
+            for (const LogBatch::Entry& entry : batch.entries()) {
+                index_[entry.id] = {segment.index, entry.length, where.offset + entry.offset};
+                if (!segment.tabled) {
+                    segment.published.push_back({entry.id, where.offset + entry.offset, entry.length, 0});
+                }
+            }
+            if (!publishHook_) inFlight_.erase({segment.index, where.offset});
+        }
+        if (publishHook_) {
+            // Still in flight while the hook runs, so published() never passes a batch it has not seen
+            publishHook_(where, batch);
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            inFlight_.erase({where.segment->index, where.offset});
+        }
+    }
+
+    /**
+     * @brief Log position before which every append is published (and seen by the publish hook)
+     */
+    LogLocation published() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (!current_) return LogLocation{};
+        if (inFlight_.empty()) return LogLocation{current_->index, 0, tail_};
+        return LogLocation{inFlight_.begin()->first, 0, inFlight_.begin()->second};
+    }
+
+    /**
+     * @brief A reservation whose write failed: stop waiting for it (checkpoint() covers past it)
+     */
+    void abandon(const Reservation& where) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        inFlight_.erase({where.segment->index, where.offset});
+    }
+
+    /**
+     * @brief Write the tables recovery needs and `counter`, so open() scans only what follows
+     *
+     * Covers the log up to its oldest write still in flight. Sealed segments
+     * get their `segment-N.idx` once; the `checkpoint` file is replaced
+     * each time. Both are synced with the data they list, then renamed into
+     * place. Call it from one thread at a time.
+     * @param indexed  where the caller's record index is durable up to; RecoveryStats::indexed next time
+     */
+    bool checkpoint(uint64_t counter, Checkpoint* written = nullptr, const LogLocation& indexed = LogLocation{}) {
+        Checkpoint done;
+        std::vector<std::shared_ptr<LogSegment>> sealed;
+        std::shared_ptr<LogSegment> open;
+        std::vector<RecordTableEntry> entries;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            if (!current_) return false;
+            if (inFlight_.empty()) {
+                done.segment = current_->index;
+                done.offset = tail_;
+            } else {
+                done.segment = inFlight_.begin()->first;
+                done.offset = inFlight_.begin()->second;
+            }
+            for (const auto& entry : segments_) {
+                if (entry.first < done.segment && !entry.second->tabled) sealed.push_back(entry.second);
+            }
+            auto covered = segments_.find(done.segment);
+            if (covered != segments_.end()) {
+                open = covered->second;
+                for (const RecordTableEntry& entry : open->published) {
+                    if (entry.offset < done.offset) entries.push_back(entry);
+                }
+            }
+        }
+
+        for (const auto& segment : sealed) {
+            std::vector<RecordTableEntry> table;
+            {
+                std::shared_lock<std::shared_mutex> lock(mutex_);
+                table = segment->published;
+            }
+            struct stat info;
+            if (fstat(segment->fd, &info) < 0 || !sync(*segment) ||
+                !writeTable(tablePath(directory_, segment->index), *segment,
+                            static_cast<uint64_t>(info.st_size), 0, table)) {
+                return false;
+            }
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            segment->tabled = true;
+            segment->published.clear();
+            segment->published.shrink_to_fit();
+            done.tables++;
+        }
+
+        if (!open || !sync(*open) ||
+            !writeTable(directory_ + "/checkpoint", *open, done.offset, counter, entries, indexed)) {
+            return false;
+        }
+        done.entries = entries.size();
+        if (written) *written = done;
+        return true;
+    }
+
+    /**
+     * @brief True once segment `index` takes no more appends and all its writes are published
+     */
+    bool settled(uint32_t index) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (!current_ || index >= current_->index) return false;
+        return inFlight_.empty() || inFlight_.begin()->first > index;
+    }
+
+    /**
+     * @brief Called after every publish(), on the publishing thread (e.g. to index the batch)
+     *
+     * Set it before the first append; it is not synchronized with appends.
+     */
+    using PublishHook = std::function<void(const Reservation&, const LogBatch&)>;
+    void onPublish(PublishHook hook) { publishHook_ = std::move(hook); }
+
+    bool locate(uint64_t id, LogLocation& out) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = index_.find(id);
+        if (it == index_.end()) return false;
+        out = it->second;
+        return true;
+    }
+
+    /**
+     * @brief Payload of record `id`; false if unknown or its CRC does not match
+     */
+    bool read(uint64_t id, std::string& payload) const {
+        LogLocation where;
+        std::shared_ptr<LogSegment> segment;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto it = index_.find(id);
+            if (it == index_.end()) return false;
+            where = it->second;
+            auto found = segments_.find(where.segment);
+            if (found == segments_.end()) return false;
+            segment = found->second;
+        }
+
+        if (segment->compacted()) return readCached(*segment, where, id, payload);
+        return readRecord(segment->fd, where, id, payload);
+    }
+
+    /**
+     * @brief read() without an open log: one pread of the record at `where`
+     */
+    static bool readAt(const std::string& directory, const LogLocation& where, uint64_t id,
+                       std::string& payload) {
+        int fd = ::open(segmentPath(directory, where.segment).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        bool found = readRecord(fd, where, id, payload);
+        if (!found) {
+            // Compacted since: follow its relocation table
+            std::vector<CompactedRecord> relocated;
+            found = loadRelocations(fd, relocated) && readCompacted(fd, relocated, where, id, payload);
+        }
+        close(fd);
+        return found;
+    }
+
+    /**
+     * @brief Call fn(id, payload, size) for every intact record, oldest first
+     *
+     * Reads the segment files, so records still being written may be missed.
+     */
+    template<typename Fn>
+    uint64_t scan(Fn fn) const {
+        std::vector<std::shared_ptr<LogSegment>> segments;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            for (const auto& entry : segments_) segments.push_back(entry.second);
+        }
+        uint64_t records = 0;
+        for (const auto& segment : segments) {
+            walkSegment(segment->fd, [&](const LogRecordHeader& header, uint64_t, const char* payload) {
+                fn(header.id, payload, header.length);
+                records++;
+            });
+        }
+        return records;
+    }
+
+    /**
+     * @brief scan() without opening the log, from segment `first` on
+     *
+     * Read-only: nothing is recovered or truncated, so it is safe while a
+     * server appends to the directory. Calls fn(id, payload, size, location).
+     */
+    template<typename Fn>
+    static uint64_t scanDirectory(const std::string& directory, uint32_t first, Fn fn) {
+        return scanDirectory(directory, LogLocation{first, 0, 0}, fn);
+    }
+
+    /**
+     * @brief scanDirectory() of the records at `from` and after it
+     */
+    template<typename Fn>
+    static uint64_t scanDirectory(const std::string& directory, const LogLocation& from, Fn fn) {
+        std::vector<uint32_t> found;
+        if (!listSegments(directory, found)) return 0;
+        uint64_t records = 0;
+        for (uint32_t index : found) {
+            if (index < from.segment) continue;
+            uint64_t start = index == from.segment ? from.offset : 0;
+            int fd = ::open(segmentPath(directory, index).c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) continue;
+            // A compacted segment is decoded whole; its records keep their offsets
+            walkSegment(fd, [&](const LogRecordHeader& header, uint64_t offset, const char* payload) {
+                if (offset < start) return;
+                fn(header.id, payload, header.length, LogLocation{index, header.length, offset});
+                records++;
+            }, nullptr, std::max<uint64_t>(start, SEGMENT_HEADER_SIZE));
+            close(fd);
+        }
+        return records;
+    }
+
+    /**
+     * @brief Every segment but the one taking appends, oldest first
+     */
+    std::vector<std::shared_ptr<const LogSegment>> sealedSegments() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::vector<std::shared_ptr<const LogSegment>> sealed;
+        for (const auto& entry : segments_) {
+            if (entry.second != current_) sealed.push_back(entry.second);
+        }
+        return sealed;
+    }
+
+    /**
+     * @brief Swap sealed segment `index` for its compacted rewrite at `path`, renamed over it
+     *
+     * Reads already holding the old segment finish on the old file; later
+     * reads use the new one. Locations do not change, so no index does.
+     */
+    bool replaceSegment(uint32_t index, const std::string& path) {
+        auto segment = std::make_shared<LogSegment>();
+        segment->index = index;
+        segment->path = segmentPath(directory_, index);
+        segment->tabled = true;
+        segment->fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+        if (segment->fd < 0 || !loadRelocations(segment->fd, segment->relocated)) return false;
+
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto it = segments_.find(index);
+        if (it == segments_.end() || it->second == current_) return false;
+        if (rename(path.c_str(), segment->path.c_str()) < 0) return false;
+        unlink(tablePath(directory_, index).c_str());   // The relocation table replaces it
+        syncDirectory();
+        it->second = segment;
+
+        std::lock_guard<std::mutex> cacheLock(blockCacheMutex_);
+        blockCache_.remove_if([&](const DecodedBlock& block) { return block.segment == index; });
+        return true;
+    }
+
+    /**
+     * @brief Call fn(header, offset, payload) per intact record of a mapped segment file
+     *
+     * A compacted segment yields its records decoded, at their original
+     * offsets, in the order they were appended.
+     * @param from  first offset to look at (a plain segment's records start at SEGMENT_HEADER_SIZE)
+     * @return end offset of the last intact record
+     */
+    template<typename Fn>
+    static uint64_t walkMapped(const char* base, size_t size, Fn fn, uint64_t* skipped = nullptr,
+                               uint64_t from = SEGMENT_HEADER_SIZE) {
+        if (size < SEGMENT_HEADER_SIZE) return 0;
+        SegmentFileHeader file;
+        std::memcpy(&file, base, sizeof(file));
+        if (std::memcmp(file.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) == 0 &&
+            file.version == SEGMENT_COMPACTED_VERSION) {
+            return walkCompacted(base, size, file, fn, skipped);
+        }
+
+        uint64_t position = std::max<uint64_t>(from, SEGMENT_HEADER_SIZE);
+        uint64_t end = position;
+        while (position + sizeof(LogRecordHeader) <= size) {
+            LogRecordHeader header;
+            std::memcpy(&header, base + position, sizeof(header));
+            const char* payload = base + position + sizeof(header);
+            if (header.magic == LOG_RECORD_MAGIC &&
+                header.length <= size - position - sizeof(header) &&
+                header.crc == LogBatch::checksum(header, payload)) {
+                if (skipped) *skipped += position - end;
+                fn(header, position, payload);
+                position += logRecordSize(header.length);
+                end = std::min<uint64_t>(position, size);
+            } else {
+                position += LOG_RECORD_ALIGN;   // Resync on the next aligned header
+            }
+        }
+        return end;
+    }
+
+    /**
+     * @brief Decode the LOG_RECORD_BLOCK record at `offset` of a mapped compacted segment
+     */
+    static bool decodeBlock(const char* base, size_t size, uint64_t offset, std::vector<std::string>& records) {
+        LogRecordHeader header;
+        if (offset + sizeof(header) > size) return false;
+        std::memcpy(&header, base + offset, sizeof(header));
+        const char* payload = base + offset + sizeof(header);
+        if (header.magic != LOG_RECORD_MAGIC || !(header.flags & LOG_RECORD_BLOCK) ||
+            header.length > size - offset - sizeof(header) || header.crc != LogBatch::checksum(header, payload)) {
+            return false;
+        }
+        size_t count = SequenceBlockCoder::count(payload, header.length);
+        return count > 0 && SequenceBlockCoder::decode(payload, header.length, count - 1, records);
+    }
+
+    size_t recordCount() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return index_.size();
+    }
+
+    size_t segmentCount() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return segments_.size();
+    }
+
+    uint64_t bytesAppended() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return bytesAppended_;
+    }
+
+    const RecoveryStats& recovery() const { return recovery_; }
+
+    /**
+     * @brief RecoveryStats::indexed of `directory` without opening the log (for readers beside a server)
+     */
+    static LogLocation checkpointedIndex(const std::string& directory) {
+        RecordTableHeader header{};
+        std::vector<RecordTableEntry> entries;
+        if (!loadTable(directory + "/checkpoint", header, entries)) return LogLocation{};
+        return LogLocation{header.indexedSegment, 0, header.indexedOffset};
+    }
+    const std::string& directory() const { return directory_; }
+    size_t segmentBytes() const { return segmentBytes_; }
+
+    static std::string segmentPath(const std::string& directory, uint32_t index) {
+        char name[32];
+        snprintf(name, sizeof(name), "segment-%08u.seg", index);
+        return directory + "/" + name;
+    }
+
+    static std::string tablePath(const std::string& directory, uint32_t index) {
+        char name[32];
+        snprintf(name, sizeof(name), "segment-%08u.idx", index);
+        return directory + "/" + name;
+    }
+
+private:
+    static bool listSegments(const std::string& directory, std::vector<uint32_t>& found) {
+        DIR* dir = opendir(directory.c_str());
+        if (!dir) return false;
+        while (struct dirent* entry = readdir(dir)) {
+            unsigned index;
+            char tail;
+            if (sscanf(entry->d_name, "segment-%8u.se%c", &index, &tail) == 2 && tail == 'g' &&
+                std::strlen(entry->d_name) == 20) {
+                found.push_back(index);
+            }
+        }
+        closedir(dir);
+        std::sort(found.begin(), found.end());
+        return true;
+    }
+
+    static bool readRecord(int fd, const LogLocation& where, uint64_t id, std::string& payload) {
+        std::string record(sizeof(LogRecordHeader) + where.length, '\0');
+        if (!readFully(fd, &record[0], record.size(), where.offset)) return false;
+        LogRecordHeader header;
+        std::memcpy(&header, record.data(), sizeof(header));
+        if (header.magic != LOG_RECORD_MAGIC || header.id != id || header.length != where.length ||
+            (header.flags & LOG_RECORD_BLOCK) ||
+            header.crc != LogBatch::checksum(header, record.data() + sizeof(header))) {
+            return false;
+        }
+        payload.assign(record, sizeof(header), std::string::npos);
+        return true;
+    }
+
+    /**
+     * @brief Relocation table of a compacted segment; false for a plain or damaged one
+     */
+    static bool loadRelocations(int fd, std::vector<CompactedRecord>& relocated) {
+        SegmentFileHeader file;
+        if (!readFully(fd, &file, sizeof(file), 0) ||
+            std::memcmp(file.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0 ||
+            file.version != SEGMENT_COMPACTED_VERSION || file.tableEntries == 0) {
+            return false;
+        }
+        relocated.resize(file.tableEntries);
+        size_t bytes = relocated.size() * sizeof(CompactedRecord);
+        return readFully(fd, relocated.data(), bytes, file.tableOffset) &&
+               Crc32c::calculate(relocated.data(), bytes) == file.tableCrc;
+    }
+
+    /**
+     * @brief Relocation entry of the record originally at `where`; nullptr if it has none
+     */
+    static const CompactedRecord* findRelocated(const std::vector<CompactedRecord>& relocated,
+                                                const LogLocation& where, uint64_t id) {
+        auto it = std::lower_bound(relocated.begin(), relocated.end(), where.offset,
+                                   [](const CompactedRecord& record, uint64_t offset) { return record.offset < offset; });
+        if (it == relocated.end() || it->offset != where.offset || it->id != id || it->length != where.length) {
+            return nullptr;
+        }
+        return &*it;
+    }
+
+    /**
+     * @brief Records [0, record.entry] of the block holding `record`
+     */
+    static bool decodeRelocated(int fd, const CompactedRecord& record, std::vector<std::string>& records) {
+        LogRecordHeader header;
+        if (!readFully(fd, &header, sizeof(header), record.block) || header.magic != LOG_RECORD_MAGIC ||
+            !(header.flags & LOG_RECORD_BLOCK)) {
+            return false;
+        }
+        std::string block(header.length, '\0');
+        if (!readFully(fd, &block[0], block.size(), record.block + sizeof(header)) ||
+            header.crc != LogBatch::checksum(header, block.data())) {
+            return false;
+        }
+
+        // Decoding stops at the record: a block's first records are the cheapest to read
+        return SequenceBlockCoder::decode(block.data(), block.size(), record.entry, records) &&
+               records[record.entry].size() == record.length;
+    }
+
+    /**
+     * @brief Payload of the record originally at `where` in a compacted segment
+     */
+    static bool readCompacted(int fd, const std::vector<CompactedRecord>& relocated, const LogLocation& where,
+                              uint64_t id, std::string& payload) {
+        const CompactedRecord* record = findRelocated(relocated, where, id);
+        std::vector<std::string> records;
+        if (!record || !decodeRelocated(fd, *record, records)) return false;
+        payload = std::move(records[record->entry]);
+        return true;
+    }
+
+    /**
+     * @brief readCompacted() through the cache of recently decoded blocks
+     *
+     * A block is decoded as far as the furthest record asked for so far;
+     * decoding happens outside the cache lock.
+     */
+    bool readCached(const LogSegment& segment, const LogLocation& where, uint64_t id, std::string& payload) const {
+        const CompactedRecord* record = findRelocated(segment.relocated, where, id);
+        if (!record) return false;
+        {
+            std::lock_guard<std::mutex> lock(blockCacheMutex_);
+            for (auto it = blockCache_.begin(); it != blockCache_.end(); ++it) {
+                if (it->segment != segment.index || it->offset != record->block) continue;
+                if (it->records.size() <= record->entry) break;
+                blockCache_.splice(blockCache_.begin(), blockCache_, it);
+                payload = it->records[record->entry];
+                return true;
+            }
+        }
+
+        DecodedBlock decoded{segment.index, record->block, {}};
+        if (!decodeRelocated(segment.fd, *record, decoded.records)) return false;
+        payload = decoded.records[record->entry];
+
+        std::lock_guard<std::mutex> lock(blockCacheMutex_);
+        blockCache_.remove_if([&](const DecodedBlock& block) {
+            return block.segment == decoded.segment && block.offset == decoded.offset;
+        });
+        blockCache_.push_front(std::move(decoded));
+        if (blockCache_.size() > LOG_BLOCK_CACHE_ENTRIES) blockCache_.pop_back();
+        return true;
+    }
+
+    template<typename Fn>
+    static uint64_t walkCompacted(const char* base, size_t size, const SegmentFileHeader& file, Fn fn,
+                                  uint64_t* skipped) {
+        size_t bytes = static_cast<size_t>(file.tableEntries) * sizeof(CompactedRecord);
+        if (file.tableOffset > size || bytes > size - file.tableOffset ||
+            Crc32c::calculate(base + file.tableOffset, bytes) != file.tableCrc) {
+            if (skipped) *skipped += size;
+            return 0;
+        }
+
+        uint64_t decoded = 0;
+        std::vector<std::string> records;
+        for (uint32_t i = 0; i < file.tableEntries; i++) {
+            CompactedRecord record;
+            std::memcpy(&record, base + file.tableOffset + i * sizeof(CompactedRecord), sizeof(record));
+            if (record.block != decoded) {
+                decoded = record.block;
+                records.clear();
+                decodeBlock(base, size, record.block, records);
+            }
+            if (record.entry >= records.size() || records[record.entry].size() != record.length) {
+                if (skipped) *skipped += record.length;   // Its block is damaged
+                continue;
+            }
+            LogRecordHeader header{LOG_RECORD_MAGIC, 0, record.id, record.length, 0};
+            header.crc = LogBatch::checksum(header, records[record.entry].data());
+            fn(header, record.offset, records[record.entry].data());
+        }
+        return size;
+    }
+
+    /**
+     * @brief Map a segment and call fn(header, offset, payload) per intact record
+     * @return end offset of the last intact record
+     */
+    template<typename Fn>
+    static uint64_t walkSegment(int fd, Fn fn, uint64_t* skipped = nullptr, uint64_t from = SEGMENT_HEADER_SIZE) {
+        struct stat info;
+        if (fstat(fd, &info) < 0 || static_cast<size_t>(info.st_size) < SEGMENT_HEADER_SIZE) {
+            return 0;
+        }
+        size_t size = static_cast<size_t>(info.st_size);
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) return 0;
+        uint64_t end = walkMapped(static_cast<const char*>(mapped), size, fn, skipped, from);
+        munmap(mapped, size);
+        return end;
+    }
+
+    /**
+     * @brief Index one segment: from its table if it has one, then by scanning the rest
+     *
+     * `checkpoint` and `entries`, if set, are the checkpoint file's table of this segment.
+     */
+    bool recoverSegment(uint32_t index, bool newest, const RecordTableHeader* checkpoint,
+                        const std::vector<RecordTableEntry>* entries) {
+        auto segment = std::make_shared<LogSegment>();
+        segment->index = index;
+        segment->path = segmentPath(directory_, index);
+        segment->fd = ::open(segment->path.c_str(), O_RDWR | O_CLOEXEC);
+        if (segment->fd < 0) return false;
+
+        struct stat info;
+        SegmentFileHeader header;
+        if (fstat(segment->fd, &info) < 0) return false;
+        if (newest && static_cast<size_t>(info.st_size) < SEGMENT_HEADER_SIZE) {
+            // Crashed while creating it: start the segment over
+            recovery_.truncatedBytes += info.st_size;
+            return ftruncate(segment->fd, 0) == 0 && writeHeader(*segment) && adopt(segment, true);
+        }
+        if (!readFully(segment->fd, &header, sizeof(header), 0) ||
+            std::memcmp(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0 ||
+            (header.version != SEGMENT_VERSION && header.version != SEGMENT_COMPACTED_VERSION) ||
+            header.headerSize != SEGMENT_HEADER_SIZE) {
+            recovery_.skippedBytes += info.st_size;
+            return true;   // Not a segment: leave it alone, appends go to a new one
+        }
+        segment->createdNs = header.createdNs;
+        if (header.version == SEGMENT_COMPACTED_VERSION) {
+            // The table holds every record: nothing to decode. Appends go to a new segment.
+            if (!loadRelocations(segment->fd, segment->relocated)) {
+                recovery_.skippedBytes += info.st_size;
+                return true;
+            }
+            for (const CompactedRecord& record : segment->relocated) {
+                recovered(record.id, {index, record.length, record.offset}, true);
+            }
+            segment->tabled = true;
+            return adopt(segment, false);
+        }
+
+        // Its own table, else the checkpoint's; a table for another file by this name is stale
+        RecordTableHeader table{};
+        std::vector<RecordTableEntry> loaded;
+        uint64_t from = SEGMENT_HEADER_SIZE;
+        if (loadTable(tablePath(directory_, index), table, loaded) && table.segmentNs == header.createdNs &&
+            table.end <= static_cast<uint64_t>(info.st_size)) {
+            segment->tabled = true;
+            entries = &loaded;
+            from = table.end;
+        } else if (checkpoint && checkpoint->segmentNs == header.createdNs &&
+                   checkpoint->end <= static_cast<uint64_t>(info.st_size)) {
+            from = checkpoint->end;
+        } else {
+            entries = nullptr;
+        }
+        if (entries) {
+            for (const RecordTableEntry& entry : *entries) {
+                recovered(entry.id, {index, entry.length, entry.offset}, true);
+                if (!segment->tabled) segment->published.push_back(entry);
+            }
+        }
+
+        uint64_t end = walkSegment(segment->fd, [&](const LogRecordHeader& record, uint64_t offset,
+                                                    const char*) {
+            recovered(record.id, {index, record.length, offset}, false);
+            if (!segment->tabled) segment->published.push_back({record.id, offset, record.length, 0});
+        }, &recovery_.skippedBytes, from);
+        recovery_.scannedBytes += static_cast<uint64_t>(info.st_size) - std::min<uint64_t>(from, info.st_size);
+
+        if (newest && static_cast<uint64_t>(info.st_size) > end) {
+            recovery_.truncatedBytes += info.st_size - end;
+            if (ftruncate(segment->fd, end) < 0) return false;
+        }
+        if (newest) tail_ = end;
+        return adopt(segment, newest);
+    }
+
+    void recovered(uint64_t id, const LogLocation& where, bool tabled) {
+        index_[id] = where;
+        recovery_.records++;
+        if (tabled) recovery_.tabledRecords++;
+        recovery_.maxId = std::max(recovery_.maxId, id);
+    }
+
+    /**
+     * @brief Read a record table; false if missing, torn or corrupt
+     */
+    static bool loadTable(const std::string& path, RecordTableHeader& header, std::vector<RecordTableEntry>& entries) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        bool loaded = readFully(fd, &header, sizeof(header), 0) &&
+                      std::memcmp(header.magic, RECORD_TABLE_MAGIC, sizeof(RECORD_TABLE_MAGIC)) == 0 &&
+                      header.version == RECORD_TABLE_VERSION && header.entries < (1ull << 32);
+        if (loaded) {
+            entries.resize(header.entries);
+            size_t bytes = entries.size() * sizeof(RecordTableEntry);
+            loaded = readFully(fd, entries.data(), bytes, sizeof(header)) &&
+                     Crc32c::calculate(entries.data(), bytes) == header.crc;
+        }
+        close(fd);
+        return loaded;
+    }
+
+    /**
+     * @brief Write a record table next to `path`, sync it, then rename it into place
+     */
+    bool writeTable(const std::string& path, const LogSegment& segment, uint64_t end, uint64_t counter,
+                    std::vector<RecordTableEntry>& entries, const LogLocation& indexed = LogLocation{}) const {
+        std::sort(entries.begin(), entries.end(),
+                  [](const RecordTableEntry& a, const RecordTableEntry& b) { return a.offset < b.offset; });
+        size_t bytes = entries.size() * sizeof(RecordTableEntry);
+        RecordTableHeader header{};
+        std::memcpy(header.magic, RECORD_TABLE_MAGIC, sizeof(RECORD_TABLE_MAGIC));
+        header.version = RECORD_TABLE_VERSION;
+        header.segment = segment.index;
+        header.segmentNs = segment.createdNs;
+        header.end = end;
+        header.entries = entries.size();
+        header.counter = counter;
+        header.crc = Crc32c::calculate(entries.data(), bytes);
+        header.indexedSegment = indexed.segment;
+        header.indexedOffset = indexed.offset;
+
+        std::string temporary = path + ".tmp";
+        int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        bool written = pwrite(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+        for (size_t done = 0; written && done < bytes;) {
+            ssize_t n = pwrite(fd, reinterpret_cast<const char*>(entries.data()) + done, bytes - done,
+                               sizeof(header) + done);
+            if (n < 0 && errno == EINTR) continue;
+            written = n > 0;
+            if (written) done += static_cast<size_t>(n);
+        }
+        written = written && fdatasync(fd) == 0;
+        close(fd);
+        if (!written || rename(temporary.c_str(), path.c_str()) < 0) {
+            unlink(temporary.c_str());
+            return false;
+        }
+        syncDirectory();
+        return true;
+    }
+
+    bool adopt(const std::shared_ptr<LogSegment>& segment, bool newest) {
+        segments_[segment->index] = segment;
+        recovery_.segments++;
+        if (newest) {
+            current_ = segment;
+            if (tail_ < SEGMENT_HEADER_SIZE) tail_ = SEGMENT_HEADER_SIZE;
+        }
+        return true;
+    }
+
+    bool rollOver(uint32_t index) {
+        auto segment = std::make_shared<LogSegment>();
+        segment->index = index;
+        segment->path = segmentPath(directory_, index);
+        segment->fd = ::open(segment->path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (segment->fd < 0 || !writeHeader(*segment)) return false;
+        syncDirectory();   // The new file's entry; its contents are synced with its records
+        segments_[index] = segment;
+        current_ = segment;
+        tail_ = SEGMENT_HEADER_SIZE;
+        return true;
+    }
+
+    static bool writeHeader(LogSegment& segment) {
+        SegmentFileHeader header{};
+        std::memcpy(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+        header.version = SEGMENT_VERSION;
+        header.headerSize = SEGMENT_HEADER_SIZE;
+        header.segment = segment.index;
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        header.createdNs = static_cast<uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec;
+        segment.createdNs = header.createdNs;
+        return pwrite(segment.fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+    }
+
+    void syncDirectory() const {
+        int fd = ::open(directory_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) return;
+        fsync(fd);
+        close(fd);
+    }
+
+    // Compacted rewrites and tables a crash left before their rename; what they replace is intact
+    void removeTemporaries() const {
+        DIR* dir = opendir(directory_.c_str());
+        if (!dir) return;
+        while (struct dirent* entry = readdir(dir)) {
+            size_t length = std::strlen(entry->d_name);
+            bool ours = std::strncmp(entry->d_name, "segment-", 8) == 0 ||
+                        std::strcmp(entry->d_name, "checkpoint.tmp") == 0;
+            if (ours && length > 4 && std::strcmp(entry->d_name + length - 4, ".tmp") == 0) {
+                unlink((directory_ + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(dir);
+    }
+
+    static bool readFully(int fd, void* out, size_t size, uint64_t offset) {
+        char* data = static_cast<char*>(out);
+        size_t done = 0;
+        while (done < size) {
+            ssize_t n = pread(fd, data + done, size - done, offset + done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    static bool makeDirectories(const std::string& path) {
+        for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+            std::string prefix = path.substr(0, slash);
+            if (!prefix.empty() && mkdir(prefix.c_str(), 0755) < 0 && errno != EEXIST) return false;
+            if (slash == std::string::npos) return true;
+        }
+    }
+
+    const size_t segmentBytes_;
+    std::string directory_;
+    mutable std::shared_mutex mutex_;
+    std::map<uint32_t, std::shared_ptr<LogSegment>> segments_;
+    std::shared_ptr<LogSegment> current_;
+    uint64_t tail_ = 0;
+    uint64_t bytesAppended_ = 0;
+    std::unordered_map<uint64_t, LogLocation> index_;
+    std::set<std::pair<uint32_t, uint64_t>> inFlight_;   // Reserved, not yet published: (segment, offset)
+    RecoveryStats recovery_;
+    PublishHook publishHook_;
+
+    // Compacted blocks decoded by read(), most recently used first
+    struct DecodedBlock {
+        uint32_t segment;
+        uint64_t offset;                    // Of the block's LOG_RECORD_BLOCK record
+        std::vector<std::string> records;   // The block's first records, as far as decoded
+    };
+    mutable std::mutex blockCacheMutex_;
+    mutable std::list<DecodedBlock> blockCache_;
+};
+
+//=============================================================================
+// Group Commit
+//=============================================================================
+
+/**
+ * @brief Committer thread: one fdatasync per segment for a window of appends
+ *
+ * Writers submit each append once it is written, with a callback. The
+ * committer gathers submissions until the window is full (records, bytes)
+ * or its first append is maxDelayUs old, syncs every segment the window
+ * touched, then runs the callbacks with the result. Appends submitted while
+ * a sync runs form the next window, so under load every sync covers many
+ * appends and the fdatasync rate stays bounded.
+ */
+class GroupCommitter {
+public:
+    using Done = std::function<void(bool durable)>;
+
+    /**
+     * @param syncs  optional counter bumped once per fdatasync
+     */
+    explicit GroupCommitter(const GroupCommitConfig& config = GroupCommitConfig(),
+                            std::atomic<uint64_t>* syncs = nullptr)
+        : config_(config), syncs_(syncs) {}
+
+    ~GroupCommitter() {
+        stop();
+    }
+
+    GroupCommitter(const GroupCommitter&) = delete;
+    GroupCommitter& operator=(const GroupCommitter&) = delete;
+
+    void start() {
+        stopping_ = false;
+        thread_ = std::thread([this] { run(); });
+    }
+
+    /**
+     * @brief Commit everything submitted so far, then end the thread
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    /**
+     * @brief `records` appended to `segment` and written; `done` runs on the committer thread
+     */
+    void submit(std::shared_ptr<LogSegment> segment, size_t records, size_t bytes, Done done) {
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pending_.empty()) opened_ = std::chrono::steady_clock::now();
+            pending_.push_back({std::move(segment), std::move(done)});
+            records_ += records;
+            bytes_ += bytes;
+            wake = pending_.size() == 1 || full();
+        }
+        if (wake) wake_.notify_one();
+    }
+
+    uint64_t commits() const { return commits_.load(std::memory_order_relaxed); }
+    uint64_t committedRecords() const { return committedRecords_.load(std::memory_order_relaxed); }
+    const GroupCommitConfig& config() const { return config_; }
+
+private:
+    struct Pending {
+        std::shared_ptr<LogSegment> segment;
+        Done done;
+    };
+
+    bool full() const {
+        return records_ >= config_.maxRecords || bytes_ >= config_.maxBytes;
+    }
+
+    void run() {
+        std::vector<Pending> window;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [&] { return stopping_ || !pending_.empty(); });
+            if (pending_.empty()) break;   // Stopping with nothing left
+
+            // Hold the window open until it fills or its first append has waited long enough
+            wake_.wait_until(lock, opened_ + std::chrono::microseconds(config_.maxDelayUs),
+                             [&] { return stopping_ || full(); });
+            window.swap(pending_);
+            size_t records = records_;
+            records_ = 0;
+            bytes_ = 0;
+            lock.unlock();
+
+            // One sync per segment; a failure fails only that segment's appends
+            std::unordered_set<const LogSegment*> failed;
+            std::unordered_set<const LogSegment*> synced;
+            for (const Pending& entry : window) {
+                const LogSegment* segment = entry.segment.get();
+                if (!synced.insert(segment).second) continue;
+                if (!SegmentLog::sync(*segment)) failed.insert(segment);
+                if (syncs_) syncs_->fetch_add(1, std::memory_order_relaxed);
+            }
+            for (Pending& entry : window) {
+                entry.done(failed.count(entry.segment.get()) == 0);
+            }
+            window.clear();
+            commits_.fetch_add(1, std::memory_order_relaxed);
+            committedRecords_.fetch_add(records, std::memory_order_relaxed);
+
+            lock.lock();
+        }
+    }
+
+    const GroupCommitConfig config_;
+    std::atomic<uint64_t>* const syncs_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<Pending> pending_;
+    std::chrono::steady_clock::time_point opened_;
+    size_t records_ = 0;
+    size_t bytes_ = 0;
+    bool stopping_ = false;
+    std::thread thread_;
+    std::atomic<uint64_t> commits_{0};
+    std::atomic<uint64_t> committedRecords_{0};
+};
+
+} // namespace DNASerialProcessor
+
+#endif // DNA_SEGMENT_LOG_HPP
@@ -0,0 +1,618 @@
+#ifndef DNA_SEQUENCE_CODER_HPP
+#define DNA_SEQUENCE_CODER_HPP
+
+/**
+ * @file dna_sequence_coder.hpp
+ * @brief Context-mixing entropy coder for blocks of stored Inchrosil records
+ *
+ * 2-bit packing (dna_codec.hpp) spends exactly 2 bits on every base. Real
+ * sequences repeat themselves, so a coder that predicts each base from the
+ * bases before it spends less. SequenceBlockCoder compresses a block of
+ * records as one arithmetic-coded stream, each record as its header text
+ * followed by its packed bases:
+ *
+ * - Bases: each base is two binary decisions. Order-2, -4 and -8 contexts
+ *   and hashed order-12, -16 and -22 contexts each predict them. A match
+ *   model predicts the base that followed the last occurrence of the
+ *   previous SEQUENCE_MATCH_MIN bases, so repeats and near-duplicate
+ *   records cost a fraction of a bit per base. A logistic mixer combines
+ *   the predictions, with one weight set per match length and decision.
+ * - Header text: bitwise order-0 to order-4 contexts plus the line so far,
+ *   mixed the same way. Headers repeat field for field.
+ *
+ * Models start empty for every block, so each block decodes on its own.
+ * They are sized by the block's bases and header bytes, which the block
+ * table records, so decoding a small block sets up small tables.
+ * Every record carries the CRC32C of its payload, and decode() checks it.
+ * A block the models cannot shrink, such as random bases, is stored as it is.
+ *
+ * The arithmetic is integer-only, so a block encoded on one platform
+ * decodes bit-exactly on any other.
+ *
+ * @version 1.0
+ * @date 2025-11-24
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "dna_crc32c.hpp"
+
+namespace DNASerialProcessor {
+
+constexpr uint8_t SEQUENCE_BLOCK_STORED = 0;     // Payloads as they are
+constexpr uint8_t SEQUENCE_BLOCK_MIXED = 1;      // Context-mixing coded, text model of 2^18 slots
+constexpr uint8_t SEQUENCE_BLOCK_SIZED = 2;      // Context-mixing coded, every model sized by the block
+constexpr uint32_t SEQUENCE_MATCH_MIN = 24;      // Bases hashed to find an earlier occurrence
+constexpr size_t SEQUENCE_HEADER_SCAN = 4096;    // Header text must end within this many bytes
+
+namespace SequenceCoding {
+
+inline void putVarint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+inline bool getVarint(const char*& p, const char* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Bytes of header text before the packed bases: through "\n---\n", else everything
+ */
+inline size_t headerBytes(const char* payload, size_t size) {
+    const char* end = payload + std::min(size, SEQUENCE_HEADER_SCAN);
+    static const char marker[] = "\n---\n";
+    const char* found = std::search(payload, end, marker, marker + 5);
+    return found == end ? size : static_cast<size_t>(found - payload) + 5;
+}
+
+//=============================================================================
+// Logistic Domain
+//=============================================================================
+
+// 12-bit probability of a 1 from stretch units (1/256 of a logit), by interpolation
+constexpr int squash(int d) {
+    constexpr int table[33] = {
+        1, 2, 3, 6, 10, 16, 27, 45, 73, 120, 194, 310, 488, 747, 1101, 1546, 2047,
+        2549, 2994, 3348, 3607, 3785, 3901, 3975, 4024, 4050, 4068, 4079, 4085, 4089, 4092, 4093, 4094};
+    if (d > 2047) return 4095;
+    if (d < -2047) return 1;
+    int weight = d & 127;
+    int index = (d >> 7) + 16;
+    return (table[index] * (128 - weight) + table[index + 1] * weight + 64) >> 7;
+}
+
+struct StretchTable {
+    int16_t t[4096];
+
+    constexpr StretchTable() : t() {
+        int next = 0;
+        for (int d = -2047; d <= 2047; d++) {
+            int p = squash(d);
+            for (int i = next; i <= p; i++) t[i] = static_cast<int16_t>(d);
+            next = p + 1;
+        }
+        for (int i = next; i < 4096; i++) t[i] = 2047;
+    }
+};
+
+constexpr StretchTable STRETCH_TABLE;
+
+// Inverse of squash()
+inline int stretch(int p) {
+    return STRETCH_TABLE.t[p];
+}
+
+// Counter adaptation rate by hit count: about 1 / (n + 1.5)
+struct ReciprocalTable {
+    int32_t t[1024];
+
+    constexpr ReciprocalTable() : t() {
+        for (int i = 0; i < 1024; i++) t[i] = 16384 / (i + i + 3);
+    }
+};
+
+constexpr ReciprocalTable RECIPROCAL_TABLE;
+
+//=============================================================================
+// Models
+//=============================================================================
+
+/**
+ * @brief Adaptive bit probabilities: 22-bit probability and 10-bit hit count per slot
+ *
+ * A slot learns fast while its count is low and settles as it grows.
+ */
+class BitCounters {
+public:
+    explicit BitCounters(size_t slots = 0) : t_(slots, 1u << 31) {}
+
+    int p(size_t slot) const { return static_cast<int>(t_[slot] >> 20); }
+
+    void update(size_t slot, int bit, uint32_t limit = 255) {
+        uint32_t& t = t_[slot];
+        uint32_t n = t & 1023;
+        int64_t p = t >> 10;
+        if (n < limit) {
+            t++;
+        } else {
+            t = (t & 0xfffffc00u) | limit;
+        }
+        t += static_cast<uint32_t>((((static_cast<int64_t>(bit) << 22) - p) >> 3) * RECIPROCAL_TABLE.t[n] & ~int64_t(1023));
+    }
+
+    void prefetch(size_t slot) const { __builtin_prefetch(&t_[slot]); }
+
+    size_t size() const { return t_.size(); }
+
+private:
+    std::vector<uint32_t> t_;
+};
+
+/**
+ * @brief Logistic mixing: a weighted sum of stretched predictions, one weight set per context
+ */
+class Mixer {
+public:
+    static constexpr size_t MAX_INPUTS = 8;
+
+    explicit Mixer(size_t contexts) : weights_(MAX_INPUTS * contexts, (1 << 16) / 4) {}
+
+    void add(int stretched) { x_[count_++] = stretched; }
+
+    int mix(size_t context) {
+        weight_ = &weights_[context * MAX_INPUTS];
+        int64_t dot = 0;
+        for (size_t i = 0; i < count_; i++) dot += static_cast<int64_t>(x_[i]) * weight_[i];
+        int d = static_cast<int>(std::max<int64_t>(-2047, std::min<int64_t>(2047, dot >> 16)));
+        pr_ = squash(d);
+        return pr_;
+    }
+
+    void update(int bit) {
+        int err = ((bit << 12) - pr_) * MIXER_RATE;
+        for (size_t i = 0; i < count_; i++) weight_[i] += (x_[i] * err + (1 << 13)) >> 14;
+        count_ = 0;
+    }
+
+private:
+    static constexpr int MIXER_RATE = 8;
+
+    std::vector<int32_t> weights_;
+    int x_[MAX_INPUTS] = {};
+    size_t count_ = 0;
+    int32_t* weight_ = nullptr;
+    int pr_ = 2048;
+};
+
+inline int clampProbability(int p) {
+    return std::max(1, std::min(4095, p));
+}
+
+// Table size for `items` entries: the next power of two, within [2^12, 2^maxBits]
+inline int tableBits(uint64_t items, int maxBits) {
+    int bits = 12;
+    while (bits < maxBits && (uint64_t(1) << bits) < items) bits++;
+    return bits;
+}
+
+/**
+ * @brief Predicts bases (2-bit symbols), one binary decision at a time
+ *
+ * Decision 0 is a base's high bit; decision 1 + high bit is its low bit.
+ * Each context owns four counter slots, one per decision (the fourth unused).
+ */
+class BaseModel {
+public:
+    explicit BaseModel(uint64_t bases)
+        : hashBits_(tableBits(bases, 20)),
+          mixer_(MATCH_BUCKETS * 3),
+          matchCounters_(MATCH_BUCKETS * 2),
+          matchTable_(size_t(1) << tableBits(bases, 22), 0) {
+        for (size_t i = 0; i < MODELS; i++) {
+            counters_[i] = BitCounters(size_t(4) << (i < DIRECT ? 2 * ORDERS[i] : hashBits_));
+        }
+        history_.reserve(static_cast<size_t>(bases));
+        selectContexts();
+    }
+
+    // 12-bit probability that the next bit of decision `node` is 1
+    int predict(int node) {
+        node_ = node;
+        for (size_t i = 0; i < MODELS; i++) mixer_.add(stretch(counters_[i].p(slots_[i] + node)));
+
+        // The match model speaks only while the base so far agrees with its prediction
+        expectedBit_ = -1;
+        if (matchLength_ > 0) {
+            int expected = history_[matchPointer_];
+            if (node == 0) {
+                expectedBit_ = expected >> 1;
+            } else if (node - 1 == (expected >> 1)) {
+                expectedBit_ = expected & 1;
+            }
+        }
+        int bucket = expectedBit_ < 0 ? 0 : matchBucket();
+        matchSlot_ = static_cast<size_t>(bucket * 2 + std::max(0, expectedBit_));
+        mixer_.add(expectedBit_ < 0 ? 0 : stretch(matchCounters_.p(matchSlot_)));
+        mixer_.add(256);
+        return clampProbability(mixer_.mix(static_cast<size_t>(bucket * 3 + node)));
+    }
+
+    void update(int bit) {
+        for (size_t i = 0; i < MODELS; i++) counters_[i].update(slots_[i] + node_, bit, 1023);
+        if (expectedBit_ >= 0) matchCounters_.update(matchSlot_, bit, 1023);
+        mixer_.update(bit);
+    }
+
+    // After both decisions: the base was `symbol`
+    void push(int symbol) {
+        history_.push_back(static_cast<uint8_t>(symbol));
+        context_ = (context_ << 2) | static_cast<uint64_t>(symbol);
+        selectContexts();   // Early, so the counter loads overlap the match search
+        size_t position = history_.size();
+
+        if (matchLength_ > 0 && history_[matchPointer_] == symbol) {
+            matchLength_ = std::min<uint32_t>(matchLength_ + 1, 65535);
+            matchPointer_++;
+        } else {
+            matchLength_ = 0;
+        }
+        if (position < SEQUENCE_MATCH_MIN) return;
+
+        size_t hash = static_cast<size_t>(((context_ & ((uint64_t(1) << (2 * SEQUENCE_MATCH_MIN)) - 1)) *
+                                           0x9E3779B97F4A7C15ull) >> 40) & (matchTable_.size() - 1);
+        if (matchLength_ == 0) {
+            uint32_t candidate = matchTable_[hash];
+            uint32_t length = 0;
+            while (candidate > length && length < 32 &&
+                   history_[candidate - 1 - length] == history_[position - 1 - length]) {
+                length++;
+            }
+            if (length >= 16) {
+                matchLength_ = length;
+                matchPointer_ = candidate;
+            }
+        }
+        matchTable_[hash] = static_cast<uint32_t>(position);
+    }
+
+private:
+    static constexpr size_t MODELS = 6;
+    static constexpr size_t DIRECT = 3;                   // Orders small enough to index directly
+    static constexpr uint32_t ORDERS[MODELS] = {2, 4, 8, 12, 16, 22};
+    static constexpr int MATCH_BUCKETS = 8;
+
+    int matchBucket() const {
+        uint32_t n = matchLength_;
+        return n < 16 ? 1 : n < 24 ? 2 : n < 32 ? 3 : n < 64 ? 4 : n < 128 ? 5 : n < 512 ? 6 : 7;
+    }
+
+    void selectContexts() {
+        for (size_t i = 0; i < MODELS; i++) {
+            uint64_t context = context_ & ((uint64_t(1) << (2 * ORDERS[i])) - 1);
+            if (i < DIRECT) {
+                slots_[i] = static_cast<size_t>(context) << 2;
+            } else {
+                uint64_t hash = (context + ORDERS[i]) * 0x9E3779B97F4A7C15ull;
+                slots_[i] = static_cast<size_t>(hash >> (64 - hashBits_)) << 2;
+            }
+            counters_[i].prefetch(slots_[i]);
+        }
+    }
+
+    const int hashBits_;
+    BitCounters counters_[MODELS];
+    size_t slots_[MODELS] = {};
+    Mixer mixer_;
+    int node_ = 0;
+    uint64_t context_ = 0;                  // Last 32 bases, newest in the low bits
+
+    std::vector<uint8_t> history_;          // Every base of the block so far
+    BitCounters matchCounters_;             // P(1) by match length bucket and expected bit
+    std::vector<uint32_t> matchTable_;      // Hash of the last SEQUENCE_MATCH_MIN bases -> position
+    uint32_t matchLength_ = 0;
+    size_t matchPointer_ = 0;               // Base predicted next
+    int expectedBit_ = -1;
+    size_t matchSlot_ = 0;
+};
+
+/**
+ * @brief Predicts header text bitwise from the preceding bytes and the current line
+ */
+class TextModel {
+public:
+    static constexpr int MAX_BITS = 18;
+
+    explicit TextModel(int bits = MAX_BITS) : mask_((1u << bits) - 1), mixer_(256) {
+        for (size_t i = 0; i < MODELS; i++) counters_[i] = BitCounters(size_t(1) << bits);
+    }
+
+    // Table bits for a block with `bytes` of header text (SEQUENCE_BLOCK_SIZED)
+    static int bitsFor(uint64_t bytes) { return tableBits(8 * bytes, MAX_BITS); }
+
+    int predict() {
+        for (size_t i = 0; i < MODELS; i++) {
+            slots_[i] = static_cast<size_t>((hashes_[i] + partial_ * 0x9E3779B1u) & mask_);
+            mixer_.add(stretch(counters_[i].p(slots_[i])));
+        }
+        mixer_.add(256);
+        return clampProbability(mixer_.mix(partial_));
+    }
+
+    void update(int bit) {
+        for (size_t i = 0; i < MODELS; i++) counters_[i].update(slots_[i], bit);
+        mixer_.update(bit);
+        partial_ = (partial_ << 1) | static_cast<uint32_t>(bit);
+        if (partial_ < 256) return;
+
+        uint8_t byte = static_cast<uint8_t>(partial_);
+        partial_ = 1;
+        recent_ = (recent_ << 8) | byte;
+        line_ = byte == '\n' ? 0 : (line_ + byte + 1) * 0x2F0F3F0Bu;
+        hashes_[0] = 0;
+        for (size_t i = 1; i < 5; i++) {
+            hashes_[i] = static_cast<uint32_t>(((recent_ & ((uint64_t(1) << (8 * i)) - 1)) + i) *
+                                               0x9E3779B97F4A7C15ull >> 32);
+        }
+        hashes_[5] = line_ * 0x6F4F2A35u + 5;
+    }
+
+private:
+    static constexpr size_t MODELS = 6;     // Orders 0-4 and the line so far
+
+    const uint32_t mask_;
+    BitCounters counters_[MODELS];
+    uint32_t hashes_[MODELS] = {};
+    size_t slots_[MODELS] = {};
+    Mixer mixer_;
+    uint32_t partial_ = 1;                  // Bits of the current byte, after a leading 1
+    uint64_t recent_ = 0;
+    uint32_t line_ = 0;
+};
+
+//=============================================================================
+// Binary Arithmetic Coder
+//=============================================================================
+
+class ArithmeticEncoder {
+public:
+    explicit ArithmeticEncoder(std::string& out) : out_(out) {}
+
+    void encode(int bit, int p) {
+        uint32_t middle = low_ + static_cast<uint32_t>((static_cast<uint64_t>(high_ - low_) * p) >> 12);
+        if (bit) {
+            high_ = middle;
+        } else {
+            low_ = middle + 1;
+        }
+        while (((low_ ^ high_) & 0xff000000u) == 0) {
+            out_.push_back(static_cast<char>(high_ >> 24));
+            low_ <<= 8;
+            high_ = (high_ << 8) | 255;
+        }
+    }
+
+    void flush() {
+        for (int shift = 24; shift >= 0; shift -= 8) out_.push_back(static_cast<char>(low_ >> shift));
+    }
+
+private:
+    std::string& out_;
+    uint32_t low_ = 0;
+    uint32_t high_ = 0xffffffffu;
+};
+
+class ArithmeticDecoder {
+public:
+    ArithmeticDecoder(const char* data, const char* end) : p_(data), end_(end) {
+        for (int i = 0; i < 4; i++) x_ = (x_ << 8) | next();
+    }
+
+    int decode(int p) {
+        uint32_t middle = low_ + static_cast<uint32_t>((static_cast<uint64_t>(high_ - low_) * p) >> 12);
+        int bit = x_ <= middle;
+        if (bit) {
+            high_ = middle;
+        } else {
+            low_ = middle + 1;
+        }
+        while (((low_ ^ high_) & 0xff000000u) == 0) {
+            low_ <<= 8;
+            high_ = (high_ << 8) | 255;
+            x_ = (x_ << 8) | next();
+        }
+        return bit;
+    }
+
+private:
+    uint32_t next() { return p_ < end_ ? static_cast<uint8_t>(*p_++) : 0; }
+
+    const char* p_;
+    const char* end_;
+    uint32_t low_ = 0;
+    uint32_t high_ = 0xffffffffu;
+    uint32_t x_ = 0;
+};
+
+} // namespace SequenceCoding
+
+//=============================================================================
+// Block Coder
+//=============================================================================
+
+/**
+ * @brief Encode and decode blocks of record payloads
+ *
+ * Block: method byte, varint record count, then per record its varint
+ * size, varint header bytes and CRC32C; then the payloads, stored or coded.
+ */
+class SequenceBlockCoder {
+public:
+    struct Record {
+        const char* data;
+        size_t size;
+    };
+
+    /**
+     * @brief Append the block of `records` to `out`; coded unless that saves nothing
+     */
+    static void encode(const std::vector<Record>& records, std::string& out) {
+        std::string table;
+        SequenceCoding::putVarint(table, records.size());
+        uint64_t raw = 0, bases = 0, text = 0;
+        for (const Record& record : records) {
+            size_t header = SequenceCoding::headerBytes(record.data, record.size);
+            SequenceCoding::putVarint(table, record.size);
+            SequenceCoding::putVarint(table, header);
+            uint32_t crc = Crc32c::calculate(record.data, record.size);
+            table.append(reinterpret_cast<const char*>(&crc), sizeof(crc));
+            raw += record.size;
+            bases += 4 * (record.size - header);
+            text += header;
+        }
+
+        std::string coded;
+        coded.reserve(static_cast<size_t>(raw / 2));
+        {
+            SequenceCoding::ArithmeticEncoder encoder(coded);
+            SequenceCoding::TextModel headers(SequenceCoding::TextModel::bitsFor(text));
+            SequenceCoding::BaseModel model(bases);
+            for (const Record& record : records) {
+                size_t header = SequenceCoding::headerBytes(record.data, record.size);
+                for (size_t i = 0; i < header; i++) {
+                    uint8_t byte = static_cast<uint8_t>(record.data[i]);
+                    for (int shift = 7; shift >= 0; shift--) {
+                        int bit = (byte >> shift) & 1;
+                        encoder.encode(bit, headers.predict());
+                        headers.update(bit);
+                    }
+                }
+                for (size_t i = header; i < record.size; i++) {
+                    uint8_t byte = static_cast<uint8_t>(record.data[i]);
+                    for (int shift = 6; shift >= 0; shift -= 2) {
+                        int symbol = (byte >> shift) & 3;
+                        int high = symbol >> 1;
+                        encoder.encode(high, model.predict(0));
+                        model.update(high);
+                        encoder.encode(symbol & 1, model.predict(1 + high));
+                        model.update(symbol & 1);
+                        model.push(symbol);
+                    }
+                }
+            }
+            encoder.flush();
+        }
+
+        bool mixed = coded.size() < raw;
+        out.push_back(static_cast<char>(mixed ? SEQUENCE_BLOCK_SIZED : SEQUENCE_BLOCK_STORED));
+        out += table;
+        if (mixed) {
+            out += coded;
+        } else {
+            for (const Record& record : records) out.append(record.data, record.size);
+        }
+    }
+
+    /**
+     * @brief Payloads of records [0, last] of a block (the rest are not decoded)
+     * @return false if the block is damaged or a payload fails its CRC
+     */
+    static bool decode(const char* data, size_t size, size_t last, std::vector<std::string>& out) {
+        const char* p = data;
+        const char* end = data + size;
+        if (p == end) return false;
+        uint8_t method = static_cast<uint8_t>(*p++);
+        uint64_t count;
+        if (!SequenceCoding::getVarint(p, end, count) || last >= count) return false;
+
+        std::vector<uint64_t> sizes(count), headers(count);
+        std::vector<uint32_t> crcs(count);
+        uint64_t bases = 0, text = 0;
+        for (uint64_t i = 0; i < count; i++) {
+            if (!SequenceCoding::getVarint(p, end, sizes[i]) || !SequenceCoding::getVarint(p, end, headers[i]) ||
+                headers[i] > sizes[i] || end - p < 4) {
+                return false;
+            }
+            std::memcpy(&crcs[i], p, 4);
+            p += 4;
+            // The models are sized by the whole block, as when encoding, even if decoding stops early
+            bases += 4 * (sizes[i] - headers[i]);
+            text += headers[i];
+        }
+
+        out.assign(last + 1, std::string());
+        if (method == SEQUENCE_BLOCK_STORED) {
+            for (size_t i = 0; i <= last; i++) {
+                if (static_cast<uint64_t>(end - p) < sizes[i]) return false;
+                out[i].assign(p, sizes[i]);
+                p += sizes[i];
+            }
+        } else if (method == SEQUENCE_BLOCK_MIXED || method == SEQUENCE_BLOCK_SIZED) {
+            SequenceCoding::ArithmeticDecoder decoder(p, end);
+            SequenceCoding::TextModel headerText(method == SEQUENCE_BLOCK_SIZED
+                                                 ? SequenceCoding::TextModel::bitsFor(text)
+                                                 : SequenceCoding::TextModel::MAX_BITS);
+            SequenceCoding::BaseModel model(bases);
+            for (size_t r = 0; r <= last; r++) {
+                std::string& payload = out[r];
+                payload.resize(sizes[r]);
+                for (size_t i = 0; i < headers[r]; i++) {
+                    int byte = 0;
+                    for (int b = 0; b < 8; b++) {
+                        int bit = decoder.decode(headerText.predict());
+                        headerText.update(bit);
+                        byte = (byte << 1) | bit;
+                    }
+                    payload[i] = static_cast<char>(byte);
+                }
+                for (size_t i = headers[r]; i < sizes[r]; i++) {
+                    int byte = 0;
+                    for (int b = 0; b < 4; b++) {
+                        int high = decoder.decode(model.predict(0));
+                        model.update(high);
+                        int low = decoder.decode(model.predict(1 + high));
+                        model.update(low);
+                        int symbol = (high << 1) | low;
+                        model.push(symbol);
+                        byte = (byte << 2) | symbol;
+                    }
+                    payload[i] = static_cast<char>(byte);
+                }
+            }
+        } else {
+            return false;
+        }
+
+        for (size_t i = 0; i <= last; i++) {
+            if (Crc32c::calculate(out[i].data(), out[i].size()) != crcs[i]) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Number of records in a block; 0 if its table is unreadable
+     */
+    static size_t count(const char* data, size_t size) {
+        const char* p = data + 1;
+        uint64_t count;
+        return size > 0 && SequenceCoding::getVarint(p, data + size, count) ? static_cast<size_t>(count) : 0;
+    }
+};
+
+} // namespace DNASerialProcessor
+
+#endif // DNA_SEQUENCE_CODER_HPP
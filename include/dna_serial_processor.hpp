@@ -39,6 +39,9 @@
 #include <array>
 #include <chrono>
 
+#include "dna_latency_histogram.hpp"
+#include "dna_direct_writer.hpp"
+
 // ARM-specific optimizations
 #ifdef __aarch64__
 #include <arm_neon.h>
@@ -94,6 +97,27 @@ private:
     static uint32_t calculateSoftware(const uint8_t* data, size_t len);
 };
 
+inline uint32_t HardwareCRC32::calculateSoftware(const uint8_t* data, size_t len) {
+    // Table-driven fallback (same polynomial as the ARM CRC32 instructions)
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int j = 0; j < 8; j++) {
+                c = (c >> 1) ^ (0xEDB88320 & -(c & 1));
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
 /**
  * @brief NEON SIMD-accelerated nucleotide validation
  */
@@ -155,6 +179,16 @@ private:
     static bool validateSoftware(const char* seq, size_t len);
 };
 
+inline bool NEONValidator::validateSoftware(const char* seq, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        char c = seq[i];
+        if (c != 'A' && c != 'T' && c != 'C' && c != 'G' && c != 'N') {
+            return false;
+        }
+    }
+    return true;
+}
+
 /**
  * @brief Lock-free ring buffer using atomic operations
  */
@@ -265,6 +299,7 @@ struct CACHE_ALIGNED DNAMetadata {
     char sequenceId[128];
     char description[256];
     char format[32];
+    char clientId[64];        // Source (serial port, client address); MetadataStore::byClient
     uint64_t originalLength;
     uint64_t encodedLength;
     uint64_t timestamp;
@@ -276,6 +311,7 @@ struct CACHE_ALIGNED DNAMetadata {
         sequenceId[0] = '\0';
         description[0] = '\0';
         format[0] = '\0';
+        clientId[0] = '\0';
     }
 };
 
@@ -501,13 +537,24 @@ struct StorageConfig {
     bool storeOriginal = true;
     bool storeDecoded = true;
     bool storeRaw = false;
-    bool compressOld = true;
+    bool compressOld = true;   // Recompress cold log segments (SegmentCompactor)
     size_t writeCacheSize = 128 * 1024 * 1024;  // 128 MB
     size_t optimalBlockSize = 262144;            // 256 KB (optimal for NVMe)
     bool enableIndexing = true;
     bool useDirectIO = false;  // O_DIRECT for large sequential writes
 };
 
+/**
+ * @brief DirectWriter for one storage file: optimalBlockSize blocks, writeCacheSize pool
+ */
+inline DirectWriterConfig directWriterConfig(const StorageConfig& config) {
+    DirectWriterConfig direct;
+    direct.blockSize = config.optimalBlockSize;
+    direct.cacheBytes = config.writeCacheSize;
+    direct.direct = config.useDirectIO;
+    return direct;
+}
+
 /**
  * @brief Optimized storage manager with batched writes
  */
@@ -578,7 +625,37 @@ struct ProcessorStats {
     CACHE_ALIGNED std::atomic<uint64_t> parsingErrors{0};
     CACHE_ALIGNED std::atomic<uint64_t> storageErrors{0};
     
-    double getAverageLatencyMs() const;
+    // Per-stage timings (receive -> parse -> validate -> encode -> store, and
+    // end to end as TOTAL); each worker thread records into its own shard
+    PipelineLatency latency;
+    
+    /**
+     * @brief Time one stage of a buffer that entered it at startedNs (PipelineLatency::now())
+     */
+    void recordStage(PipelineStage stage, uint64_t startedNs) {
+        latency.record(stage, PipelineLatency::now() - startedNs);
+    }
+    
+    /**
+     * @brief Count a stored sequence and its end-to-end time since receivedNs (PipelineLatency::now())
+     *
+     * The store worker's only way to count a sequence, so TOTAL holds one sample per sequence.
+     */
+    void recordSequence(size_t bytes, uint64_t receivedNs) {
+        totalBytesProcessed.fetch_add(bytes, std::memory_order_relaxed);
+        totalSequences.fetch_add(1, std::memory_order_relaxed);
+        recordStage(PipelineStage::TOTAL, receivedNs);
+    }
+    
+    double getAverageLatencyMs() const {
+        return latency.snapshot(PipelineStage::TOTAL).mean() / 1e6;
+    }
+    
+    double getLatencyPercentileMs(double percentile,
+                                  PipelineStage stage = PipelineStage::TOTAL) const {
+        return latency.snapshot(stage).percentile(percentile) / 1e6;
+    }
+    
     double getThroughputKBps() const;
     double getCPUUtilization() const;
 };
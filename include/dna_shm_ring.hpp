@@ -0,0 +1,401 @@
+#ifndef DNA_SHM_RING_HPP
+#define DNA_SHM_RING_HPP
+
+/**
+ * @file dna_shm_ring.hpp
+ * @brief Shared-memory transport for clients on the same host as dna_server
+ *
+ * The client creates a memfd holding a single-producer/single-consumer byte
+ * ring and passes it, together with an eventfd doorbell, to the server over
+ * a Unix domain socket (SCM_RIGHTS). From then on:
+ * - client -> server: wire-protocol frames are written into the ring; the
+ *   server decodes them where they lie and hands records to workers as
+ *   slices of the mapping (no socket copies on either side)
+ * - server -> client: HELLO_ACK, CREDIT, ACK and ERROR frames still go over
+ *   the Unix socket, so the client's receive path is unchanged
+ *
+ * Ring layout: one ShmRingHeader page, then `capacity` bytes (power of two).
+ * Each entry is an 8-byte ShmEntryHeader followed by one frame, padded to 8
+ * bytes. Entries never wrap: an entry that does not fit before the end of
+ * the ring is preceded by a SHM_ENTRY_WRAP marker and written at offset 0.
+ *
+ * `head` only moves forward when the producer publishes an entry; `tail`
+ * only moves when the consumer no longer needs the bytes (the workers are
+ * done with every record in them), so space is reused strictly in order.
+ *
+ * The doorbell is rung only when the consumer announced it is about to
+ * sleep (`consumerWaiting`), so a busy server never pays a syscall per frame.
+ *
+ * The memfd is sealed against resizing, and the consumer bounds every entry
+ * by its own view of the mapping, so a misbehaving client can corrupt only
+ * its own records, never make the server read outside the ring.
+ *
+ * @version 1.0
+ * @date 2025-11-24
+ */
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace DNASerialProcessor {
+
+constexpr uint32_t SHM_RING_MAGIC = 0x4D485344;          // "DSHM"
+constexpr uint32_t SHM_RING_VERSION = 1;
+constexpr size_t SHM_RING_DEFAULT_SIZE = 64 << 20;      // 64 MB
+constexpr size_t SHM_RING_MIN_SIZE = 64 << 10;
+constexpr size_t SHM_RING_MAX_SIZE = size_t(1) << 30;
+constexpr size_t SHM_HEADER_SIZE = 4096;                // Data starts on its own page
+constexpr uint32_t SHM_ENTRY_WRAP = 0xFFFFFFFF;
+constexpr const char* SHM_DEFAULT_SOCKET = "/tmp/dna_server.sock";
+
+struct ShmRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+
+    alignas(64) std::atomic<uint64_t> head;               // Producer: bytes published
+    alignas(64) std::atomic<uint64_t> tail;               // Consumer: bytes released
+    alignas(64) std::atomic<uint32_t> consumerWaiting;    // Set before the consumer sleeps
+};
+
+static_assert(sizeof(ShmRingHeader) <= SHM_HEADER_SIZE, "ring header must fit its page");
+
+struct ShmEntryHeader {
+    uint32_t length;     // Frame bytes, or SHM_ENTRY_WRAP
+    uint32_t reserved;
+};
+
+/**
+ * @brief One end of a shared ring: owns the mapping, the memfd and the doorbell
+ */
+class ShmRing {
+public:
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    ~ShmRing() {
+#ifdef __linux__
+        if (header_) munmap(header_, SHM_HEADER_SIZE + capacity_);
+        if (memfd_ >= 0) close(memfd_);
+        if (doorbell_ >= 0) close(doorbell_);
+#endif
+    }
+
+    /**
+     * @brief Producer side: a fresh ring of `capacity` bytes (rounded up to a power of two)
+     */
+    static std::unique_ptr<ShmRing> create(size_t capacity) {
+#ifdef __linux__
+        size_t size = SHM_RING_MIN_SIZE;
+        while (size < capacity && size < SHM_RING_MAX_SIZE) size <<= 1;
+
+        int memfd = memfd_create("dna_shm_ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (memfd < 0) return nullptr;
+        int doorbell = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        std::unique_ptr<ShmRing> ring(new ShmRing(memfd, doorbell));
+        if (doorbell < 0 || ftruncate(memfd, SHM_HEADER_SIZE + size) < 0 ||
+            fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0 ||
+            !ring->map(size)) {
+            return nullptr;
+        }
+
+        ShmRingHeader* header = new (ring->header_) ShmRingHeader;
+        header->magic = SHM_RING_MAGIC;
+        header->version = SHM_RING_VERSION;
+        header->capacity = size;
+        header->head.store(0, std::memory_order_relaxed);
+        header->tail.store(0, std::memory_order_relaxed);
+        header->consumerWaiting.store(0, std::memory_order_relaxed);
+        return ring;
+#else
+        (void)capacity;
+        return nullptr;
+#endif
+    }
+
+    /**
+     * @brief Consumer side: map a ring received from a client (takes both fds)
+     * @return nullptr if the memfd does not hold a valid ring
+     */
+    static std::unique_ptr<ShmRing> attach(int memfd, int doorbell) {
+#ifdef __linux__
+        std::unique_ptr<ShmRing> ring(new ShmRing(memfd, doorbell));
+        // Unsealed, the client could shrink the file and fault the server
+        struct stat info;
+        int seals = fcntl(memfd, F_GET_SEALS);
+        if (seals < 0 || !(seals & F_SEAL_SHRINK) ||
+            fstat(memfd, &info) < 0 || info.st_size < static_cast<off_t>(SHM_HEADER_SIZE)) {
+            return nullptr;
+        }
+        size_t size = static_cast<size_t>(info.st_size) - SHM_HEADER_SIZE;
+        if (size < SHM_RING_MIN_SIZE || size > SHM_RING_MAX_SIZE || (size & (size - 1)) != 0 ||
+            !ring->map(size)) {
+            return nullptr;
+        }
+
+        // The client controls these bytes: trust nothing but the mapped size
+        const ShmRingHeader* header = ring->header_;
+        if (header->magic != SHM_RING_MAGIC || header->version != SHM_RING_VERSION ||
+            header->capacity != size) {
+            return nullptr;
+        }
+        ring->readPos_ = header->tail.load(std::memory_order_acquire);
+        return ring;
+#else
+        (void)memfd;
+        (void)doorbell;
+        return nullptr;
+#endif
+    }
+
+    int memfd() const { return memfd_; }
+    int doorbell() const { return doorbell_; }
+    size_t capacity() const { return capacity_; }
+
+    // Largest frame that fits in one entry
+    size_t maxFrame() const { return capacity_ / 2 - sizeof(ShmEntryHeader); }
+
+    //=========================================================================
+    // Producer (client)
+    //=========================================================================
+
+    /**
+     * @brief Append one frame; false if the ring has no room for it right now
+     */
+    bool tryWrite(const char* frame, size_t length) {
+        uint64_t head = header_->head.load(std::memory_order_relaxed);
+        uint64_t tail = header_->tail.load(std::memory_order_acquire);
+        size_t entry = sizeof(ShmEntryHeader) + align8(length);
+        size_t offset = head & (capacity_ - 1);
+        size_t skip = capacity_ - offset < entry ? capacity_ - offset : 0;
+
+        if (head + skip + entry - tail > capacity_) return false;
+
+        if (skip > 0) {
+            ShmEntryHeader wrap{SHM_ENTRY_WRAP, 0};
+            std::memcpy(data_ + offset, &wrap, sizeof(wrap));
+            offset = 0;
+        }
+        ShmEntryHeader header{static_cast<uint32_t>(length), 0};
+        std::memcpy(data_ + offset, &header, sizeof(header));
+        std::memcpy(data_ + offset + sizeof(header), frame, length);
+
+        // seq_cst pairs with the consumer's prepareWait(): either it sees the
+        // new head, or we see it waiting and ring the doorbell
+        header_->head.store(head + skip + entry, std::memory_order_seq_cst);
+        if (header_->consumerWaiting.load(std::memory_order_seq_cst) &&
+            header_->consumerWaiting.exchange(0, std::memory_order_seq_cst)) {
+            uint64_t one = 1;
+            ssize_t rc = write(doorbell_, &one, sizeof(one));
+            (void)rc;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Everything written has been released by the consumer
+     */
+    bool drained() const {
+        return header_->tail.load(std::memory_order_acquire) ==
+               header_->head.load(std::memory_order_relaxed);
+    }
+
+    //=========================================================================
+    // Consumer (server)
+    //=========================================================================
+
+    /**
+     * @brief Next published frame, in place; nullptr when none is ready
+     *
+     * Returns nullptr (and stops for good) on a corrupt entry; check corrupt().
+     */
+    const char* next(size_t& length) {
+        while (!corrupt_) {
+            uint64_t head = header_->head.load(std::memory_order_acquire);
+            if (readPos_ == head) return nullptr;
+            if (head - readPos_ > capacity_) {
+                corrupt_ = true;
+                break;
+            }
+
+            size_t offset = readPos_ & (capacity_ - 1);
+            ShmEntryHeader entry;
+            std::memcpy(&entry, data_ + offset, sizeof(entry));
+            if (entry.length == SHM_ENTRY_WRAP) {
+                readPos_ += capacity_ - offset;
+                continue;
+            }
+
+            size_t size = sizeof(ShmEntryHeader) + align8(entry.length);
+            if (size > capacity_ - offset || readPos_ + size > head) {
+                corrupt_ = true;
+                break;
+            }
+            readPos_ += size;
+            length = entry.length;
+            return data_ + offset + sizeof(ShmEntryHeader);
+        }
+        return nullptr;
+    }
+
+    bool corrupt() const { return corrupt_; }
+
+    // Ring position just past the last frame returned by next()
+    uint64_t readPosition() const { return readPos_; }
+
+    /**
+     * @brief Step back to an earlier readPosition(), not yet released, to read again
+     */
+    void rewind(uint64_t position) {
+        readPos_ = position;
+    }
+
+    /**
+     * @brief Give bytes up to `position` back to the producer
+     */
+    void release(uint64_t position) {
+        header_->tail.store(position, std::memory_order_release);
+    }
+
+    /**
+     * @brief Ask for the doorbell before sleeping
+     * @return false if frames arrived meanwhile (parse them instead of sleeping)
+     */
+    bool prepareWait() {
+        header_->consumerWaiting.store(1, std::memory_order_seq_cst);
+        if (header_->head.load(std::memory_order_seq_cst) != readPos_) {
+            header_->consumerWaiting.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    void clearDoorbell() {
+        uint64_t value;
+        ssize_t rc = read(doorbell_, &value, sizeof(value));
+        (void)rc;
+    }
+
+    //=========================================================================
+    // Handshake (Unix domain socket)
+    //=========================================================================
+
+    /**
+     * @brief Client: pass the memfd and doorbell to the server
+     */
+    bool sendTo(int socket) const {
+#ifdef __linux__
+        uint32_t magic = SHM_RING_MAGIC;
+        struct iovec iov{&magic, sizeof(magic)};
+        alignas(struct cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))] = {};
+
+        struct msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+        int fds[2] = {memfd_, doorbell_};
+        std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+        return sendmsg(socket, &msg, MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(magic));
+#else
+        (void)socket;
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Server: receive the fds sent by sendTo()
+     * @return 1 on success, 0 if nothing has arrived yet, -1 on error or EOF
+     */
+    static int receiveFrom(int socket, int& memfd, int& doorbell) {
+#ifdef __linux__
+        uint32_t magic = 0;
+        struct iovec iov{&magic, sizeof(magic)};
+        alignas(struct cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))] = {};
+
+        struct msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        ssize_t n = recvmsg(socket, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+
+        memfd = doorbell = -1;
+        struct cmsghdr* cmsg = n > 0 ? CMSG_FIRSTHDR(&msg) : nullptr;
+        if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+            cmsg->cmsg_len == CMSG_LEN(2 * sizeof(int))) {
+            int fds[2];
+            std::memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+            memfd = fds[0];
+            doorbell = fds[1];
+        }
+        if (n != static_cast<ssize_t>(sizeof(magic)) || magic != SHM_RING_MAGIC || memfd < 0 ||
+            (msg.msg_flags & MSG_CTRUNC)) {
+            if (memfd >= 0) close(memfd);
+            if (doorbell >= 0) close(doorbell);
+            return -1;
+        }
+        return 1;
+#else
+        (void)socket;
+        (void)memfd;
+        (void)doorbell;
+        return -1;
+#endif
+    }
+
+private:
+    ShmRing(int memfd, int doorbell) : memfd_(memfd), doorbell_(doorbell) {}
+
+    bool map(size_t capacity) {
+#ifdef __linux__
+        void* base = mmap(nullptr, SHM_HEADER_SIZE + capacity, PROT_READ | PROT_WRITE,
+                          MAP_SHARED, memfd_, 0);
+        if (base == MAP_FAILED) return false;
+        header_ = static_cast<ShmRingHeader*>(base);
+        data_ = static_cast<char*>(base) + SHM_HEADER_SIZE;
+        capacity_ = capacity;
+        return true;
+#else
+        (void)capacity;
+        return false;
+#endif
+    }
+
+    static size_t align8(size_t n) { return (n + 7) & ~size_t(7); }
+
+    int memfd_ = -1;
+    int doorbell_ = -1;
+    ShmRingHeader* header_ = nullptr;
+    char* data_ = nullptr;
+    size_t capacity_ = 0;
+    uint64_t readPos_ = 0;    // Consumer: parsed up to here (>= tail)
+    bool corrupt_ = false;
+};
+
+} // namespace DNASerialProcessor
+
+#endif // DNA_SHM_RING_HPP
@@ -0,0 +1,393 @@
+#ifndef DNA_WIRE_PROTOCOL_HPP
+#define DNA_WIRE_PROTOCOL_HPP
+
+/**
+ * @file dna_wire_protocol.hpp
+ * @brief Length-prefixed binary framing shared by dna_client and dna_server
+ *
+ * Every frame is a fixed 16-byte header followed by `length` payload bytes:
+ *
+ *   offset  size  field
+ *   0       4     magic    0xD7 'D' 'N' 'A'
+ *   4       1     version  WIRE_VERSION
+ *   5       1     type     FrameType
+ *   6       2     flags    per-type options (records: RECORD_FLAG_META)
+ *   8       4     length   payload bytes
+ *   12      4     crc32    CRC32 of the payload
+ *
+ * Multi-byte fields are little-endian (host order on every supported target).
+ * A receiver reads the header, then jumps straight to the next frame boundary
+ * without scanning the payload.
+ *
+ * Negotiation: a binary client opens with HELLO; the server answers HELLO_ACK
+ * (or ERROR). The first byte 0xD7 can never start a text-protocol record
+ * ('>', '@' or a nucleotide), so the server tells both protocols apart from
+ * the first byte and the legacy newline-delimited protocol keeps working.
+ *
+ * @version 1.0
+ * @date 2025-11-24
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "dna_serial_processor.hpp"
+
+namespace DNASerialProcessor {
+
+//=============================================================================
+// Frame Layout
+//=============================================================================
+
+constexpr uint8_t WIRE_MAGIC[4] = {0xD7, 'D', 'N', 'A'};
+constexpr uint8_t WIRE_VERSION = 1;
+constexpr uint32_t WIRE_MAX_PAYLOAD = 256u * 1024 * 1024;  // 256 MB per frame
+constexpr uint32_t PING_MAX_PAYLOAD = 256;                  // Largest PING the server echoes
+
+enum class FrameType : uint8_t {
+    // Control
+    HELLO        = 0x01,  // client -> server, HelloPayload
+    HELLO_ACK    = 0x02,  // server -> client, HelloPayload (chosen version)
+    PING         = 0x03,  // echoed back unchanged, up to PING_MAX_PAYLOAD bytes
+    BYE          = 0x04,  // orderly close
+    CREDIT       = 0x05,  // server -> client, CreditPayload (additional records allowed)
+    ACK          = 0x06,  // server -> client, AckHeader + AckEntry[count]
+    ERROR        = 0x0F,  // UTF-8 message, sender closes afterwards
+
+    // Records
+    RECORD_RAW   = 0x10,  // bare nucleotides
+    RECORD_FASTA = 0x11,  // ">header\n" + sequence lines (may be multi-line)
+    RECORD_FASTQ = 0x12,  // "@id\nSEQ\n+\nQUAL\n"
+    RECORD_PACKED = 0x13, // PackedRecordHeader + 2-bit packed bases
+
+    // Containers
+    BATCH        = 0x20   // concatenation of complete record frames
+};
+
+struct FrameHeader {
+    uint8_t magic[4];
+    uint8_t version;
+    uint8_t type;
+    uint16_t flags;
+    uint32_t length;
+    uint32_t crc32;
+} __attribute__((packed));
+
+static_assert(sizeof(FrameHeader) == 16, "FrameHeader must be 16 bytes");
+
+// HELLO capability bits
+constexpr uint32_t CAP_BATCH = 1u << 0;
+constexpr uint32_t CAP_FLOW_CONTROL = 1u << 1;  // Credits + ACKs (see below)
+constexpr uint32_t CAP_PRIORITY = 1u << 2;      // Records may carry a RecordMeta prefix
+
+struct HelloPayload {
+    uint16_t minVersion;
+    uint16_t maxVersion;   // HELLO_ACK: minVersion == maxVersion == chosen version
+    uint32_t capabilities;
+} __attribute__((packed));
+
+/**
+ * A HELLO may be followed by the client's name (printable ASCII, no spaces,
+ * up to HELLO_MAX_CLIENT_NAME bytes). The server schedules and measures
+ * clients by name, falling back to the peer address for unnamed ones.
+ */
+constexpr size_t HELLO_MAX_CLIENT_NAME = 64;
+
+inline bool validClientName(const char* name, size_t length) {
+    if (length == 0 || length > HELLO_MAX_CLIENT_NAME) return false;
+    for (size_t i = 0; i < length; i++) {
+        if (name[i] <= ' ' || name[i] > '~') return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Payload prefix of RECORD_PACKED frames
+ *
+ * Followed by, in order:
+ * - nameLength bytes: the FASTA/FASTQ header line without '>'/'@' (none for RAW)
+ * - exactly (baseCount + 3) / 4 bytes packed with NucleotideCodec
+ *   (dna_codec.hpp): 4 bases per byte, MSB first
+ * - baseCount quality bytes if PACKED_FLAG_QUALITY is set (FASTQ)
+ *
+ * So a packed record carries everything its RECORD_FASTA/FASTQ frame would.
+ */
+constexpr uint8_t PACKED_FLAG_QUALITY = 1u << 0;
+constexpr size_t PACKED_MAX_NAME = 0xFFFF;  // nameLength is 16 bits
+
+struct PackedRecordHeader {
+    uint64_t baseCount;
+    uint32_t sequenceCrc32;  // CRC32 of the ASCII bases before packing
+    uint8_t sourceType;      // RECORD_RAW/FASTA/FASTQ the bases came from
+    uint8_t flags;           // PACKED_FLAG_QUALITY
+    uint16_t nameLength;     // Header line bytes before the packed bases
+} __attribute__((packed));
+
+static_assert(sizeof(PackedRecordHeader) == 16, "PackedRecordHeader must be 16 bytes");
+
+/**
+ * Priority lanes (CAP_PRIORITY): a record frame with RECORD_FLAG_META set
+ * starts with a RecordMeta, followed by the payload it would have had
+ * without it (bases, or PackedRecordHeader + packed bytes). Records without
+ * it are PRIORITY_NORMAL with no deadline. Lower values are more urgent,
+ * matching the RTOS task classes.
+ */
+enum RecordPriority : uint8_t {
+    PRIORITY_CRITICAL = 0,
+    PRIORITY_HIGH     = 1,
+    PRIORITY_NORMAL   = 2,
+    PRIORITY_LOW      = 3
+};
+
+constexpr int PRIORITY_LANES = 4;
+constexpr uint16_t RECORD_FLAG_META = 1u << 0;
+
+struct RecordMeta {
+    uint8_t priority;      // RecordPriority
+    uint8_t reserved[3];
+    uint32_t deadlineMs;   // Budget from arrival at the server; 0 = no deadline
+} __attribute__((packed));
+
+static_assert(sizeof(RecordMeta) == 8, "RecordMeta must be 8 bytes");
+
+inline const char* priorityName(uint8_t priority) {
+    switch (priority) {
+        case PRIORITY_CRITICAL: return "CRITICAL";
+        case PRIORITY_HIGH:     return "HIGH";
+        case PRIORITY_NORMAL:   return "NORMAL";
+        case PRIORITY_LOW:      return "LOW";
+        default:                return "UNKNOWN";
+    }
+}
+
+/**
+ * Flow control (CAP_FLOW_CONTROL): the server grants credits after HELLO_ACK;
+ * every record frame (also inside a BATCH) consumes one. A record sent
+ * without credit is a protocol error. Processed records are acknowledged in
+ * ACK frames, which also hand the consumed credits back.
+ */
+struct CreditPayload {
+    uint32_t credits;
+} __attribute__((packed));
+
+struct AckHeader {
+    uint32_t credits;   // Credits returned with this ACK
+    uint32_t count;     // AckEntry records that follow
+} __attribute__((packed));
+
+enum AckStatus : uint8_t {
+    ACK_STORED  = 0,
+    ACK_INVALID = 1,   // Failed nucleotide validation
+    ACK_FAILED  = 2,   // Storage error
+    ACK_EXPIRED = 3    // Dropped unprocessed: missed its RecordMeta deadline
+};
+
+struct AckEntry {
+    uint64_t recordNumber;  // 1-based position of the record on this connection
+    uint64_t sequenceId;    // Server-assigned ID (the record's key in the storage log)
+    uint8_t status;         // AckStatus
+    uint8_t reserved[7];
+} __attribute__((packed));
+
+static_assert(sizeof(AckEntry) == 24, "AckEntry must be 24 bytes");
+
+inline bool isRecordFrame(FrameType type) {
+    return type == FrameType::RECORD_RAW || type == FrameType::RECORD_FASTA ||
+           type == FrameType::RECORD_FASTQ || type == FrameType::RECORD_PACKED;
+}
+
+/**
+ * @brief True if a stream starting with `data` uses the binary protocol
+ */
+inline bool isBinaryProtocol(const char* data, size_t size) {
+    return size > 0 && static_cast<uint8_t>(data[0]) == WIRE_MAGIC[0];
+}
+
+//=============================================================================
+// Encoding
+//=============================================================================
+
+class FrameEncoder {
+public:
+    /**
+     * @brief Append one complete frame to `out`
+     */
+    static void append(std::string& out, FrameType type,
+                       const void* payload, size_t length, uint16_t flags = 0) {
+        FrameHeader header;
+        std::memcpy(header.magic, WIRE_MAGIC, sizeof(WIRE_MAGIC));
+        header.version = WIRE_VERSION;
+        header.type = static_cast<uint8_t>(type);
+        header.flags = flags;
+        header.length = static_cast<uint32_t>(length);
+        header.crc32 = HardwareCRC32::calculate(static_cast<const uint8_t*>(payload), length);
+
+        out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.append(static_cast<const char*>(payload), length);
+    }
+
+    static void append(std::string& out, FrameType type, const std::string& payload,
+                       uint16_t flags = 0) {
+        append(out, type, payload.data(), payload.size(), flags);
+    }
+
+    static std::string encode(FrameType type, const std::string& payload, uint16_t flags = 0) {
+        std::string out;
+        out.reserve(sizeof(FrameHeader) + payload.size());
+        append(out, type, payload, flags);
+        return out;
+    }
+
+    /**
+     * @brief RECORD_PACKED payload from bases already packed with NucleotideCodec
+     *
+     * `header.nameLength` and the quality flag are set from `name` and
+     * `quality`; quality, if any, must hold one byte per base.
+     */
+    static std::string packedRecord(PackedRecordHeader header, const std::string& name,
+                                    const std::string& packed, const std::string& quality = "") {
+        header.nameLength = static_cast<uint16_t>(name.size());
+        header.flags = quality.empty() ? 0 : PACKED_FLAG_QUALITY;
+        std::string out;
+        out.reserve(sizeof(header) + name.size() + packed.size() + quality.size());
+        out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        out += name;
+        out += packed;
+        out += quality;
+        return out;
+    }
+
+    static std::string hello(uint16_t minVersion, uint16_t maxVersion, uint32_t capabilities,
+                             const std::string& clientName = "") {
+        HelloPayload hello{minVersion, maxVersion, capabilities};
+        std::string payload(reinterpret_cast<const char*>(&hello), sizeof(hello));
+        payload += clientName;
+        std::string out;
+        append(out, FrameType::HELLO, payload);
+        return out;
+    }
+};
+
+//=============================================================================
+// Decoding
+//=============================================================================
+
+struct FrameView {
+    FrameType type;
+    uint16_t flags;
+    const char* payload;
+    uint32_t length;
+    size_t frameSize;     // header + payload, i.e. distance to the next frame
+};
+
+/**
+ * @brief Strip a record frame's RecordMeta, if it has one
+ *
+ * On return `payload`/`length` describe the record without the prefix and
+ * `meta` holds its priority and deadline (NORMAL, none when absent).
+ * @return false if the flag is set but the prefix is truncated or invalid
+ */
+inline bool splitRecordMeta(const FrameView& frame, RecordMeta& meta,
+                            const char*& payload, uint32_t& length) {
+    meta = RecordMeta{PRIORITY_NORMAL, {0, 0, 0}, 0};
+    payload = frame.payload;
+    length = frame.length;
+    if (!(frame.flags & RECORD_FLAG_META)) return true;
+
+    if (length < sizeof(RecordMeta)) return false;
+    std::memcpy(&meta, payload, sizeof(meta));
+    payload += sizeof(RecordMeta);
+    length -= sizeof(RecordMeta);
+    return meta.priority < PRIORITY_LANES;
+}
+
+/**
+ * @brief The parts of a RECORD_PACKED payload (after splitRecordMeta)
+ */
+struct PackedRecordView {
+    PackedRecordHeader header;
+    const char* name;
+    size_t nameLength;
+    const char* packed;
+    size_t packedBytes;
+    const char* quality;     // nullptr unless PACKED_FLAG_QUALITY
+};
+
+/**
+ * @return false if the payload is not exactly the header, name, packed bases
+ *         and (when flagged) one quality byte per base
+ */
+inline bool splitPackedRecord(const char* payload, uint32_t length, PackedRecordView& record) {
+    if (length < sizeof(PackedRecordHeader)) return false;
+    std::memcpy(&record.header, payload, sizeof(PackedRecordHeader));
+    const PackedRecordHeader& header = record.header;
+    if (header.baseCount > WIRE_MAX_PAYLOAD * 4ull) return false;
+
+    uint64_t packedBytes = (header.baseCount + 3) / 4;
+    uint64_t qualityBytes = (header.flags & PACKED_FLAG_QUALITY) ? header.baseCount : 0;
+    if (length != sizeof(PackedRecordHeader) + header.nameLength + packedBytes + qualityBytes) {
+        return false;
+    }
+    record.name = payload + sizeof(PackedRecordHeader);
+    record.nameLength = header.nameLength;
+    record.packed = record.name + record.nameLength;
+    record.packedBytes = packedBytes;
+    record.quality = qualityBytes ? record.packed + packedBytes : nullptr;
+    return true;
+}
+
+enum class DecodeStatus {
+    NEED_MORE,   // buffer holds a partial frame
+    FRAME,       // `frame` is valid
+    ERROR        // stream is corrupt; `error` says why
+};
+
+class FrameDecoder {
+public:
+    /**
+     * @brief Decode the frame at the start of `data` without copying the payload
+     */
+    static DecodeStatus decode(const char* data, size_t size, FrameView& frame,
+                               std::string* error = nullptr) {
+        if (size < sizeof(FrameHeader)) return DecodeStatus::NEED_MORE;
+
+        FrameHeader header;
+        std::memcpy(&header, data, sizeof(header));
+
+        if (std::memcmp(header.magic, WIRE_MAGIC, sizeof(WIRE_MAGIC)) != 0) {
+            return fail(error, "bad frame magic");
+        }
+        if (header.version != WIRE_VERSION) {
+            return fail(error, "unsupported frame version " + std::to_string(header.version));
+        }
+        if (header.length > WIRE_MAX_PAYLOAD) {
+            return fail(error, "frame too large (" + std::to_string(header.length) + " bytes)");
+        }
+        if (size < sizeof(FrameHeader) + header.length) return DecodeStatus::NEED_MORE;
+
+        const char* payload = data + sizeof(FrameHeader);
+        uint32_t crc = HardwareCRC32::calculate(reinterpret_cast<const uint8_t*>(payload),
+                                                header.length);
+        if (crc != header.crc32) {
+            return fail(error, "frame CRC mismatch");
+        }
+
+        frame.type = static_cast<FrameType>(header.type);
+        frame.flags = header.flags;
+        frame.payload = payload;
+        frame.length = header.length;
+        frame.frameSize = sizeof(FrameHeader) + header.length;
+        return DecodeStatus::FRAME;
+    }
+
+private:
+    static DecodeStatus fail(std::string* error, const std::string& message) {
+        if (error) *error = message;
+        return DecodeStatus::ERROR;
+    }
+};
+
+} // namespace DNASerialProcessor
+
+#endif // DNA_WIRE_PROTOCOL_HPP
@@ -0,0 +1,135 @@
+#ifndef DNA_WORK_STEALING_HPP
+#define DNA_WORK_STEALING_HPP
+
+/**
+ * @file dna_work_stealing.hpp
+ * @brief Chase-Lev work-stealing deque for the server worker pool
+ *
+ * The owning worker pushes and pops at the bottom (LIFO, cache-warm);
+ * any other worker steals from the top (FIFO, oldest and usually largest
+ * piece of work). Owner operations touch no shared cache line unless the
+ * deque is down to its last element; a steal is one CAS on `top`.
+ *
+ * Follows the C11 formulation of Lê, Pop, Cohen and Zappa Nardelli
+ * ("Correct and Efficient Work-Stealing for Weak Memory Models", 2013),
+ * with a fixed power-of-two capacity: when the ring is full, push() fails
+ * and the owner simply runs the task itself.
+ *
+ * Elements are pointers; the deque never owns what they point to.
+ *
+ * @version 1.0
+ * @date 2025-11-24
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace DNASerialProcessor {
+
+template<typename T>
+class WorkStealingDeque {
+public:
+    /**
+     * @param capacity rounded up to the next power of two (minimum 2)
+     */
+    explicit WorkStealingDeque(size_t capacity)
+        : mask_(roundUpPow2(capacity) - 1),
+          buffer_(new std::atomic<T*>[mask_ + 1]) {
+        for (size_t i = 0; i <= mask_; i++) {
+            buffer_[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    /**
+     * @brief Approximate element count (exact when called by the owner while idle)
+     */
+    size_t size() const {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Owner only
+     * @return false if the deque is full
+     */
+    bool push(T* item) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t > static_cast<int64_t>(mask_)) return false;
+
+        buffer_[b & mask_].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Owner only: newest element, or nullptr if empty
+     */
+    T* pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);   // Was empty
+            return nullptr;
+        }
+
+        T* item = buffer_[b & mask_].load(std::memory_order_relaxed);
+        if (t == b) {
+            // Last element: race thieves for it
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    /**
+     * @brief Any thread: oldest element, or nullptr if empty or the race was lost
+     */
+    T* steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+
+        T* item = buffer_[t & mask_].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+private:
+    static size_t roundUpPow2(size_t n) {
+        size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    const size_t mask_;
+    std::unique_ptr<std::atomic<T*>[]> buffer_;
+
+    alignas(64) std::atomic<int64_t> top_{0};      // Thieves
+    alignas(64) std::atomic<int64_t> bottom_{0};   // Owner
+};
+
+} // namespace DNASerialProcessor
+
+#endif // DNA_WORK_STEALING_HPP
@@ -0,0 +1,97 @@
+#!/bin/bash
+
+###############################################################################
+# DNA Server I/O Backend Benchmark
+# Compares the epoll and io_uring server paths, and TCP loopback against the
+# shared-memory transport, end to end: clients stream random sequences,
+# timing stops when every record is on disk.
+###############################################################################
+
+set -e
+
+PROJECT_ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BIN_DIR="${BIN_DIR:-$PROJECT_ROOT/bin}"
+
+PORT="${PORT:-9190}"
+CLIENTS="${CLIENTS:-8}"
+SEQUENCES="${SEQUENCES:-2000}"
+LENGTH="${LENGTH:-1000}"
+WORKERS="${WORKERS:-0}"
+
+GREEN='\033[0;32m'
+CYAN='\033[0;36m'
+NC='\033[0m'
+
+# Stored records (every log record's payload starts with an INCHROSIL header)
+count_records() {
+    find "$1" -name 'segment-*.seg' -exec cat {} + 2>/dev/null | grep -a -o 'INCHROSIL' | wc -l
+}
+
+# TRANSPORT=shm runs the clients over the shared-memory ring instead of TCP
+run_backend() {
+    local name="$1"
+    shift
+
+    local workdir
+    workdir="$(mktemp -d)"
+    local expected=$((CLIENTS * SEQUENCES))
+    local server_args=("$PORT" "$@")
+    local client_args=()
+    if [ "$WORKERS" -gt 0 ]; then
+        server_args+=(--workers "$WORKERS")
+    fi
+    if [ "${TRANSPORT:-tcp}" = "shm" ]; then
+        server_args+=(--shm "$workdir/dna_server.sock")
+        client_args+=(--shm "$workdir/dna_server.sock")
+    fi
+
+    (cd "$workdir" && exec "$BIN_DIR/dna_server" "${server_args[@]}" > server.log 2>&1) &
+    local server_pid=$!
+    sleep 0.5
+
+    local start end
+    start=$(date +%s.%N)
+    for _ in $(seq 1 "$CLIENTS"); do
+        "$BIN_DIR/dna_client" localhost "$PORT" --stress "$SEQUENCES" --length "$LENGTH" \
+            "${client_args[@]}" > /dev/null 2>&1 &
+    done
+    wait $(jobs -p | grep -v "^${server_pid}$") 2>/dev/null || true
+
+    # Wait until the server has stored every record (30 s cap)
+    for _ in $(seq 1 3000); do
+        local stored
+        stored=$(count_records "$workdir")
+        [ "$stored" -ge "$expected" ] && break
+        sleep 0.01
+    done
+    end=$(date +%s.%N)
+
+    kill "$server_pid" 2>/dev/null || true
+    wait "$server_pid" 2>/dev/null || true
+
+    local stored
+    stored=$(count_records "$workdir")
+    local backend_line
+    backend_line=$(grep -m1 "Reactor threads" "$workdir/server.log" || true)
+    rm -rf "$workdir"
+
+    awk -v n="$name" -v s="$stored" -v e="$expected" -v t0="$start" -v t1="$end" \
+        -v len="$LENGTH" -v info="$backend_line" 'BEGIN {
+        t = t1 - t0;
+        printf "  %-10s %8d/%-8d records  %7.2f s  %10.0f seq/s  %8.1f MB/s   [%s]\n",
+               n, s, e, t, s / t, s * len / t / 1048576, info
+    }'
+}
+
+echo -e "${CYAN}DNA Server I/O backend benchmark${NC}"
+echo "  clients=$CLIENTS sequences/client=$SEQUENCES length=$LENGTH bp"
+echo ""
+
+run_backend "epoll"
+PORT=$((PORT + 1))
+run_backend "io_uring" --io-uring
+PORT=$((PORT + 1))
+TRANSPORT=shm run_backend "shm"
+
+echo ""
+echo -e "${GREEN}[✓]${NC} Done (io_uring falls back to epoll if the kernel lacks support; shm uses epoll)"
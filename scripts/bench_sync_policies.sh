@@ -0,0 +1,85 @@
+#!/bin/bash
+
+###############################################################################
+# DNA Server Durability Benchmark
+# Runs the same client load against each --sync policy. Timing stops when
+# every client has its ACKs, which under batch/record means every record
+# has been fdatasync'ed; the server's own status line supplies the fdatasync
+# count and its end-to-end latency percentiles.
+###############################################################################
+
+set -e
+
+PROJECT_ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BIN_DIR="${BIN_DIR:-$PROJECT_ROOT/bin}"
+
+PORT="${PORT:-9290}"
+CLIENTS="${CLIENTS:-8}"
+SEQUENCES="${SEQUENCES:-2000}"
+LENGTH="${LENGTH:-1000}"
+SERVER_ARGS="${SERVER_ARGS:-}"      # e.g. --io-uring, or --storage-dir on the disk under test
+
+GREEN='\033[0;32m'
+CYAN='\033[0;36m'
+NC='\033[0m'
+
+# Stored records (every log record's payload starts with an INCHROSIL header)
+count_records() {
+    find "$1" -name 'segment-*.seg' -exec cat {} + 2>/dev/null | grep -a -o 'INCHROSIL' | wc -l
+}
+
+run_policy() {
+    local policy="$1"
+    shift
+
+    local workdir
+    workdir="$(mktemp -d)"
+    local expected=$((CLIENTS * SEQUENCES))
+
+    # shellcheck disable=SC2086
+    (cd "$workdir" && exec "$BIN_DIR/dna_server" "$PORT" --sync "$policy" "$@" $SERVER_ARGS \
+        > server.log 2>&1) &
+    local server_pid=$!
+    sleep 0.5
+
+    local start end
+    start=$(date +%s.%N)
+    for _ in $(seq 1 "$CLIENTS"); do
+        "$BIN_DIR/dna_client" localhost "$PORT" --stress "$SEQUENCES" --length "$LENGTH" \
+            > /dev/null 2>&1 &
+    done
+    wait $(jobs -p | grep -v "^${server_pid}$") 2>/dev/null || true
+    end=$(date +%s.%N)
+
+    # One more status line (printed every second) with the final counters
+    sleep 1.2
+    kill "$server_pid" 2>/dev/null || true
+    wait "$server_pid" 2>/dev/null || true
+
+    local stored status syncs latency
+    stored=$(count_records "$workdir")
+    status=$(tr '\r' '\n' < "$workdir/server.log" | grep -a "Uptime" | tail -1)
+    syncs=$(echo "$status" | grep -o 'Syncs: [0-9]*' | grep -o '[0-9]*' || true)
+    latency=$(echo "$status" | grep -o 'p50/p99/p99.9: [^|]*' | sed 's/p50\/p99\/p99.9: //; s/ *$//')
+    rm -rf "$workdir"
+
+    awk -v n="$policy" -v s="$stored" -v e="$expected" -v t0="$start" -v t1="$end" \
+        -v syncs="${syncs:-0}" -v lat="$latency" 'BEGIN {
+        t = t1 - t0;
+        printf "  %-8s %8d/%-8d records  %7.2f s  %10.0f seq/s  %7d fdatasyncs  p50/p99/p99.9 %s\n",
+               n, s, e, t, s / t, syncs, lat
+    }'
+}
+
+echo -e "${CYAN}DNA Server durability benchmark${NC}"
+echo "  clients=$CLIENTS sequences/client=$SEQUENCES length=$LENGTH bp ${SERVER_ARGS}"
+echo ""
+
+run_policy none
+PORT=$((PORT + 1))
+run_policy batch
+PORT=$((PORT + 1))
+run_policy record
+
+echo ""
+echo -e "${GREEN}[✓]${NC} Done (none: ACK once written to the page cache; batch: group commit; record: fdatasync per write)"
@@ -143,9 +143,14 @@ build_tools() {
     
     # Binary generator
     print_build "Building Binary Generator..."
-    $CXX $CXXFLAGS "$SRC_DIR/generate_binary_files.cpp" -o "$BIN_DIR/generate_binary_files"
+    $CXX $CXXFLAGS $INCLUDES -pthread "$SRC_DIR/generate_binary_files.cpp" -o "$BIN_DIR/generate_binary_files"
     print_info "Built: $BIN_DIR/generate_binary_files"
     
+    # Record lookup
+    print_build "Building Record Lookup..."
+    $CXX $CXXFLAGS $INCLUDES -pthread "$SRC_DIR/dna_lookup.cpp" -o "$BIN_DIR/dna_lookup"
+    print_info "Built: $BIN_DIR/dna_lookup"
+    
     echo ""
 }
 
@@ -156,7 +161,7 @@ build_tests() {
     
     # Binary file tests
     print_build "Building Binary File Tests..."
-    $CXX $CXXFLAGS "$SRC_DIR/test_binary_files.cpp" -o "$BIN_DIR/test_binary_files"
+    $CXX $CXXFLAGS $INCLUDES -pthread "$SRC_DIR/test_binary_files.cpp" -o "$BIN_DIR/test_binary_files"
     print_info "Built: $BIN_DIR/test_binary_files"
     
     # Compression tests
@@ -169,6 +174,66 @@ build_tests() {
     $CXX $CXXFLAGS "$SRC_DIR/test_different_sizes.cpp" -o "$BIN_DIR/test_different_sizes"
     print_info "Built: $BIN_DIR/test_different_sizes"
     
+    # Wire protocol tests
+    print_build "Building Wire Protocol Tests..."
+    $CXX $CXXFLAGS $INCLUDES "$SRC_DIR/test_wire_protocol.cpp" -o "$BIN_DIR/test_wire_protocol"
+    print_info "Built: $BIN_DIR/test_wire_protocol"
+    
+    # MPMC queue tests
+    print_build "Building MPMC Queue Tests..."
+    $CXX $CXXFLAGS $INCLUDES -pthread "$SRC_DIR/test_mpmc_queue.cpp" -o "$BIN_DIR/test_mpmc_queue"
+    print_info "Built: $BIN_DIR/test_mpmc_queue"
+    
+    # Work-stealing deque tests
+    print_build "Building Work-Stealing Tests..."
+    $CXX $CXXFLAGS $INCLUDES -pthread "$SRC_DIR/test_work_stealing.cpp" -o "$BIN_DIR/test_work_stealing"
+    print_info "Built: $BIN_DIR/test_work_stealing"
+    
+    # Receive buffer tests
+    print_build "Building Receive Buffer Tests..."
+    $CXX $CXXFLAGS $INCLUDES -pthread "$SRC_DIR/test_recv_buffer.cpp" -o "$BIN_DIR/test_recv_buffer"
+    print_info "Built: $BIN_DIR/test_recv_buffer"
+    
+    # Shared-memory ring tests
+    print_build "Building Shared-Memory Ring Tests..."
+    $CXX $CXXFLAGS $INCLUDES -pthread "$SRC_DIR/test_shm_ring.cpp" -o "$BIN_DIR/test_shm_ring"
+    print_info "Built: $BIN_DIR/test_shm_ring"
+    
+    # Latency histogram tests
+    print_build "Building Latency Histogram Tests..."
+    $CXX $CXXFLAGS $INCLUDES -pthread "$SRC_DIR/test_latency_histogram.cpp" -o "$BIN_DIR/test_latency_histogram"
+    print_info "Built: $BIN_DIR/test_latency_histogram"
+    
+    # Segment log tests
+    print_build "Building Segment Log Tests..."
+    $CXX $CXXFLAGS $INCLUDES -pthread "$SRC_DIR/test_segment_log.cpp" -o "$BIN_DIR/test_segment_log"
+    print_info "Built: $BIN_DIR/test_segment_log"
+    
+    # Direct I/O writer tests
+    print_build "Building Direct Writer Tests..."
+    $CXX $CXXFLAGS $INCLUDES -pthread "$SRC_DIR/test_direct_writer.cpp" -o "$BIN_DIR/test_direct_writer"
+    print_info "Built: $BIN_DIR/test_direct_writer"
+    
+    # Record index tests
+    print_build "Building Record Index Tests..."
+    $CXX $CXXFLAGS $INCLUDES -pthread "$SRC_DIR/test_record_index.cpp" -o "$BIN_DIR/test_record_index"
+    print_info "Built: $BIN_DIR/test_record_index"
+    
+    # Metadata store tests
+    print_build "Building Metadata Store Tests..."
+    $CXX $CXXFLAGS $INCLUDES -pthread "$SRC_DIR/test_metadata_store.cpp" -o "$BIN_DIR/test_metadata_store"
+    print_info "Built: $BIN_DIR/test_metadata_store"
+    
+    # Segment compactor tests
+    print_build "Building Segment Compactor Tests..."
+    $CXX $CXXFLAGS $INCLUDES -pthread "$SRC_DIR/test_segment_compactor.cpp" -o "$BIN_DIR/test_segment_compactor"
+    print_info "Built: $BIN_DIR/test_segment_compactor"
+    
+    # FASTA converter tests
+    print_build "Building FASTA Converter Tests..."
+    $CXX $CXXFLAGS $INCLUDES -pthread "$SRC_DIR/test_fasta_converter.cpp" -o "$BIN_DIR/test_fasta_converter"
+    print_info "Built: $BIN_DIR/test_fasta_converter"
+    
     echo ""
 }
 
@@ -211,8 +276,12 @@ verify_build() {
     PASSED=0
     
     # Check binaries exist
-    for binary in dna_client dna_server dna_binary_decoder generate_binary_files \
-                  test_binary_files test_compression_sizes test_different_sizes; do
+    for binary in dna_client dna_server dna_binary_decoder generate_binary_files dna_lookup \
+                  test_binary_files test_compression_sizes test_different_sizes \
+                  test_wire_protocol test_mpmc_queue test_work_stealing \
+                  test_recv_buffer test_shm_ring test_latency_histogram test_segment_log \
+                  test_direct_writer test_record_index test_metadata_store test_segment_compactor \
+                  test_fasta_converter; do
         TOTAL=$((TOTAL + 1))
         if [ -f "$BIN_DIR/$binary" ] && [ -x "$BIN_DIR/$binary" ]; then
             print_info "$binary: executable"
@@ -270,6 +339,90 @@ run_tests() {
         print_warning "test_different_sizes not found"
     fi
     
+    echo -e "\n${CYAN}Test 4: Wire Protocol Framing${NC}"
+    if [ -f "$BIN_DIR/test_wire_protocol" ]; then
+        "$BIN_DIR/test_wire_protocol" || true
+    else
+        print_warning "test_wire_protocol not found"
+    fi
+    
+    echo -e "\n${CYAN}Test 5: MPMC Queue${NC}"
+    if [ -f "$BIN_DIR/test_mpmc_queue" ]; then
+        "$BIN_DIR/test_mpmc_queue" || true
+    else
+        print_warning "test_mpmc_queue not found"
+    fi
+    
+    echo -e "\n${CYAN}Test 6: Work-Stealing Deque${NC}"
+    if [ -f "$BIN_DIR/test_work_stealing" ]; then
+        "$BIN_DIR/test_work_stealing" || true
+    else
+        print_warning "test_work_stealing not found"
+    fi
+    
+    echo -e "\n${CYAN}Test 7: Receive Buffers${NC}"
+    if [ -f "$BIN_DIR/test_recv_buffer" ]; then
+        "$BIN_DIR/test_recv_buffer" || true
+    else
+        print_warning "test_recv_buffer not found"
+    fi
+    
+    echo -e "\n${CYAN}Test 8: Shared-Memory Ring${NC}"
+    if [ -f "$BIN_DIR/test_shm_ring" ]; then
+        "$BIN_DIR/test_shm_ring" || true
+    else
+        print_warning "test_shm_ring not found"
+    fi
+    
+    echo -e "\n${CYAN}Test 9: Latency Histograms${NC}"
+    if [ -f "$BIN_DIR/test_latency_histogram" ]; then
+        "$BIN_DIR/test_latency_histogram" || true
+    else
+        print_warning "test_latency_histogram not found"
+    fi
+    
+    echo -e "\n${CYAN}Test 10: Segment Log${NC}"
+    if [ -f "$BIN_DIR/test_segment_log" ]; then
+        "$BIN_DIR/test_segment_log" || true
+    else
+        print_warning "test_segment_log not found"
+    fi
+    
+    echo -e "\n${CYAN}Test 11: Direct I/O Writer${NC}"
+    if [ -f "$BIN_DIR/test_direct_writer" ]; then
+        "$BIN_DIR/test_direct_writer" || true
+    else
+        print_warning "test_direct_writer not found"
+    fi
+    
+    echo -e "\n${CYAN}Test 12: Record Index${NC}"
+    if [ -f "$BIN_DIR/test_record_index" ]; then
+        "$BIN_DIR/test_record_index" || true
+    else
+        print_warning "test_record_index not found"
+    fi
+    
+    echo -e "\n${CYAN}Test 13: Metadata Store${NC}"
+    if [ -f "$BIN_DIR/test_metadata_store" ]; then
+        "$BIN_DIR/test_metadata_store" || true
+    else
+        print_warning "test_metadata_store not found"
+    fi
+    
+    echo -e "\n${CYAN}Test 14: Segment Compactor${NC}"
+    if [ -f "$BIN_DIR/test_segment_compactor" ]; then
+        "$BIN_DIR/test_segment_compactor" || true
+    else
+        print_warning "test_segment_compactor not found"
+    fi
+    
+    echo -e "\n${CYAN}Test 15: FASTA Converter${NC}"
+    if [ -f "$BIN_DIR/test_fasta_converter" ]; then
+        "$BIN_DIR/test_fasta_converter" || true
+    else
+        print_warning "test_fasta_converter not found"
+    fi
+    
     echo ""
 }
 
@@ -0,0 +1,234 @@
+/**
+ * @file benchmark_mpmc_queue.cpp
+ * @brief Microbenchmark: BoundedMPMCQueue vs the old mutex ThreadSafeQueue
+ *
+ * Two scenarios, both with items shaped like the server's work items
+ * (timestamp + 256-byte payload string):
+ * - Saturated throughput: P producers, C consumers, items/second
+ * - Idle latency: one item every 500 us, enqueue-to-dequeue percentiles
+ *
+ * The baseline reproduces what dna_server used before: one global mutex,
+ * copy on pop, and consumers that sleep 10 ms whenever the queue is empty.
+ *
+ * Usage:
+ *   ./benchmark_mpmc_queue [producers] [consumers] [items-per-producer]
+ *
+ * @date 2025-11-24
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+#include "dna_mpmc_queue.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+struct WorkItem {
+    uint64_t sentNs = 0;
+    std::string payload;
+};
+
+static uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count();
+}
+
+//=============================================================================
+// Baseline: former dna_server queue + sleep-polling worker
+//=============================================================================
+
+template<typename T>
+class ThreadSafeQueue {
+private:
+    std::queue<T> queue_;
+    mutable std::mutex mutex_;
+
+public:
+    void push(const T& item) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push(item);
+    }
+
+    bool pop(T& item) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.empty()) {
+            return false;
+        }
+        item = queue_.front();
+        queue_.pop();
+        return true;
+    }
+};
+
+struct LegacyAdapter {
+    ThreadSafeQueue<WorkItem> queue;
+    std::atomic<bool> done{false};
+
+    void push(WorkItem&& item) { queue.push(item); }
+
+    bool pop(WorkItem& item) {
+        while (true) {
+            if (queue.pop(item)) return true;
+            if (done) return queue.pop(item);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    void finish() { done = true; }
+};
+
+struct MPMCAdapter {
+    DNASerialProcessor::BoundedMPMCQueue<WorkItem> queue{4096};
+
+    void push(WorkItem&& item) { queue.push(std::move(item)); }
+    void finish() { queue.close(); }
+
+    // Consumers take up to 32 items per wakeup, as the server workers do
+    struct Consumer {
+        MPMCAdapter& owner;
+        WorkItem batch[32];
+        size_t next = 0, count = 0;
+
+        explicit Consumer(MPMCAdapter& adapter) : owner(adapter) {}
+
+        bool pop(WorkItem& item) {
+            if (next == count) {
+                count = owner.queue.popBatch(batch, 32);
+                next = 0;
+                if (count == 0) return false;
+            }
+            item = std::move(batch[next++]);
+            return true;
+        }
+    };
+};
+
+struct LegacyConsumer {
+    LegacyAdapter& owner;
+    bool pop(WorkItem& item) { return owner.pop(item); }
+};
+
+template<typename Adapter> struct ConsumerOf;
+template<> struct ConsumerOf<LegacyAdapter> { using type = LegacyConsumer; };
+template<> struct ConsumerOf<MPMCAdapter> { using type = MPMCAdapter::Consumer; };
+
+//=============================================================================
+// Scenarios
+//=============================================================================
+
+template<typename Adapter>
+double runThroughput(int producers, int consumers, int perProducer) {
+    Adapter adapter;
+    std::atomic<uint64_t> consumed{0};
+    const std::string payload(256, 'A');
+
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&] {
+            typename ConsumerOf<Adapter>::type consumer{adapter};
+            WorkItem item;
+            while (consumer.pop(item)) consumed++;
+        });
+    }
+
+    std::vector<std::thread> feeders;
+    for (int p = 0; p < producers; p++) {
+        feeders.emplace_back([&] {
+            for (int i = 0; i < perProducer; i++) {
+                adapter.push(WorkItem{0, payload});
+            }
+        });
+    }
+    for (auto& t : feeders) t.join();
+    adapter.finish();
+    for (auto& t : threads) t.join();
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return consumed.load() / seconds;
+}
+
+struct LatencyResult {
+    double p50, p99, p999, max;   // microseconds
+};
+
+template<typename Adapter>
+LatencyResult runLatency(int consumers, int items) {
+    Adapter adapter;
+    std::mutex samplesMutex;
+    std::vector<uint64_t> samples;
+    samples.reserve(items);
+
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&] {
+            typename ConsumerOf<Adapter>::type consumer{adapter};
+            WorkItem item;
+            std::vector<uint64_t> local;
+            while (consumer.pop(item)) local.push_back(nowNs() - item.sentNs);
+            std::lock_guard<std::mutex> lock(samplesMutex);
+            samples.insert(samples.end(), local.begin(), local.end());
+        });
+    }
+
+    // Low arrival rate: consumers are idle between items (the common server case)
+    for (int i = 0; i < items; i++) {
+        adapter.push(WorkItem{nowNs(), std::string(256, 'A')});
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    adapter.finish();
+    for (auto& t : threads) t.join();
+
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&](double p) {
+        size_t index = std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()));
+        return samples[index] / 1000.0;
+    };
+    return {pct(0.50), pct(0.99), pct(0.999), samples.back() / 1000.0};
+}
+
+int main(int argc, char* argv[]) {
+    int producers = argc > 1 ? std::max(1, std::atoi(argv[1])) : 4;
+    int consumers = argc > 2 ? std::max(1, std::atoi(argv[2])) : 4;
+    int perProducer = argc > 3 ? std::max(1, std::atoi(argv[3])) : 250000;
+    int latencyItems = 2000;
+
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║         MPMC Queue vs ThreadSafeQueue Microbenchmark          ║" << std::endl;
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+    std::cout << "Producers: " << producers << "  Consumers: " << consumers
+              << "  Items: " << producers * perProducer << "  Cores: "
+              << std::thread::hardware_concurrency() << std::endl;
+
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "\n📈 Saturated throughput (items/s)" << std::endl;
+    double legacy = runThroughput<LegacyAdapter>(producers, consumers, perProducer);
+    double mpmc = runThroughput<MPMCAdapter>(producers, consumers, perProducer);
+    std::cout << "  ThreadSafeQueue + 10 ms poll: " << std::setw(12) << legacy << std::endl;
+    std::cout << "  BoundedMPMCQueue + parking:   " << std::setw(12) << mpmc
+              << "  (" << std::setprecision(2) << mpmc / legacy << "x)" << std::endl;
+
+    std::cout << std::setprecision(1);
+    std::cout << "\n⏱️  Idle latency, 1 item / 500 us (microseconds)" << std::endl;
+    std::cout << "                                   p50       p99     p99.9       max" << std::endl;
+    LatencyResult a = runLatency<LegacyAdapter>(consumers, latencyItems);
+    LatencyResult b = runLatency<MPMCAdapter>(consumers, latencyItems);
+    for (auto& row : {std::make_pair("ThreadSafeQueue + 10 ms poll:", a),
+                      std::make_pair("BoundedMPMCQueue + parking:  ", b)}) {
+        std::cout << "  " << row.first
+                  << std::setw(9) << row.second.p50 << std::setw(10) << row.second.p99
+                  << std::setw(10) << row.second.p999 << std::setw(10) << row.second.max
+                  << std::endl;
+    }
+    std::cout << std::endl;
+    return 0;
+}
@@ -10,6 +10,11 @@
  * - Multiple send modes (file, interactive, stress test)
  * - Progress tracking
  * - Error handling and reconnection
+ * - Binary framed protocol with HELLO negotiation (falls back to text)
+ * - Optional 2-bit packing at the edge (--pack, 4x fewer bytes on the wire)
+ * - Credit-based flow control: sends only what the server can absorb, waits for ACKs
+ * - Shared-memory transport for clients on the server's host (--shm)
+ * - Record priority and deadline (--priority, --deadline; CAP_PRIORITY servers)
  * 
  * Compile:
  *   g++ -std=c++17 -O3 -pthread -o dna_client dna_client.cpp
@@ -20,6 +25,12 @@
  *   ./dna_client 192.168.1.100 9090 --file genome.fasta
  *   ./dna_client localhost 9090 --interactive
  *   ./dna_client localhost 9090 --stress 1000
+ *   ./dna_client localhost 9090 --stress 1000 --batch 64
+ *   ./dna_client localhost 9090 --stress 1000 --pack
+ *   ./dna_client localhost 9090 --protocol text --file genome.fasta
+ *   ./dna_client localhost --shm /tmp/dna_server.sock --stress 1000
+ *   ./dna_client localhost 9090 --stress 100 --priority critical --deadline 50
+ *   ./dna_client localhost 9090 --stress 1000 --client-id loader-2
  * 
  * @version 1.0
  * @date 2025-11-24
@@ -35,13 +46,26 @@
 #include <random>
 #include <algorithm>
 #include <cstring>
+#include <cerrno>
+#include <iomanip>
+#include <memory>
 
 // Network includes
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <netdb.h>
+#include <sys/time.h>
+
+#include "dna_codec.hpp"
+#include "dna_shm_ring.hpp"
+#include "dna_wire_protocol.hpp"
+
+using DNASerialProcessor::FrameEncoder;
+using DNASerialProcessor::FrameType;
+using DNASerialProcessor::NucleotideCodec;
 
 //=============================================================================
 // Configuration
@@ -49,6 +73,20 @@
 
 constexpr int DEFAULT_PORT = 9090;
 constexpr int BUFFER_SIZE = 65536;
+constexpr int HANDSHAKE_TIMEOUT_MS = 2000;
+constexpr int ACK_TIMEOUT_MS = 10000;       // Max wait for outstanding ACKs on disconnect
+constexpr int MAX_REJECT_REPORTS = 10;
+
+enum class ProtocolMode {
+    BINARY,   // Framed protocol (dna_wire_protocol.hpp)
+    TEXT      // Legacy newline-delimited records
+};
+
+enum class Handshake {
+    ACCEPTED,   // HELLO_ACK
+    REJECTED,   // The server answered with a frame, but not HELLO_ACK (e.g. ERROR)
+    NO_BINARY   // Timeout, closed or not a frame: a text-only server
+};
 
 //=============================================================================
 // DNA Client
@@ -60,56 +98,105 @@ private:
     int serverPort_;
     int socket_;
     bool connected_;
+    ProtocolMode protocol_;
+    size_t batchSize_;
+    bool pack_;
+    std::string batch_;          // Encoded record frames waiting for a BATCH flush
+    size_t batchCount_ = 0;
+    uint64_t bytesSent_ = 0;
+    
+    // Flow control (binary protocol, CAP_FLOW_CONTROL)
+    bool flowControl_ = false;
+    uint64_t credits_ = 0;
+    uint64_t recordsSent_ = 0;
+    uint64_t recordsAcked_ = 0;
+    uint64_t recordsRejected_ = 0;
+    std::string inbox_;          // Bytes received from the server, not yet parsed
+    
+    // Shared-memory transport: frames go into the ring, replies come over the socket
+    std::string shmPath_;
+    std::unique_ptr<DNASerialProcessor::ShmRing> shm_;
+    
+    // Priority lane and deadline sent with each record (CAP_PRIORITY)
+    DNASerialProcessor::RecordMeta meta_{DNASerialProcessor::PRIORITY_NORMAL, {0, 0, 0}, 0};
+    bool priorityAccepted_ = false;
+    
+    // Sent in HELLO: the server's scheduling and latency key (else our IP address)
+    std::string clientName_;
 
 public:
-    DNAClient(const std::string& host, int port) 
-        : serverHost_(host), serverPort_(port), socket_(-1), connected_(false) {}
+    DNAClient(const std::string& host, int port, 
+              ProtocolMode protocol = ProtocolMode::BINARY, size_t batchSize = 1,
+              bool pack = false, const std::string& shmPath = "") 
+        : serverHost_(host), serverPort_(port), socket_(-1), connected_(false),
+          protocol_(protocol), batchSize_(std::max<size_t>(1, batchSize)), pack_(pack),
+          shmPath_(shmPath) {}
     
     ~DNAClient() {
         disconnect();
     }
     
+    /**
+     * @brief Lane and deadline (ms after the server admits it, 0 = none) for later records
+     */
+    void setPriority(uint8_t priority, uint32_t deadlineMs) {
+        meta_.priority = priority;
+        meta_.deadlineMs = deadlineMs;
+    }
+    
+    /**
+     * @brief Name sent in HELLO; the server's --client-weight and latencies use it
+     */
+    void setClientName(const std::string& name) {
+        clientName_ = name;
+    }
+    
     bool connect() {
-        // Create socket
-        socket_ = socket(AF_INET, SOCK_STREAM, 0);
-        if (socket_ < 0) {
-            std::cerr << "Failed to create socket" << std::endl;
-            return false;
+        if (!shmPath_.empty()) {
+            return connectShm();
         }
         
-        // Resolve hostname
-        struct hostent* server = gethostbyname(serverHost_.c_str());
-        if (server == nullptr) {
-            std::cerr << "Failed to resolve hostname: " << serverHost_ << std::endl;
-            close(socket_);
+        if (!openSocket()) {
             return false;
         }
         
-        // Setup server address
-        struct sockaddr_in serverAddr;
-        memset(&serverAddr, 0, sizeof(serverAddr));
-        serverAddr.sin_family = AF_INET;
-        memcpy(&serverAddr.sin_addr.s_addr, server->h_addr, server->h_length);
-        serverAddr.sin_port = htons(serverPort_);
-        
-        // Connect
-        if (::connect(socket_, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
-            std::cerr << "Failed to connect to " << serverHost_ 
-                      << ":" << serverPort_ << std::endl;
+        Handshake handshake = protocol_ == ProtocolMode::BINARY ? negotiate() : Handshake::ACCEPTED;
+        if (handshake == Handshake::REJECTED) {
+            // The server speaks binary and said no: the text protocol would hide that
             close(socket_);
+            socket_ = -1;
             return false;
         }
+        if (handshake == Handshake::NO_BINARY) {
+            // Older servers only speak the text protocol: reconnect and use it
+            std::cout << "Binary protocol not accepted, falling back to text protocol" << std::endl;
+            close(socket_);
+            protocol_ = ProtocolMode::TEXT;
+            if (!openSocket()) {
+                return false;
+            }
+        }
         
         connected_ = true;
-        std::cout << "Connected to " << serverHost_ << ":" << serverPort_ << std::endl;
+        std::cout << "Connected to " << serverHost_ << ":" << serverPort_ 
+                  << " (" << (protocol_ == ProtocolMode::BINARY ? "binary" : "text") 
+                  << " protocol)" << std::endl;
         return true;
     }
     
     void disconnect() {
         if (socket_ >= 0) {
+            if (connected_ && protocol_ == ProtocolMode::BINARY) {
+                flush();
+                if (flowControl_ && recordsSent_ > 0) {
+                    waitForAcks();
+                }
+                sendAll(FrameEncoder::encode(FrameType::BYE, ""));
+            }
             close(socket_);
             socket_ = -1;
         }
+        shm_.reset();
         connected_ = false;
     }
     
@@ -117,35 +204,113 @@ public:
         return connected_;
     }
     
-    bool sendSequence(const std::string& sequence, const std::string& format = "RAW") {
+    ProtocolMode protocol() const {
+        return protocol_;
+    }
+    
+    uint64_t bytesSent() const {
+        return bytesSent_;
+    }
+    
+    /**
+     * @brief Block until every record sent so far is acknowledged (or timeout)
+     */
+    bool waitForAcks() {
+        if (!flowControl_ || !flush()) return false;
+        
+        setReceiveTimeout(ACK_TIMEOUT_MS);
+        while (connected_ && recordsAcked_ < recordsSent_) {
+            if (!receiveFrames(true)) break;
+        }
+        setReceiveTimeout(0);
+        
+        std::cout << "Acknowledged: " << recordsAcked_ << " / " << recordsSent_ << " records";
+        if (recordsRejected_ > 0) {
+            std::cout << " (" << recordsRejected_ << " rejected)";
+        }
+        std::cout << std::endl;
+        return recordsAcked_ == recordsSent_;
+    }
+    
+    bool sendSequence(const std::string& sequence, const std::string& format = "RAW",
+                      const std::string& header = "", const std::string& quality = "") {
         if (!connected_) {
             std::cerr << "Not connected to server" << std::endl;
             return false;
         }
         
         std::string data;
+        std::string name = header.empty() ? "sequence" : header;
+        // Quality scores: all 'I' (Phred 40) unless provided
+        std::string scores = quality.empty() ? std::string(sequence.length(), 'I') : quality;
         
         if (format == "FASTA") {
-            data = ">sequence\n" + sequence + "\n";
+            data = ">" + name + "\n" + sequence + "\n";
         } else if (format == "FASTQ") {
-            data = "@sequence\n" + sequence + "\n+\n";
-            // Add quality scores (all 'I' = Phred 40)
-            data += std::string(sequence.length(), 'I') + "\n";
+            data = "@" + name + "\n" + sequence + "\n+\n" + scores + "\n";
         } else {
             data = sequence + "\n";
         }
         
-        ssize_t sent = send(socket_, data.c_str(), data.length(), 0);
+        if (protocol_ == ProtocolMode::TEXT) {
+            return sendAll(data);
+        }
         
-        if (sent < 0) {
-            std::cerr << "Failed to send data" << std::endl;
-            connected_ = false;
+        // Binary: the frame carries the whole record, including embedded newlines
+        FrameType type = FrameType::RECORD_RAW;
+        if (format == "FASTA") {
+            type = FrameType::RECORD_FASTA;
+        } else if (format == "FASTQ") {
+            type = FrameType::RECORD_FASTQ;
+        } else {
+            data = sequence;
+        }
+        
+        if (pack_) {
+            // Validate, checksum and pack here; the server stores the bytes as-is
+            // Header name and FASTQ qualities travel with the packed bases
+            if (!packRecord(sequence, type, type == FrameType::RECORD_RAW ? "" : name,
+                            type == FrameType::RECORD_FASTQ ? scores : "", data)) {
+                return false;
+            }
+            type = FrameType::RECORD_PACKED;
+        }
+        
+        uint16_t flags = 0;
+        if (priorityAccepted_ && (meta_.priority != DNASerialProcessor::PRIORITY_NORMAL || 
+                                  meta_.deadlineMs != 0)) {
+            data.insert(0, reinterpret_cast<const char*>(&meta_), sizeof(meta_));
+            flags = DNASerialProcessor::RECORD_FLAG_META;
+        }
+        
+        if (!acquireCredit()) {
             return false;
         }
+        recordsSent_++;
         
+        if (batchSize_ == 1) {
+            return sendAll(FrameEncoder::encode(type, data, flags));
+        }
+        
+        FrameEncoder::append(batch_, type, data, flags);
+        if (++batchCount_ >= batchSize_) {
+            return flush();
+        }
         return true;
     }
     
+    /**
+     * @brief Send any records still waiting in the current batch
+     */
+    bool flush() {
+        if (batchCount_ == 0) return true;
+        
+        std::string frame = FrameEncoder::encode(FrameType::BATCH, batch_);
+        batch_.clear();
+        batchCount_ = 0;
+        return sendAll(frame);
+    }
+    
     bool sendFile(const std::string& filename) {
         std::ifstream file(filename);
         if (!file) {
@@ -155,30 +320,32 @@ public:
         
         std::string line;
         std::string sequence;
+        std::string header;
+        std::string quality;
         std::string format = "RAW";
+        bool readQuality = false;
         int sequenceCount = 0;
         
         while (std::getline(file, line)) {
             if (line.empty()) continue;
             
-            if (line[0] == '>') {
-                // FASTA header - send previous sequence if any
-                if (!sequence.empty()) {
-                    sendSequence(sequence, "FASTA");
-                    sequenceCount++;
-                    sequence.clear();
-                }
-                format = "FASTA";
-            } else if (line[0] == '@') {
-                // FASTQ header
+            if (readQuality) {
+                // FASTQ quality line (may itself start with '@' or '+')
+                quality = line;
+                readQuality = false;
+            } else if (line[0] == '>' || line[0] == '@') {
+                // New FASTA/FASTQ header - send previous sequence if any
                 if (!sequence.empty()) {
-                    sendSequence(sequence, "FASTQ");
+                    sendSequence(sequence, format, header, quality);
                     sequenceCount++;
                     sequence.clear();
+                    quality.clear();
                 }
-                format = "FASTQ";
-            } else if (line[0] == '+') {
-                // FASTQ quality separator - skip
+                format = (line[0] == '>') ? "FASTA" : "FASTQ";
+                header = line.substr(1);
+            } else if (line[0] == '+' && format == "FASTQ") {
+                // FASTQ quality separator - next line holds the scores
+                readQuality = true;
                 continue;
             } else {
                 // Sequence data
@@ -192,13 +359,352 @@ public:
         
         // Send last sequence
         if (!sequence.empty()) {
-            sendSequence(sequence, format);
+            sendSequence(sequence, format, header, quality);
             sequenceCount++;
         }
+        flush();
         
         std::cout << "\rSent " << sequenceCount << " sequences from " << filename << std::endl;
         return true;
     }
+
+private:
+    /**
+     * @brief Connect over the server's Unix socket and hand it a shared ring
+     */
+    bool connectShm() {
+        struct sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (shmPath_.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Socket path too long: " << shmPath_ << std::endl;
+            return false;
+        }
+        std::strncpy(address.sun_path, shmPath_.c_str(), sizeof(address.sun_path) - 1);
+        
+        socket_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (socket_ < 0 || ::connect(socket_, (struct sockaddr*)&address, sizeof(address)) < 0) {
+            std::cerr << "Failed to connect to " << shmPath_ << std::endl;
+            disconnect();
+            return false;
+        }
+        
+        shm_ = DNASerialProcessor::ShmRing::create(DNASerialProcessor::SHM_RING_DEFAULT_SIZE);
+        if (!shm_ || !shm_->sendTo(socket_)) {
+            std::cerr << "Failed to set up the shared-memory ring" << std::endl;
+            disconnect();
+            return false;
+        }
+        
+        // HELLO already travels through the ring; there is no text fallback
+        protocol_ = ProtocolMode::BINARY;
+        if (negotiate() != Handshake::ACCEPTED) {
+            std::cerr << "Server did not accept the shared-memory client" << std::endl;
+            disconnect();
+            return false;
+        }
+        
+        connected_ = true;
+        std::cout << "Connected to " << shmPath_ << " (shared memory, " 
+                  << (shm_->capacity() >> 20) << " MB ring)" << std::endl;
+        return true;
+    }
+    
+    bool openSocket() {
+        // Create socket
+        socket_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (socket_ < 0) {
+            std::cerr << "Failed to create socket" << std::endl;
+            return false;
+        }
+        
+        // Resolve hostname
+        struct hostent* server = gethostbyname(serverHost_.c_str());
+        if (server == nullptr) {
+            std::cerr << "Failed to resolve hostname: " << serverHost_ << std::endl;
+            close(socket_);
+            socket_ = -1;
+            return false;
+        }
+        
+        // Setup server address
+        struct sockaddr_in serverAddr;
+        memset(&serverAddr, 0, sizeof(serverAddr));
+        serverAddr.sin_family = AF_INET;
+        memcpy(&serverAddr.sin_addr.s_addr, server->h_addr, server->h_length);
+        serverAddr.sin_port = htons(serverPort_);
+        
+        // Connect
+        if (::connect(socket_, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+            std::cerr << "Failed to connect to " << serverHost_ 
+                      << ":" << serverPort_ << std::endl;
+            close(socket_);
+            socket_ = -1;
+            return false;
+        }
+        return true;
+    }
+    
+    /**
+     * @brief HELLO / HELLO_ACK exchange
+     * @return ACCEPTED, REJECTED when the server answers with another frame,
+     *         NO_BINARY when it does not answer with a frame at all
+     */
+    Handshake negotiate() {
+        using namespace DNASerialProcessor;
+        
+        inbox_.clear();
+        if (!sendAll(FrameEncoder::hello(WIRE_VERSION, WIRE_VERSION, 
+                                         CAP_BATCH | CAP_FLOW_CONTROL | CAP_PRIORITY, clientName_))) {
+            return Handshake::NO_BINARY;
+        }
+        
+        // A text-only server never answers, so bound the wait
+        setReceiveTimeout(HANDSHAKE_TIMEOUT_MS);
+        FrameView frame;
+        bool framed = readFrame(frame);
+        setReceiveTimeout(0);
+        if (!framed) {
+            return Handshake::NO_BINARY;
+        }
+        
+        if (frame.type != FrameType::HELLO_ACK || frame.length < sizeof(HelloPayload)) {
+            if (frame.type == FrameType::ERROR) {
+                std::cerr << "Server rejected handshake: " 
+                          << std::string(frame.payload, frame.length) << std::endl;
+            } else {
+                std::cerr << "Server answered HELLO with frame type " 
+                          << static_cast<int>(frame.type) << std::endl;
+            }
+            return Handshake::REJECTED;
+        }
+        
+        HelloPayload ack;
+        std::memcpy(&ack, frame.payload, sizeof(ack));
+        flowControl_ = (ack.capabilities & CAP_FLOW_CONTROL) != 0;
+        priorityAccepted_ = (ack.capabilities & CAP_PRIORITY) != 0;
+        if (!priorityAccepted_ && (meta_.priority != PRIORITY_NORMAL || meta_.deadlineMs != 0)) {
+            std::cerr << "Server has no priority lanes; records sent as NORMAL" << std::endl;
+        }
+        inbox_.erase(0, frame.frameSize);  // CREDIT may already follow in inbox_
+        return Handshake::ACCEPTED;
+    }
+    
+    /**
+     * @brief Block until inbox_ starts with a complete frame (left in place)
+     */
+    bool readFrame(DNASerialProcessor::FrameView& frame) {
+        using namespace DNASerialProcessor;
+        
+        frame.type = FrameType::HELLO;
+        char chunk[4096];
+        while (true) {
+            DecodeStatus status = FrameDecoder::decode(inbox_.data(), inbox_.size(), frame);
+            if (status == DecodeStatus::FRAME) return true;
+            if (status == DecodeStatus::ERROR) return false;
+            
+            ssize_t n = recv(socket_, chunk, sizeof(chunk), 0);
+            if (n <= 0) return false;
+            inbox_.append(chunk, n);
+        }
+    }
+    
+    /**
+     * @brief Take one credit, flushing the batch and waiting for ACKs if none is left
+     */
+    bool acquireCredit() {
+        if (!flowControl_) return true;
+        
+        while (credits_ == 0) {
+            if (!flush() || !receiveFrames(true)) {
+                std::cerr << "Connection lost while waiting for credits" << std::endl;
+                connected_ = false;
+                return false;
+            }
+        }
+        credits_--;
+        return true;
+    }
+    
+    /**
+     * @brief Read server frames (CREDIT, ACK, ERROR); blocks for at least one if asked
+     */
+    bool receiveFrames(bool block) {
+        // Frames may already be buffered (e.g. CREDIT right behind HELLO_ACK)
+        size_t handled = 0;
+        if (!parseInbox(handled)) return false;
+        if (handled > 0) return true;
+        
+        char chunk[16384];
+        ssize_t n = recv(socket_, chunk, sizeof(chunk), block ? 0 : MSG_DONTWAIT);
+        if (n == 0) return false;
+        if (n < 0) {
+            return !block && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+        inbox_.append(chunk, n);
+        return parseInbox(handled);
+    }
+    
+    bool parseInbox(size_t& handled) {
+        using namespace DNASerialProcessor;
+        
+        size_t offset = 0;
+        while (true) {
+            FrameView frame;
+            std::string error;
+            DecodeStatus status = FrameDecoder::decode(inbox_.data() + offset, 
+                                                       inbox_.size() - offset, frame, &error);
+            if (status == DecodeStatus::NEED_MORE) break;
+            if (status == DecodeStatus::ERROR) {
+                std::cerr << "Bad frame from server: " << error << std::endl;
+                return false;
+            }
+            if (!handleServerFrame(frame)) return false;
+            offset += frame.frameSize;
+            handled++;
+        }
+        inbox_.erase(0, offset);
+        return true;
+    }
+    
+    bool handleServerFrame(const DNASerialProcessor::FrameView& frame) {
+        using namespace DNASerialProcessor;
+        
+        switch (frame.type) {
+            case FrameType::CREDIT: {
+                CreditPayload credit;
+                if (frame.length < sizeof(credit)) return false;
+                std::memcpy(&credit, frame.payload, sizeof(credit));
+                credits_ += credit.credits;
+                return true;
+            }
+            
+            case FrameType::ACK: {
+                AckHeader header;
+                if (frame.length < sizeof(header)) return false;
+                std::memcpy(&header, frame.payload, sizeof(header));
+                if (frame.length < sizeof(header) + header.count * sizeof(AckEntry)) return false;
+                
+                credits_ += header.credits;
+                recordsAcked_ += header.count;
+                for (uint32_t i = 0; i < header.count; i++) {
+                    AckEntry entry;
+                    std::memcpy(&entry, frame.payload + sizeof(header) + i * sizeof(entry), 
+                                sizeof(entry));
+                    if (entry.status == ACK_STORED) continue;
+                    if (++recordsRejected_ <= MAX_REJECT_REPORTS) {
+                        std::cerr << "Record " << entry.recordNumber << " rejected by server ("
+                                  << (entry.status == ACK_INVALID ? "invalid sequence" :
+                                      entry.status == ACK_EXPIRED ? "missed deadline"
+                                                                  : "storage error")
+                                  << ")" << std::endl;
+                    }
+                }
+                return true;
+            }
+            
+            case FrameType::ERROR:
+                std::cerr << "Server error: " << std::string(frame.payload, frame.length) 
+                          << std::endl;
+                connected_ = false;
+                return false;
+            
+            default:
+                return true;  // PING replies and future frame types
+        }
+    }
+    
+    /**
+     * @brief Build a RECORD_PACKED payload
+     * @return false (and says why) if it cannot carry the record as given
+     */
+    static bool packRecord(const std::string& sequence, FrameType sourceType, const std::string& name,
+                           const std::string& quality, std::string& payload) {
+        if (name.size() > DNASerialProcessor::PACKED_MAX_NAME) {
+            std::cerr << "Header longer than " << DNASerialProcessor::PACKED_MAX_NAME 
+                      << " bytes, not sent" << std::endl;
+            return false;
+        }
+        if (!quality.empty() && quality.size() != sequence.size()) {
+            std::cerr << "Quality length does not match sequence length, not sent" << std::endl;
+            return false;
+        }
+        
+        DNASerialProcessor::PackedRecordHeader header{};
+        header.baseCount = sequence.size();
+        header.sequenceCrc32 = DNASerialProcessor::HardwareCRC32::calculate(
+            reinterpret_cast<const uint8_t*>(sequence.data()), sequence.size());
+        header.sourceType = static_cast<uint8_t>(sourceType);
+        
+        std::string packed;
+        if (!NucleotideCodec::pack(sequence.data(), sequence.size(), packed)) {
+            std::cerr << "Invalid nucleotides in sequence, not sent" << std::endl;
+            return false;
+        }
+        
+        payload = FrameEncoder::packedRecord(header, name, packed, quality);
+        return true;
+    }
+    
+    void setReceiveTimeout(int milliseconds) {
+        struct timeval tv;
+        tv.tv_sec = milliseconds / 1000;
+        tv.tv_usec = (milliseconds % 1000) * 1000;
+        setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+    
+    bool sendAll(const std::string& data) {
+        if (shm_) {
+            return writeShm(data);
+        }
+        
+        size_t offset = 0;
+        while (offset < data.size()) {
+            ssize_t sent = send(socket_, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "Failed to send data" << std::endl;
+                connected_ = false;
+                return false;
+            }
+            offset += sent;
+        }
+        bytesSent_ += data.size();
+        return true;
+    }
+    
+    /**
+     * @brief Publish one frame in the shared ring, waiting for the server to free space
+     */
+    bool writeShm(const std::string& frame) {
+        if (frame.size() > shm_->maxFrame()) {
+            // Larger than the ring: let it drain, send over the socket, and
+            // wait for the ACK, so the server still sees frames in order
+            std::unique_ptr<DNASerialProcessor::ShmRing> ring = std::move(shm_);
+            bool ok = waitShm([&] { return ring->drained(); }) && sendAll(frame) &&
+                      waitShm([&] { return recordsAcked_ >= recordsSent_; });
+            shm_ = std::move(ring);
+            return ok;
+        }
+        
+        // Space comes back as the server's workers finish records (ACKs follow)
+        if (!waitShm([&] { return shm_->tryWrite(frame.data(), frame.size()); })) {
+            return false;
+        }
+        bytesSent_ += frame.size();
+        return true;
+    }
+    
+    template<typename Ready>
+    bool waitShm(Ready ready) {
+        while (!ready()) {
+            if (!flowControl_ || !receiveFrames(true)) {
+                std::cerr << "Connection lost while waiting for the shared ring" << std::endl;
+                connected_ = false;
+                return false;
+            }
+        }
+        return true;
+    }
 };
 
 //=============================================================================
@@ -280,10 +786,16 @@ void stressTest(DNAClient& client, int numSequences, size_t sequenceLength = 100
     double throughputSeq = numSequences / seconds;
     double throughputKB = (numSequences * sequenceLength) / 1024.0 / seconds;
     
+    client.flush();
+    
     std::cout << "\n\nStress Test Complete!" << std::endl;
     std::cout << "Time: " << seconds << " seconds" << std::endl;
     std::cout << "Throughput: " << throughputSeq << " sequences/sec" << std::endl;
     std::cout << "Throughput: " << throughputKB << " KB/sec" << std::endl;
+    std::cout << "Wire bytes: " << client.bytesSent() / 1024 << " KB ("
+              << std::fixed << std::setprecision(2)
+              << static_cast<double>(client.bytesSent()) / (numSequences * sequenceLength)
+              << " bytes/base)" << std::endl;
 }
 
 void printUsage(const char* program) {
@@ -293,6 +805,15 @@ void printUsage(const char* program) {
     std::cout << "  --interactive           Interactive mode" << std::endl;
     std::cout << "  --stress <count>        Stress test with N random sequences" << std::endl;
     std::cout << "  --length <size>         Sequence length for stress test (default: 1000)" << std::endl;
+    std::cout << "  --protocol <mode>       binary (default) or text" << std::endl;
+    std::cout << "  --batch <n>             Records per BATCH frame, binary protocol (default: 1)" << std::endl;
+    std::cout << "  --pack                  Validate and 2-bit pack on the client (binary protocol)" << std::endl;
+    std::cout << "  --shm <path>            Shared-memory transport via the server's Unix socket" << std::endl;
+    std::cout << "                          (server on this host started with --shm)" << std::endl;
+    std::cout << "  --priority <lane>       critical, high, normal (default) or low" << std::endl;
+    std::cout << "  --deadline <ms>         Server drops (or demotes) records not dispatched in time" << std::endl;
+    std::cout << "  --client-id <name>      Name for the server's per-client weights and latencies" << std::endl;
+    std::cout << "                          (binary protocol; default: this host's IP address)" << std::endl;
     std::cout << "\nExamples:" << std::endl;
     std::cout << "  " << program << " localhost 9090" << std::endl;
     std::cout << "  " << program << " 192.168.1.100 9090 --file genome.fasta" << std::endl;
@@ -316,6 +837,13 @@ int main(int argc, char* argv[]) {
     std::string filename;
     int stressCount = 1000;
     size_t sequenceLength = 1000;
+    ProtocolMode protocol = ProtocolMode::BINARY;
+    size_t batchSize = 1;
+    bool pack = false;
+    std::string shmPath;
+    uint8_t priority = DNASerialProcessor::PRIORITY_NORMAL;
+    uint32_t deadlineMs = 0;
+    std::string clientName;
     
     // Parse arguments
     for (int i = 2; i < argc; i++) {
@@ -331,6 +859,41 @@ int main(int argc, char* argv[]) {
             stressCount = std::atoi(argv[++i]);
         } else if (arg == "--length" && i + 1 < argc) {
             sequenceLength = std::atoi(argv[++i]);
+        } else if (arg == "--protocol" && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (value != "binary" && value != "text") {
+                std::cerr << "Unknown protocol: " << value << std::endl;
+                return 1;
+            }
+            protocol = (value == "text") ? ProtocolMode::TEXT : ProtocolMode::BINARY;
+        } else if (arg == "--pack") {
+            pack = true;
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batchSize = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--shm" && i + 1 < argc) {
+            shmPath = argv[++i];
+        } else if (arg == "--priority" && i + 1 < argc) {
+            std::string value = argv[++i];
+            priority = DNASerialProcessor::PRIORITY_LANES;
+            for (uint8_t lane = 0; lane < DNASerialProcessor::PRIORITY_LANES; lane++) {
+                std::string name = DNASerialProcessor::priorityName(lane);
+                std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                if (value == name) priority = lane;
+            }
+            if (priority == DNASerialProcessor::PRIORITY_LANES) {
+                std::cerr << "Unknown priority: " << value << std::endl;
+                return 1;
+            }
+        } else if (arg == "--deadline" && i + 1 < argc) {
+            deadlineMs = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--client-id" && i + 1 < argc) {
+            clientName = argv[++i];
+            if (!DNASerialProcessor::validClientName(clientName.data(), clientName.size())) {
+                std::cerr << "Invalid client ID: " << clientName << " (1-"
+                          << DNASerialProcessor::HELLO_MAX_CLIENT_NAME 
+                          << " printable characters, no spaces)" << std::endl;
+                return 1;
+            }
         } else if (arg[0] != '-') {
             port = std::atoi(arg.c_str());
         }
@@ -343,11 +906,17 @@ int main(int argc, char* argv[]) {
     }
     
     std::cout << "=== DNA Client ===" << std::endl;
-    std::cout << "Server: " << server << ":" << port << std::endl;
+    if (shmPath.empty()) {
+        std::cout << "Server: " << server << ":" << port << std::endl;
+    } else {
+        std::cout << "Server: " << shmPath << " (shared memory)" << std::endl;
+    }
     std::cout << "Mode: " << mode << std::endl;
     
     // Create and connect client
-    DNAClient client(server, port);
+    DNAClient client(server, port, protocol, batchSize, pack, shmPath);
+    client.setPriority(priority, deadlineMs);
+    client.setClientName(clientName);
     
     if (!client.connect()) {
         return 1;
@@ -78,7 +78,11 @@ void printStats(const ProcessorStats& stats, float temperature) {
     std::cout << "Throughput: " << std::setw(6) << std::setprecision(1) 
               << stats.getThroughputKBps() << " KB/s | ";
     std::cout << "CPU: " << std::setw(4) << std::setprecision(1) 
-              << stats.getCPUUtilization() << "% ";
+              << stats.getCPUUtilization() << "% | ";
+    std::cout << "Latency p50/p99/p99.9: " << std::setprecision(2)
+              << stats.getLatencyPercentileMs(50) << "/"
+              << stats.getLatencyPercentileMs(99) << "/"
+              << stats.getLatencyPercentileMs(99.9) << " ms ";
     std::cout << std::flush;
 }
 
@@ -199,6 +203,15 @@ void runExample() {
     std::cout << "Storage Errors: " << finalStats.storageErrors.load() << std::endl;
     std::cout << "Average Latency: " << std::fixed << std::setprecision(2) 
               << finalStats.getAverageLatencyMs() << " ms" << std::endl;
+    std::cout << "Latency p50 / p99 / p99.9 by stage:" << std::endl;
+    for (int stage = 0; stage < PIPELINE_STAGES; stage++) {
+        PipelineStage which = static_cast<PipelineStage>(stage);
+        if (finalStats.latency.snapshot(which).count() == 0) continue;
+        std::cout << "  " << std::left << std::setw(10) << stageName(which) << std::right
+                  << finalStats.getLatencyPercentileMs(50, which) << " / "
+                  << finalStats.getLatencyPercentileMs(99, which) << " / "
+                  << finalStats.getLatencyPercentileMs(99.9, which) << " ms" << std::endl;
+    }
     std::cout << "Average Throughput: " << std::fixed << std::setprecision(1) 
               << finalStats.getThroughputKBps() << " KB/s" << std::endl;
     std::cout << "Average CPU: " << std::fixed << std::setprecision(1) 
@@ -7,9 +7,23 @@
  * 
  * Features:
  * - TCP server listening on port 9090
- * - Multi-client support (up to 16 simultaneous connections)
+ * - epoll reactor threads (one per core) owning all client sockets
+ * - Optional io_uring backend (multishot recv + async storage writes)
+ * - Append-only segment log storage (dna_segment_log.hpp), indexed by record ID
+ * - Per-record metadata rows (dna_metadata_store.hpp), added once a record is durable
+ * - Optional durability: group commit (one fdatasync per window) or per record;
+ *   acknowledgements wait for the commit covering their record
+ * - Binary framed protocol (dna_wire_protocol.hpp) with legacy text fallback
+ * - Credit-based flow control with per-record ACKs; bounded in-flight records
+ * - Batched workers: small records are validated, encoded and stored together
+ * - Optional shard-per-core mode (SO_REUSEPORT, pinned, no shared state)
+ * - Shared-memory transport for co-located clients (memfd ring over a Unix socket)
+ * - Fair scheduling: per-client queues, weighted deficit round-robin by bytes
+ * - Priority lanes (CRITICAL..LOW) with per-record deadlines, strict or EDF
+ * - Multi-client support (up to 4096 simultaneous connections)
  * - Hardware-accelerated processing (NEON, CRC32, SHA256)
- * - Real-time statistics
+ * - Real-time statistics, per-stage latency percentiles (lock-free histograms)
+ * - Optional Prometheus /metrics endpoint with sliding-window rates
  * - Thread-safe queue management
  * 
  * Compile:
@@ -17,8 +31,23 @@
  *       -pthread -o dna_server dna_server.cpp
  * 
  * Usage:
- *   ./dna_server [port]
+ *   ./dna_server [port] [options]
  *   ./dna_server 9090
+ *   ./dna_server 9090 --reactors 2 --workers 4 --max-clients 8192
+ *   ./dna_server 9090 --io-uring
+ *   ./dna_server 9090 --queue-capacity 16384 --credit-window 128
+ *   ./dna_server 9090 --batch-records 1        (one record per write)
+ *   ./dna_server 9090 --shards 4               (SO_REUSEPORT shard per core)
+ *   ./dna_server 9090 --shm /tmp/dna_server.sock   (co-located clients)
+ *   ./dna_server 9090 --client-weight loader-2=4   (4x the byte share under load)
+ *   ./dna_server 9090 --lanes edf --deadline-miss demote
+ *   ./dna_server 9090 --metrics-port 9100     (Prometheus scrape endpoint)
+ *   ./dna_server 9090 --storage-dir /data/dna --segment-size 256
+ *   ./dna_server 9090 --sync batch --commit-us 200   (group commit)
+ *   ./dna_server 9090 --no-index              (no ID/name/checksum index)
+ *   ./dna_server 9090 --no-metadata           (no per-record metadata catalog)
+ *   ./dna_server 9090 --compress-after 1440 --compress-io 4   (recompress day-old segments)
+ *   ./dna_server 9090 --checkpoint-ms 1000    (bound the log replayed at startup)
  * 
  * @version 1.0
  * @date 2025-11-24
@@ -27,16 +56,21 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <queue>
 #include <thread>
 #include <mutex>
 #include <atomic>
 #include <chrono>
 #include <sstream>
 #include <iomanip>
-#include <fstream>
 #include <algorithm>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <map>
+#include <deque>
 #include <cstring>
+#include <cerrno>
+#include <csignal>
 #include <ctime>
 
 // Network includes
@@ -45,6 +79,44 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/un.h>
+#include <poll.h>
+
+#include "dna_io_uring.hpp"
+#include "dna_codec.hpp"
+#include "dna_latency_histogram.hpp"
+#include "dna_metadata_store.hpp"
+#include "dna_metrics.hpp"
+#include "dna_mpmc_queue.hpp"
+#include "dna_record_index.hpp"
+#include "dna_recv_buffer.hpp"
+#include "dna_segment_compactor.hpp"
+#include "dna_segment_log.hpp"
+#include "dna_serial_processor.hpp"
+#include "dna_shm_ring.hpp"
+#include "dna_work_stealing.hpp"
+#include "dna_wire_protocol.hpp"
+
+using DNASerialProcessor::CPUAffinity;
+using DNASerialProcessor::DecodeStatus;
+using DNASerialProcessor::FrameDecoder;
+using DNASerialProcessor::FrameEncoder;
+using DNASerialProcessor::FrameType;
+using DNASerialProcessor::FrameView;
+using DNASerialProcessor::GroupCommitter;
+using DNASerialProcessor::LatencyHistogram;
+using DNASerialProcessor::LogBatch;
+using DNASerialProcessor::MetadataStore;
+using DNASerialProcessor::MetricsWriter;
+using DNASerialProcessor::PipelineLatency;
+using DNASerialProcessor::PipelineStage;
+using DNASerialProcessor::RecordIndex;
+using DNASerialProcessor::SegmentCompactor;
+using DNASerialProcessor::SegmentLog;
+using DNASerialProcessor::SyncPolicy;
+using DNASerialProcessor::NucleotideCodec;
 
 // ARM hardware acceleration
 #ifdef __aarch64__
@@ -60,22 +132,135 @@
 //=============================================================================
 
 constexpr int DEFAULT_PORT = 9090;
-constexpr int MAX_CLIENTS = 16;
-constexpr int BUFFER_SIZE = 65536;  // 64 KB
-constexpr int QUEUE_SIZE = 1024;
+constexpr int MAX_CLIENTS = 4096;       // Enforced on accept
+constexpr int LISTEN_BACKLOG = SOMAXCONN;
+constexpr int QUEUE_SIZE = 65536;       // Records queued or in flight, all reactors
+constexpr int CREDIT_WINDOW = 256;      // Credits granted per flow-controlled connection
+constexpr size_t WORKER_BATCH = 32;     // Inbox depth at which dispatch looks for another worker
+constexpr int STORE_BATCH_RECORDS = 256;      // Records a worker takes per batch
+constexpr size_t STORE_BATCH_BYTES = 1 << 20; // Encoded bytes per storage write
+constexpr const char* STORAGE_DIR = "dna_log";  // Segment log directory (per shard: shard-<n>/)
+constexpr int CHECKPOINT_MS = 5000;           // Between SegmentLog checkpoints
+constexpr uint64_t CHECKPOINT_ID_LEASE = 1 << 20;  // IDs a checkpoint reserves past those issued
+constexpr size_t FRAME_RESERVE_MAX = 1 << 20;  // Bytes a frame header may reserve ahead; the rest grows as it arrives
+constexpr size_t OUTBOX_READ_CAP = 256 << 10;  // Unsent reply bytes above which a client is not read
+constexpr size_t SPLIT_THRESHOLD = 4 << 20;   // Bases: larger records are encoded in parallel
+constexpr size_t SPLIT_CHUNK = 1 << 20;       // Bases per encode sub-task (multiple of 4)
+constexpr size_t STEAL_DEQUE_SIZE = 1024;     // Encode sub-tasks per worker deque
+constexpr size_t PACKED_VERIFY_SLICE = 64 << 10;  // Bases decoded at a time to check a packed CRC (multiple of 4)
+constexpr int MAX_EPOLL_EVENTS = 256;
+constexpr unsigned URING_ENTRIES = 512;
+constexpr unsigned URING_BUFFER_COUNT = 256;     // Provided buffers per reactor (power of two)
+constexpr size_t URING_BUFFER_SIZE = 16384;      // 16 KB each -> 4 MB per reactor
+constexpr unsigned URING_WRITE_DEPTH = 64;       // In-flight storage writes per worker
+constexpr unsigned URING_SUBMIT_BATCH = 16;      // Storage writes per io_uring_enter
+constexpr uint64_t DRR_QUANTUM = 64 << 10;       // Bytes a weight-1 client may dispatch per turn
+constexpr uint64_t DRR_RECORD_OVERHEAD = 64;     // Charged per record on top of its bytes
+constexpr size_t MAX_TRACKED_CLIENTS = 1024;     // Client IDs with their own latency histogram
+constexpr int LATENCY_REPORT_INTERVAL = 10;      // Seconds between per-client latency lines
+
+enum class IoBackend {
+    EPOLL,
+    IO_URING
+};
+
+enum class Scheduler {
+    FIFO,   // Records go to the workers in arrival order
+    DRR     // Per-client queues, deficit round-robin weighted by bytes
+};
+
+// How the DRR scheduler picks between priority lanes (RecordMeta)
+enum class LanePolicy {
+    STRICT,   // Lowest non-empty lane first
+    EDF       // Earliest deadline first across lanes
+};
+
+enum class DeadlinePolicy {
+    DROP,     // Acknowledge with ACK_EXPIRED without processing
+    DEMOTE    // Move to the LOW lane and process when there is time
+};
+
+// EDF deadline of records that carry none, per lane (the RTOS example's task budgets)
+constexpr uint32_t LANE_BUDGET_MS[DNASerialProcessor::PRIORITY_LANES] = {10, 50, 100, 500};
+
+struct ServerConfig {
+    int port = DEFAULT_PORT;
+    int reactorThreads = 0;   // 0 = one per core
+    int workerThreads = 0;    // 0 = one per core
+    int maxClients = MAX_CLIENTS;
+    IoBackend ioBackend = IoBackend::EPOLL;
+    int queueCapacity = QUEUE_SIZE;
+    int creditWindow = CREDIT_WINDOW;
+    int batchRecords = STORE_BATCH_RECORDS;
+    size_t batchBytes = STORE_BATCH_BYTES;
+    std::string storageDir = STORAGE_DIR;
+    size_t segmentBytes = DNASerialProcessor::SEGMENT_DEFAULT_BYTES;
+    SyncPolicy syncPolicy = SyncPolicy::NONE;
+    DNASerialProcessor::GroupCommitConfig commit;   // Window for SyncPolicy::BATCH
+    bool enableIndexing = true;   // Sorted ID/name/checksum index in <storageDir>/index
+    bool enableMetadata = true;   // DNAMetadata per stored record in <storageDir>/metadata
+    bool compressOld = true;      // Recompress cold sealed segments in the background
+    int checkpointMs = CHECKPOINT_MS;   // 0 = only at shutdown
+    DNASerialProcessor::CompactionConfig compaction;
+    
+    // Shared-nothing mode: `shards` servers bind the port with SO_REUSEPORT,
+    // each with its own reactor, worker, queue and statistics
+    int shards = 0;           // 0 = one server with shared state
+    int shardIndex = 0;
+    int cpuCore = -1;         // Pin this server's threads to one core
+    
+    std::string shmSocket;    // Unix socket for shared-memory clients (empty = off)
+    
+    Scheduler scheduler = Scheduler::DRR;
+    std::unordered_map<std::string, uint32_t> clientWeights;   // Client name or IP -> DRR weight (default 1)
+    LanePolicy lanePolicy = LanePolicy::STRICT;
+    DeadlinePolicy deadlinePolicy = DeadlinePolicy::DROP;
+    
+    int metricsPort = 0;      // Prometheus /metrics listener for all shards (0 = off)
+};
 
 //=============================================================================
 // DNA Sequence Structure
 //=============================================================================
 
+/**
+ * @brief Where a record came from, so workers can acknowledge it
+ */
+struct RecordOrigin {
+    int reactor = -1;           // Index into DNAServer::reactors_
+    int fd = -1;
+    uint32_t generation = 0;
+    uint64_t recordNumber = 0;  // 1-based per connection
+    uint64_t cost = 0;          // Bytes charged to the scheduler's dispatch window
+    uint64_t admittedNs = 0;    // steady_clock time of admission, for per-client latency
+    uint64_t deadlineNs = 0;    // steady_clock deadline from RecordMeta (0 = none)
+    uint8_t lane = DNASerialProcessor::PRIORITY_NORMAL;
+};
+
 struct DNASequence {
     uint64_t id;
     std::string clientId;
-    std::string sequence;
     std::string format;  // FASTA, FASTQ, RAW
+    std::string name;    // First word of the FASTA/FASTQ header line (empty for RAW)
     uint64_t timestamp;
     
-    DNASequence() : id(0), timestamp(0) {}
+    // Record bytes, still in the connection's receive block. The reactor
+    // slices them out; the worker narrows the slice to the bases (or to the
+    // packed bytes of a RECORD_PACKED frame) without copying.
+    DNASerialProcessor::BufferSlice payload;
+    std::string sequence;  // Only when bases had to be compacted (multi-line FASTA)
+    
+    // Set when the client already validated and packed the bases (RECORD_PACKED)
+    bool preEncoded;
+    uint64_t baseCount;
+    uint32_t checksum;
+    
+    RecordOrigin origin;
+    
+    DNASequence() : id(0), timestamp(0), preEncoded(false), baseCount(0), checksum(0) {}
+    
+    const char* bases() const { return sequence.empty() ? payload.data() : sequence.data(); }
+    size_t length() const { return sequence.empty() ? payload.size() : sequence.size(); }
 };
 
 //=============================================================================
@@ -113,6 +298,53 @@ public:
         return ~crc;
 #endif
     }
+    
+    /**
+     * @brief CRC of A||B from crc(A), crc(B) and len(B) (zlib's crc32_combine)
+     *
+     * Lets sub-tasks checksum slices of one sequence independently.
+     */
+    static uint32_t combine(uint32_t crcA, uint32_t crcB, uint64_t lengthB) {
+        if (lengthB == 0) return crcA;
+        
+        // Operator that feeds one zero bit through the CRC register
+        uint32_t odd[32], even[32];
+        odd[0] = 0xEDB88320;
+        for (int n = 1; n < 32; n++) {
+            odd[n] = 1u << (n - 1);
+        }
+        gf2Square(even, odd);   // Two zero bits
+        gf2Square(odd, even);   // Four zero bits
+        
+        // Apply len(B) zero bytes to crc(A), squaring the operator per bit of the length
+        do {
+            gf2Square(even, odd);
+            if (lengthB & 1) crcA = gf2Times(even, crcA);
+            lengthB >>= 1;
+            if (lengthB == 0) break;
+            
+            gf2Square(odd, even);
+            if (lengthB & 1) crcA = gf2Times(odd, crcA);
+            lengthB >>= 1;
+        } while (lengthB != 0);
+        
+        return crcA ^ crcB;
+    }
+    
+private:
+    static uint32_t gf2Times(const uint32_t* matrix, uint32_t vector) {
+        uint32_t sum = 0;
+        for (; vector; vector >>= 1, matrix++) {
+            if (vector & 1) sum ^= *matrix;
+        }
+        return sum;
+    }
+    
+    static void gf2Square(uint32_t* square, const uint32_t* matrix) {
+        for (int n = 0; n < 32; n++) {
+            square[n] = gf2Times(matrix, matrix[n]);
+        }
+    }
 };
 
 //=============================================================================
@@ -174,59 +406,84 @@ public:
 };
 
 //=============================================================================
-// Thread-Safe Queue
+// Server Statistics
 //=============================================================================
 
-template<typename T>
-class ThreadSafeQueue {
-private:
-    std::queue<T> queue_;
-    mutable std::mutex mutex_;
-    std::atomic<size_t> size_{0};
-
-public:
-    void push(const T& item) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        queue_.push(item);
-        size_.fetch_add(1, std::memory_order_relaxed);
-    }
-    
-    bool pop(T& item) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (queue_.empty()) {
-            return false;
-        }
-        item = queue_.front();
-        queue_.pop();
-        size_.fetch_sub(1, std::memory_order_relaxed);
-        return true;
-    }
-    
-    size_t size() const {
-        return size_.load(std::memory_order_relaxed);
-    }
+/**
+ * @brief Results of one priority lane over a report interval
+ */
+struct LaneStats {
+    LatencyHistogram latency;   // Processed records, admission to result
+    uint64_t missed = 0;        // Deadline passed before the result (includes dropped)
+    uint64_t dropped = 0;       // Expired before dispatch, acknowledged ACK_EXPIRED
     
-    bool empty() const {
-        return size() == 0;
+    void merge(const LaneStats& other) {
+        latency.merge(other.latency);
+        missed += other.missed;
+        dropped += other.dropped;
     }
 };
 
-//=============================================================================
-// Server Statistics
-//=============================================================================
-
 struct ServerStats {
     std::atomic<uint64_t> totalConnections{0};
     std::atomic<uint64_t> activeConnections{0};
+    std::atomic<uint64_t> rejectedConnections{0};
     std::atomic<uint64_t> totalSequences{0};
     std::atomic<uint64_t> totalBytesReceived{0};
     std::atomic<uint64_t> validationErrors{0};
     std::atomic<uint64_t> processingErrors{0};
+    std::atomic<uint64_t> protocolErrors{0};
+    std::atomic<uint64_t> binaryConnections{0};
+    std::atomic<uint64_t> backpressurePauses{0};
+    std::atomic<uint64_t> recordsInFlight{0};
+    std::atomic<uint64_t> storageWrites{0};
+    std::atomic<uint64_t> storageSyncs{0};     // fdatasync calls
+    
+    // Per-stage timings since start; reactors and workers record lock-free
+    PipelineLatency pipeline;
+    
+    // Admission-to-result latency per client ID and per priority lane since the
+    // last report. Reactors record under the lock once per completion drain;
+    // client entries are never erased, so connections keep a pointer to theirs.
+    std::mutex latencyMutex;
+    std::unordered_map<std::string, LatencyHistogram> clientLatency;
+    LaneStats lanes[DNASerialProcessor::PRIORITY_LANES];
     
     std::chrono::steady_clock::time_point startTime;
     
     ServerStats() : startTime(std::chrono::steady_clock::now()) {}
     
+    /**
+     * @brief The histogram for a client ID; IDs past MAX_TRACKED_CLIENTS share one
+     */
+    LatencyHistogram* clientHistogram(const std::string& clientId) {
+        std::lock_guard<std::mutex> lock(latencyMutex);
+        auto it = clientLatency.find(clientId);
+        if (it != clientLatency.end()) return &it->second;
+        if (clientLatency.size() >= MAX_TRACKED_CLIENTS) return &clientLatency["(other)"];
+        return &clientLatency[clientId];
+    }
+    
+    /**
+     * @brief Add this interval's per-client histograms to `out` and start a new interval
+     */
+    void takeClientLatency(std::map<std::string, LatencyHistogram>& out) {
+        std::lock_guard<std::mutex> lock(latencyMutex);
+        for (auto& entry : clientLatency) {
+            if (entry.second.count() == 0) continue;
+            out[entry.first].merge(entry.second);
+            entry.second.reset();
+        }
+    }
+    
+    void takeLaneStats(LaneStats (&out)[DNASerialProcessor::PRIORITY_LANES]) {
+        std::lock_guard<std::mutex> lock(latencyMutex);
+        for (int lane = 0; lane < DNASerialProcessor::PRIORITY_LANES; lane++) {
+            out[lane].merge(lanes[lane]);
+            lanes[lane] = LaneStats();
+        }
+    }
+    
     double getUptimeSeconds() const {
         auto now = std::chrono::steady_clock::now();
         return std::chrono::duration<double>(now - startTime).count();
@@ -239,30 +496,490 @@ struct ServerStats {
     }
 };
 
+/**
+ * @brief Plain sum of one or more servers' counters
+ *
+ * Shards never write each other's counters; the statistics loop reads them
+ * once per interval and adds them up here.
+ */
+struct StatsSnapshot {
+    uint64_t totalConnections = 0;
+    uint64_t activeConnections = 0;
+    uint64_t rejectedConnections = 0;
+    uint64_t totalSequences = 0;
+    uint64_t totalBytesReceived = 0;
+    uint64_t validationErrors = 0;
+    uint64_t processingErrors = 0;
+    uint64_t protocolErrors = 0;
+    uint64_t binaryConnections = 0;
+    uint64_t backpressurePauses = 0;
+    uint64_t recordsInFlight = 0;
+    uint64_t storageWrites = 0;
+    uint64_t storageSyncs = 0;
+    double uptimeSeconds = 0.0;
+    LatencyHistogram latency;   // Admission to result, since start
+    
+    void add(const ServerStats& stats) {
+        totalConnections += stats.totalConnections.load(std::memory_order_relaxed);
+        activeConnections += stats.activeConnections.load(std::memory_order_relaxed);
+        rejectedConnections += stats.rejectedConnections.load(std::memory_order_relaxed);
+        totalSequences += stats.totalSequences.load(std::memory_order_relaxed);
+        totalBytesReceived += stats.totalBytesReceived.load(std::memory_order_relaxed);
+        validationErrors += stats.validationErrors.load(std::memory_order_relaxed);
+        processingErrors += stats.processingErrors.load(std::memory_order_relaxed);
+        protocolErrors += stats.protocolErrors.load(std::memory_order_relaxed);
+        binaryConnections += stats.binaryConnections.load(std::memory_order_relaxed);
+        backpressurePauses += stats.backpressurePauses.load(std::memory_order_relaxed);
+        recordsInFlight += stats.recordsInFlight.load(std::memory_order_relaxed);
+        storageWrites += stats.storageWrites.load(std::memory_order_relaxed);
+        storageSyncs += stats.storageSyncs.load(std::memory_order_relaxed);
+        latency.merge(stats.pipeline.snapshot(PipelineStage::TOTAL));
+        uptimeSeconds = std::max(uptimeSeconds, stats.getUptimeSeconds());
+    }
+};
+
+//=============================================================================
+// Reactor (epoll event loop)
+//=============================================================================
+
+/**
+ * @brief Per-connection state owned by exactly one reactor thread
+ */
+enum class ProtocolMode {
+    UNKNOWN,   // Nothing received yet
+    TEXT,      // Legacy newline-delimited records
+    BINARY     // Framed protocol (dna_wire_protocol.hpp)
+};
+
+/**
+ * @brief Server end of a shared-memory client (dna_shm_ring.hpp)
+ *
+ * Records parsed from the ring in one pass share a lease: a payload-less
+ * RecvBlock whose references are held by the records' slices. The reactor
+ * keeps one more reference and gives ring bytes back to the client once it
+ * is the only holder left, oldest lease first.
+ */
+struct ShmPeer {
+    std::unique_ptr<DNASerialProcessor::ShmRing> ring;
+    std::deque<std::pair<DNASerialProcessor::RecvBlock*, uint64_t>> leases;  // (lease, ring end)
+    DNASerialProcessor::RecvBlock* current = nullptr;   // Lease of the pass in progress
+    
+    ~ShmPeer() {
+        for (auto& lease : leases) lease.first->release();
+    }
+    
+    /**
+     * @return true once every record parsed from the ring has been released
+     */
+    bool reclaim() {
+        while (!leases.empty() && leases.front().first->unique()) {
+            ring->release(leases.front().second);
+            leases.front().first->release();
+            leases.pop_front();
+        }
+        return leases.empty();
+    }
+};
+
+/**
+ * @brief A connection's records in one priority lane
+ */
+struct ClientLane {
+    std::deque<DNASequence> queued;
+    uint64_t deficit = 0;        // Bytes this connection may still dispatch in its turn
+    bool scheduled = false;      // Listed in the lane's Reactor::activeClients
+    bool inTurn = false;         // At the head of the list with its quantum granted
+};
+
+struct ClientConnection {
+    int fd;
+    std::string clientId;
+    DNASerialProcessor::ReceiveBuffer input;   // recv() lands here; records are slices of it
+    size_t scanned = 0;                        // Text: bytes of input known to hold no newline
+    size_t batchResume = 0;                    // Binary: paused inside the BATCH at the head of
+                                               // input, after this many payload bytes
+    ProtocolMode mode = ProtocolMode::UNKNOWN;
+    bool handshakeDone = false;
+    bool closeAfterFlush = false;
+    std::string outbox;          // Bytes waiting for the socket to become writable
+    size_t outboxSent = 0;       // Prefix of outbox already written
+    bool outputBlocked = false;  // Not read while more than OUTBOX_READ_CAP of replies is unsent
+    bool waitingWritable = false;
+    uint32_t generation = 0;     // Distinguishes reused fds in io_uring completions
+    
+    // Flow control: flow-controlled clients spend credits, the rest are paused
+    // (no reads, TCP backpressure) while the reactor's budget is exhausted
+    bool flowControl = false;
+    uint32_t credits = 0;        // Granted, not yet used
+    uint32_t window = 0;         // credits + records in flight
+    uint64_t inFlight = 0;
+    uint64_t recordsReceived = 0;
+    bool paused = false;
+    bool peerClosed = false;     // EOF seen while paused; close once the backlog is parsed
+    bool waitingCredits = false; // Queued in Reactor::creditWaiters
+    bool recvArmed = false;      // io_uring: multishot recv outstanding
+    std::string pendingAcks;     // AckEntry records for the next ACK frame
+    
+    // Shared-memory clients: frames arrive in the ring, the socket carries replies
+    bool awaitingShm = false;    // Accepted on the Unix socket, ring fds not received yet
+    std::unique_ptr<ShmPeer> shm;
+    
+    // Fair scheduling: admitted records wait in their priority lane until the
+    // reactor's deficit round-robin hands them to a worker
+    ClientLane lanes[DNASerialProcessor::PRIORITY_LANES];
+    std::string identity;        // Name from HELLO, else clientId (the IP address or "local")
+    uint32_t weight = 1;         // Quanta per turn (ServerConfig::clientWeights)
+    LatencyHistogram* latency = nullptr;   // Shared by all connections of this identity
+    
+    ClientConnection(int socket, const std::string& id, DNASerialProcessor::RecvBlockPool& pool)
+        : fd(socket), clientId(id), input(pool) {}
+};
+
+/**
+ * @brief A processed record handed back from a worker to its reactor
+ */
+struct Completion {
+    RecordOrigin origin;
+    uint64_t sequenceId;
+    uint8_t status;
+};
+
+// Called once stored records are durable under the sync policy (false: the sync failed)
+using Durable = std::function<void(bool durable)>;
+
+/**
+ * @brief Non-blocking epoll loop; all sockets of a reactor are touched by one thread
+ */
+struct Reactor {
+    int epollFd = -1;
+    int wakeFd = -1;   // eventfd used to interrupt epoll_wait on shutdown
+    std::thread thread;
+    std::unordered_map<int, std::unique_ptr<ClientConnection>> connections;
+    std::unique_ptr<DNASerialProcessor::IoUring> ring;  // Set for the io_uring backend
+    uint32_t nextGeneration = 0;
+    int index = 0;
+    
+    // Flow control; touched only by the reactor thread
+    int64_t budget = 0;          // Records this reactor may still admit
+    std::deque<std::pair<int, uint32_t>> creditWaiters;  // (fd, generation) below full window
+    size_t pausedConnections = 0;
+    
+    // Fair scheduling; records with the workers are bounded so a client's
+    // backlog waits in its own queue instead of ahead of everyone else's
+    std::deque<std::pair<int, uint32_t>> activeClients[DNASerialProcessor::PRIORITY_LANES];  // (fd, generation)
+    size_t dispatchedRecords = 0;
+    uint64_t dispatchedBytes = 0;
+    size_t dispatchRecordLimit = 0;
+    uint64_t dispatchByteLimit = 0;
+    
+    // Filled by workers, drained by the reactor after a wakeFd signal
+    std::mutex completionMutex;
+    std::vector<Completion> completions;
+    
+    // Shared-memory clients: doorbell eventfd -> connection fd, and the rings
+    // of closed connections whose records are still with the workers
+    std::unordered_map<int, int> doorbells;
+    std::vector<std::unique_ptr<ShmPeer>> retiredShm;
+};
+
+static bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+#if DNA_HAS_IO_URING
+/**
+ * @brief Per-worker asynchronous segment log writer on top of io_uring
+ *
+ * The log range is reserved synchronously; the write is submitted to the
+ * ring and reaped later, so workers never block on storage. Records become
+ * readable from the log once their write completes.
+ */
+class UringFileWriter {
+public:
+    explicit UringFileWriter(std::atomic<uint64_t>& errorCounter) : errors_(errorCounter) {}
+    
+    ~UringFileWriter() {
+        drain();
+    }
+    
+    bool init() {
+        return ring_.init(URING_WRITE_DEPTH * 2);
+    }
+    
+    // Runs on the worker thread once the write completed or failed
+    using Written = std::function<void(const SegmentLog::Reservation&, bool ok)>;
+    
+    bool write(SegmentLog& log, LogBatch&& batch, Written written = nullptr) {
+        while (pending_.size() >= URING_WRITE_DEPTH) {
+            reap(true);
+        }
+        
+        SegmentLog::Reservation where;
+        if (!log.reserve(batch.size(), where)) return false;
+        
+        uint64_t tag = nextTag_++;
+        PendingWrite& pw = pending_[tag];
+        pw.log = &log;
+        pw.where = std::move(where);
+        pw.batch = std::move(batch);
+        pw.written = std::move(written);
+        submitWrite(tag, pw);
+        
+        // Batch submissions: one io_uring_enter per URING_SUBMIT_BATCH writes
+        if (++queued_ >= URING_SUBMIT_BATCH) {
+            reap(false);
+        }
+        return true;
+    }
+    
+    /**
+     * @brief Submit queued writes and process completions; optionally wait for one
+     */
+    void reap(bool wait) {
+        if (pending_.empty()) return;
+        ring_.submit(wait ? 1 : 0);
+        queued_ = 0;
+        
+        struct io_uring_cqe* cqe;
+        while ((cqe = ring_.peekCqe()) != nullptr) {
+            uint64_t userData = cqe->user_data;
+            int res = cqe->res;
+            ring_.cqeSeen();
+            
+            auto it = pending_.find(userData);
+            if (it == pending_.end()) continue;
+            PendingWrite& pw = it->second;
+            
+            if (res <= 0) {
+                errors_.fetch_add(1);   // The hole is skipped as corrupt on recovery
+                pw.log->abandon(pw.where);
+                if (pw.written) pw.written(pw.where, false);
+                pending_.erase(it);
+                continue;
+            }
+            pw.done += static_cast<size_t>(res);
+            if (pw.done < pw.batch.size()) {
+                submitWrite(it->first, pw);  // Short write: continue where we stopped
+            } else {
+                pw.log->publish(pw.where, pw.batch);
+                if (pw.written) pw.written(pw.where, true);
+                pending_.erase(it);
+            }
+        }
+        ring_.submit();
+    }
+    
+    void drain() {
+        while (!pending_.empty()) {
+            reap(true);
+        }
+    }
+    
+    bool pending() const {
+        return !pending_.empty();
+    }
+    
+private:
+    struct PendingWrite {
+        SegmentLog* log = nullptr;
+        SegmentLog::Reservation where;
+        LogBatch batch;
+        Written written;
+        size_t done = 0;
+    };
+    
+    DNASerialProcessor::IoUring ring_;
+    std::unordered_map<uint64_t, PendingWrite> pending_;
+    uint64_t nextTag_ = 1;
+    unsigned queued_ = 0;
+    std::atomic<uint64_t>& errors_;
+    
+    void submitWrite(uint64_t tag, PendingWrite& pw) {
+        struct io_uring_sqe* sqe = ring_.getSqe();
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = pw.where.segment->fd;
+        sqe->addr = reinterpret_cast<uint64_t>(pw.batch.buffer().data() + pw.done);
+        sqe->len = static_cast<uint32_t>(pw.batch.size() - pw.done);
+        sqe->off = pw.where.offset + pw.done;
+        sqe->user_data = tag;
+    }
+};
+#else
+class UringFileWriter {
+public:
+    explicit UringFileWriter(std::atomic<uint64_t>&) {}
+    bool init() { return false; }
+    using Written = std::function<void(const SegmentLog::Reservation&, bool ok)>;
+    bool write(SegmentLog&, LogBatch&&, Written = nullptr) { return false; }
+    void reap(bool) {}
+    void drain() {}
+    bool pending() const { return false; }
+};
+#endif  // DNA_HAS_IO_URING
+
+//=============================================================================
+// Work-Stealing Worker Pool
+//=============================================================================
+
+struct EncodeJob;
+
+/**
+ * @brief One slice of a large record: validate, checksum and pack it
+ */
+struct EncodeTask {
+    EncodeJob* job = nullptr;
+    size_t offset = 0;   // In bases, multiple of 4
+    size_t length = 0;
+    uint32_t crc = 0;
+};
+
+/**
+ * @brief A record split into sub-tasks; whoever finishes the last one stores it
+ */
+struct EncodeJob {
+    DNASequence seq;
+    std::string encoded;               // Each task packs into its own byte range
+    std::vector<EncodeTask> tasks;
+    std::atomic<size_t> remaining{0};
+    std::atomic<bool> invalid{false};
+    uint64_t startedNs = 0;            // For the ENCODE stage timing
+};
+
+// Per-record batch state besides the ACK_* results
+constexpr uint8_t BATCH_PENDING = 0xFF;
+constexpr uint8_t BATCH_SPLIT = 0xFE;    // Handed to splitEncode, acknowledged by it
+constexpr uint8_t BATCH_HELD = 0xFD;     // Stored; acknowledged once durable
+
+struct Worker {
+    int index = 0;
+    DNASerialProcessor::BoundedMPMCQueue<DNASequence> inbox;   // Records routed here by reactors
+    DNASerialProcessor::WorkStealingDeque<EncodeTask> tasks;   // Sub-tasks other workers may steal
+    std::unique_ptr<UringFileWriter> writer;
+    std::thread thread;
+    
+    // Batch scratch, reused so the steady state allocates nothing
+    std::vector<DNASequence> batch;
+    std::vector<uint8_t> status;
+    std::vector<uint32_t> checksums;
+    std::vector<DNASerialProcessor::DNAMetadata> metadata;   // Rows of the records in `output`
+    std::string unpacked;        // Client-packed bases, decoded a slice at a time for their CRC
+    LogBatch output;
+    std::vector<std::vector<Completion>> completions;   // Per reactor
+    
+    // Results posted by this worker; read by the metrics exporter
+    std::atomic<uint64_t> recordsDone{0};
+    std::atomic<uint64_t> basesDone{0};
+    
+    explicit Worker(size_t inboxCapacity) : inbox(inboxCapacity), tasks(STEAL_DEQUE_SIZE) {}
+};
+
+/**
+ * @brief A worker's counters and inbox depth at one moment (metrics export)
+ */
+struct WorkerSample {
+    int index;
+    size_t queued;        // Records waiting in the inbox
+    uint64_t records;     // Results posted since start
+    uint64_t bases;       // Nucleotides in those records
+};
+
 //=============================================================================
 // DNA Server
 //=============================================================================
 
 class DNAServer {
 private:
-    int port_;
+    ServerConfig config_;
     int serverSocket_;
+    int shmSocket_ = -1;      // Unix socket accepting shared-memory clients
     std::atomic<bool> running_{false};
     
-    ThreadSafeQueue<DNASequence> processingQueue_;
+    // Receive blocks outlive every connection and queued record (declared first)
+    DNASerialProcessor::RecvBlockPool recvPool_;
     ServerStats stats_;
+    SegmentLog log_;
+    std::unique_ptr<GroupCommitter> committer_;   // SyncPolicy::BATCH
+    std::unique_ptr<RecordIndex> index_;          // ServerConfig::enableIndexing
+    uint64_t indexCaughtUp_ = 0;                  // Records re-added at start (see openIndex)
+    std::unique_ptr<MetadataStore> metadata_;     // ServerConfig::enableMetadata
+    std::unique_ptr<SegmentCompactor> compactor_; // ServerConfig::compressOld
     
-    std::vector<std::thread> workerThreads_;
-    std::thread acceptThread_;
+    // IDs continue past every ID issued before the restart (see start)
+    uint64_t firstSequence_ = 0;
+    std::thread checkpointThread_;
+    std::mutex checkpointMutex_;
+    std::condition_variable checkpointWake_;
+    std::atomic<uint64_t> checkpoints_{0};
+    
+    // Reactors route records to worker inboxes; idle workers steal from each other
+    std::vector<std::unique_ptr<Worker>> workers_;
+    DNASerialProcessor::EventCount workAvailable_;
+    std::atomic<bool> workersStopping_{false};
+    std::vector<std::unique_ptr<Reactor>> reactors_;
+    std::string shardTag_;   // Appended to connection logs in shard mode (counts are per shard)
     
 public:
-    explicit DNAServer(int port) : port_(port), serverSocket_(-1) {}
+    explicit DNAServer(const ServerConfig& config)
+        : config_(config), serverSocket_(-1), log_(config.segmentBytes) {
+        if (config_.shards > 0) {
+            shardTag_ = " [shard " + std::to_string(config_.shardIndex) + "]";
+        }
+    }
     
     ~DNAServer() {
         stop();
     }
     
     bool start() {
+        // Fall back to epoll when the kernel (or a seccomp profile) lacks io_uring
+        if (config_.ioBackend == IoBackend::IO_URING && 
+            !DNASerialProcessor::IoUring::isSupported()) {
+            std::cerr << "[WARN] io_uring not available, falling back to epoll" << std::endl;
+            config_.ioBackend = IoBackend::EPOLL;
+        }
+        bool useUring = config_.ioBackend == IoBackend::IO_URING;
+        
+        // Index the existing segments before taking any records
+        if (!log_.open(config_.storageDir)) {
+            std::cerr << "Failed to open storage log in " << config_.storageDir << ": "
+                      << strerror(errno) << std::endl;
+            return false;
+        }
+        // The checkpoint's lease covers IDs issued since it; the records cover the rest
+        const SegmentLog::RecoveryStats& recovered = log_.recovery();
+        uint64_t stride = static_cast<uint64_t>(std::max(1, config_.shards));
+        firstSequence_ = std::max(recovered.counter, recovered.maxId > 0 ? (recovered.maxId - 1) / stride + 1 : 0);
+        if (config_.enableIndexing && !openIndex()) {
+            std::cerr << "Failed to open record index in " << config_.storageDir << "/index: "
+                      << strerror(errno) << std::endl;
+            return false;
+        }
+        if (config_.enableMetadata) {
+            metadata_ = std::make_unique<MetadataStore>();
+            if (!metadata_->open(config_.storageDir + "/metadata")) {
+                std::cerr << "Failed to open metadata store in " << config_.storageDir << "/metadata: "
+                          << strerror(errno) << std::endl;
+                return false;
+            }
+        }
+        if (config_.syncPolicy == SyncPolicy::BATCH) {
+            committer_ = std::make_unique<GroupCommitter>(config_.commit, &stats_.storageSyncs);
+            committer_->start();
+        }
+        if (config_.compressOld) {
+            compactor_ = std::make_unique<SegmentCompactor>(log_, config_.compaction,
+                [this](const DNASerialProcessor::CompactionReport& report) {
+                    std::cout << "\n[COMPACT] Segment " << report.segment << shardTag_ << ": "
+                              << (report.bytesBefore >> 10) << " KB -> " << (report.bytesAfter >> 10)
+                              << " KB (" << std::fixed << std::setprecision(1)
+                              << 100.0 * report.bytesSaved() / report.bytesBefore << "% saved, "
+                              << report.duplicates << " duplicates) in " << report.seconds << " s"
+                              << std::defaultfloat << std::endl;
+                });
+            compactor_->start();
+        }
+        
         // Create socket
         serverSocket_ = socket(AF_INET, SOCK_STREAM, 0);
         if (serverSocket_ < 0) {
@@ -270,9 +987,12 @@ public:
             return false;
         }
         
-        // Set socket options
+        // Set socket options; shards each bind the port and the kernel
+        // spreads incoming connections across their listening sockets
         int opt = 1;
-        if (setsockopt(serverSocket_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        if (setsockopt(serverSocket_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+            (config_.shards > 0 &&
+             setsockopt(serverSocket_, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)) {
             std::cerr << "Failed to set socket options" << std::endl;
             close(serverSocket_);
             return false;
@@ -282,34 +1002,151 @@ public:
         struct sockaddr_in address;
         address.sin_family = AF_INET;
         address.sin_addr.s_addr = INADDR_ANY;
-        address.sin_port = htons(port_);
+        address.sin_port = htons(config_.port);
         
         if (bind(serverSocket_, (struct sockaddr*)&address, sizeof(address)) < 0) {
-            std::cerr << "Failed to bind to port " << port_ << std::endl;
+            std::cerr << "Failed to bind to port " << config_.port << std::endl;
             close(serverSocket_);
             return false;
         }
         
-        // Listen
-        if (listen(serverSocket_, MAX_CLIENTS) < 0) {
+        // Listen (non-blocking for epoll: every reactor polls the listening socket)
+        if (listen(serverSocket_, LISTEN_BACKLOG) < 0 || 
+            (!useUring && !setNonBlocking(serverSocket_))) {
             std::cerr << "Failed to listen on socket" << std::endl;
             close(serverSocket_);
             return false;
         }
         
+        // Shared-memory clients are served by the epoll reactors
+        if (!config_.shmSocket.empty()) {
+            if (useUring) {
+                std::cerr << "[WARN] --shm needs the epoll backend, shared-memory clients disabled" 
+                          << std::endl;
+                config_.shmSocket.clear();
+            } else if (!openShmListener()) {
+                close(serverSocket_);
+                return false;
+            }
+        }
+        
+        int cores = std::max(1u, std::thread::hardware_concurrency());
+        int numReactors = config_.reactorThreads > 0 ? config_.reactorThreads : cores;
+        int numWorkers = config_.workerThreads > 0 ? config_.workerThreads : cores;
+        
+        // Create reactors before any thread starts so stop() can always clean up
+        for (int i = 0; i < numReactors; i++) {
+            auto reactor = std::make_unique<Reactor>();
+            reactor->index = i;
+            reactor->budget = std::max(1, config_.queueCapacity / numReactors);
+            // Two batches per worker: enough to keep them busy between wakeups
+            reactor->dispatchRecordLimit = std::max<size_t>(
+                config_.batchRecords, 2 * static_cast<size_t>(config_.batchRecords) * numWorkers / numReactors);
+            reactor->dispatchByteLimit = std::max<uint64_t>(
+                config_.batchBytes, 2 * static_cast<uint64_t>(config_.batchBytes) * numWorkers / numReactors);
+            reactor->wakeFd = eventfd(0, EFD_CLOEXEC);
+            
+            bool ok = reactor->wakeFd >= 0;
+            if (ok && useUring) {
+                reactor->ring = std::make_unique<DNASerialProcessor::IoUring>();
+                ok = initUringReactor(*reactor);
+            } else if (ok) {
+                reactor->epollFd = epoll_create1(EPOLL_CLOEXEC);
+                ok = reactor->epollFd >= 0;
+            }
+            
+            if (!ok) {
+                std::cerr << "Failed to create reactor" << std::endl;
+                closeReactor(*reactor);
+                closeAllReactors();
+                closeShmListener();
+                close(serverSocket_);
+                return false;
+            }
+            
+            if (useUring) {
+                reactors_.push_back(std::move(reactor));
+                continue;
+            }
+            
+            // EPOLLEXCLUSIVE wakes a single reactor per incoming connection
+            struct epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+            ev.data.fd = serverSocket_;
+            epoll_ctl(reactor->epollFd, EPOLL_CTL_ADD, serverSocket_, &ev);
+            
+            if (shmSocket_ >= 0) {
+                ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+                ev.data.fd = shmSocket_;
+                epoll_ctl(reactor->epollFd, EPOLL_CTL_ADD, shmSocket_, &ev);
+            }
+            
+            ev.events = EPOLLIN;
+            ev.data.fd = reactor->wakeFd;
+            epoll_ctl(reactor->epollFd, EPOLL_CTL_ADD, reactor->wakeFd, &ev);
+            
+            reactors_.push_back(std::move(reactor));
+        }
+        
         running_ = true;
+        checkpointThread_ = std::thread([this] { checkpointLoop(); });
         
-        // Start worker threads (one per core)
-        int numWorkers = std::thread::hardware_concurrency();
+        // Start worker threads (one per core); flow control bounds the total
+        // across inboxes by queueCapacity, so each gets an equal share
+        size_t inboxCapacity = std::max<size_t>(WORKER_BATCH * 8, config_.queueCapacity / numWorkers);
         for (int i = 0; i < numWorkers; i++) {
-            workerThreads_.emplace_back(&DNAServer::processingWorker, this, i);
+            workers_.push_back(std::make_unique<Worker>(inboxCapacity));
+            workers_.back()->index = i;
+        }
+        for (auto& worker : workers_) {
+            worker->thread = std::thread(&DNAServer::processingWorker, this, std::ref(*worker));
+        }
+        
+        // Start reactor threads
+        for (auto& reactor : reactors_) {
+            reactor->thread = useUring
+                ? std::thread(&DNAServer::uringReactorLoop, this, std::ref(*reactor))
+                : std::thread(&DNAServer::reactorLoop, this, std::ref(*reactor));
         }
         
-        // Start accept thread
-        acceptThread_ = std::thread(&DNAServer::acceptClients, this);
+        if (config_.shards > 0) {
+            // Reactor and worker share the core: records never cross cores
+            bool pinned = config_.cpuCore >= 0;
+            for (auto& worker : workers_) {
+                pinned = pinned && CPUAffinity::pinThreadToCore(worker->thread, config_.cpuCore);
+            }
+            for (auto& reactor : reactors_) {
+                pinned = pinned && CPUAffinity::pinThreadToCore(reactor->thread, config_.cpuCore);
+            }
+            std::cout << "Shard " << config_.shardIndex << ": "
+                      << (useUring ? "io_uring" : "epoll") << ", core " << config_.cpuCore
+                      << (pinned ? "" : " (not pinned)") << ", queue capacity "
+                      << config_.queueCapacity << std::endl;
+            printStorage();
+            return true;
+        }
         
-        std::cout << "DNA Server started on port " << port_ << std::endl;
-        std::cout << "Worker threads: " << numWorkers << std::endl;
+        std::cout << "DNA Server started on port " << config_.port << std::endl;
+        std::cout << "Reactor threads: " << numReactors 
+                  << " (" << (useUring ? "io_uring" : "epoll")
+                  << ", max clients: " << config_.maxClients << ")" << std::endl;
+        std::cout << "Worker threads: " << numWorkers << " (batch: " << config_.batchRecords
+                  << " records / " << (config_.batchBytes >> 10) << " KB per write)" << std::endl;
+        printStorage();
+        std::cout << "Queue capacity: " << config_.queueCapacity << " records (credit window: "
+                  << config_.creditWindow << ")" << std::endl;
+        if (config_.scheduler == Scheduler::DRR) {
+            std::cout << "Scheduler: deficit round-robin (" << (DRR_QUANTUM >> 10) 
+                      << " KB quantum, " << config_.clientWeights.size() << " weighted clients), "
+                      << (config_.lanePolicy == LanePolicy::EDF ? "EDF" : "strict") << " lanes, "
+                      << (config_.deadlinePolicy == DeadlinePolicy::DROP ? "drop" : "demote")
+                      << " late records" << std::endl;
+        } else {
+            std::cout << "Scheduler: FIFO" << std::endl;
+        }
+        if (shmSocket_ >= 0) {
+            std::cout << "Shared-memory clients: " << config_.shmSocket << std::endl;
+        }
         std::cout << "Hardware acceleration: " 
                   << (HAS_ARM_ACCEL ? "Enabled (NEON + CRC32)" : "Disabled") 
                   << std::endl;
@@ -318,235 +1155,2214 @@ public:
         return true;
     }
     
+    void printStorage() const {
+        const SegmentLog::RecoveryStats& recovered = log_.recovery();
+        std::cout << "Storage: " << config_.storageDir << "/ (" << (log_.segmentBytes() >> 20)
+                  << " MB segments, " << recovered.records << " records in " << recovered.segments
+                  << " existing segments";
+        if (recovered.skippedBytes > 0 || recovered.truncatedBytes > 0) {
+            std::cout << "; skipped " << recovered.skippedBytes << " corrupt bytes, truncated "
+                      << recovered.truncatedBytes << " torn bytes";
+        }
+        std::cout << "), sync: " << DNASerialProcessor::syncPolicyName(config_.syncPolicy);
+        if (config_.syncPolicy == SyncPolicy::BATCH) {
+            std::cout << " (commit every " << config_.commit.maxRecords << " records / "
+                      << config_.commit.maxDelayUs << " us / " << (config_.commit.maxBytes >> 10) << " KB)";
+        }
+        std::cout << std::endl;
+        std::cout << "Checkpoints: ";
+        if (config_.checkpointMs > 0) {
+            std::cout << "every " << config_.checkpointMs << " ms";
+        } else {
+            std::cout << "at shutdown only";
+        }
+        std::cout << " (" << recovered.tabledRecords << " records from tables, "
+                  << (recovered.scannedBytes >> 10) << " KB of log replayed; next ID "
+                  << firstSequence_ * std::max(1, config_.shards) + config_.shardIndex + 1 << ")" << std::endl;
+        if (index_) {
+            RecordIndex::Stats stats = index_->stats();
+            std::cout << "Index: " << index_->directory() << "/ (" << stats.runs << " runs, "
+                      << stats.runEntries << " entries, " << (stats.fenceBytes >> 10) << " KB resident; "
+                      << indexCaughtUp_ << " records re-indexed)" << std::endl;
+        }
+        if (metadata_) {
+            MetadataStore::Stats stats = metadata_->stats();
+            std::cout << "Metadata: " << config_.storageDir << "/metadata/ (" << stats.runs << " runs, "
+                      << stats.runEntries << " entries, " << (stats.residentBytes >> 10) << " KB resident)"
+                      << std::endl;
+        }
+        if (compactor_) {
+            const DNASerialProcessor::CompactionConfig& compaction = compactor_->config();
+            std::cout << "Compaction: sealed segments idle " << compaction.minAgeSeconds / 60 << " min, "
+                      << (compaction.ioBytesPerSecond >> 20) << " MB/s, " << compaction.cpuPercent
+                      << "% of a core" << std::endl;
+        }
+    }
+    
+    /**
+     * @brief Checkpoint the log every checkpointMs, leasing IDs ahead in case of a crash
+     */
+    void checkpointLoop() {
+        std::unique_lock<std::mutex> lock(checkpointMutex_);
+        while (!workersStopping_) {
+            if (config_.checkpointMs > 0) {
+                checkpointWake_.wait_for(lock, std::chrono::milliseconds(config_.checkpointMs));
+            } else {
+                checkpointWake_.wait(lock);
+            }
+            if (workersStopping_ || config_.checkpointMs <= 0) continue;
+            if (DNASerialProcessor::checkpointIndex(log_, index_.get(), issuedSequences() + CHECKPOINT_ID_LEASE) &&
+                (!metadata_ || metadata_->sync())) {
+                checkpoints_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                std::cerr << "\n[CHECKPOINT] " << config_.storageDir << ": " << strerror(errno) << std::endl;
+            }
+        }
+    }
+    
+    uint64_t issuedSequences() const {
+        return firstSequence_ + stats_.totalSequences.load(std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief Open the index, add the records its runs do not cover, then follow the log
+     */
+    bool openIndex() {
+        index_ = std::make_unique<RecordIndex>();
+        if (!index_->open(config_.storageDir + "/index")) return false;
+        indexCaughtUp_ = DNASerialProcessor::catchUpIndex(*index_, log_);
+        return true;
+    }
+    
     void stop() {
         if (!running_) return;
         
         running_ = false;
         
-        // Close server socket
-        if (serverSocket_ >= 0) {
-            close(serverSocket_);
-            serverSocket_ = -1;
+        // Wake reactors and wait for them to exit
+        for (auto& reactor : reactors_) {
+            uint64_t one = 1;
+            ssize_t rc = write(reactor->wakeFd, &one, sizeof(one));
+            (void)rc;
         }
         
-        // Wait for threads
-        if (acceptThread_.joinable()) {
-            acceptThread_.join();
+        for (auto& reactor : reactors_) {
+            if (reactor->thread.joinable()) {
+                reactor->thread.join();
+            }
+            for (auto& entry : reactor->connections) {
+                flushQueued(*reactor, *entry.second);
+            }
+            for (auto& lane : reactor->activeClients) lane.clear();
         }
         
-        for (auto& thread : workerThreads_) {
-            if (thread.joinable()) {
-                thread.join();
+        // Workers post completions to reactors, so they go before the reactors.
+        // They finish whatever is queued, then exit instead of parking.
+        workersStopping_ = true;
+        for (auto& worker : workers_) {
+            worker->inbox.close();
+        }
+        workAvailable_.notifyAll();
+        for (auto& worker : workers_) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
             }
         }
+        // A rewrite in progress is abandoned; its segment stays as it was
+        if (compactor_) {
+            compactor_->stop();
+        }
+        // The workers' last appends are written; make them durable too
+        if (committer_) {
+            committer_->stop();
+        }
+        // Everything admitted is stored: the next start continues at the exact ID and replays nothing
+        {
+            std::lock_guard<std::mutex> lock(checkpointMutex_);
+            checkpointWake_.notify_all();
+        }
+        if (checkpointThread_.joinable()) {
+            checkpointThread_.join();
+        }
+        // The index's memtable goes out with it, covering the whole log: the next start re-indexes nothing
+        if (DNASerialProcessor::checkpointIndex(log_, index_.get(), issuedSequences())) {
+            checkpoints_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (index_) {
+            index_->close();
+        }
+        // Every durable record has its row; the memtable goes out as a run
+        if (metadata_) {
+            metadata_->sync();
+            metadata_->close();
+        }
+        closeAllReactors();
         
-        std::cout << "\nServer stopped." << std::endl;
+        // Close server sockets
+        if (serverSocket_ >= 0) {
+            close(serverSocket_);
+            serverSocket_ = -1;
+        }
+        closeShmListener();
+        
+        std::cout << "\nServer stopped." << std::endl;
+    }
+    
+    const ServerStats& getStats() const {
+        return stats_;
+    }
+    
+    const SegmentLog& getLog() const {
+        return log_;
+    }
+    
+    uint64_t checkpoints() const {
+        return checkpoints_.load(std::memory_order_relaxed);
+    }
+    
+    SegmentCompactor::Stats compactionStats() const {
+        return compactor_ ? compactor_->stats() : SegmentCompactor::Stats();
+    }
+    
+    ServerStats& getStats() {
+        return stats_;
+    }
+    
+    int shardIndex() const {
+        return config_.shardIndex;
+    }
+    
+    /**
+     * @brief Relaxed reads of each worker's counters; safe while the server runs
+     */
+    std::vector<WorkerSample> sampleWorkers() const {
+        std::vector<WorkerSample> samples;
+        for (const auto& worker : workers_) {
+            samples.push_back({worker->index, worker->inbox.size(),
+                               worker->recordsDone.load(std::memory_order_relaxed),
+                               worker->basesDone.load(std::memory_order_relaxed)});
+        }
+        return samples;
+    }
+    
+private:
+    void reactorLoop(Reactor& reactor) {
+        struct epoll_event events[MAX_EPOLL_EVENTS];
+        
+        while (running_) {
+            int n = epoll_wait(reactor.epollFd, events, MAX_EPOLL_EVENTS, -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "epoll_wait failed" << std::endl;
+                break;
+            }
+            
+            for (int i = 0; i < n; i++) {
+                int fd = events[i].data.fd;
+                
+                if (fd == reactor.wakeFd) {
+                    uint64_t value;
+                    ssize_t rc = read(reactor.wakeFd, &value, sizeof(value));
+                    (void)rc;
+                    drainCompletions(reactor);
+                } else if (fd == serverSocket_) {
+                    acceptClients(reactor);
+                } else if (fd == shmSocket_) {
+                    acceptShmClients(reactor);
+                } else if (reactor.doorbells.count(fd)) {
+                    auto it = reactor.connections.find(reactor.doorbells[fd]);
+                    if (it != reactor.connections.end() && !readShm(reactor, *it->second)) {
+                        closeClient(reactor, it);
+                    }
+                } else {
+                    auto it = reactor.connections.find(fd);
+                    if (it == reactor.connections.end()) continue;
+                    ClientConnection& conn = *it->second;
+                    
+                    bool keep = true;
+                    if (events[i].events & EPOLLOUT) {
+                        keep = writeReady(reactor, conn);
+                    }
+                    if (keep && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+                        keep = readClient(reactor, conn, events[i].events);
+                    }
+                    if (!keep || (conn.closeAfterFlush && conn.outbox.empty())) {
+                        closeClient(reactor, it);
+                    }
+                }
+            }
+        }
+    }
+    
+    void acceptClients(Reactor& reactor) {
+        while (running_) {
+            struct sockaddr_in clientAddr;
+            socklen_t clientLen = sizeof(clientAddr);
+            
+            int clientSocket = accept4(serverSocket_, (struct sockaddr*)&clientAddr, &clientLen,
+                                       SOCK_NONBLOCK | SOCK_CLOEXEC);
+            
+            if (clientSocket < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    std::cerr << "Accept failed" << std::endl;
+                }
+                return;
+            }
+            
+            ClientConnection* conn = addClient(reactor, clientSocket, clientAddr);
+            if (!conn) continue;
+            
+            struct epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.fd = clientSocket;
+            if (epoll_ctl(reactor.epollFd, EPOLL_CTL_ADD, clientSocket, &ev) < 0) {
+                closeClient(reactor, reactor.connections.find(clientSocket));
+            }
+        }
+    }
+    
+    /**
+     * @brief Register an accepted socket with a reactor (enforces maxClients)
+     * @return the new connection, or nullptr if it was rejected
+     */
+    ClientConnection* addClient(Reactor& reactor, int clientSocket, 
+                                const struct sockaddr_in& clientAddr) {
+        return addClient(reactor, clientSocket, inet_ntoa(clientAddr.sin_addr), 
+                         ntohs(clientAddr.sin_port));
+    }
+    
+    ClientConnection* addClient(Reactor& reactor, int clientSocket, 
+                                const std::string& clientIp, int clientPort) {
+        // Reserve the slot before accepting: reactors add clients in parallel,
+        // so a load() followed by fetch_add() could let several past the limit
+        uint64_t active = stats_.activeConnections.fetch_add(1);
+        if (active >= static_cast<uint64_t>(config_.maxClients)) {
+            stats_.activeConnections.fetch_sub(1);
+            stats_.rejectedConnections.fetch_add(1);
+            close(clientSocket);
+            return nullptr;
+        }
+
+        stats_.totalConnections.fetch_add(1);
+
+        auto conn = std::make_unique<ClientConnection>(clientSocket, clientIp, recvPool_);
+        conn->generation = ++reactor.nextGeneration & 0xFFFFFF;
+        identifyClient(*conn, clientIp);
+        ClientConnection* raw = conn.get();
+        reactor.connections.emplace(clientSocket, std::move(conn));
+        
+        std::cout << "\n[CONNECT] Client " << clientIp << ":" << clientPort 
+                  << " (Total: " << stats_.activeConnections.load() << ")" << shardTag_ << std::endl;
+        return raw;
+    }
+    
+    /**
+     * @brief Key a connection's DRR weight and latency histogram on `identity`
+     *
+     * Called with the address on accept, then with the name from HELLO if
+     * the client sent one, so clients behind one address are told apart.
+     */
+    void identifyClient(ClientConnection& conn, const std::string& identity) {
+        conn.identity = identity;
+        auto weight = config_.clientWeights.find(identity);
+        conn.weight = weight != config_.clientWeights.end() ? weight->second : 1;
+        conn.latency = stats_.clientHistogram(identity);
+    }
+    
+    /**
+     * @brief Drain readable data from a client
+     * @return false when the connection should be closed
+     */
+    bool readClient(Reactor& reactor, ClientConnection& conn, uint32_t events) {
+        if (conn.awaitingShm) {
+            return attachShm(reactor, conn);
+        }
+        
+        // Bounded number of reads per wakeup so one busy client cannot starve the rest
+        for (int reads = 0; reads < 16 && !conn.closeAfterFlush && !conn.paused && !conn.outputBlocked;
+             reads++) {
+            // Straight into the connection's receive block: records are sliced, not copied
+            size_t space;
+            char* dst = conn.input.prepareWrite(DNASerialProcessor::RECV_MIN_READ, space);
+            uint64_t started = PipelineLatency::now();
+            ssize_t bytesRead = recv(conn.fd, dst, space, 0);
+            if (bytesRead > 0) {
+                stats_.pipeline.record(PipelineStage::RECEIVE, PipelineLatency::now() - started);
+            }
+            
+            if (bytesRead == 0) {
+                return false;  // Client disconnected
+            }
+            if (bytesRead < 0) {
+                if (errno == EINTR) continue;
+                conn.input.releaseIfIdle();  // Idle connections hold no block
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            
+            conn.input.commitWrite(bytesRead);
+            if (!consumeData(reactor, conn, bytesRead)) {
+                return false;
+            }
+        }
+        
+        return !(events & (EPOLLHUP | EPOLLERR));
+    }
+    
+    /**
+     * @brief Feed received bytes (already appended to conn.input) to the protocol parser
+     * @return false when the connection should be closed
+     */
+    bool consumeData(Reactor& reactor, ClientConnection& conn, size_t length) {
+        stats_.totalBytesReceived.fetch_add(length);
+        
+        // The first byte decides the protocol for the lifetime of the connection
+        if (conn.mode == ProtocolMode::UNKNOWN) {
+            if (DNASerialProcessor::isBinaryProtocol(conn.input.data(), conn.input.size())) {
+                conn.mode = ProtocolMode::BINARY;
+                stats_.binaryConnections.fetch_add(1);
+            } else {
+                conn.mode = ProtocolMode::TEXT;
+            }
+        }
+        
+        uint64_t started = PipelineLatency::now();
+        bool open = parseAccumulated(reactor, conn);
+        stats_.pipeline.record(PipelineStage::PARSE, PipelineLatency::now() - started);
+        return open;
+    }
+    
+    /**
+     * @brief Turn buffered bytes into records; stops (keeping the rest) while paused
+     * @return false when the connection should be closed
+     */
+    bool parseAccumulated(Reactor& reactor, ClientConnection& conn) {
+        if (conn.mode == ProtocolMode::BINARY) {
+            return consumeFrames(reactor, conn);
+        }
+        
+        // Process complete sequences (separated by newlines). Each line becomes
+        // a slice of the receive block; a partial line is never rescanned.
+        const char* data = conn.input.data();
+        size_t size = conn.input.size();
+        size_t offset = 0;
+        while (!conn.paused && !conn.outputBlocked && conn.scanned < size) {
+            const char* newline = static_cast<const char*>(
+                std::memchr(data + conn.scanned, '\n', size - conn.scanned));
+            if (!newline) {
+                conn.scanned = size;
+                break;
+            }
+            
+            size_t lineLength = newline - (data + offset);
+            if (lineLength > 0) {
+                RecordOrigin origin;
+                admitRecord(reactor, conn, origin);
+                processSequence(reactor, conn, conn.input.slice(data + offset, lineLength), origin);
+            }
+            offset += lineLength + 1;
+            conn.scanned = offset;
+        }
+        
+        conn.input.consume(offset);
+        conn.scanned -= offset;
+        return true;
+    }
+    
+    bool consumeFrames(Reactor& reactor, ClientConnection& conn) {
+        size_t offset = 0;
+        bool keep = true;
+        
+        while (keep && !conn.closeAfterFlush && !conn.paused && !conn.outputBlocked) {
+            FrameView frame;
+            std::string error;
+            DecodeStatus status = FrameDecoder::decode(conn.input.data() + offset,
+                                                       conn.input.size() - offset,
+                                                       frame, &error);
+            if (status == DecodeStatus::NEED_MORE) {
+                // Header known: make room so the rest of the frame arrives contiguously. The header is
+                // not verified yet, so only up to FRAME_RESERVE_MAX; receiving grows the block after that.
+                size_t available = conn.input.size() - offset;
+                if (available >= sizeof(DNASerialProcessor::FrameHeader)) {
+                    DNASerialProcessor::FrameHeader header;
+                    std::memcpy(&header, conn.input.data() + offset, sizeof(header));
+                    if (!conn.handshakeDone &&
+                        header.length > sizeof(DNASerialProcessor::HelloPayload) +
+                                        DNASerialProcessor::HELLO_MAX_CLIENT_NAME) {
+                        protocolError(reactor, conn, "frame of " + std::to_string(header.length) +
+                                      " bytes before HELLO");
+                        break;
+                    }
+                    conn.input.consume(offset);
+                    offset = 0;
+                    conn.input.reserveContiguous(
+                        std::min<size_t>(sizeof(header) + header.length, FRAME_RESERVE_MAX));
+                }
+                break;
+            }
+            
+            if (status == DecodeStatus::ERROR) {
+                protocolError(reactor, conn, error);
+                break;
+            }
+            
+            keep = handleFrame(reactor, conn, frame, false);
+            if (conn.batchResume > 0) break;   // The BATCH stays at the head until resumed
+            offset += frame.frameSize;
+        }
+        
+        // Records hold slices; the buffer just advances past them
+        conn.input.consume(offset);
+        return keep;
+    }
+    
+    /**
+     * @brief A record's bytes: a slice of the receive block, or of the client's ring
+     */
+    DNASerialProcessor::BufferSlice recordSlice(ClientConnection& conn, const char* data,
+                                                size_t length) {
+        if (conn.shm && conn.shm->current) {
+            return DNASerialProcessor::BufferSlice(conn.shm->current, data, length);
+        }
+        return conn.input.slice(data, length);
+    }
+    
+    /**
+     * @brief Dispatch one decoded frame
+     * @return false when the connection should be closed immediately
+     */
+    bool handleFrame(Reactor& reactor, ClientConnection& conn, const FrameView& frame, 
+                     bool insideBatch) {
+        if (!conn.handshakeDone && frame.type != FrameType::HELLO) {
+            protocolError(reactor, conn, "expected HELLO");
+            return true;
+        }
+        
+        switch (frame.type) {
+            case FrameType::HELLO: {
+                DNASerialProcessor::HelloPayload hello;
+                if (conn.handshakeDone || frame.length < sizeof(hello)) {
+                    protocolError(reactor, conn, "malformed HELLO");
+                    return true;
+                }
+                std::memcpy(&hello, frame.payload, sizeof(hello));
+                if (hello.minVersion > DNASerialProcessor::WIRE_VERSION ||
+                    hello.maxVersion < DNASerialProcessor::WIRE_VERSION) {
+                    protocolError(reactor, conn, "no common protocol version");
+                    return true;
+                }
+                if (frame.length > sizeof(hello)) {
+                    const char* name = frame.payload + sizeof(hello);
+                    size_t nameLength = frame.length - sizeof(hello);
+                    if (!DNASerialProcessor::validClientName(name, nameLength)) {
+                        protocolError(reactor, conn, "invalid client name in HELLO");
+                        return true;
+                    }
+                    identifyClient(conn, std::string(name, nameLength));
+                }
+                
+                // Flow control only for clients that asked for it (they read ACKs)
+                conn.flowControl = (hello.capabilities & DNASerialProcessor::CAP_FLOW_CONTROL) != 0;
+                DNASerialProcessor::HelloPayload ack{
+                    DNASerialProcessor::WIRE_VERSION, DNASerialProcessor::WIRE_VERSION,
+                    DNASerialProcessor::CAP_BATCH | 
+                    (conn.flowControl ? DNASerialProcessor::CAP_FLOW_CONTROL : 0u) |
+                    (hello.capabilities & DNASerialProcessor::CAP_PRIORITY)};
+                std::string out;
+                FrameEncoder::append(out, FrameType::HELLO_ACK, &ack, sizeof(ack));
+                conn.handshakeDone = true;
+                if (!queueOutput(reactor, conn, out)) return false;
+                if (conn.flowControl) grantCredits(reactor, conn);
+                return true;
+            }
+            
+            case FrameType::PING:
+                if (frame.length > DNASerialProcessor::PING_MAX_PAYLOAD) {
+                    protocolError(reactor, conn, "PING of " + std::to_string(frame.length) + " bytes");
+                    return true;
+                }
+                return queueOutput(reactor, conn, 
+                                   FrameEncoder::encode(FrameType::PING, 
+                                                        std::string(frame.payload, frame.length)));
+            
+            case FrameType::BYE:
+                return false;
+            
+            case FrameType::RECORD_RAW:
+            case FrameType::RECORD_FASTA:
+            case FrameType::RECORD_FASTQ: {
+                RecordOrigin origin;
+                DNASerialProcessor::RecordMeta meta;
+                const char* payload;
+                uint32_t length;
+                if (!DNASerialProcessor::splitRecordMeta(frame, meta, payload, length)) {
+                    protocolError(reactor, conn, "invalid record priority prefix");
+                    return true;
+                }
+                if (!admitRecord(reactor, conn, origin)) return true;
+                applyRecordMeta(origin, meta);
+                const char* format = frame.type == FrameType::RECORD_FASTA ? "FASTA" :
+                                     frame.type == FrameType::RECORD_FASTQ ? "FASTQ" : "RAW";
+                processRecord(reactor, conn, recordSlice(conn, payload, length), format, origin);
+                return true;
+            }
+            
+            case FrameType::RECORD_PACKED: {
+                RecordOrigin origin;
+                DNASerialProcessor::RecordMeta meta;
+                DNASerialProcessor::PackedRecordView packed;
+                const char* payload;
+                uint32_t length;
+                if (!DNASerialProcessor::splitRecordMeta(frame, meta, payload, length)) {
+                    protocolError(reactor, conn, "invalid record priority prefix");
+                    return true;
+                }
+                if (!DNASerialProcessor::splitPackedRecord(payload, length, packed)) {
+                    protocolError(reactor, conn, "packed record length does not match its header");
+                    return true;
+                }
+                if (!admitRecord(reactor, conn, origin)) return true;
+                applyRecordMeta(origin, meta);
+                processPackedRecord(reactor, conn, packed,
+                                    recordSlice(conn, packed.packed, packed.packedBytes), origin);
+                return true;
+            }
+            
+            case FrameType::BATCH: {
+                if (insideBatch) {
+                    protocolError(reactor, conn, "nested BATCH");
+                    return true;
+                }
+                // A BATCH paused part-way resumes after the records already admitted
+                size_t offset = conn.batchResume;
+                conn.batchResume = 0;
+                while (offset < frame.length && !conn.closeAfterFlush) {
+                    if (conn.paused) {
+                        conn.batchResume = offset;
+                        return true;
+                    }
+                    FrameView inner;
+                    std::string error;
+                    DecodeStatus status = FrameDecoder::decode(frame.payload + offset,
+                                                               frame.length - offset, inner, &error);
+                    if (status != DecodeStatus::FRAME) {
+                        protocolError(reactor, conn, status == DecodeStatus::NEED_MORE 
+                                                     ? "truncated frame in BATCH" : error);
+                        return true;
+                    }
+                    if (!DNASerialProcessor::isRecordFrame(inner.type)) {
+                        protocolError(reactor, conn, "non-record frame in BATCH");
+                        return true;
+                    }
+                    if (!handleFrame(reactor, conn, inner, true)) return false;
+                    offset += inner.frameSize;
+                }
+                return true;
+            }
+            
+            default:
+                protocolError(reactor, conn, "unknown frame type " + 
+                              std::to_string(static_cast<int>(frame.type)));
+                return true;
+        }
+    }
+    
+    /**
+     * @brief Send an ERROR frame and close once it has been written
+     */
+    void protocolError(Reactor& reactor, ClientConnection& conn, const std::string& message) {
+        stats_.protocolErrors.fetch_add(1);
+        std::cout << "\n[PROTOCOL] " << conn.clientId << ": " << message << std::endl;
+        queueOutput(reactor, conn, FrameEncoder::encode(FrameType::ERROR, message));
+        conn.closeAfterFlush = true;
+    }
+    
+    /**
+     * @brief Queue bytes for a client and try to write them right away
+     * @return false if the socket failed
+     */
+    bool queueOutput(Reactor& reactor, ClientConnection& conn, const std::string& data) {
+        // Drop the written prefix only once it is most of the string, so compaction stays linear
+        if (conn.outboxSent > conn.outbox.size() / 2) {
+            conn.outbox.erase(0, conn.outboxSent);
+            conn.outboxSent = 0;
+        }
+        conn.outbox += data;
+        if (!flushOutput(reactor, conn)) return false;
+        
+        // A client that does not read its replies stops being read (TCP backpressure)
+        if (!conn.outputBlocked && conn.outbox.size() - conn.outboxSent > OUTBOX_READ_CAP) {
+            conn.outputBlocked = true;
+            if (reactor.epollFd >= 0) {
+                updateEvents(reactor, conn);
+            } else {
+                cancelRecv(reactor, conn);
+            }
+        }
+        return true;
+    }
+    
+    bool flushOutput(Reactor& reactor, ClientConnection& conn) {
+        while (conn.outboxSent < conn.outbox.size()) {
+            ssize_t sent = send(conn.fd, conn.outbox.data() + conn.outboxSent,
+                                conn.outbox.size() - conn.outboxSent, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+                break;
+            }
+            conn.outboxSent += sent;
+        }
+        if (conn.outboxSent == conn.outbox.size()) {
+            conn.outbox.clear();
+            conn.outboxSent = 0;
+        }
+        
+        // Ask for a writability notification only while output is pending. A blocked
+        // connection keeps it, so writeReady() gets to resume reading.
+        bool wantWritable = !conn.outbox.empty() || conn.outputBlocked;
+        if (wantWritable != conn.waitingWritable) {
+            conn.waitingWritable = wantWritable;
+            if (reactor.epollFd >= 0) {
+                updateEvents(reactor, conn);
+            } else if (wantWritable) {
+                armPollOut(reactor, conn);
+            }
+        }
+        return true;
+    }
+    
+    /**
+     * @brief The socket can take more: send, and resume reading once replies fit under the cap
+     * @return false when the connection should be closed
+     */
+    bool writeReady(Reactor& reactor, ClientConnection& conn) {
+        if (!flushOutput(reactor, conn)) return false;
+        if (!conn.outputBlocked || conn.outbox.size() - conn.outboxSent > OUTBOX_READ_CAP) return true;
+        
+        conn.outputBlocked = false;
+        if (!flushOutput(reactor, conn)) return false;   // Drops the interest kept while blocked
+        if (conn.paused) return true;                    // resumeReading() restarts it
+        
+        if (!parseAccumulated(reactor, conn)) return false;
+        if (conn.paused || conn.outputBlocked) return true;
+        if (conn.peerClosed) return false;
+        
+        if (reactor.epollFd >= 0) {
+            updateEvents(reactor, conn);
+        } else if (!conn.recvArmed) {
+            armRecv(reactor, conn);
+        }
+        return true;
+    }
+    
+    /**
+     * @brief Recompute the epoll interest set from the paused/blocked/writable state
+     */
+    void updateEvents(Reactor& reactor, ClientConnection& conn) {
+        struct epoll_event ev{};
+        // A paused connection must not report EPOLLRDHUP either (level-triggered spin)
+        bool reading = !conn.paused && !conn.outputBlocked;
+        ev.events = (reading ? static_cast<uint32_t>(EPOLLIN | EPOLLRDHUP) : 0u) |
+                    (conn.waitingWritable ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        ev.data.fd = conn.fd;
+        epoll_ctl(reactor.epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+    }
+    
+    //=========================================================================
+    // Shared-memory clients (dna_shm_ring.hpp)
+    //=========================================================================
+    
+    bool openShmListener() {
+        struct sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (config_.shmSocket.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Shared-memory socket path too long: " << config_.shmSocket << std::endl;
+            return false;
+        }
+        std::strncpy(address.sun_path, config_.shmSocket.c_str(), sizeof(address.sun_path) - 1);
+        
+        shmSocket_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        unlink(config_.shmSocket.c_str());   // Stale socket from a previous run
+        if (shmSocket_ < 0 ||
+            bind(shmSocket_, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+            listen(shmSocket_, LISTEN_BACKLOG) < 0) {
+            std::cerr << "Failed to listen on " << config_.shmSocket << std::endl;
+            if (shmSocket_ >= 0) close(shmSocket_);
+            shmSocket_ = -1;
+            return false;
+        }
+        return true;
+    }
+    
+    void closeShmListener() {
+        if (shmSocket_ < 0) return;
+        close(shmSocket_);
+        unlink(config_.shmSocket.c_str());
+        shmSocket_ = -1;
+    }
+    
+    void acceptShmClients(Reactor& reactor) {
+        while (running_) {
+            int clientSocket = accept4(shmSocket_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (clientSocket < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    std::cerr << "Accept failed" << std::endl;
+                }
+                return;
+            }
+            
+            struct ucred peer{};
+            socklen_t peerLen = sizeof(peer);
+            getsockopt(clientSocket, SOL_SOCKET, SO_PEERCRED, &peer, &peerLen);
+            
+            ClientConnection* conn = addClient(reactor, clientSocket, "local", peer.pid);
+            if (!conn) continue;
+            conn->awaitingShm = true;
+            
+            struct epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.fd = clientSocket;
+            if (epoll_ctl(reactor.epollFd, EPOLL_CTL_ADD, clientSocket, &ev) < 0) {
+                closeClient(reactor, reactor.connections.find(clientSocket));
+            }
+        }
+    }
+    
+    /**
+     * @brief Receive the client's ring and doorbell, then serve it like a binary client
+     * @return false when the connection should be closed
+     */
+    bool attachShm(Reactor& reactor, ClientConnection& conn) {
+        int memfd, doorbell;
+        int rc = DNASerialProcessor::ShmRing::receiveFrom(conn.fd, memfd, doorbell);
+        if (rc == 0) return true;
+        if (rc < 0) return false;
+        
+        auto peer = std::make_unique<ShmPeer>();
+        peer->ring = DNASerialProcessor::ShmRing::attach(memfd, doorbell);
+        if (!peer->ring) {
+            std::cout << "\n[PROTOCOL] " << conn.clientId << ": invalid shared-memory ring" << std::endl;
+            stats_.protocolErrors.fetch_add(1);
+            return false;
+        }
+        
+        struct epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = doorbell;
+        if (epoll_ctl(reactor.epollFd, EPOLL_CTL_ADD, doorbell, &ev) < 0) return false;
+        reactor.doorbells[doorbell] = conn.fd;
+        
+        conn.shm = std::move(peer);
+        conn.awaitingShm = false;
+        conn.mode = ProtocolMode::BINARY;
+        stats_.binaryConnections.fetch_add(1);
+        return readShm(reactor, conn);
+    }
+    
+    /**
+     * @brief Parse every frame published in the client's ring, in place
+     * @return false when the connection should be closed
+     */
+    bool readShm(Reactor& reactor, ClientConnection& conn) {
+        ShmPeer& shm = *conn.shm;
+        shm.ring->clearDoorbell();
+        
+        bool keep = true;
+        while (keep && !conn.closeAfterFlush && !conn.paused) {
+            uint64_t start = shm.ring->readPosition();
+            shm.current = DNASerialProcessor::RecvBlock::allocate(0, nullptr);
+            
+            size_t length;
+            const char* data;
+            uint64_t before = start;
+            while (keep && !conn.closeAfterFlush && !conn.paused &&
+                   (data = shm.ring->next(length)) != nullptr) {
+                FrameView frame;
+                std::string error;
+                if (FrameDecoder::decode(data, length, frame, &error) != DecodeStatus::FRAME ||
+                    frame.frameSize != length) {
+                    protocolError(reactor, conn, error.empty() ? "bad frame in shared ring" : error);
+                    break;
+                }
+                keep = handleFrame(reactor, conn, frame, false);
+                if (conn.batchResume > 0) {
+                    shm.ring->rewind(before);  // Read the BATCH again when resumed
+                    break;
+                }
+                before = shm.ring->readPosition();
+            }
+            if (shm.ring->corrupt()) {
+                protocolError(reactor, conn, "corrupt shared ring");
+            }
+            
+            // The reactor's own reference keeps the ring bytes until workers are done
+            stats_.totalBytesReceived.fetch_add(shm.ring->readPosition() - start);
+            shm.leases.emplace_back(shm.current, shm.ring->readPosition());
+            shm.current = nullptr;
+            shm.reclaim();
+            
+            // Sleep on the doorbell only if nothing arrived meanwhile
+            if (shm.ring->prepareWait()) break;
+        }
+        return keep;
+    }
+    
+    //=========================================================================
+    // Flow control
+    //=========================================================================
+    
+    /**
+     * @brief Account for one incoming record and tag it for acknowledgement
+     * @return false if a flow-controlled client had no credit (connection is closing)
+     */
+    bool admitRecord(Reactor& reactor, ClientConnection& conn, RecordOrigin& origin) {
+        if (conn.flowControl) {
+            if (conn.credits == 0) {
+                protocolError(reactor, conn, "record sent without credit");
+                return false;
+            }
+            conn.credits--;
+        } else if (--reactor.budget <= 0 && !conn.paused) {
+            // No credits to withhold: stop reading and let TCP push back
+            pauseReading(reactor, conn);
+        }
+        
+        conn.inFlight++;
+        stats_.recordsInFlight.fetch_add(1, std::memory_order_relaxed);
+        origin.reactor = reactor.index;
+        origin.fd = conn.fd;
+        origin.generation = conn.generation;
+        origin.recordNumber = ++conn.recordsReceived;
+        origin.admittedNs = steadyNanos();
+        return true;
+    }
+    
+    static void applyRecordMeta(RecordOrigin& origin, const DNASerialProcessor::RecordMeta& meta) {
+        origin.lane = meta.priority;
+        if (meta.deadlineMs > 0) {
+            origin.deadlineNs = origin.admittedNs + uint64_t(meta.deadlineMs) * 1000000;
+        }
+    }
+    
+    /**
+     * @brief Top a flow-controlled connection up to its window from the reactor budget
+     */
+    void grantCredits(Reactor& reactor, ClientConnection& conn) {
+        uint32_t wanted = static_cast<uint32_t>(config_.creditWindow) - conn.window;
+        uint32_t grant = static_cast<uint32_t>(
+            std::min<int64_t>(wanted, std::max<int64_t>(reactor.budget, 0)));
+        
+        if (grant > 0) {
+            reactor.budget -= grant;
+            conn.window += grant;
+            conn.credits += grant;
+            DNASerialProcessor::CreditPayload payload{grant};
+            std::string out;
+            FrameEncoder::append(out, FrameType::CREDIT, &payload, sizeof(payload));
+            queueOutput(reactor, conn, out);
+        }
+        
+        if (conn.window < static_cast<uint32_t>(config_.creditWindow) && !conn.waitingCredits) {
+            conn.waitingCredits = true;
+            reactor.creditWaiters.emplace_back(conn.fd, conn.generation);
+        }
+    }
+    
+    /**
+     * @brief Hand freed budget to connections waiting for credits, then resume paused ones
+     */
+    void releaseBudget(Reactor& reactor) {
+        while (reactor.budget > 0 && !reactor.creditWaiters.empty()) {
+            auto waiter = reactor.creditWaiters.front();
+            reactor.creditWaiters.pop_front();
+            auto it = reactor.connections.find(waiter.first);
+            if (it == reactor.connections.end() || it->second->generation != waiter.second) {
+                continue;
+            }
+            it->second->waitingCredits = false;
+            grantCredits(reactor, *it->second);
+        }
+        
+        if (reactor.budget > 0 && reactor.pausedConnections > 0) {
+            std::vector<int> finished;
+            for (auto& entry : reactor.connections) {
+                if (entry.second->paused && reactor.budget > 0 &&
+                    !resumeReading(reactor, *entry.second)) {
+                    finished.push_back(entry.first);
+                }
+            }
+            for (int fd : finished) {
+                auto it = reactor.connections.find(fd);
+                if (it != reactor.connections.end()) closeClient(reactor, it);
+            }
+        }
+    }
+    
+    void pauseReading(Reactor& reactor, ClientConnection& conn) {
+        conn.paused = true;
+        reactor.pausedConnections++;
+        stats_.backpressurePauses.fetch_add(1, std::memory_order_relaxed);
+        if (reactor.epollFd >= 0) {
+            updateEvents(reactor, conn);
+        } else {
+            cancelRecv(reactor, conn);
+        }
+    }
+    
+    /**
+     * @brief Parse what arrived while paused, then start reading again
+     * @return false when the connection should be closed
+     */
+    bool resumeReading(Reactor& reactor, ClientConnection& conn) {
+        conn.paused = false;
+        reactor.pausedConnections--;
+        
+        if (!parseAccumulated(reactor, conn)) return false;
+        if (conn.shm && !readShm(reactor, conn)) return false;
+        if (conn.paused) return true;        // Budget ran out again
+        if (conn.outputBlocked) return true; // writeReady() restarts it
+        if (conn.peerClosed) return false;
+        
+        if (reactor.epollFd >= 0) {
+            updateEvents(reactor, conn);
+        } else if (!conn.recvArmed) {
+            armRecv(reactor, conn);
+        }
+        return true;
+    }
+    
+    /**
+     * @brief Called by workers: queue an acknowledgement for the record's reactor
+     */
+    void postCompletion(const DNASequence& seq, uint8_t status) {
+        if (seq.origin.reactor < 0) return;
+        Reactor& reactor = *reactors_[seq.origin.reactor];
+        
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(reactor.completionMutex);
+            wake = reactor.completions.empty();
+            reactor.completions.push_back({seq.origin, seq.id, status});
+        }
+        // One eventfd write per batch: the reactor drains everything on wakeup
+        if (wake) {
+            uint64_t one = 1;
+            ssize_t rc = write(reactor.wakeFd, &one, sizeof(one));
+            (void)rc;
+        }
+    }
+    
+    /**
+     * @brief Return credits/budget for processed records and send ACK frames
+     */
+    void drainCompletions(Reactor& reactor) {
+        std::vector<Completion> done;
+        {
+            std::lock_guard<std::mutex> lock(reactor.completionMutex);
+            done.swap(reactor.completions);
+        }
+        if (done.empty()) return;
+        stats_.recordsInFlight.fetch_sub(done.size(), std::memory_order_relaxed);
+        
+        // Workers drop their slices before posting, so rings can be reclaimed
+        // before the ACKs go out: an acknowledged record's ring bytes are free
+        reactor.retiredShm.erase(
+            std::remove_if(reactor.retiredShm.begin(), reactor.retiredShm.end(),
+                           [](const std::unique_ptr<ShmPeer>& peer) { return peer->reclaim(); }),
+            reactor.retiredShm.end());
+        
+        std::vector<ClientConnection*> acked;
+        uint64_t now = steadyNanos();
+        std::unique_lock<std::mutex> latencyLock(stats_.latencyMutex);
+        for (const Completion& c : done) {
+            reactor.dispatchedRecords--;
+            reactor.dispatchedBytes -= c.origin.cost;
+            
+            LaneStats& lane = stats_.lanes[c.origin.lane];
+            bool missed = c.origin.deadlineNs != 0 && now > c.origin.deadlineNs;
+            if (c.status == DNASerialProcessor::ACK_EXPIRED) {
+                lane.dropped++;
+            } else {
+                lane.latency.record(now - c.origin.admittedNs);
+                stats_.pipeline.record(PipelineStage::TOTAL, now - c.origin.admittedNs);
+            }
+            if (missed) lane.missed++;
+            
+            auto it = reactor.connections.find(c.origin.fd);
+            if (it == reactor.connections.end() || it->second->generation != c.origin.generation) {
+                reactor.budget++;   // Connection is gone: its slot goes back to the pool
+                continue;
+            }
+            
+            ClientConnection& conn = *it->second;
+            conn.inFlight--;
+            if (c.status != DNASerialProcessor::ACK_EXPIRED) {
+                conn.latency->record(now - c.origin.admittedNs);
+            }
+            if (conn.shm) conn.shm->reclaim();
+            if (!conn.flowControl) {
+                reactor.budget++;
+                continue;
+            }
+            
+            if (conn.pendingAcks.empty()) acked.push_back(&conn);
+            DNASerialProcessor::AckEntry entry{};
+            entry.recordNumber = c.origin.recordNumber;
+            entry.sequenceId = c.sequenceId;
+            entry.status = c.status;
+            conn.pendingAcks.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        }
+        latencyLock.unlock();
+        
+        // Results freed dispatch window: next records by deficit round-robin
+        scheduleRecords(reactor);
+        
+        // One ACK frame per connection per wakeup; it returns the credits as well
+        for (ClientConnection* conn : acked) {
+            uint32_t count = static_cast<uint32_t>(conn->pendingAcks.size() / 
+                                                   sizeof(DNASerialProcessor::AckEntry));
+            DNASerialProcessor::AckHeader header{count, count};
+            conn->credits += count;
+            
+            std::string payload(reinterpret_cast<const char*>(&header), sizeof(header));
+            payload += conn->pendingAcks;
+            conn->pendingAcks.clear();
+            queueOutput(reactor, *conn, FrameEncoder::encode(FrameType::ACK, payload));
+        }
+        
+        releaseBudget(reactor);
+    }
+    
+#if DNA_HAS_IO_URING
+    // io_uring completion tags: operation (8 bits) | connection generation (24) | fd (32)
+    enum UringOp : uint64_t {
+        URING_ACCEPT = 1,
+        URING_RECV = 2,
+        URING_WAKE = 3,
+        URING_POLLOUT = 4,
+        URING_CANCEL = 5
+    };
+    
+    static uint64_t uringTag(UringOp op, int fd, uint32_t generation = 0) {
+        return (static_cast<uint64_t>(op) << 56) | 
+               (static_cast<uint64_t>(generation & 0xFFFFFF) << 32) | 
+               static_cast<uint32_t>(fd);
+    }
+    
+    /**
+     * @brief Find the connection a completion belongs to (nullptr-equivalent if stale)
+     */
+    std::unordered_map<int, std::unique_ptr<ClientConnection>>::iterator 
+    findTagged(Reactor& reactor, uint64_t userData) {
+        int fd = static_cast<int>(userData & 0xFFFFFFFFu);
+        uint32_t generation = static_cast<uint32_t>((userData >> 32) & 0xFFFFFF);
+        auto it = reactor.connections.find(fd);
+        if (it != reactor.connections.end() && it->second->generation != generation) {
+            return reactor.connections.end();
+        }
+        return it;
+    }
+    
+    bool initUringReactor(Reactor& reactor) {
+        return reactor.ring->init(URING_ENTRIES) &&
+               reactor.ring->provideBuffers(0, URING_BUFFER_COUNT, URING_BUFFER_SIZE);
+    }
+    
+    void uringReactorLoop(Reactor& reactor) {
+        DNASerialProcessor::IoUring& ring = *reactor.ring;
+        struct sockaddr_in clientAddr;
+        socklen_t clientLen = sizeof(clientAddr);
+        uint64_t wakeValue = 0;
+        
+        auto armAccept = [&]() {
+            clientLen = sizeof(clientAddr);
+            struct io_uring_sqe* sqe = ring.getSqe();
+            sqe->opcode = IORING_OP_ACCEPT;
+            sqe->fd = serverSocket_;
+            sqe->addr = reinterpret_cast<uint64_t>(&clientAddr);
+            sqe->addr2 = reinterpret_cast<uint64_t>(&clientLen);
+            sqe->accept_flags = SOCK_CLOEXEC;
+            sqe->user_data = uringTag(URING_ACCEPT, serverSocket_);
+        };
+        
+        auto armWake = [&]() {
+            struct io_uring_sqe* sqe = ring.getSqe();
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = reactor.wakeFd;
+            sqe->addr = reinterpret_cast<uint64_t>(&wakeValue);
+            sqe->len = sizeof(wakeValue);
+            sqe->user_data = uringTag(URING_WAKE, reactor.wakeFd);
+        };
+        
+        armAccept();
+        armWake();
+        
+        while (running_) {
+            // One syscall submits pending SQEs and waits for completions
+            int rc = ring.submit(1);
+            if (rc < 0 && rc != -EINTR && rc != -EBUSY && rc != -EAGAIN) {
+                std::cerr << "io_uring_enter failed: " << strerror(-rc) << std::endl;
+                break;
+            }
+            
+            struct io_uring_cqe* cqe;
+            while ((cqe = ring.peekCqe()) != nullptr) {
+                uint64_t userData = cqe->user_data;
+                UringOp op = static_cast<UringOp>(userData >> 56);
+                int res = cqe->res;
+                uint32_t flags = cqe->flags;
+                ring.cqeSeen();
+                
+                if (op == URING_WAKE) {
+                    drainCompletions(reactor);
+                    if (running_) armWake();
+                } else if (op == URING_ACCEPT) {
+                    ClientConnection* conn = res >= 0 ? addClient(reactor, res, clientAddr) : nullptr;
+                    if (conn) {
+                        armRecv(reactor, *conn);
+                    }
+                    if (running_) armAccept();
+                } else if (op == URING_RECV) {
+                    handleUringRecv(reactor, userData, res, flags);
+                } else if (op == URING_POLLOUT) {
+                    auto it = findTagged(reactor, userData);
+                    if (it == reactor.connections.end()) continue;
+                    it->second->waitingWritable = false;
+                    if (!writeReady(reactor, *it->second) ||
+                        (it->second->closeAfterFlush && it->second->outbox.empty())) {
+                        closeClient(reactor, it);
+                    }
+                }
+            }
+        }
+    }
+    
+    void armRecv(Reactor& reactor, ClientConnection& conn) {
+        // Multishot recv: one SQE keeps producing completions, each in a kernel-picked buffer
+        conn.recvArmed = true;
+        struct io_uring_sqe* sqe = reactor.ring->getSqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = conn.fd;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = 0;
+        sqe->user_data = uringTag(URING_RECV, conn.fd, conn.generation);
+    }
+    
+    void handleUringRecv(Reactor& reactor, uint64_t userData, int res, uint32_t flags) {
+        DNASerialProcessor::IoUring& ring = *reactor.ring;
+        auto it = findTagged(reactor, userData);
+        
+        if (flags & IORING_CQE_F_BUFFER) {
+            uint16_t bufferId = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+            bool keep = true;
+            if (res > 0 && it != reactor.connections.end()) {
+                // Provided buffers go straight back to the kernel, so this is the one copy
+                it->second->input.append(ring.bufferData(0, bufferId), res);
+                keep = consumeData(reactor, *it->second, res);
+            }
+            ring.recycleBuffer(0, bufferId);
+            if (!keep || (it != reactor.connections.end() && 
+                          it->second->closeAfterFlush && it->second->outbox.empty())) {
+                closeClient(reactor, it);
+                return;
+            }
+        }
+        
+        if (it == reactor.connections.end()) return;
+        ClientConnection& conn = *it->second;
+        if (!(flags & IORING_CQE_F_MORE)) conn.recvArmed = false;
+        
+        if (res == 0 && (conn.paused || conn.outputBlocked)) {
+            conn.peerClosed = true;   // Buffered records still need parsing
+        } else if (res == 0 || (res < 0 && res != -ENOBUFS && res != -ECANCELED)) {
+            closeClient(reactor, it);
+        } else if (!conn.recvArmed && !conn.paused && !conn.outputBlocked) {
+            armRecv(reactor, conn);  // Multishot ended (buffers ran out, cancel raced resume)
+        }
+    }
+    
+    /**
+     * @brief Stop the multishot recv of a paused connection; re-armed on resume
+     */
+    void cancelRecv(Reactor& reactor, const ClientConnection& conn) {
+        if (!conn.recvArmed) return;
+        struct io_uring_sqe* sqe = reactor.ring->getSqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = uringTag(URING_RECV, conn.fd, conn.generation);
+        sqe->user_data = uringTag(URING_CANCEL, conn.fd, conn.generation);
+    }
+    void armPollOut(Reactor& reactor, const ClientConnection& conn) {
+        struct io_uring_sqe* sqe = reactor.ring->getSqe();
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = conn.fd;
+        sqe->poll32_events = POLLOUT;
+        sqe->user_data = uringTag(URING_POLLOUT, conn.fd, conn.generation);
+    }
+#else
+    bool initUringReactor(Reactor&) { return false; }
+    void uringReactorLoop(Reactor&) {}
+    void armPollOut(Reactor&, const ClientConnection&) {}
+    void armRecv(Reactor&, ClientConnection&) {}
+    void cancelRecv(Reactor&, const ClientConnection&) {}
+#endif  // DNA_HAS_IO_URING
+    
+    void closeClient(Reactor& reactor,
+                     std::unordered_map<int, std::unique_ptr<ClientConnection>>::iterator it) {
+        std::string clientId = it->second->clientId;
+        ClientConnection& conn = *it->second;
+        
+        // Unused credits go back to the pool now, in-flight records when they complete
+        if (conn.flowControl) reactor.budget += conn.credits;
+        if (conn.paused) reactor.pausedConnections--;
+        flushQueued(reactor, conn);
+        
+        if (reactor.epollFd >= 0) {
+            epoll_ctl(reactor.epollFd, EPOLL_CTL_DEL, it->first, nullptr);
+        }
+        if (conn.shm) {
+            int doorbell = conn.shm->ring->doorbell();
+            epoll_ctl(reactor.epollFd, EPOLL_CTL_DEL, doorbell, nullptr);
+            reactor.doorbells.erase(doorbell);
+            // The mapping must outlive records still held by workers
+            if (!conn.shm->reclaim()) reactor.retiredShm.push_back(std::move(conn.shm));
+        }
+        // shutdown() completes any armed io_uring recv and sends FIN even if
+        // the kernel still holds a reference to the socket
+        shutdown(it->first, SHUT_RDWR);
+        close(it->first);
+        reactor.connections.erase(it);
+        stats_.activeConnections.fetch_sub(1);
+        
+        std::cout << "\n[DISCONNECT] Client " << clientId 
+                  << " (Active: " << stats_.activeConnections.load() << ")" << shardTag_ << std::endl;
+        
+        releaseBudget(reactor);
+    }
+    
+    void closeReactor(Reactor& reactor) {
+        for (auto& entry : reactor.connections) {
+            close(entry.first);
+            stats_.activeConnections.fetch_sub(1);
+        }
+        reactor.connections.clear();
+        reactor.doorbells.clear();
+        reactor.retiredShm.clear();
+        
+        if (reactor.epollFd >= 0) close(reactor.epollFd);
+        if (reactor.wakeFd >= 0) close(reactor.wakeFd);
+        reactor.epollFd = -1;
+        reactor.wakeFd = -1;
+        reactor.ring.reset();
+    }
+    
+    void closeAllReactors() {
+        for (auto& reactor : reactors_) {
+            closeReactor(*reactor);
+        }
+        reactors_.clear();
+    }
+    
+    void processSequence(Reactor& reactor, ClientConnection& conn, 
+                         DNASerialProcessor::BufferSlice&& data, const RecordOrigin& origin) {
+        // Parse format (simple detection)
+        const char* format = data.data()[0] == '>' ? "FASTA" : (data.data()[0] == '@' ? "FASTQ" : "RAW");
+        processRecord(reactor, conn, std::move(data), format, origin);
+    }
+    
+    void processRecord(Reactor& reactor, ClientConnection& conn, DNASerialProcessor::BufferSlice&& data,
+                       const std::string& format, const RecordOrigin& origin) {
+        DNASequence seq;
+        seq.origin = origin;
+        seq.id = nextSequenceId();
+        seq.clientId = conn.clientId;
+        seq.timestamp = time(nullptr);
+        seq.format = format;
+        
+        // Header/whitespace handling happens on the worker (extractBases)
+        seq.payload = std::move(data);
+        enqueueRecord(reactor, conn, std::move(seq));
+    }
+    
+    void processPackedRecord(Reactor& reactor, ClientConnection& conn,
+                             const DNASerialProcessor::PackedRecordView& packed,
+                             DNASerialProcessor::BufferSlice&& bases, const RecordOrigin& origin) {
+        DNASequence seq;
+        seq.origin = origin;
+        seq.id = nextSequenceId();
+        seq.clientId = conn.clientId;
+        seq.timestamp = time(nullptr);
+        
+        switch (static_cast<FrameType>(packed.header.sourceType)) {
+            case FrameType::RECORD_FASTA: seq.format = "FASTA"; break;
+            case FrameType::RECORD_FASTQ: seq.format = "FASTQ"; break;
+            default:                      seq.format = "RAW";   break;
+        }
+        // Named like the unpacked record; qualities are dropped, as for RECORD_FASTQ
+        if (seq.format != "RAW") {
+            seq.name = headerName(packed.name, packed.nameLength);
+        }
+        
+        // Packed at the edge: the worker checks padding and CRC (verifyPacked), then stores it as-is
+        seq.preEncoded = true;
+        seq.payload = std::move(bases);
+        seq.baseCount = packed.header.baseCount;
+        seq.checksum = packed.header.sequenceCrc32;
+        
+        enqueueRecord(reactor, conn, std::move(seq));
+    }
+    
+    //=========================================================================
+    // Fair scheduling (reactor thread)
+    //=========================================================================
+    
+    static uint64_t steadyNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    /**
+     * @brief Queue an admitted record behind its connection's backlog in its lane
+     *
+     * The record goes to a worker right away if the dispatch window is open
+     * and nothing more urgent is waiting.
+     */
+    void enqueueRecord(Reactor& reactor, ClientConnection& conn, DNASequence&& seq) {
+        seq.origin.cost = seq.length() + DRR_RECORD_OVERHEAD;
+        if (config_.scheduler == Scheduler::FIFO) {
+            dispatchRecord(reactor, std::move(seq));
+            return;
+        }
+        
+        queueInLane(reactor, conn, seq.origin.lane, std::move(seq));
+        scheduleRecords(reactor);
+    }
+    
+    static void queueInLane(Reactor& reactor, ClientConnection& conn, int lane, DNASequence&& seq) {
+        ClientLane& queue = conn.lanes[lane];
+        queue.queued.push_back(std::move(seq));
+        if (!queue.scheduled) {
+            queue.scheduled = true;
+            reactor.activeClients[lane].emplace_back(conn.fd, conn.generation);
+        }
     }
     
-    const ServerStats& getStats() const {
-        return stats_;
+    /**
+     * @brief Whether a record of `cost` bytes may join those already with the workers
+     */
+    static bool dispatchFits(const Reactor& reactor, uint64_t cost) {
+        if (reactor.dispatchedRecords == 0) return true;   // One record always fits, however large
+        return reactor.dispatchedRecords < reactor.dispatchRecordLimit &&
+               reactor.dispatchedBytes + cost <= reactor.dispatchByteLimit;
     }
     
-private:
-    void acceptClients() {
-        while (running_) {
-            struct sockaddr_in clientAddr;
-            socklen_t clientLen = sizeof(clientAddr);
-            
-            int clientSocket = accept(serverSocket_, (struct sockaddr*)&clientAddr, &clientLen);
-            
-            if (clientSocket < 0) {
-                if (running_) {
-                    std::cerr << "Accept failed" << std::endl;
-                }
+    void dispatchRecord(Reactor& reactor, DNASequence&& seq) {
+        reactor.dispatchedRecords++;
+        reactor.dispatchedBytes += seq.origin.cost;
+        dispatch(std::move(seq));
+    }
+    
+    /**
+     * @brief Deficit round-robin within one lane: the connection whose head record goes next
+     *
+     * On its turn a connection earns DRR_QUANTUM x weight bytes and sends
+     * records while their cost fits, so each client gets a byte share set by
+     * its weight whatever its record sizes. A turn cut short by the dispatch
+     * window (or a more urgent lane) resumes, with the deficit it had left;
+     * smaller records of other clients do not overtake it, so a large record
+     * cannot be starved within its lane.
+     */
+    ClientConnection* laneHead(Reactor& reactor, int lane) {
+        auto& active = reactor.activeClients[lane];
+        while (!active.empty()) {
+            auto entry = active.front();
+            auto it = reactor.connections.find(entry.first);
+            if (it == reactor.connections.end() || it->second->generation != entry.second) {
+                active.pop_front();   // Closed; its records were flushed
                 continue;
             }
             
-            stats_.totalConnections.fetch_add(1);
-            stats_.activeConnections.fetch_add(1);
+            ClientConnection& conn = *it->second;
+            ClientLane& queue = conn.lanes[lane];
+            if (queue.queued.empty()) {
+                // Idle clients do not bank credit for later bursts
+                queue.deficit = 0;
+                queue.inTurn = false;
+                queue.scheduled = false;
+                active.pop_front();
+                continue;
+            }
+            if (!queue.inTurn) {
+                queue.deficit += DRR_QUANTUM * conn.weight;
+                queue.inTurn = true;
+            }
+            if (queue.queued.front().origin.cost <= queue.deficit) return &conn;
             
-            std::string clientIp = inet_ntoa(clientAddr.sin_addr);
-            int clientPort = ntohs(clientAddr.sin_port);
+            queue.inTurn = false;   // Deficit spent: next client's turn
+            active.pop_front();
+            active.push_back(entry);
+        }
+        return nullptr;
+    }
+    
+    /**
+     * @brief Deadline EDF orders by: the record's own, else its lane's budget
+     */
+    static uint64_t effectiveDeadline(const DNASequence& seq, int lane) {
+        if (seq.origin.deadlineNs != 0 && seq.origin.lane == lane) return seq.origin.deadlineNs;
+        return seq.origin.admittedNs + uint64_t(LANE_BUDGET_MS[lane]) * 1000000;
+    }
+    
+    /**
+     * @brief Hand queued records to the workers while the dispatch window is open
+     *
+     * Lanes are served strictly by priority, or by the earliest deadline of
+     * their next record (LanePolicy::EDF); within a lane clients share by
+     * deficit round-robin. A record whose deadline passed while it waited is
+     * acknowledged ACK_EXPIRED without processing, or moved to the LOW lane.
+     */
+    void scheduleRecords(Reactor& reactor) {
+        uint64_t now = 0;
+        for (;;) {
+            ClientConnection* conn = nullptr;
+            int lane = -1;
+            uint64_t earliest = UINT64_MAX;
+            for (int l = 0; l < DNASerialProcessor::PRIORITY_LANES; l++) {
+                ClientConnection* head = laneHead(reactor, l);
+                if (!head) continue;
+                if (config_.lanePolicy == LanePolicy::STRICT) {
+                    conn = head;
+                    lane = l;
+                    break;
+                }
+                uint64_t deadline = effectiveDeadline(head->lanes[l].queued.front(), l);
+                if (deadline < earliest) {
+                    earliest = deadline;
+                    conn = head;
+                    lane = l;
+                }
+            }
+            if (!conn) return;
             
-            std::cout << "\n[CONNECT] Client " << clientIp << ":" << clientPort 
-                      << " (Total: " << stats_.activeConnections.load() << ")" << std::endl;
+            ClientLane& queue = conn->lanes[lane];
+            DNASequence& seq = queue.queued.front();
+            if (seq.origin.deadlineNs != 0) {
+                if (now == 0) now = steadyNanos();
+                bool demoted = config_.deadlinePolicy == DeadlinePolicy::DEMOTE &&
+                               lane == DNASerialProcessor::PRIORITY_LOW;
+                if (now > seq.origin.deadlineNs && !demoted) {
+                    DNASequence late = std::move(seq);
+                    queue.queued.pop_front();
+                    expireRecord(reactor, *conn, std::move(late));
+                    continue;
+                }
+            }
             
-            // Handle client in new thread
-            std::thread clientThread(&DNAServer::handleClient, this, clientSocket, clientIp);
-            clientThread.detach();
+            if (!dispatchFits(reactor, seq.origin.cost)) return;
+            queue.deficit -= seq.origin.cost;
+            dispatchRecord(reactor, std::move(seq));
+            queue.queued.pop_front();
         }
     }
     
-    void handleClient(int clientSocket, const std::string& clientId) {
-        char buffer[BUFFER_SIZE];
-        std::string accumulated;
+    /**
+     * @brief A queued record missed its deadline: drop it or move it to the LOW lane
+     */
+    void expireRecord(Reactor& reactor, ClientConnection& conn, DNASequence&& seq) {
+        if (config_.deadlinePolicy == DeadlinePolicy::DEMOTE) {
+            queueInLane(reactor, conn, DNASerialProcessor::PRIORITY_LOW, std::move(seq));
+            return;
+        }
         
-        while (running_) {
-            ssize_t bytesRead = recv(clientSocket, buffer, BUFFER_SIZE - 1, 0);
+        // Completes like a processed record, so credits and stats stay balanced
+        seq.origin.cost = 0;
+        seq.payload.reset();
+        reactor.dispatchedRecords++;
+        postCompletion(seq, DNASerialProcessor::ACK_EXPIRED);
+    }
+    
+    /**
+     * @brief Send a connection's queued records to the workers regardless of the window
+     *
+     * Used when the connection closes or the server stops: records that were
+     * admitted are still stored, as they would be with FIFO dispatch.
+     */
+    void flushQueued(Reactor& reactor, ClientConnection& conn) {
+        for (ClientLane& queue : conn.lanes) {
+            while (!queue.queued.empty()) {
+                dispatchRecord(reactor, std::move(queue.queued.front()));
+                queue.queued.pop_front();
+            }
+        }
+    }
+    
+    /**
+     * @brief Shards interleave IDs (k, k + N, k + 2N, ...) so they never share a counter
+     */
+    uint64_t nextSequenceId() {
+        uint64_t local = firstSequence_ + stats_.totalSequences.fetch_add(1);
+        return local * std::max(1, config_.shards) + config_.shardIndex + 1;
+    }
+    
+    /**
+     * @brief A record's name: the first word of its header line (without '>'/'@')
+     */
+    static std::string headerName(const char* header, size_t size) {
+        size_t end = 0;
+        while (end < size && header[end] != ' ' && (header[end] < '\t' || header[end] > '\r')) {
+            end++;
+        }
+        return std::string(header, end);
+    }
+    
+    /**
+     * @brief Narrow a text record to its bases (FASTA body, FASTQ sequence line)
+     *
+     * Single-line bases stay a slice of the receive block; only records with
+     * embedded whitespace (multi-line FASTA, CRLF) are compacted into a string.
+     */
+    static void extractBases(DNASequence& seq) {
+        const char* data = seq.payload.data();
+        size_t size = seq.payload.size();
+        size_t start = 0;
+        size_t end = size;
+        
+        if (seq.format != "RAW") {
+            // Skip header line, keeping its first word as the name; FASTQ keeps only the sequence line
+            const char* header = static_cast<const char*>(std::memchr(data, '\n', size));
+            start = header ? header - data + 1 : size;
+            size_t nameStart = size > 0 && (data[0] == '>' || data[0] == '@') ? 1 : 0;
+            seq.name = headerName(data + nameStart, start - nameStart);
+            end = size;
+            if (seq.format == "FASTQ") {
+                const char* seqEnd = static_cast<const char*>(
+                    std::memchr(data + start, '\n', size - start));
+                end = seqEnd ? seqEnd - data : start;
+            }
+        }
+        
+        auto isSpace = [](char c) { return c == ' ' || (c >= '\t' && c <= '\r'); };
+        if (std::any_of(data + start, data + end, isSpace)) {
+            seq.sequence.reserve(end - start);
+            std::copy_if(data + start, data + end, std::back_inserter(seq.sequence),
+                         [&](char c) { return !isSpace(c); });
+            seq.payload.reset();
+        } else {
+            seq.payload = seq.payload.sub(start, end - start);
+        }
+    }
+    
+    /**
+     * @brief Route a record to the reactor's home worker, or the least loaded one
+     */
+    void dispatch(DNASequence&& seq) {
+        Worker* target = workers_[seq.origin.reactor % workers_.size()].get();
+        if (target->inbox.size() >= WORKER_BATCH) {
+            // Home worker is backed up (e.g. busy with a huge record)
+            for (auto& worker : workers_) {
+                if (worker->inbox.size() < target->inbox.size()) {
+                    target = worker.get();
+                }
+            }
+        }
+        
+        // Flow control keeps inboxes from filling; parking here is only a backstop
+        if (!target->inbox.tryPush(std::move(seq)) && !target->inbox.push(std::move(seq))) {
+            return;  // Shutting down
+        }
+        workAvailable_.notifyOne();
+    }
+    
+    size_t queuedRecords() const {
+        size_t total = 0;
+        for (const auto& worker : workers_) {
+            total += worker->inbox.size();
+        }
+        return total;
+    }
+    
+    void processingWorker(Worker& self) {
+        // Each worker owns its ring, so storage submissions need no locking
+        if (config_.ioBackend == IoBackend::IO_URING) {
+            self.writer = std::make_unique<UringFileWriter>(stats_.processingErrors);
+            if (!self.writer->init()) self.writer.reset();
+        }
+        
+        self.batch.resize(config_.batchRecords);
+        self.completions.resize(reactors_.size());
+        while (true) {
+            // Own sub-tasks first (newest, cache-warm), then own inbox, then steal
+            if (EncodeTask* task = self.tasks.pop()) {
+                runEncodeTask(*task, self);
+                continue;
+            }
             
-            if (bytesRead <= 0) {
-                break;  // Client disconnected
+            // Whatever has queued up since the last pop becomes one batch: no
+            // waiting for a batch to fill, so an idle server still answers at once
+            size_t count = self.inbox.tryPopBatch(self.batch.data(), self.batch.size());
+            if (count > 0) {
+                processBatch(self, count);
+                continue;
             }
             
-            buffer[bytesRead] = '\0';
-            accumulated += std::string(buffer, bytesRead);
-            stats_.totalBytesReceived.fetch_add(bytesRead);
+            if (stealWork(self)) continue;
             
-            // Process complete sequences (separated by newlines)
-            size_t pos;
-            while ((pos = accumulated.find('\n')) != std::string::npos) {
-                std::string line = accumulated.substr(0, pos);
-                accumulated = accumulated.substr(pos + 1);
-                
-                if (!line.empty()) {
-                    processSequence(line, clientId);
-                }
+            // Park until a reactor or a splitting worker publishes work; with
+            // io_uring writes outstanding, wake periodically to reap them
+            bool pendingWrites = self.writer && self.writer->pending();
+            if (pendingWrites) self.writer->reap(false);
+            
+            uint32_t key = workAvailable_.prepareWait();
+            if (hasWork()) {
+                workAvailable_.cancelWait();
+                continue;
             }
+            if (workersStopping_) {
+                workAvailable_.cancelWait();
+                break;  // Everything visible is drained
+            }
+            workAvailable_.wait(key, pendingWrites ? std::chrono::nanoseconds(std::chrono::milliseconds(10))
+                                                   : std::chrono::nanoseconds(-1));
         }
         
-        stats_.activeConnections.fetch_sub(1);
-        close(clientSocket);
-        
-        std::cout << "\n[DISCONNECT] Client " << clientId 
-                  << " (Active: " << stats_.activeConnections.load() << ")" << std::endl;
+        self.writer.reset();  // Drains outstanding writes
     }
     
-    void processSequence(const std::string& data, const std::string& clientId) {
-        DNASequence seq;
-        seq.id = stats_.totalSequences.fetch_add(1) + 1;
-        seq.clientId = clientId;
-        seq.timestamp = time(nullptr);
-        
-        // Parse format (simple detection)
-        if (data[0] == '>') {
-            seq.format = "FASTA";
-            // Extract sequence (skip header line)
-            size_t seqStart = data.find('\n');
-            if (seqStart != std::string::npos) {
-                seq.sequence = data.substr(seqStart + 1);
-            }
-        } else if (data[0] == '@') {
-            seq.format = "FASTQ";
-            // For FASTQ, just take the sequence line
-            size_t seqStart = data.find('\n');
-            if (seqStart != std::string::npos) {
-                size_t seqEnd = data.find('\n', seqStart + 1);
-                if (seqEnd != std::string::npos) {
-                    seq.sequence = data.substr(seqStart + 1, seqEnd - seqStart - 1);
-                }
+    /**
+     * @brief Take work from other workers: encode sub-tasks first, then queued records
+     */
+    bool stealWork(Worker& self) {
+        size_t n = workers_.size();
+        for (size_t i = 1; i < n; i++) {
+            Worker& victim = *workers_[(self.index + i) % n];
+            if (EncodeTask* task = victim.tasks.steal()) {
+                runEncodeTask(*task, self);
+                return true;
             }
-        } else {
-            seq.format = "RAW";
-            seq.sequence = data;
         }
         
-        // Remove whitespace
-        seq.sequence.erase(
-            std::remove_if(seq.sequence.begin(), seq.sequence.end(), ::isspace),
-            seq.sequence.end()
-        );
+        for (size_t i = 1; i < n; i++) {
+            Worker& victim = *workers_[(self.index + i) % n];
+            // Take half of what is waiting so the victim keeps the rest
+            size_t want = std::min(self.batch.size(), (victim.inbox.size() + 1) / 2);
+            size_t count = want > 0 ? victim.inbox.tryPopBatch(self.batch.data(), want) : 0;
+            if (count > 0) {
+                processBatch(self, count);
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    bool hasWork() const {
+        for (const auto& worker : workers_) {
+            if (!worker->inbox.empty() || !worker->tasks.empty()) return true;
+        }
+        return false;
+    }
+    
+    /**
+     * @brief Check a client-packed record: last byte's unused bits clear, CRC matching its bases
+     *
+     * The client's CRC covers the ASCII bases, so they are decoded a slice at
+     * a time into `scratch` and the slice CRCs combined.
+     */
+    static bool verifyPacked(const DNASequence& seq, std::string& scratch) {
+        const uint8_t* packed = reinterpret_cast<const uint8_t*>(seq.payload.data());
+        size_t tail = seq.baseCount % 4;
+        if (tail != 0 && (packed[seq.payload.size() - 1] & (0xFF >> (2 * tail))) != 0) {
+            return false;
+        }
         
-        // Add to processing queue
-        processingQueue_.push(seq);
+        uint32_t crc = 0;   // CRC of no bytes
+        scratch.resize(std::min<uint64_t>(seq.baseCount, PACKED_VERIFY_SLICE));
+        for (uint64_t done = 0; done < seq.baseCount; done += PACKED_VERIFY_SLICE) {
+            size_t count = std::min<uint64_t>(seq.baseCount - done, PACKED_VERIFY_SLICE);
+            NucleotideCodec::unpackInto(packed + done / 4, count, &scratch[0]);
+            crc = HardwareCRC32::combine(
+                crc, HardwareCRC32::calculate(reinterpret_cast<const uint8_t*>(scratch.data()), count), count);
+        }
+        return crc == seq.checksum;
     }
     
-    void processingWorker(int workerId) {
-        while (running_) {
-            DNASequence seq;
-            
-            if (!processingQueue_.pop(seq)) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    /**
+             * @brief Validate, checksum, encode and store self.batch[0, count)
+     *
+     * Each stage runs over the whole batch before the next one starts, so the
+     * validator and CRC loops stay hot, and the encoded records are packed
+     * back to back into one buffer that is written with a single storage
+     * operation per batchBytes. Records above SPLIT_THRESHOLD leave the batch
+     * and are encoded in parallel instead.
+     */
+    void processBatch(Worker& self, size_t count) {
+        DNASequence* records = self.batch.data();
+        self.status.assign(count, BATCH_PENDING);
+        self.checksums.resize(count);
+        
+        uint64_t started = PipelineLatency::now();
+        for (size_t i = 0; i < count; i++) {
+            stats_.pipeline.record(PipelineStage::QUEUE, started - records[i].origin.admittedNs);
+        }
+        
+        uint64_t splitNs = 0;
+        size_t validated = 0;
+        for (size_t i = 0; i < count; i++) {
+            DNASequence& seq = records[i];
+            if (seq.preEncoded) {
+                // Packed by the client: no re-encoding, but its CRC becomes the stored
+                // checksum and CHECKSUM index key, so it has to match the bases
+                if (!verifyPacked(seq, self.unpacked)) {
+                    self.status[i] = DNASerialProcessor::ACK_INVALID;
+                }
+                self.checksums[i] = seq.checksum;
                 continue;
             }
-            
-            // Validate sequence using NEON
-            if (!NEONValidator::validate(seq.sequence.c_str(), seq.sequence.length())) {
+            extractBases(seq);
+            if (seq.length() >= SPLIT_THRESHOLD) {
+                uint64_t splitStarted = PipelineLatency::now();
+                splitEncode(std::move(seq), self);
+                splitNs += PipelineLatency::now() - splitStarted;
+                self.status[i] = BATCH_SPLIT;
+            } else {
+                validated++;
+            }
+        }
+        
+        // Validate using NEON
+        for (size_t i = 0; i < count; i++) {
+            const DNASequence& seq = records[i];
+            if (self.status[i] != BATCH_PENDING || seq.preEncoded) continue;
+            if (!NEONValidator::validate(seq.bases(), seq.length())) {
+                self.status[i] = DNASerialProcessor::ACK_INVALID;
+            }
+        }
+        
+        // Calculate checksums using hardware CRC32
+        for (size_t i = 0; i < count; i++) {
+            const DNASequence& seq = records[i];
+            if (self.status[i] != BATCH_PENDING || seq.preEncoded) continue;
+            self.checksums[i] = HardwareCRC32::calculate(
+                reinterpret_cast<const uint8_t*>(seq.bases()), seq.length());
+        }
+        
+        // Stage times are per batch; every record in it is charged the whole time
+        uint64_t encodeStarted = PipelineLatency::now();
+        if (validated > 0) {
+            stats_.pipeline.record(PipelineStage::VALIDATE, encodeStarted - started - splitNs, validated);
+        }
+        
+        // Inchrosil 2-bit encoding straight into the output buffer
+        size_t first = 0;
+        size_t encoded = 0;
+        uint64_t storeNs = 0;
+        for (size_t i = 0; i < count; i++) {
+            const DNASequence& seq = records[i];
+            if (self.status[i] == DNASerialProcessor::ACK_INVALID) {
                 stats_.validationErrors.fetch_add(1);
                 std::cout << "[WARN] Invalid sequence from " << seq.clientId 
                           << " (ID: " << seq.id << ")" << std::endl;
                 continue;
             }
+            if (self.status[i] != BATCH_PENDING) continue;
             
-            // Calculate checksum using hardware CRC32
-            uint32_t checksum = HardwareCRC32::calculate(
-                reinterpret_cast<const uint8_t*>(seq.sequence.c_str()),
-                seq.sequence.length()
-            );
-            
-            // Simulate Inchrosil encoding (placeholder)
-            std::string encoded = encodeToInchrosil(seq.sequence);
+            if (self.output.empty()) first = i;
+            encoded++;
+            self.output.begin(seq.id);
+            std::string& out = self.output.buffer();
+            appendIchHeader(out, seq, self.checksums[i]);
+            if (seq.preEncoded) {
+                out.append(seq.payload.data(), seq.payload.size());
+            } else {
+                size_t offset = out.size();
+                out.resize(offset + NucleotideCodec::packedSize(seq.length()));
+                NucleotideCodec::packInto(seq.bases(), seq.length(),
+                                          reinterpret_cast<uint8_t*>(&out[offset]));
+            }
+            self.output.end();
             
-            // Store to file (simple append)
-            storeSequence(seq, encoded, checksum);
+            // RECORD syncs each record on its own, so each is its own append
+            if (self.output.size() >= config_.batchBytes || config_.syncPolicy == SyncPolicy::RECORD) {
+                storeNs += flushBatch(self, first, i + 1);
+            }
+        }
+        if (!self.output.empty()) {
+            storeNs += flushBatch(self, first, count);
+        }
+        if (encoded > 0) {
+            stats_.pipeline.record(PipelineStage::ENCODE,
+                                   PipelineLatency::now() - encodeStarted - storeNs, encoded);
+        }
+        
+        postCompletions(self, count);
+    }
+    
+    /**
+     * @brief Append self.output to the log; records [first, end) still pending are in it
+     * @return nanoseconds spent in the storage write
+     */
+    uint64_t flushBatch(Worker& self, size_t first, size_t end) {
+        const DNASequence* records = self.batch.data();
+        size_t pending = std::count(self.status.begin() + first, self.status.begin() + end,
+                                    BATCH_PENDING);
+        
+        self.metadata.clear();
+        if (metadata_) {
+            self.metadata.resize(pending);
+            size_t row = 0;
+            for (size_t i = first; i < end; i++) {
+                if (self.status[i] != BATCH_PENDING) continue;
+                describeRecord(records[i], self.checksums[i], self.metadata[row++]);
+            }
+        }
+        
+        // The ACKs go out from the commit, or from the io_uring completion, not with the batch.
+        // So do the metadata rows: a row never describes a record the log lost.
+        Durable durable;
+        bool hold = holdAcks(self);
+        if (hold) {
+            std::vector<Completion> held;
+            held.reserve(pending);
+            for (size_t i = first; i < end; i++) {
+                if (self.status[i] != BATCH_PENDING || records[i].origin.reactor < 0) continue;
+                held.push_back({records[i].origin, records[i].id, DNASerialProcessor::ACK_STORED});
+            }
+            durable = [this, held = std::move(held), rows = std::move(self.metadata)](bool ok) mutable {
+                if (ok) putMetadata(rows.data(), rows.size());
+                deliverCompletions(held, ok);
+            };
+        }
+        
+        uint64_t started = PipelineLatency::now();
+        bool stored = storeRecords(self.output, self.writer.get(), std::move(durable));
+        uint64_t elapsed = PipelineLatency::now() - started;
+        stats_.pipeline.record(PipelineStage::STORE, elapsed, pending);
+        if (stored && !hold) putMetadata(self.metadata.data(), self.metadata.size());
+        self.output.clear();
+        
+        uint8_t result = hold ? BATCH_HELD : static_cast<uint8_t>(DNASerialProcessor::ACK_STORED);
+        if (!stored) result = DNASerialProcessor::ACK_FAILED;
+        for (size_t i = first; i < end; i++) {
+            if (self.status[i] != BATCH_PENDING) continue;
+            self.status[i] = result;
             
             // Print progress
-            if (seq.id % 100 == 0) {
-                std::cout << "[WORKER-" << workerId << "] Processed " << seq.id 
-                          << " sequences (Queue: " << processingQueue_.size() << ")" 
+            if (records[i].id % 100 == 0) {
+                std::cout << "[WORKER-" << self.index << "] Processed " << records[i].id 
+                          << " sequences (Queue: " << queuedRecords() << ")" 
                           << std::endl;
             }
         }
+        return elapsed;
     }
     
-    std::string encodeToInchrosil(const std::string& sequence) {
-        // Simple 2-bit encoding: A=00, C=01, G=10, T=11
-        std::string encoded;
-        encoded.reserve(sequence.length() / 4 + 1);
+    /**
+     * @brief Hand a batch's results to the reactors: one lock and one wakeup per reactor
+     */
+    void postCompletions(Worker& self, size_t count) {
+        DNASequence* records = self.batch.data();
+        uint64_t done = 0;
+        uint64_t bases = 0;
+        for (size_t i = 0; i < count; i++) {
+            const RecordOrigin& origin = records[i].origin;
+            if (self.status[i] == BATCH_SPLIT) continue;
+            done++;
+            bases += records[i].preEncoded ? records[i].baseCount : records[i].length();
+            if (origin.reactor < 0 || self.status[i] == BATCH_HELD) continue;
+            self.completions[origin.reactor].push_back({origin, records[i].id, self.status[i]});
+        }
+        self.recordsDone.fetch_add(done, std::memory_order_relaxed);
+        self.basesDone.fetch_add(bases, std::memory_order_relaxed);
         
-        uint8_t byte = 0;
-        int bitPos = 0;
+        // Release receive blocks (and shared-memory ring leases) before the
+        // reactors see the results, rather than when the slot is next reused
+        for (size_t i = 0; i < count; i++) {
+            records[i] = DNASequence();
+        }
         
-        for (char c : sequence) {
-            uint8_t bits;
-            switch (c) {
-                case 'A': bits = 0b00; break;
-                case 'C': bits = 0b01; break;
-                case 'G': bits = 0b10; break;
-                case 'T': bits = 0b11; break;
-                default: bits = 0b00; break;  // N -> A
+        for (size_t r = 0; r < self.completions.size(); r++) {
+            pushCompletions(*reactors_[r], self.completions[r]);
+        }
+    }
+    
+    void pushCompletions(Reactor& reactor, std::vector<Completion>& done) {
+        if (done.empty()) return;
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(reactor.completionMutex);
+            wake = reactor.completions.empty();
+            reactor.completions.insert(reactor.completions.end(), done.begin(), done.end());
+        }
+        done.clear();
+        if (wake) {
+            uint64_t one = 1;
+            ssize_t rc = write(reactor.wakeFd, &one, sizeof(one));
+            (void)rc;
+        }
+    }
+    
+    /**
+     * @brief Release ACKs held for a commit (committer or worker thread)
+     */
+    void deliverCompletions(std::vector<Completion>& held, bool durable) {
+        if (!durable) {
+            stats_.processingErrors.fetch_add(1);
+            for (Completion& c : held) c.status = DNASerialProcessor::ACK_FAILED;
+        }
+        // Few reactors: a pass per reactor keeps each connection's ACKs in order
+        std::vector<Completion> mine;
+        for (size_t r = 0; r < reactors_.size() && !held.empty(); r++) {
+            for (const Completion& c : held) {
+                if (c.origin.reactor == static_cast<int>(r)) mine.push_back(c);
             }
-            
-            byte |= (bits << (6 - bitPos));
-            bitPos += 2;
-            
-            if (bitPos == 8) {
-                encoded.push_back(byte);
-                byte = 0;
-                bitPos = 0;
+            pushCompletions(*reactors_[r], mine);
+        }
+    }
+    
+    /**
+     * @brief Cut a large record into SPLIT_CHUNK slices other workers can steal
+     */
+    void splitEncode(DNASequence&& seq, Worker& self) {
+        EncodeJob* job = new EncodeJob;
+        job->seq = std::move(seq);
+        job->startedNs = PipelineLatency::now();
+        
+        size_t length = job->seq.length();
+        size_t chunks = (length + SPLIT_CHUNK - 1) / SPLIT_CHUNK;
+        job->encoded.resize(NucleotideCodec::packedSize(length));
+        job->tasks.resize(chunks);
+        job->remaining.store(chunks, std::memory_order_relaxed);
+        for (size_t i = 0; i < chunks; i++) {
+            job->tasks[i].job = job;
+            job->tasks[i].offset = i * SPLIT_CHUNK;
+            job->tasks[i].length = std::min(SPLIT_CHUNK, length - i * SPLIT_CHUNK);
+        }
+        
+        // Publish all but the first slice (thieves take the oldest), then
+        // start on the first one here; a full deque means running it inline
+        for (size_t i = 1; i < chunks; i++) {
+            if (!self.tasks.push(&job->tasks[i])) {
+                runEncodeTask(job->tasks[i], self);
             }
         }
+        workAvailable_.notifyAll();
+        runEncodeTask(job->tasks[0], self);
+    }
+    
+    void runEncodeTask(EncodeTask& task, Worker& self) {
+        EncodeJob* job = task.job;
         
-        if (bitPos > 0) {
-            encoded.push_back(byte);
+        if (!job->invalid.load(std::memory_order_relaxed)) {
+            const char* bases = job->seq.bases() + task.offset;
+            uint8_t* out = reinterpret_cast<uint8_t*>(&job->encoded[0]) + task.offset / 4;
+            if (NEONValidator::validate(bases, task.length) &&
+                NucleotideCodec::packInto(bases, task.length, out)) {
+                task.crc = HardwareCRC32::calculate(reinterpret_cast<const uint8_t*>(bases),
+                                                    task.length);
+            } else {
+                job->invalid.store(true, std::memory_order_relaxed);
+            }
         }
         
-        return encoded;
+        // acq_rel: the last finisher sees every other slice's bytes and CRC
+        if (job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            finishEncodeJob(job, self);
+        }
     }
     
-    void storeSequence(const DNASequence& seq, const std::string& encoded, uint32_t checksum) {
-        // Store to file (simple implementation)
-        std::string filename = "dna_output_" + std::to_string(seq.id) + ".ich";
+    void finishEncodeJob(EncodeJob* job, Worker& self) {
+        std::unique_ptr<EncodeJob> owned(job);
+        DNASequence& seq = job->seq;
         
-        std::ofstream file(filename, std::ios::binary);
-        if (!file) {
-            stats_.processingErrors.fetch_add(1);
+        if (job->invalid.load(std::memory_order_relaxed)) {
+            stats_.validationErrors.fetch_add(1);
+            std::cout << "[WARN] Invalid sequence from " << seq.clientId 
+                      << " (ID: " << seq.id << ")" << std::endl;
+            seq.payload.reset();
+            postCompletion(seq, DNASerialProcessor::ACK_INVALID);
             return;
         }
         
-        // Write header
-        file << "INCHROSIL\n";
-        file << "ID: " << seq.id << "\n";
-        file << "Client: " << seq.clientId << "\n";
-        file << "Format: " << seq.format << "\n";
-        file << "Length: " << seq.sequence.length() << "\n";
-        file << "Checksum: 0x" << std::hex << checksum << std::dec << "\n";
-        file << "Timestamp: " << seq.timestamp << "\n";
-        file << "---\n";
+        uint32_t checksum = job->tasks[0].crc;
+        for (size_t i = 1; i < job->tasks.size(); i++) {
+            checksum = HardwareCRC32::combine(checksum, job->tasks[i].crc, job->tasks[i].length);
+        }
+        
+        DNASerialProcessor::DNAMetadata row;
+        if (metadata_) describeRecord(seq, checksum, row);
+        
+        Durable durable;
+        bool hold = holdAcks(self);
+        if (hold) {
+            std::vector<Completion> held;
+            if (seq.origin.reactor >= 0) {
+                held.push_back({seq.origin, seq.id, DNASerialProcessor::ACK_STORED});
+            }
+            durable = [this, held = std::move(held), row](bool ok) mutable {
+                if (ok) putMetadata(&row, 1);
+                deliverCompletions(held, ok);
+            };
+        }
+        
+        uint64_t encodedAt = PipelineLatency::now();
+        stats_.pipeline.record(PipelineStage::ENCODE, encodedAt - job->startedNs);
+        bool stored = storeSequence(seq, job->encoded.data(), job->encoded.size(), checksum,
+                                    self.writer.get(), std::move(durable));
+        if (stored && !hold) putMetadata(&row, 1);
+        stats_.pipeline.record(PipelineStage::STORE, PipelineLatency::now() - encodedAt);
+        self.recordsDone.fetch_add(1, std::memory_order_relaxed);
+        self.basesDone.fetch_add(seq.length(), std::memory_order_relaxed);
+        seq.payload.reset();   // Release the receive buffer before the ACK is posted
+        finishSequence(seq, stored, stored && hold, self);
+    }
+    
+    /**
+     * @brief ACKs wait for the commit under a sync policy, and for the write with io_uring
+     *
+     * An io_uring write is only queued when storeRecords() returns; its
+     * completion may still report an error.
+     */
+    bool holdAcks(const Worker& self) const {
+        return config_.syncPolicy != SyncPolicy::NONE || self.writer != nullptr;
+    }
+    
+    /**
+     * @param held  the ACK waits for the commit (or the write) instead of going out now
+     */
+    void finishSequence(const DNASequence& seq, bool stored, bool held, const Worker& self) {
+        if (!held) {
+            postCompletion(seq, stored ? DNASerialProcessor::ACK_STORED 
+                                       : DNASerialProcessor::ACK_FAILED);
+        }
+            
+        // Print progress
+        if (seq.id % 100 == 0) {
+            std::cout << "[WORKER-" << self.index << "] Processed " << seq.id 
+                      << " sequences (Queue: " << queuedRecords() << ")" 
+                      << std::endl;
+        }
+    }
+    
+    /**
+     * @brief The metadata row of a record: keyed by its decimal ID, described by its name
+     */
+    static void describeRecord(const DNASequence& seq, uint32_t checksum,
+                               DNASerialProcessor::DNAMetadata& row) {
+        uint64_t bases = seq.preEncoded ? seq.baseCount : seq.length();
+        snprintf(row.sequenceId, sizeof(row.sequenceId), "%llu", static_cast<unsigned long long>(seq.id));
+        snprintf(row.description, sizeof(row.description), "%s", seq.name.c_str());
+        snprintf(row.format, sizeof(row.format), "%s", seq.format.c_str());
+        snprintf(row.clientId, sizeof(row.clientId), "%s", seq.clientId.c_str());
+        row.originalLength = bases;
+        row.encodedLength = NucleotideCodec::packedSize(bases);
+        row.timestamp = seq.timestamp;
+        row.crc32 = checksum;
+        std::memset(row.sha256, 0, sizeof(row.sha256));   // Not computed on this path
+    }
+    
+    /**
+     * @brief Add stored records' rows to the metadata store (worker or committer thread)
+     */
+    void putMetadata(const DNASerialProcessor::DNAMetadata* rows, size_t count) {
+        if (!metadata_ || count == 0) return;
+        if (!metadata_->put(rows, count)) {
+            stats_.processingErrors.fetch_add(1);
+            std::cerr << "\n[METADATA] " << config_.storageDir << ": " << strerror(errno) << std::endl;
+        }
+    }
+    
+    /**
+     * @brief Append an Inchrosil record header; the packed bases follow it
+     */
+    static void appendIchHeader(std::string& out, const DNASequence& seq, uint32_t checksum) {
+        char hex[16];
+        snprintf(hex, sizeof(hex), "%x", checksum);
         
-        // Write encoded data
-        file.write(encoded.c_str(), encoded.length());
+        out += "INCHROSIL\n";
+        out += "ID: ";        out += std::to_string(seq.id);        out += "\n";
+        if (!seq.name.empty()) {
+            out += "Name: ";  out += seq.name;                      out += "\n";
+        }
+        out += "Client: ";    out += seq.clientId;                  out += "\n";
+        out += "Format: ";    out += seq.format;                    out += "\n";
+        out += "Length: ";
+        out += std::to_string(seq.preEncoded ? seq.baseCount : seq.length());
+        out += "\n";
+        out += "Checksum: 0x"; out += hex;                          out += "\n";
+        out += "Timestamp: "; out += std::to_string(seq.timestamp); out += "\n";
+        out += "---\n";
+    }
+    
+    bool storeSequence(const DNASequence& seq, const char* encoded, size_t encodedSize, uint32_t checksum,
+                       UringFileWriter* writer, Durable durable) {
+        LogBatch record;
+        record.buffer().reserve(encodedSize + 256);
+        record.begin(seq.id);
+        appendIchHeader(record.buffer(), seq, checksum);
+        record.buffer().append(encoded, encodedSize);
+        record.end();
+        return storeRecords(record, writer, std::move(durable));
+    }
+    
+    /**
+     * @brief One storage operation: append a batch of records to the segment log
+     *
+     * Each log record's payload is one Inchrosil record (text header, then
+     * the packed bases). The batch is left empty. `durable`, if set, runs
+     * once the records are synced under the sync policy, unless this
+     * returns false.
+     */
+    bool storeRecords(LogBatch& records, UringFileWriter* writer, Durable durable = nullptr) {
+        stats_.storageWrites.fetch_add(1, std::memory_order_relaxed);
+        size_t count = records.entries().size();
+        size_t bytes = records.size();
         
-        file.close();
+        bool stored;
+        if (writer) {
+            UringFileWriter::Written written;
+            if (durable) {
+                written = [this, count, bytes, durable = std::move(durable)](
+                              const SegmentLog::Reservation& where, bool ok) mutable {
+                    commitRecords(where, count, bytes, ok, std::move(durable));
+                };
+            }
+            stored = writer->write(log_, std::move(records), std::move(written));
+        } else {
+            SegmentLog::Reservation where;
+            stored = log_.append(records, &where);
+            if (stored && durable) {
+                commitRecords(where, count, bytes, true, std::move(durable));
+            }
+        }
+        records.clear();
+        if (!stored) {
+            stats_.processingErrors.fetch_add(1);
+        }
+        return stored;
+    }
+    
+    /**
+     * @brief Written records: sync them here (RECORD), hand them to the committer (BATCH), or done (NONE)
+     */
+    void commitRecords(const SegmentLog::Reservation& where, size_t count, size_t bytes, bool written,
+                       Durable durable) {
+        if (!written || config_.syncPolicy == SyncPolicy::NONE) {
+            durable(written);
+            return;
+        }
+        uint64_t writtenNs = PipelineLatency::now();
+        if (config_.syncPolicy == SyncPolicy::RECORD) {
+            bool synced = SegmentLog::sync(*where.segment);
+            stats_.storageSyncs.fetch_add(1, std::memory_order_relaxed);
+            stats_.pipeline.record(PipelineStage::COMMIT, PipelineLatency::now() - writtenNs, count);
+            durable(synced);
+            return;
+        }
+        committer_->submit(where.segment, count, bytes,
+                           [this, writtenNs, count, durable = std::move(durable)](bool ok) {
+            stats_.pipeline.record(PipelineStage::COMMIT, PipelineLatency::now() - writtenNs, count);
+            durable(ok);
+        });
     }
 };
 
@@ -554,44 +3370,471 @@ private:
 // Main
 //=============================================================================
 
-void printStats(const DNAServer& server) {
-    const auto& stats = server.getStats();
+/**
+ * @brief Sliding-window rates of the servers' counters; sampled and read by one thread
+ */
+struct ServerMeters {
+    DNASerialProcessor::SlidingRate sequences{10};
+    DNASerialProcessor::SlidingRate sequencesMinute{60};
+    DNASerialProcessor::SlidingRate bytes{10};
+    DNASerialProcessor::SlidingRate bytesMinute{60};
+    DNASerialProcessor::SlidingRate writes{10};
+    DNASerialProcessor::SlidingRate connections{10};
+    std::map<std::string, DNASerialProcessor::SlidingRate> workerRecords;   // By metric labels
+    std::map<std::string, DNASerialProcessor::SlidingRate> workerBases;
+    
+    void sample(const std::vector<std::unique_ptr<DNAServer>>& servers) {
+        double now = PipelineLatency::now() / 1e9;
+        StatsSnapshot stats;
+        for (const auto& server : servers) {
+            stats.add(server->getStats());
+            for (const WorkerSample& worker : server->sampleWorkers()) {
+                std::string labels = workerLabels(*server, worker);
+                workerRecords.emplace(labels, 10).first->second.sample(worker.records, now);
+                workerBases.emplace(labels, 10).first->second.sample(worker.bases, now);
+            }
+        }
+        sequences.sample(stats.totalSequences, now);
+        sequencesMinute.sample(stats.totalSequences, now);
+        bytes.sample(stats.totalBytesReceived, now);
+        bytesMinute.sample(stats.totalBytesReceived, now);
+        writes.sample(stats.storageWrites, now);
+        connections.sample(stats.totalConnections, now);
+    }
+    
+    static std::string workerLabels(const DNAServer& server, const WorkerSample& worker) {
+        return "shard=\"" + std::to_string(server.shardIndex()) + "\",worker=\"" +
+               std::to_string(worker.index) + "\"";
+    }
+};
+
+void printStats(const std::vector<std::unique_ptr<DNAServer>>& servers, ServerMeters& meters) {
+    StatsSnapshot stats;
+    for (const auto& server : servers) {
+        stats.add(server->getStats());
+    }
+    meters.sample(servers);
     
     std::cout << "\r";
-    std::cout << "Connections: " << stats.activeConnections.load() 
-              << "/" << stats.totalConnections.load() << " | ";
-    std::cout << "Sequences: " << stats.totalSequences.load() << " | ";
-    std::cout << "Received: " << (stats.totalBytesReceived.load() / 1024) << " KB | ";
-    std::cout << "Errors: " << stats.validationErrors.load() << " | ";
-    std::cout << "Throughput: " << std::fixed << std::setprecision(1) 
-              << stats.getThroughputKBps() << " KB/s | ";
-    std::cout << "Uptime: " << (int)stats.getUptimeSeconds() << "s  ";
+    std::cout << "Connections: " << stats.activeConnections 
+              << "/" << stats.totalConnections << " | ";
+    std::cout << "Sequences: " << stats.totalSequences << " | ";
+    std::cout << "Received: " << (stats.totalBytesReceived / 1024) << " KB | ";
+    std::cout << "Errors: " << stats.validationErrors << " | ";
+    std::cout << "In flight: " << stats.recordsInFlight << " | ";
+    std::cout << "Writes: " << stats.storageWrites << " | ";
+    if (stats.storageSyncs > 0) {
+        std::cout << "Syncs: " << stats.storageSyncs << " | ";
+    }
+    std::cout << "Rate: " << std::fixed << std::setprecision(1) 
+              << meters.sequences.perSecond() << " seq/s | ";
+    std::cout << "Throughput: " << meters.bytes.perSecond() / 1024.0 << " KB/s (10 s) | ";
+    std::cout << "Latency p50/p99/p99.9: " << std::setprecision(2)
+              << stats.latency.percentile(50) / 1e6 << "/"
+              << stats.latency.percentile(99) / 1e6 << "/"
+              << stats.latency.percentile(99.9) / 1e6 << " ms | ";
+    std::cout << "Uptime: " << (int)stats.uptimeSeconds << "s  ";
     std::cout << std::flush;
 }
 
-int main(int argc, char* argv[]) {
-    int port = DEFAULT_PORT;
+static void printPercentiles(const LatencyHistogram& latency, const char* unit = "records") {
+    auto ms = [](uint64_t ns) { return ns / 1e6; };
+    std::cout << latency.count() << " " << unit << std::fixed << std::setprecision(2)
+              << " | p50 " << ms(latency.percentile(50)) << " ms"
+              << " | p99 " << ms(latency.percentile(99)) << " ms"
+              << " | p99.9 " << ms(latency.percentile(99.9)) << " ms"
+              << " | max " << ms(latency.max()) << " ms";
+}
+
+/**
+ * @brief One line per client ID, busy priority lane and pipeline stage over the last interval
+ *
+ * `reported` holds the stage totals of the previous report and is updated.
+ */
+void printLatencyReport(const std::vector<std::unique_ptr<DNAServer>>& servers,
+                        LatencyHistogram (&reported)[DNASerialProcessor::PIPELINE_STAGES]) {
+    std::map<std::string, LatencyHistogram> clients;
+    LaneStats lanes[DNASerialProcessor::PRIORITY_LANES];
+    LatencyHistogram stages[DNASerialProcessor::PIPELINE_STAGES];
+    for (const auto& server : servers) {
+        server->getStats().takeClientLatency(clients);
+        server->getStats().takeLaneStats(lanes);
+        for (int stage = 0; stage < DNASerialProcessor::PIPELINE_STAGES; stage++) {
+            stages[stage].merge(server->getStats().pipeline.snapshot(static_cast<PipelineStage>(stage)));
+        }
+    }
+    LatencyHistogram interval[DNASerialProcessor::PIPELINE_STAGES];
+    for (int stage = 0; stage < DNASerialProcessor::PIPELINE_STAGES; stage++) {
+        interval[stage] = stages[stage].since(reported[stage]);
+        reported[stage] = stages[stage];
+    }
+    if (clients.empty()) return;
     
-    if (argc > 1) {
-        port = std::atoi(argv[1]);
-        if (port <= 0 || port > 65535) {
-            std::cerr << "Invalid port number" << std::endl;
-            return 1;
+    std::cout << std::endl;
+    for (const auto& entry : clients) {
+        std::cout << "[LATENCY] " << entry.first << ": ";
+        printPercentiles(entry.second);
+        std::cout << std::endl;
+    }
+    for (int lane = 0; lane < DNASerialProcessor::PRIORITY_LANES; lane++) {
+        if (lanes[lane].latency.count() == 0 && lanes[lane].dropped == 0) continue;
+        std::cout << "[LANE] " << DNASerialProcessor::priorityName(lane) << ": ";
+        printPercentiles(lanes[lane].latency);
+        std::cout << " | missed " << lanes[lane].missed 
+                  << " (dropped " << lanes[lane].dropped << ")" << std::endl;
+    }
+    for (int stage = 0; stage < DNASerialProcessor::PIPELINE_STAGES; stage++) {
+        if (interval[stage].count() == 0) continue;
+        // Receive and parse are timed per recv() call, the rest per record
+        PipelineStage which = static_cast<PipelineStage>(stage);
+        bool perCall = which == PipelineStage::RECEIVE || which == PipelineStage::PARSE;
+        std::cout << "[STAGE] " << DNASerialProcessor::stageName(which) << ": ";
+        printPercentiles(interval[stage], perCall ? "calls" : "records");
+        std::cout << std::endl;
+    }
+}
+
+/**
+ * @brief Prometheus text exposition of every server's counters, queues and histograms
+ *
+ * Runs on the metrics thread. Counters are relaxed atomic loads and the
+ * histograms are merged from per-thread shards, so reactors and workers
+ * are never blocked by a scrape.
+ */
+std::string renderMetrics(const std::vector<std::unique_ptr<DNAServer>>& servers,
+                          const ServerMeters& meters) {
+    StatsSnapshot stats;
+    for (const auto& server : servers) {
+        stats.add(server->getStats());
+    }
+    
+    MetricsWriter out;
+    auto counter = [&](const char* name, const char* help, double value) {
+        out.header(name, "counter", help);
+        out.value(name, value);
+    };
+    auto gauge = [&](const char* name, const char* help, double value) {
+        out.header(name, "gauge", help);
+        out.value(name, value);
+    };
+    
+    counter("dna_server_connections_total", "Client connections accepted.", stats.totalConnections);
+    gauge("dna_server_connections_active", "Client connections open now.", stats.activeConnections);
+    counter("dna_server_connections_rejected_total", "Connections refused at the client limit.",
+            stats.rejectedConnections);
+    counter("dna_server_binary_connections_total", "Connections using the framed protocol.",
+            stats.binaryConnections);
+    counter("dna_server_sequences_total", "Records admitted.", stats.totalSequences);
+    counter("dna_server_received_bytes_total", "Bytes received from clients.", stats.totalBytesReceived);
+    counter("dna_server_validation_errors_total", "Records rejected as invalid.", stats.validationErrors);
+    counter("dna_server_processing_errors_total", "Storage or processing failures.",
+            stats.processingErrors);
+    counter("dna_server_protocol_errors_total", "Connections closed for protocol errors.",
+            stats.protocolErrors);
+    counter("dna_server_backpressure_pauses_total", "Times a connection stopped being read.",
+            stats.backpressurePauses);
+    counter("dna_server_storage_writes_total", "Storage write operations.", stats.storageWrites);
+    counter("dna_server_storage_syncs_total", "fdatasync calls on the segment log.", stats.storageSyncs);
+    gauge("dna_server_records_in_flight", "Records admitted and not yet acknowledged.",
+          stats.recordsInFlight);
+    
+    uint64_t logRecords = 0, logSegments = 0, logBytes = 0, logCheckpoints = 0;
+    SegmentCompactor::Stats compaction;
+    for (const auto& server : servers) {
+        logRecords += server->getLog().recordCount();
+        logSegments += server->getLog().segmentCount();
+        logBytes += server->getLog().bytesAppended();
+        logCheckpoints += server->checkpoints();
+        SegmentCompactor::Stats shard = server->compactionStats();
+        compaction.segments += shard.segments;
+        compaction.duplicates += shard.duplicates;
+        compaction.bytesBefore += shard.bytesBefore;
+        compaction.bytesAfter += shard.bytesAfter;
+        compaction.failures += shard.failures;
+    }
+    gauge("dna_server_log_records", "Records indexed in the segment log.", logRecords);
+    gauge("dna_server_log_segments", "Segment files in the log.", logSegments);
+    counter("dna_server_log_appended_bytes_total", "Bytes appended to the log since start.", logBytes);
+    counter("dna_server_log_checkpoints_total", "Segment log checkpoints written.", logCheckpoints);
+    counter("dna_server_compacted_segments_total", "Cold segments recompressed.", compaction.segments);
+    counter("dna_server_compaction_saved_bytes_total", "Bytes freed by recompressing segments.",
+            compaction.bytesSaved());
+    counter("dna_server_compaction_duplicates_total", "Records stored once as a duplicate payload.",
+            compaction.duplicates);
+    counter("dna_server_compaction_failures_total", "Segment rewrites that failed.", compaction.failures);
+    gauge("dna_server_uptime_seconds", "Seconds since the server started.", stats.uptimeSeconds);
+    
+    out.header("dna_server_sequences_per_second", "gauge", "Admitted records per second over a window.");
+    out.value("dna_server_sequences_per_second", meters.sequences.perSecond(), "window=\"10s\"");
+    out.value("dna_server_sequences_per_second", meters.sequencesMinute.perSecond(), "window=\"60s\"");
+    out.header("dna_server_received_bytes_per_second", "gauge", "Received bytes per second over a window.");
+    out.value("dna_server_received_bytes_per_second", meters.bytes.perSecond(), "window=\"10s\"");
+    out.value("dna_server_received_bytes_per_second", meters.bytesMinute.perSecond(), "window=\"60s\"");
+    out.header("dna_server_storage_writes_per_second", "gauge", "Storage writes per second over 10 s.");
+    out.value("dna_server_storage_writes_per_second", meters.writes.perSecond(), "window=\"10s\"");
+    out.header("dna_server_connections_per_second", "gauge", "New connections per second over 10 s.");
+    out.value("dna_server_connections_per_second", meters.connections.perSecond(), "window=\"10s\"");
+    
+    std::vector<std::pair<std::string, WorkerSample>> workers;
+    for (const auto& server : servers) {
+        for (const WorkerSample& worker : server->sampleWorkers()) {
+            workers.emplace_back(ServerMeters::workerLabels(*server, worker), worker);
+        }
+    }
+    out.header("dna_server_worker_queue_depth", "gauge", "Records waiting in a worker's inbox.");
+    for (const auto& worker : workers) {
+        out.value("dna_server_worker_queue_depth", worker.second.queued, worker.first);
+    }
+    out.header("dna_server_worker_records_total", "counter", "Records finished by a worker.");
+    for (const auto& worker : workers) {
+        out.value("dna_server_worker_records_total", worker.second.records, worker.first);
+    }
+    out.header("dna_server_worker_bases_total", "counter", "Nucleotides in records finished by a worker.");
+    for (const auto& worker : workers) {
+        out.value("dna_server_worker_bases_total", worker.second.bases, worker.first);
+    }
+    out.header("dna_server_worker_records_per_second", "gauge", "Records a worker finished per second over 10 s.");
+    for (const auto& worker : workers) {
+        auto rate = meters.workerRecords.find(worker.first);
+        out.value("dna_server_worker_records_per_second",
+                  rate == meters.workerRecords.end() ? 0.0 : rate->second.perSecond(), worker.first);
+    }
+    out.header("dna_server_worker_bases_per_second", "gauge", "Nucleotides a worker finished per second over 10 s.");
+    for (const auto& worker : workers) {
+        auto rate = meters.workerBases.find(worker.first);
+        out.value("dna_server_worker_bases_per_second",
+                  rate == meters.workerBases.end() ? 0.0 : rate->second.perSecond(), worker.first);
+    }
+    
+    out.header("dna_server_stage_latency_seconds", "histogram",
+               "Time per pipeline stage; receive/parse per recv() call, the rest per record.");
+    for (int stage = 0; stage < DNASerialProcessor::PIPELINE_STAGES; stage++) {
+        PipelineStage which = static_cast<PipelineStage>(stage);
+        LatencyHistogram merged;
+        for (const auto& server : servers) {
+            merged.merge(server->getStats().pipeline.snapshot(which));
         }
+        out.histogram("dna_server_stage_latency_seconds", merged,
+                      std::string("stage=\"") + DNASerialProcessor::stageName(which) + "\"");
     }
+    return out.str();
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [port] [options]" << std::endl;
+    std::cout << "\nOptions:" << std::endl;
+    std::cout << "  --reactors <n>          epoll reactor threads (default: one per core)" << std::endl;
+    std::cout << "  --workers <n>           Processing worker threads (default: one per core)" << std::endl;
+    std::cout << "  --max-clients <n>       Maximum simultaneous connections (default: " 
+              << MAX_CLIENTS << ")" << std::endl;
+    std::cout << "  --io-uring              Use io_uring for receives and storage writes" << std::endl;
+    std::cout << "                          (falls back to epoll if unsupported)" << std::endl;
+    std::cout << "  --queue-capacity <n>    Records queued or in flight (default: " 
+              << QUEUE_SIZE << ")" << std::endl;
+    std::cout << "  --credit-window <n>     Credits per flow-controlled client (default: " 
+              << CREDIT_WINDOW << ")" << std::endl;
+    std::cout << "  --batch-records <n>     Records a worker processes and stores together (default: "
+              << STORE_BATCH_RECORDS << ")" << std::endl;
+    std::cout << "  --batch-bytes <n>       Encoded bytes per storage write (default: "
+              << STORE_BATCH_BYTES << ")" << std::endl;
+    std::cout << "  --storage-dir <dir>     Segment log directory (default: " << STORAGE_DIR
+              << "; shards use <dir>/shard-<n>)" << std::endl;
+    std::cout << "  --segment-size <MB>     Segment file size before rollover (default: "
+              << (DNASerialProcessor::SEGMENT_DEFAULT_BYTES >> 20) << ")" << std::endl;
+    std::cout << "  --sync <none|batch|record>  ACK after the write (default), after a group" << std::endl;
+    std::cout << "                          commit, or after an fdatasync per storage write" << std::endl;
+    std::cout << "  --commit-records <n>    Group commit window: records (default: "
+              << DNASerialProcessor::GroupCommitConfig().maxRecords << ")" << std::endl;
+    std::cout << "  --commit-us <us>        Group commit window: microseconds (default: "
+              << DNASerialProcessor::GroupCommitConfig().maxDelayUs << ")" << std::endl;
+    std::cout << "  --commit-bytes <n>      Group commit window: bytes (default: "
+              << DNASerialProcessor::GroupCommitConfig().maxBytes << ")" << std::endl;
+    std::cout << "  --no-index              Do not keep the ID/name/checksum index (see dna_lookup)" << std::endl;
+    std::cout << "  --no-metadata           Do not keep the per-record metadata store (<dir>/metadata)" << std::endl;
+    std::cout << "  --checkpoint-ms <ms>    Checkpoint the log this often; a restart replays only" << std::endl;
+    std::cout << "                          what came after (default: " << CHECKPOINT_MS
+              << "; 0: at shutdown only)" << std::endl;
+    std::cout << "  --no-compress           Do not recompress cold segments in the background" << std::endl;
+    std::cout << "  --compress-after <min>  Recompress sealed segments idle this long (default: "
+              << DNASerialProcessor::CompactionConfig().minAgeSeconds / 60 << ")" << std::endl;
+    std::cout << "  --compress-io <MB/s>    Compaction I/O budget, read + written (default: "
+              << (DNASerialProcessor::CompactionConfig().ioBytesPerSecond >> 20) << ")" << std::endl;
+    std::cout << "  --compress-cpu <pct>    Compaction CPU budget, percent of one core (default: "
+              << DNASerialProcessor::CompactionConfig().cpuPercent << ")" << std::endl;
+    std::cout << "  --scheduler <drr|fifo>  Order records reach the workers: per-client deficit" << std::endl;
+    std::cout << "                          round-robin by bytes (default) or arrival order" << std::endl;
+    std::cout << "  --client-weight <id>=<w>  DRR weight for a client name (dna_client --client-id)" << std::endl;
+    std::cout << "                            or, for unnamed clients, an IP address; repeatable" << std::endl;
+    std::cout << "  --lanes <strict|edf>    Pick between priority lanes by priority (default) or" << std::endl;
+    std::cout << "                          earliest deadline" << std::endl;
+    std::cout << "  --deadline-miss <drop|demote>  Records past their deadline before dispatch:" << std::endl;
+    std::cout << "                          ACK_EXPIRED without processing (default) or LOW lane" << std::endl;
+    std::cout << "  --shm <path>            Also accept shared-memory clients on this Unix socket" << std::endl;
+    std::cout << "                          (epoll backend; e.g. " 
+              << DNASerialProcessor::SHM_DEFAULT_SOCKET << ")" << std::endl;
+    std::cout << "  --metrics-port <port>   Serve Prometheus metrics at http://<host>:<port>/metrics" << std::endl;
+    std::cout << "  --shards <n>            Shared-nothing shards on SO_REUSEPORT, each pinned" << std::endl;
+    std::cout << "                          to a core with its own reactor and worker (0: one per core)" << std::endl;
+}
+
+static volatile std::sig_atomic_t shutdownRequested = 0;
+
+static void requestShutdown(int) {
+    shutdownRequested = 1;
+}
+
+int main(int argc, char* argv[]) {
+    ServerConfig config;
     
-    DNAServer server(port);
+    // Parse arguments
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        
+        if (arg == "--reactors" && i + 1 < argc) {
+            config.reactorThreads = std::atoi(argv[++i]);
+        } else if (arg == "--workers" && i + 1 < argc) {
+            config.workerThreads = std::atoi(argv[++i]);
+        } else if (arg == "--max-clients" && i + 1 < argc) {
+            config.maxClients = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--io-uring") {
+            config.ioBackend = IoBackend::IO_URING;
+        } else if (arg == "--queue-capacity" && i + 1 < argc) {
+            config.queueCapacity = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--credit-window" && i + 1 < argc) {
+            config.creditWindow = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--batch-records" && i + 1 < argc) {
+            config.batchRecords = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--batch-bytes" && i + 1 < argc) {
+            config.batchBytes = std::max<long long>(1, std::atoll(argv[++i]));
+        } else if (arg == "--storage-dir" && i + 1 < argc) {
+            config.storageDir = argv[++i];
+        } else if (arg == "--segment-size" && i + 1 < argc) {
+            config.segmentBytes = static_cast<size_t>(std::max(1, std::atoi(argv[++i]))) << 20;
+        } else if (arg == "--sync" && i + 1 < argc) {
+            std::string policy = argv[++i];
+            config.syncPolicy = policy == "batch"  ? SyncPolicy::BATCH
+                              : policy == "record" ? SyncPolicy::RECORD : SyncPolicy::NONE;
+        } else if (arg == "--commit-records" && i + 1 < argc) {
+            config.commit.maxRecords = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--commit-us" && i + 1 < argc) {
+            config.commit.maxDelayUs = std::max<long long>(0, std::atoll(argv[++i]));
+        } else if (arg == "--commit-bytes" && i + 1 < argc) {
+            config.commit.maxBytes = std::max<long long>(1, std::atoll(argv[++i]));
+        } else if (arg == "--no-index") {
+            config.enableIndexing = false;
+        } else if (arg == "--no-metadata") {
+            config.enableMetadata = false;
+        } else if (arg == "--checkpoint-ms" && i + 1 < argc) {
+            config.checkpointMs = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--no-compress") {
+            config.compressOld = false;
+        } else if (arg == "--compress-after" && i + 1 < argc) {
+            config.compaction.minAgeSeconds = static_cast<uint64_t>(std::max(0, std::atoi(argv[++i]))) * 60;
+        } else if (arg == "--compress-io" && i + 1 < argc) {
+            config.compaction.ioBytesPerSecond = static_cast<uint64_t>(std::max(1, std::atoi(argv[++i]))) << 20;
+        } else if (arg == "--compress-cpu" && i + 1 < argc) {
+            config.compaction.cpuPercent = static_cast<uint32_t>(std::min(100, std::max(1, std::atoi(argv[++i]))));
+        } else if (arg == "--scheduler" && i + 1 < argc) {
+            std::string scheduler = argv[++i];
+            config.scheduler = scheduler == "fifo" ? Scheduler::FIFO : Scheduler::DRR;
+        } else if (arg == "--client-weight" && i + 1 < argc) {
+            std::string spec = argv[++i];
+            size_t eq = spec.rfind('=');
+            if (eq == std::string::npos || eq == 0) {
+                std::cerr << "Invalid --client-weight " << spec << " (expected <id>=<weight>)" << std::endl;
+                return 1;
+            }
+            config.clientWeights[spec.substr(0, eq)] = 
+                static_cast<uint32_t>(std::max(1, std::atoi(spec.c_str() + eq + 1)));
+        } else if (arg == "--lanes" && i + 1 < argc) {
+            std::string lanes = argv[++i];
+            config.lanePolicy = lanes == "edf" ? LanePolicy::EDF : LanePolicy::STRICT;
+        } else if (arg == "--deadline-miss" && i + 1 < argc) {
+            std::string policy = argv[++i];
+            config.deadlinePolicy = policy == "demote" ? DeadlinePolicy::DEMOTE : DeadlinePolicy::DROP;
+        } else if (arg == "--shm" && i + 1 < argc) {
+            config.shmSocket = argv[++i];
+        } else if (arg == "--metrics-port" && i + 1 < argc) {
+            config.metricsPort = std::atoi(argv[++i]);
+        } else if (arg == "--shards" && i + 1 < argc) {
+            int shards = std::atoi(argv[++i]);
+            config.shards = shards > 0 ? shards : std::max(1u, std::thread::hardware_concurrency());
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg[0] != '-') {
+            config.port = std::atoi(arg.c_str());
+        }
+    }
     
-    if (!server.start()) {
-        std::cerr << "Failed to start server" << std::endl;
+    if (config.port <= 0 || config.port > 65535) {
+        std::cerr << "Invalid port number" << std::endl;
         return 1;
     }
     
+    std::vector<std::unique_ptr<DNAServer>> servers;
+    if (config.shards > 0) {
+        // One single-threaded server per shard; limits are split between them
+        int cores = std::max(1u, std::thread::hardware_concurrency());
+        for (int i = 0; i < config.shards; i++) {
+            ServerConfig shard = config;
+            shard.shardIndex = i;
+            shard.cpuCore = i % cores;
+            shard.reactorThreads = 1;
+            shard.workerThreads = 1;
+            shard.queueCapacity = std::max(1, config.queueCapacity / config.shards);
+            shard.maxClients = std::max(1, config.maxClients / config.shards);
+            if (i > 0) shard.shmSocket.clear();   // One Unix socket path: shard 0 serves it
+            shard.storageDir = config.storageDir + "/shard-" + std::to_string(i);
+            servers.push_back(std::make_unique<DNAServer>(shard));
+        }
+        std::cout << "DNA Server: " << config.shards << " shards on port " << config.port 
+                  << " (SO_REUSEPORT)" << std::endl;
+    } else {
+        servers.push_back(std::make_unique<DNAServer>(config));
+    }
+    
+    std::signal(SIGINT, requestShutdown);
+    std::signal(SIGTERM, requestShutdown);
+
+    for (auto& server : servers) {
+        if (!server->start()) {
+            std::cerr << "Failed to start server" << std::endl;
+            return 1;
+        }
+    }
+    if (config.shards > 0) {
+        std::cout << "Waiting for clients..." << std::endl;
+    }
+    
+    // Scrapes render on the exporter's own thread, with its own meters
+    ServerMeters exportedMeters;
+    std::unique_ptr<DNASerialProcessor::MetricsHttpServer> metrics;
+    if (config.metricsPort > 0) {
+        metrics = std::make_unique<DNASerialProcessor::MetricsHttpServer>(
+            config.metricsPort,
+            [&] { return renderMetrics(servers, exportedMeters); },
+            [&] { exportedMeters.sample(servers); });
+        if (!metrics->start()) {
+            std::cerr << "Failed to bind metrics port " << config.metricsPort << std::endl;
+            return 1;
+        }
+        std::cout << "Metrics: http://0.0.0.0:" << config.metricsPort << "/metrics" << std::endl;
+    }
+    
     // Statistics loop
-    while (true) {
+    ServerMeters meters;
+    LatencyHistogram reportedStages[DNASerialProcessor::PIPELINE_STAGES];
+    for (int seconds = 1; !shutdownRequested; seconds++) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
-        printStats(server);
+        printStats(servers, meters);
+        if (seconds % LATENCY_REPORT_INTERVAL == 0) {
+            printLatencyReport(servers, reportedStages);
+        }
     }
     
+    // SIGINT/SIGTERM: store what was admitted and write a final checkpoint
+    metrics.reset();
+    servers.clear();
     return 0;
 }
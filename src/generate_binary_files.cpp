@@ -2,186 +2,122 @@
  * @file generate_binary_files.cpp
  * @brief Generate binary encoded DNA files from FASTA input
  * 
- * Creates .bin files with 2-bit DNA encoding:
+ * Creates .bin files with 2-bit DNA encoding (dna_binary_format.hpp):
  * - A = 00, T = 01, G = 10, C = 11
  * - 4 nucleotides per byte
- * - Includes metadata header
+ * - Version 2 container: 64-byte-aligned chunks with a CRC32C each,
+ *   then a name table and an index written last
+ * - Streamed: FASTA is read in --buffer-mb blocks (default 4) and each
+ *   chunk is written as it fills, so memory stays flat for any input size
+ * - Pipelined (dna_fasta_converter.hpp): files convert concurrently, with
+ *   parse + encode on a shared pool of --jobs threads; --recursive also
+ *   searches subdirectories
+ * - --direct-io: written with O_DIRECT (dna_direct_writer.hpp), bypassing
+ *   the page cache; the file gets zero padding and a footer page
+ * - x.fasta is written to x.bin; inputs that would share an output keep
+ *   their full name (x.fa.bin, x.fasta.bin), and a repeated input converts once
  * 
  * @date 2025-11-24
  */
 
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <string>
 #include <cstdint>
 #include <cstring>
+#include <cstdlib>
 #include <iomanip>
 #include <filesystem>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "dna_fasta_converter.hpp"
 
 namespace fs = std::filesystem;
 
-// Binary file header structure
-struct BinaryHeader {
-    char magic[8];           // "INCHRSIL" magic number
-    uint32_t version;        // File format version
-    uint64_t sequence_count; // Number of sequences
-    uint64_t total_bases;    // Total nucleotides
-    uint64_t compressed_size;// Size of compressed data
-    char reserved[32];       // Reserved for future use
-} __attribute__((packed));
+// Set by --direct-io
+static bool g_direct_io = false;
 
-// Sequence metadata
-struct SequenceInfo {
-    uint64_t length;         // Sequence length in bases
-    uint64_t offset;         // Offset in data section
-    char name[256];          // Sequence name
-} __attribute__((packed));
+// Set by --buffer-mb: bytes read per block, and DirectWriter's pool with --direct-io
+constexpr size_t DEFAULT_BUFFER_BYTES = 4 << 20;
+static size_t g_buffer_bytes = DEFAULT_BUFFER_BYTES;
+
+// Set by --jobs (0 = one per core) and --recursive
+static unsigned g_jobs = 0;
+static bool g_recursive = false;
 
 /**
- * @brief Encode DNA sequence to 2-bit binary
+ * @brief Print one finished file (called by the converter, one file at a time)
  */
-std::vector<uint8_t> encodeDNA(const std::string& sequence) {
-    size_t encoded_size = (sequence.length() + 3) / 4;  // 4 nucleotides per byte
-    std::vector<uint8_t> encoded(encoded_size, 0);
+void printConversion(const DNASerialProcessor::FastaConversion& file) {
+    std::ostringstream out;
+    if (!file.ok) {
+        out << "\n❌ " << file.input << ": " << file.error << "\n";
+        std::cerr << out.str() << std::flush;
+        return;
+    }
     
-    for (size_t i = 0; i < sequence.length(); i++) {
-        uint8_t bits;
-        switch(sequence[i]) {
-            case 'A': case 'a': bits = 0b00; break;
-            case 'T': case 't': bits = 0b01; break;
-            case 'G': case 'g': bits = 0b10; break;
-            case 'C': case 'c': bits = 0b11; break;
-            default: bits = 0b00; break;
-        }
-        
-        size_t byte_idx = i / 4;
-        size_t bit_pos = (3 - (i % 4)) * 2;  // MSB first
-        encoded[byte_idx] |= (bits << bit_pos);
+    out << "\n✅ Generated: " << file.output << "\n";
+    out << "   Sequences:  " << file.sequences << "\n";
+    out << "   Total bases: " << file.bases << " bp\n";
+    out << "   ASCII size:  " << file.bases << " bytes\n";
+    out << "   Binary size: " << file.packedBytes << " bytes\n";
+    out << "   Chunks:      " << file.chunks << " (CRC32C each)\n";
+    out << "   Total size:  " << file.outputBytes << " bytes\n";
+    if (g_direct_io) {
+        out << "   Written:     O_DIRECT where supported, padded to " << fs::file_size(file.output) << " bytes\n";
     }
     
-    return encoded;
+    double ratio = static_cast<double>(file.bases) / file.packedBytes;
+    out << "   Compression: " << std::fixed << std::setprecision(2) 
+        << ratio << ":1 (" << (100.0 * (1.0 - 1.0/ratio)) << "% savings)\n";
+    out << "   Throughput:  " << std::setprecision(1) << file.bytesRead / std::max(file.seconds, 1e-6) / 1e6
+        << " MB/s of FASTA (" << std::setprecision(2) << file.seconds << " s)\n";
+    std::cout << out.str() << std::flush;
 }
 
 /**
- * @brief Read FASTA file
+ * @brief One status line for the files in flight
  */
-struct FastaSequence {
-    std::string name;
-    std::string sequence;
-};
-
-std::vector<FastaSequence> readFASTA(const std::string& filename) {
-    std::vector<FastaSequence> sequences;
-    std::ifstream file(filename);
-    
-    if (!file.is_open()) {
-        std::cerr << "Error: Cannot open file " << filename << std::endl;
-        return sequences;
-    }
-    
-    FastaSequence current;
-    std::string line;
-    
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        
-        if (line[0] == '>') {
-            if (!current.sequence.empty()) {
-                sequences.push_back(current);
-                current.sequence.clear();
-            }
-            current.name = line.substr(1);
-        } else {
-            current.sequence += line;
-        }
-    }
-    
-    if (!current.sequence.empty()) {
-        sequences.push_back(current);
+void printProgress(const std::vector<DNASerialProcessor::FastaConversion>& active) {
+    std::ostringstream line;
+    line << "\r📈 " << active.size() << " in flight";
+    for (size_t i = 0; i < active.size() && i < 3; i++) {
+        line << " | " << fs::path(active[i].input).filename().string() << " "
+             << 100 * active[i].bytesRead / std::max<uint64_t>(active[i].inputBytes, 1) << "%";
     }
-    
-    file.close();
-    return sequences;
+    if (active.size() > 3) line << " | ...";
+    line << "          ";
+    std::cout << line.str() << std::flush;
+}
+
+static bool isFasta(const fs::path& path) {
+    std::string extension = path.extension().string();
+    return extension == ".fasta" || extension == ".fa";
 }
 
 /**
- * @brief Generate binary file from FASTA
+ * @brief FASTA files in `directory`, sorted; with --recursive also in its subdirectories
  */
-bool generateBinaryFile(const std::string& fasta_file, const std::string& output_file) {
-    // Read FASTA
-    auto sequences = readFASTA(fasta_file);
-    if (sequences.empty()) {
-        std::cerr << "No sequences found in " << fasta_file << std::endl;
-        return false;
-    }
-    
-    // Calculate totals
-    uint64_t total_bases = 0;
-    std::vector<std::vector<uint8_t>> encoded_sequences;
-    
-    for (const auto& seq : sequences) {
-        total_bases += seq.sequence.length();
-        encoded_sequences.push_back(encodeDNA(seq.sequence));
-    }
-    
-    uint64_t compressed_size = 0;
-    for (const auto& enc : encoded_sequences) {
-        compressed_size += enc.size();
-    }
-    
-    // Create output file
-    std::ofstream out(output_file, std::ios::binary);
-    if (!out.is_open()) {
-        std::cerr << "Error: Cannot create output file " << output_file << std::endl;
-        return false;
-    }
-    
-    // Write header
-    BinaryHeader header;
-    std::memcpy(header.magic, "INCHROSIL", 8);
-    header.version = 1;
-    header.sequence_count = sequences.size();
-    header.total_bases = total_bases;
-    header.compressed_size = compressed_size;
-    std::memset(header.reserved, 0, 32);
-    
-    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
-    
-    // Write sequence metadata
-    uint64_t data_offset = 0;
-    for (size_t i = 0; i < sequences.size(); i++) {
-        SequenceInfo info;
-        info.length = sequences[i].sequence.length();
-        info.offset = data_offset;
-        std::memset(info.name, 0, 256);
-        std::strncpy(info.name, sequences[i].name.c_str(), 255);
-        
-        out.write(reinterpret_cast<const char*>(&info), sizeof(info));
-        data_offset += encoded_sequences[i].size();
-    }
-    
-    // Write encoded data
-    for (const auto& enc : encoded_sequences) {
-        out.write(reinterpret_cast<const char*>(enc.data()), enc.size());
+std::vector<std::string> findFasta(const std::string& directory) {
+    std::vector<std::string> found;
+    std::error_code error;
+    auto options = fs::directory_options::skip_permission_denied;
+    if (g_recursive) {
+        for (fs::recursive_directory_iterator it(directory, options, error), end; !error && it != end; it.increment(error)) {
+            if (it->is_regular_file() && isFasta(it->path())) found.push_back(it->path().string());
+        }
+    } else {
+        for (fs::directory_iterator it(directory, options, error), end; !error && it != end; it.increment(error)) {
+            if (it->is_regular_file() && isFasta(it->path())) found.push_back(it->path().string());
+        }
     }
-    
-    out.close();
-    
-    // Print summary
-    std::cout << "\n✅ Generated: " << output_file << std::endl;
-    std::cout << "   Sequences:  " << sequences.size() << std::endl;
-    std::cout << "   Total bases: " << total_bases << " bp" << std::endl;
-    std::cout << "   ASCII size:  " << total_bases << " bytes" << std::endl;
-    std::cout << "   Binary size: " << compressed_size << " bytes" << std::endl;
-    std::cout << "   Header size: " << (sizeof(BinaryHeader) + sequences.size() * sizeof(SequenceInfo)) << " bytes" << std::endl;
-    std::cout << "   Total size:  " << (sizeof(BinaryHeader) + sequences.size() * sizeof(SequenceInfo) + compressed_size) << " bytes" << std::endl;
-    
-    double ratio = static_cast<double>(total_bases) / compressed_size;
-    std::cout << "   Compression: " << std::fixed << std::setprecision(2) 
-              << ratio << ":1 (" << (100.0 * (1.0 - 1.0/ratio)) << "% savings)" << std::endl;
-    
-    return true;
+    std::sort(found.begin(), found.end());
+    return found;
 }
 
 /**
@@ -208,64 +144,97 @@ int main(int argc, char* argv[]) {
     std::cout << "║            Raspberry Pi 5 - November 24, 2025                ║\n";
     std::cout << "╚══════════════════════════════════════════════════════════════╝\n\n";
     
-    if (argc > 1) {
-        // Process specified files
-        for (int i = 1; i < argc; i++) {
-            std::string fasta_file = argv[i];
-            std::string output_file = fasta_file;
-            
-            // Replace .fasta extension with .bin
-            size_t ext_pos = output_file.rfind(".fasta");
-            if (ext_pos != std::string::npos) {
-                output_file = output_file.substr(0, ext_pos) + ".bin";
-            } else {
-                output_file += ".bin";
-            }
-            
-            generateBinaryFile(fasta_file, output_file);
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--direct-io") {
+            g_direct_io = true;
+        } else if (arg == "--buffer-mb" && i + 1 < argc) {
+            g_buffer_bytes = std::max(1, std::atoi(argv[++i])) * (size_t(1) << 20);
+        } else if ((arg == "--jobs" || arg == "-j") && i + 1 < argc) {
+            g_jobs = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--recursive" || arg == "-r") {
+            g_recursive = true;
+        } else {
+            inputs.push_back(argv[i]);
         }
-    } else {
-        // Auto-discover FASTA files
-        std::cout << "🔍 Searching for FASTA files...\n\n";
-        
-        std::vector<std::string> fasta_files;
-        for (const auto& entry : fs::directory_iterator(".")) {
-            if (entry.is_regular_file()) {
-                std::string filename = entry.path().filename().string();
-                size_t len = filename.length();
-                if ((len > 6 && filename.substr(len-6) == ".fasta") || 
-                    (len > 3 && filename.substr(len-3) == ".fa")) {
-                    fasta_files.push_back(filename);
+    }
+    
+    std::vector<std::string> fasta_files;
+    if (!inputs.empty()) {
+        // Process specified files, and the FASTA files in specified directories
+        for (const std::string& fasta_file : inputs) {
+            if (fs::is_directory(fasta_file)) {
+                for (const auto& found : findFasta(fasta_file)) {
+                    fasta_files.push_back(found);
                 }
+                continue;
             }
+            fasta_files.push_back(fasta_file);
         }
+    } else {
+        // Auto-discover FASTA files
+        std::cout << "🔍 Searching for FASTA files" << (g_recursive ? " (recursive)" : "") << "...\n\n";
         
+        fasta_files = findFasta(".");
         if (fasta_files.empty()) {
             std::cout << "No FASTA files found in current directory.\n";
-            std::cout << "\nUsage: " << argv[0] << " [file1.fasta] [file2.fasta] ...\n";
+            std::cout << "\nUsage: " << argv[0]
+                      << " [--direct-io] [--buffer-mb N] [--jobs N] [--recursive] [file.fasta | directory] ...\n";
             return 1;
         }
         
         std::cout << "Found " << fasta_files.size() << " FASTA file(s):\n";
-        for (const auto& file : fasta_files) {
-            std::cout << "  • " << file << std::endl;
+        for (size_t i = 0; i < fasta_files.size() && i < 20; i++) {
+            std::cout << "  • " << fs::path(fasta_files[i]).lexically_relative(".").string() << std::endl;
         }
+        if (fasta_files.size() > 20) std::cout << "  • ... and " << fasta_files.size() - 20 << " more" << std::endl;
         std::cout << "\n";
-        
-        // Process all found FASTA files
-        for (const auto& fasta_file : fasta_files) {
-            std::string output_file = fasta_file;
-            size_t ext_pos = output_file.rfind('.');
-            if (ext_pos != std::string::npos) {
-                output_file = output_file.substr(0, ext_pos) + ".bin";
-            } else {
-                output_file += ".bin";
-            }
-            
-            generateBinaryFile(fasta_file, output_file);
-        }
     }
     
+    // x.fasta -> x.bin; x.fa and x.fasta side by side keep their full names (x.fa.bin, x.fasta.bin)
+    std::vector<DNASerialProcessor::FastaConversion> files = DNASerialProcessor::planConversions(fasta_files);
+    
+    // Convert: a reader and a writer per open file, parse + encode on a shared pool of --jobs threads
+    DNASerialProcessor::FastaConverterConfig config;
+    config.jobs = g_jobs;
+    config.blockBytes = g_buffer_bytes;
+    config.writer.directIO = g_direct_io;
+    config.writer.direct.cacheBytes = g_buffer_bytes;
+    DNASerialProcessor::FastaConverter converter(config);
+    std::cout << "⚙️  " << files.size() << " file(s), " << converter.config().jobs << " parse/encode threads, up to "
+              << std::min(converter.config().maxOpenFiles, files.size()) << " files at once, "
+              << formatSize(converter.config().maxBlocks * g_buffer_bytes) << " of blocks\n";
+    
+    bool interactive = isatty(STDOUT_FILENO);
+    auto started = std::chrono::steady_clock::now();
+    auto results = converter.convert(files,
+        [&](const DNASerialProcessor::FastaConversion& file) {
+            if (interactive) std::cout << "\r" << std::string(100, ' ') << "\r";
+            printConversion(file);
+        },
+        interactive ? DNASerialProcessor::FastaConverter::Progress(printProgress) : nullptr);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    
+    uint64_t converted = 0, read = 0, written = 0;
+    for (const auto& file : results) {
+        converted += file.ok;
+        read += file.bytesRead;
+        written += file.outputBytes;
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    
+    std::cout << "\n📊 " << converted << " of " << results.size() << " file(s) converted: "
+              << formatSize(read) << " of FASTA -> " << formatSize(written) << " in "
+              << std::fixed << std::setprecision(2) << seconds << " s ("
+              << std::setprecision(1) << read / std::max(seconds, 1e-6) / 1e6 << " MB/s, peak RSS "
+              << usage.ru_maxrss / 1024 << " MB)\n";
+    
+    if (converted != results.size()) {
+        std::cout << "\n⚠️  Some files failed\n";
+        return 1;
+    }
     std::cout << "\n✅ Binary file generation complete!\n";
     return 0;
 }
@@ -1,65 +1,37 @@
 /**
  * @file test_binary_files.cpp
  * @brief Test binary file reading and validation
- * 
- * Validates the generated .bin files:
- * - Header integrity
+ *
+ * Validates the generated .bin files (dna_binary_format.hpp):
+ * - Header integrity, version 1 or 2
+ * - Per-chunk CRC32C, checked in parallel (version 2)
  * - Data decompression
  * - Sequence reconstruction
- * 
+ *
+ * And the version 2 container itself:
+ * - Every version 1 file converts to version 2 with the same names and bases
+ * - Sequences split across chunks read back, also from arbitrary offsets
+ * - A damaged chunk is reported by number; a file without its trailer
+ *   does not open
+ * - Files written with --direct-io read back past their padding
+ *
  * @date 2025-11-24
  */
 
 #include <iostream>
+#include <chrono>
 #include <fstream>
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <iomanip>
+#include <thread>
 
-// Binary file header structure
-struct BinaryHeader {
-    char magic[8];
-    uint32_t version;
-    uint64_t sequence_count;
-    uint64_t total_bases;
-    uint64_t compressed_size;
-    char reserved[32];
-} __attribute__((packed));
-
-// Sequence metadata
-struct SequenceInfo {
-    uint64_t length;
-    uint64_t offset;
-    char name[256];
-} __attribute__((packed));
+#include "dna_binary_format.hpp"
 
-/**
- * @brief Decode 2-bit DNA to ASCII
- */
-std::string decodeDNA(const std::vector<uint8_t>& encoded, size_t length) {
-    std::string decoded;
-    decoded.reserve(length);
-    
-    for (size_t i = 0; i < length; i++) {
-        size_t byte_idx = i / 4;
-        size_t bit_pos = (3 - (i % 4)) * 2;
-        uint8_t bits = (encoded[byte_idx] >> bit_pos) & 0b11;
-        
-        char nucleotide;
-        switch(bits) {
-            case 0b00: nucleotide = 'A'; break;
-            case 0b01: nucleotide = 'T'; break;
-            case 0b10: nucleotide = 'G'; break;
-            case 0b11: nucleotide = 'C'; break;
-            default: nucleotide = 'N'; break;
-        }
-        decoded += nucleotide;
-    }
-    
-    return decoded;
-}
+using namespace DNASerialProcessor;
 
 /**
  * @brief Test binary file
@@ -67,68 +39,57 @@ std::string decodeDNA(const std::vector<uint8_t>& encoded, size_t length) {
 bool testBinaryFile(const std::string& filename) {
     std::cout << "\n📦 Testing: " << filename << std::endl;
     std::cout << std::string(70, '-') << std::endl;
-    
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "❌ Cannot open file" << std::endl;
-        return false;
-    }
-    
-    // Read header
-    BinaryHeader header;
-    file.read(reinterpret_cast<char*>(&header), sizeof(header));
-    
-    // Validate magic number
-    if (std::memcmp(header.magic, "INCHROSIL", 8) != 0) {
-        std::cerr << "❌ Invalid magic number" << std::endl;
+
+    BinaryFileReader file;
+    if (!file.open(filename)) {
+        std::cerr << "❌ Cannot open file, or not a valid .bin file" << std::endl;
         return false;
     }
-    std::cout << "✅ Magic number: INCHROSIL" << std::endl;
-    
+    std::cout << "✅ Magic number and " << (file.checksummed() ? "index CRC" : "sequence bounds") << std::endl;
+
     // Display header info
-    std::cout << "✅ Version: " << header.version << std::endl;
-    std::cout << "✅ Sequences: " << header.sequence_count << std::endl;
-    std::cout << "✅ Total bases: " << header.total_bases << " bp" << std::endl;
-    std::cout << "✅ Compressed size: " << header.compressed_size << " bytes" << std::endl;
-    
-    double ratio = static_cast<double>(header.total_bases) / header.compressed_size;
-    std::cout << "✅ Compression ratio: " << std::fixed << std::setprecision(2) 
+    std::cout << "✅ Version: " << file.version() << std::endl;
+    std::cout << "✅ Sequences: " << file.sequenceCount() << std::endl;
+    std::cout << "✅ Total bases: " << file.totalBases() << " bp" << std::endl;
+    std::cout << "✅ Compressed size: " << file.packedBytes() << " bytes" << std::endl;
+
+    double ratio = static_cast<double>(file.totalBases()) / file.packedBytes();
+    std::cout << "✅ Compression ratio: " << std::fixed << std::setprecision(2)
               << ratio << ":1 (" << (100.0 * (1.0 - 1.0/ratio)) << "% savings)" << std::endl;
-    
-    // Read sequence metadata
-    std::vector<SequenceInfo> sequences(header.sequence_count);
-    for (uint64_t i = 0; i < header.sequence_count; i++) {
-        file.read(reinterpret_cast<char*>(&sequences[i]), sizeof(SequenceInfo));
+
+    if (file.checksummed()) {
+        std::vector<uint64_t> bad;
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        if (file.validate(threads, &bad) != 0) {
+            std::cout << "❌ " << bad.size() << " of " << file.chunkCount() << " chunks fail their CRC (first: "
+                      << bad.front() << ")" << std::endl;
+            return false;
+        }
+        std::cout << "✅ " << file.chunkCount() << " chunks pass their CRC (" << threads << " threads)" << std::endl;
     }
-    
+
     std::cout << "\n📋 Sequences:" << std::endl;
-    for (uint64_t i = 0; i < header.sequence_count; i++) {
-        std::cout << "   " << (i + 1) << ". " << sequences[i].name 
-                  << " (" << sequences[i].length << " bp)" << std::endl;
-    }
-    
-    // Read and decode first sequence as verification
-    if (header.sequence_count > 0) {
-        size_t encoded_size = (sequences[0].length + 3) / 4;
-        std::vector<uint8_t> encoded_data(encoded_size);
-        
-        file.seekg(sizeof(BinaryHeader) + header.sequence_count * sizeof(SequenceInfo) + sequences[0].offset);
-        file.read(reinterpret_cast<char*>(encoded_data.data()), encoded_size);
-        
-        std::string decoded = decodeDNA(encoded_data, sequences[0].length);
-        
+    for (uint64_t i = 0; i < file.sequenceCount(); i++) {
+        std::cout << "   " << (i + 1) << ". " << file.name(i)
+                  << " (" << file.length(i) << " bp)" << std::endl;
+    }
+
+    // Decode first sequence as verification
+    if (file.sequenceCount() > 0) {
+        std::string decoded = file.sequence(0);
+
         std::cout << "\n🧬 First sequence decoded (first 60 bp):" << std::endl;
         std::cout << "   " << decoded.substr(0, std::min<size_t>(60, decoded.length())) << std::endl;
-        
+
         // Verify all bases are valid
-        bool valid = true;
+        bool valid = decoded.size() == file.length(0);
         for (char c : decoded) {
             if (c != 'A' && c != 'T' && c != 'G' && c != 'C') {
                 valid = false;
                 break;
             }
         }
-        
+
         if (valid) {
             std::cout << "✅ All nucleotides are valid (A, T, G, C)" << std::endl;
         } else {
@@ -136,27 +97,211 @@ bool testBinaryFile(const std::string& filename) {
             return false;
         }
     }
-    
-    file.close();
+
     std::cout << "\n✅ " << filename << " PASSED" << std::endl;
     return true;
 }
 
+//=============================================================================
+// Version 2 container
+//=============================================================================
+
+static int checksFailed = 0;
+
+static void check(bool condition, const std::string& name) {
+    std::cout << (condition ? "✅ " : "❌ ") << name << std::endl;
+    if (!condition) checksFailed++;
+}
+
+static std::string tempDirectory() {
+    char path[] = "/tmp/dna_binary_files_XXXXXX";
+    return mkdtemp(path) ? std::string(path) : std::string();
+}
+
+static void removeDirectory(const std::string& directory) {
+    std::string command = "rm -rf '" + directory + "'";
+    if (system(command.c_str()) != 0) std::cerr << "could not remove " << directory << std::endl;
+}
+
+// What the reader returns for `bases` as written: upper case, anything but ACGT as A
+static std::string packed(const std::string& bases) {
+    std::string expected = bases;
+    for (char& c : expected) {
+        c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+        if (c != 'A' && c != 'T' && c != 'G' && c != 'C') c = 'A';
+    }
+    return expected;
+}
+
+static std::string randomBases(size_t length, uint64_t& seed) {
+    static const char letters[] = "ACGTacgtN";
+    std::string bases(length, 'A');
+    for (char& c : bases) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        c = letters[(seed >> 33) % (seed % 97 == 0 ? 9 : 4)];
+    }
+    return bases;
+}
+
+static bool flipByte(const std::string& path, uint64_t offset) {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    char byte;
+    file.seekg(offset);
+    file.read(&byte, 1);
+    byte = static_cast<char>(byte ^ 0x5a);
+    file.seekp(offset);
+    file.write(&byte, 1);
+    return file.good();
+}
+
+// Converts with an odd chunk size, so short files span several chunks as well
+static bool convertedMatches(const std::string& v1, const std::string& v2) {
+    BinaryFileReader original;
+    if (!original.open(v1)) return false;
+    BinaryWriterConfig config;
+    config.chunkBases = 1000;   // Rounded to 1024
+    BinaryFileWriter writer(config);
+    writer.open(v2);
+    for (uint64_t i = 0; i < original.sequenceCount(); i++) {
+        std::string bases = original.sequence(i);
+        writer.beginSequence(original.name(i));
+        writer.append(bases.data(), bases.size());
+        writer.endSequence();
+    }
+    BinaryFileReader converted;
+    if (!writer.close() || !converted.open(v2) || converted.version() != BINARY_VERSION_2 ||
+        converted.sequenceCount() != original.sequenceCount() || converted.totalBases() != original.totalBases() ||
+        converted.validate(4) != 0) {
+        return false;
+    }
+    for (uint64_t i = 0; i < original.sequenceCount(); i++) {
+        if (converted.name(i) != original.name(i) || converted.sequence(i) != original.sequence(i)) return false;
+    }
+    return true;
+}
+
+bool testFormatV2(const std::vector<std::string>& v1Files) {
+    std::cout << "\n📦 Testing: version 2 container" << std::endl;
+    std::cout << std::string(70, '-') << std::endl;
+    int failedBefore = checksFailed;
+    std::string directory = tempDirectory();
+
+    bool converted = true;
+    for (const auto& file : v1Files) converted = converted && convertedMatches(file, directory + "/" + file);
+    check(converted, "every version 1 file converts with the same names and bases");
+
+    // Lengths around the chunk size, appended in uneven pieces
+    uint64_t seed = 42;
+    BinaryWriterConfig config;
+    config.chunkBases = 4096;
+    std::vector<std::string> names = {"chr1 with a name longer than the 255 bytes version 1 kept" + std::string(300, '.'),
+                                      "empty", "one", "exact", "exact_plus_one", "long"};
+    std::vector<std::string> sequences = {randomBases(10007, seed), "", "g", randomBases(8192, seed),
+                                          randomBases(4097, seed), randomBases(300001, seed)};
+    std::string path = directory + "/random.bin";
+    BinaryFileWriter writer(config);
+    bool written = writer.open(path);
+    for (size_t i = 0; i < sequences.size(); i++) {
+        written = written && writer.beginSequence(names[i]);
+        for (size_t at = 0, piece = 1; at < sequences[i].size(); at += piece, piece = piece * 3 % 1013 + 1) {
+            written = written && writer.append(sequences[i].data() + at, std::min(piece, sequences[i].size() - at));
+        }
+        written = written && writer.endSequence();
+    }
+    written = writer.close() && written;
+
+    BinaryFileReader reader;
+    bool same = written && reader.open(path) && reader.sequenceCount() == sequences.size() &&
+                reader.chunkBases() == 4096;
+    for (size_t i = 0; same && i < sequences.size(); i++) {
+        same = reader.name(i) == names[i] && reader.sequence(i) == packed(sequences[i]);
+    }
+    check(same, "sequences split across chunks read back (" + std::to_string(reader.chunkCount()) + " chunks)");
+
+    bool ranges = true;
+    std::string expected = packed(sequences.back());
+    std::string out;
+    for (int i = 0; i < 200; i++) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        uint64_t first = (seed >> 20) % expected.size();
+        uint64_t count = (seed >> 8) % 9000;
+        ranges = ranges && reader.bases(sequences.size() - 1, first, count, out) &&
+                 out == expected.substr(first, count);
+    }
+    check(ranges, "ranges from arbitrary offsets match");
+    check(reader.validate(4) == 0 && reader.fileSize() % 8 == 0, "every chunk passes its CRC");
+    reader.close();
+
+    // Damage one chunk's bases: exactly that chunk is reported
+    BinaryFileReader clean;
+    clean.open(path);
+    uint64_t target = clean.chunkCount() / 2;
+    uint64_t offset = clean.chunk(target).offset;
+    clean.close();
+    std::vector<uint64_t> bad;
+    BinaryFileReader damaged;
+    check(flipByte(path, offset + sizeof(BinaryChunkHeader) + 17) && damaged.open(path) &&
+          damaged.validate(4, &bad) == 1 && bad.front() == target,
+          "a damaged chunk is reported by number (" + std::to_string(target) + ")");
+    damaged.close();
+
+    std::string truncated = directory + "/truncated.bin";
+    std::string command = "head -c -64 '" + path + "' > '" + truncated + "'";
+    BinaryFileReader partial;
+    check(system(command.c_str()) == 0 && !partial.open(truncated), "a file without its trailer does not open");
+
+    // 32 Mbp: validation on one thread, then on all
+    std::string large = directory + "/large.bin";
+    BinaryFileWriter big;
+    big.open(large);
+    big.beginSequence("large");
+    std::string block = randomBases(1 << 20, seed);
+    for (int i = 0; i < 32; i++) big.append(block.data(), block.size());
+    BinaryFileReader largeFile;
+    bool opened = big.close() && largeFile.open(large);
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    auto start = std::chrono::steady_clock::now();
+    bool oneThread = opened && largeFile.validate(1) == 0;
+    double serial = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    bool allThreads = opened && largeFile.validate(threads) == 0;
+    double parallel = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    check(oneThread && allThreads, "32 Mbp validated: " + std::to_string(static_cast<int>(serial * 1000)) +
+          " ms on 1 thread, " + std::to_string(static_cast<int>(parallel * 1000)) + " ms on " +
+          std::to_string(threads));
+    largeFile.close();
+
+    BinaryWriterConfig directConfig;
+    directConfig.directIO = true;
+    BinaryFileWriter direct(directConfig);
+    std::string directPath = directory + "/direct.bin";
+    direct.open(directPath);
+    direct.beginSequence("direct");
+    direct.append(sequences[0].data(), sequences[0].size());
+    BinaryFileReader directFile;
+    check(direct.close() && directFile.open(directPath) && directFile.sequence(0) == packed(sequences[0]) &&
+          directFile.validate() == 0, "a --direct-io file reads back past its padding");
+    directFile.close();
+
+    removeDirectory(directory);
+    return checksFailed == failedBefore;
+}
+
 int main() {
     std::cout << "╔══════════════════════════════════════════════════════════════╗\n";
     std::cout << "║          Binary DNA File Validation Test Suite              ║\n";
     std::cout << "║            Raspberry Pi 5 - November 24, 2025               ║\n";
     std::cout << "╚══════════════════════════════════════════════════════════════╝\n";
-    
+
     std::vector<std::string> test_files = {
         "test_custom.bin",
         "test_sequences.bin",
         "large_genome.bin"
     };
-    
+
     int passed = 0;
     int failed = 0;
-    
+
     for (const auto& file : test_files) {
         if (testBinaryFile(file)) {
             passed++;
@@ -164,13 +309,25 @@ int main() {
             failed++;
         }
     }
-    
+
+    // Version 1 inputs only; files regenerated by generate_binary_files are version 2 already
+    std::vector<std::string> v1_files;
+    for (const auto& file : test_files) {
+        BinaryFileReader reader;
+        if (reader.open(file) && reader.version() == BINARY_VERSION_1) v1_files.push_back(file);
+    }
+    if (testFormatV2(v1_files)) {
+        passed++;
+    } else {
+        failed++;
+    }
+
     std::cout << "\n" << std::string(70, '=') << std::endl;
     std::cout << "📊 SUMMARY" << std::endl;
     std::cout << std::string(70, '=') << std::endl;
     std::cout << "✅ Passed: " << passed << " / " << (passed + failed) << std::endl;
     std::cout << "❌ Failed: " << failed << " / " << (passed + failed) << std::endl;
-    
+
     if (failed == 0) {
         std::cout << "\n🎉 ALL TESTS PASSED - Binary files are valid!\n" << std::endl;
         return 0;
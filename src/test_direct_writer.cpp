@@ -0,0 +1,193 @@
+/**
+ * @file test_direct_writer.cpp
+ * @brief Tests for the O_DIRECT block writer (dna_direct_writer.hpp)
+ *
+ * - Bytes read back exactly, across block boundaries and with odd write sizes
+ * - The file is page-aligned; the footer gives the logical length
+ * - Tails that leave no room for the footer page in the last block
+ * - A two-block pool (pure double buffering) still writes everything
+ * - Files without a footer are not mistaken for direct-written ones
+ *
+ * @date 2025-11-24
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dna_direct_writer.hpp"
+
+using namespace DNASerialProcessor;
+
+static int passed = 0;
+static int failed = 0;
+
+static void check(bool condition, const std::string& name) {
+    if (condition) {
+        std::cout << "  ✅ " << name << std::endl;
+        passed++;
+    } else {
+        std::cout << "  ❌ " << name << std::endl;
+        failed++;
+    }
+}
+
+static std::string makeData(size_t size, unsigned seed) {
+    std::string data(size, '\0');
+    for (size_t i = 0; i < size; i++) data[i] = "ACGT"[(i * 7 + seed + i / 13) % 4];
+    return data;
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+static uint64_t fileSize(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+}
+
+/**
+ * @brief Write `data` in pieces of varying size; true if it reads back intact
+ */
+static bool roundTrip(const std::string& path, const std::string& data, const DirectWriterConfig& config,
+                      bool* direct = nullptr) {
+    DirectWriter writer(config);
+    if (!writer.open(path)) return false;
+    if (direct) *direct = writer.isDirect();
+    size_t offset = 0;
+    for (size_t step = 1; offset < data.size(); step = step * 3 % 10007 + 1) {
+        size_t n = std::min(step, data.size() - offset);
+        if (!writer.write(data.data() + offset, n)) return false;
+        offset += n;
+    }
+    if (!writer.close() || writer.size() != data.size()) return false;
+
+    uint64_t logical = 0;
+    std::string contents = readFile(path);
+    return DirectWriter::readLogicalSize(path, logical) && logical == data.size() &&
+           contents.compare(0, data.size(), data) == 0;
+}
+
+static void testRoundTrip(const std::string& directory) {
+    std::cout << "\n📝 Round trip" << std::endl;
+
+    DirectWriterConfig config;
+    config.blockSize = 64 << 10;
+    std::string path = directory + "/large.bin";
+    std::string data = makeData((1 << 20) + 12345, 1);
+    bool direct = false;
+    check(roundTrip(path, data, config, &direct), "1 MB + 12345 bytes in odd-sized writes read back");
+    std::cout << "     (" << (direct ? "O_DIRECT" : "buffered fallback: filesystem refused O_DIRECT")
+              << ")" << std::endl;
+
+    uint64_t size = fileSize(path);
+    check(size % DIRECT_IO_ALIGN == 0 && size >= data.size() + DIRECT_IO_ALIGN &&
+          size < data.size() + 2 * DIRECT_IO_ALIGN,
+          "file is the data padded to a page plus one footer page (" + std::to_string(size) + " bytes)");
+
+    std::string contents = readFile(path);
+    check(contents.find_first_not_of('\0', data.size()) == size - sizeof(DirectFileFooter),
+          "padding is zeros up to the footer");
+
+    path = directory + "/empty.bin";
+    check(roundTrip(path, std::string(), config) && fileSize(path) == DIRECT_IO_ALIGN,
+          "an empty file is just the footer page");
+}
+
+static void testTails(const std::string& directory) {
+    std::cout << "\n✂️  Tails" << std::endl;
+
+    DirectWriterConfig config;
+    config.blockSize = 16 << 10;
+    bool all = true;
+    std::string sizes;
+    // The last block full, one page short, one byte short, exactly aligned
+    for (size_t size : {size_t(16 << 10), size_t(12 << 10), size_t((16 << 10) - 1), size_t((16 << 10) + 1),
+                        size_t(3 * 4096), size_t(1)}) {
+        bool ok = roundTrip(directory + "/tail.bin", makeData(size, static_cast<unsigned>(size)), config);
+        all = all && ok;
+        if (!ok) sizes += " " + std::to_string(size);
+    }
+    check(all, "tails at and around block and page boundaries" + (all ? "" : " (failed:" + sizes + ")"));
+
+    config.blockSize = 1000;
+    DirectWriter writer(config);
+    check(writer.blockSize() == DIRECT_IO_ALIGN, "block size rounds up to the page size");
+}
+
+static void testSmallPool(const std::string& directory) {
+    std::cout << "\n🔁 Double buffering" << std::endl;
+
+    DirectWriterConfig config;
+    config.blockSize = 8 << 10;
+    config.cacheBytes = 0;   // Clamped to two blocks
+    std::string path = directory + "/pool.bin";
+    std::string data = makeData(4 << 20, 7);
+
+    DirectWriter writer(config);
+    bool ok = writer.open(path);
+    for (size_t offset = 0; ok && offset < data.size(); offset += 3000) {
+        ok = writer.write(data.data() + offset, std::min<size_t>(3000, data.size() - offset));
+    }
+    ok = writer.close() && ok;
+    check(ok && writer.blocksAllocated() == 2, "4 MB through a pool of two 8 KB blocks");
+    check(readFile(path).compare(0, data.size(), data) == 0, "contents intact");
+
+    check(writer.open(path) && writer.write("ACGT", 4) && writer.close() && fileSize(path) == 2 * DIRECT_IO_ALIGN,
+          "reopen truncates and reuses the pool");
+}
+
+static void testForeignFiles(const std::string& directory) {
+    std::cout << "\n🚫 Files without a footer" << std::endl;
+
+    std::string path = directory + "/plain.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        std::string data = makeData(3 * DIRECT_IO_ALIGN, 3);
+        out.write(data.data(), data.size());
+    }
+    uint64_t logical = 0;
+    check(!DirectWriter::readLogicalSize(path, logical), "a plain file has no logical size");
+    check(!DirectWriter::readLogicalSize(directory + "/missing.bin", logical), "a missing file neither");
+
+    DirectWriter writer;
+    check(!writer.write("A", 1) && !writer.close(), "writes before open() fail");
+}
+
+int main() {
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║              Direct Writer Tests                             ║" << std::endl;
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+
+    // Under the working directory: /tmp is often tmpfs, which refuses O_DIRECT
+    char path[] = "dna_direct_XXXXXX";
+    std::string directory = mkdtemp(path) ? path : ".";
+
+    testRoundTrip(directory);
+    testTails(directory);
+    testSmallPool(directory);
+    testForeignFiles(directory);
+
+    std::string command = "rm -rf '" + directory + "'";
+    if (directory != "." && system(command.c_str()) != 0) std::cerr << "could not remove " << directory << std::endl;
+
+    std::cout << "\n✅ Passed: " << passed << " / " << (passed + failed) << std::endl;
+    std::cout << "❌ Failed: " << failed << " / " << (passed + failed) << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n🎉 ALL TESTS PASSED\n" << std::endl;
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,297 @@
+/**
+ * @file test_fasta_converter.cpp
+ * @brief Tests for the pipelined FASTA converter (dna_fasta_converter.hpp)
+ *
+ * - Output is byte-identical to a sequential conversion, with 4 KB blocks
+ *   cutting lines, long headers, a line longer than a block and CRLF input
+ * - Many files with several threads: every file converts, results come
+ *   back in order, done() once per file
+ * - A missing input or a file without sequences fails alone, leaving no output
+ * - A one-block budget still converts several open files
+ * - Progress reports the files in flight
+ * - x.fa and x.fasta side by side get distinct outputs; a repeated input
+ *   converts once; an output that is taken fails without touching it
+ *
+ * @date 2025-11-24
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+
+#include "dna_fasta_converter.hpp"
+
+using namespace DNASerialProcessor;
+
+static int passed = 0;
+static int failed = 0;
+
+static void check(bool condition, const std::string& name) {
+    if (condition) {
+        std::cout << "  ✅ " << name << std::endl;
+        passed++;
+    } else {
+        std::cout << "  ❌ " << name << std::endl;
+        failed++;
+    }
+}
+
+static std::string tempDirectory() {
+    char path[] = "/tmp/dna_fasta_converter_XXXXXX";
+    return mkdtemp(path) ? std::string(path) : std::string();
+}
+
+static void removeDirectory(const std::string& directory) {
+    std::string command = "rm -rf '" + directory + "'";
+    if (system(command.c_str()) != 0) std::cerr << "could not remove " << directory << std::endl;
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+static void writeFile(const std::string& path, const std::string& contents) {
+    std::ofstream(path, std::ios::binary) << contents;
+}
+
+static std::string bases(size_t length, uint64_t& seed) {
+    std::string out(length, 'A');
+    for (char& c : out) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        c = "ACGTacgtN"[(seed >> 33) % 9];
+    }
+    return out;
+}
+
+static std::string fasta(uint64_t seed, int sequences, size_t maxLength, size_t width) {
+    std::string out;
+    for (int i = 0; i < sequences; i++) {
+        out += ">seq" + std::to_string(i) + " seed " + std::to_string(seed) + "\n";
+        std::string s = bases(seed % maxLength + i * 37, seed);
+        for (size_t at = 0; at < s.size(); at += width) out += s.substr(at, width) + "\n";
+    }
+    return out;
+}
+
+/**
+ * @brief The sequential conversion: whole lines, BinaryFileWriter::append()
+ */
+static bool convertSequentially(const std::string& input, const std::string& output,
+                                const BinaryWriterConfig& config) {
+    std::istringstream in(readFile(input));
+    BinaryFileWriter writer(config);
+    if (!writer.open(output)) return false;
+    std::string line, name;
+    bool inSequence = false;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        if (line[0] == '>') {
+            if (inSequence) writer.endSequence();
+            inSequence = false;
+            name = line.substr(1);
+        } else {
+            if (!inSequence) writer.beginSequence(name);
+            inSequence = true;
+            writer.append(line.data(), line.size());
+        }
+    }
+    return writer.close();
+}
+
+static bool sameAsSequential(const FastaConversion& file, const BinaryWriterConfig& config = BinaryWriterConfig()) {
+    std::string reference = file.output + ".ref";
+    return file.ok && convertSequentially(file.input, reference, config) &&
+           readFile(reference) == readFile(file.output);
+}
+
+static FastaConversion job(const std::string& input) {
+    FastaConversion file;
+    file.input = input;
+    file.output = input + ".bin";
+    return file;
+}
+
+static void testEdges(const std::string& directory) {
+    std::cout << "\n✂️  Block boundaries" << std::endl;
+
+    uint64_t seed = 5;
+    std::vector<FastaConversion> files;
+    writeFile(directory + "/lines.fa", fasta(11, 40, 9000, 61));
+    writeFile(directory + "/header.fa", ">" + std::string(10000, 'h') + "\n" + bases(5000, seed) + "\n>short\nACGT");
+    writeFile(directory + "/oneline.fa", "ACGTTTGA\n>empty\n>long\n" + bases(50001, seed) + "\n>after\nGGCC\n");
+    std::string crlf = fasta(12, 10, 3000, 70);
+    std::string converted;
+    for (char c : crlf) converted += c == '\n' ? std::string("\r\n") : std::string(1, c);
+    writeFile(directory + "/crlf.fa", converted);
+    for (const char* name : {"lines.fa", "header.fa", "oneline.fa", "crlf.fa"}) {
+        files.push_back(job(directory + "/" + name));
+    }
+
+    FastaConverterConfig config;
+    config.jobs = 3;
+    config.blockBytes = 4096;
+    config.writer.chunkBases = 1024;
+    FastaConverter converter(config);
+    auto results = converter.convert(files);
+
+    for (const auto& result : results) {
+        check(sameAsSequential(result, config.writer), result.input.substr(directory.size() + 1) +
+              " is byte-identical to a sequential conversion (" + std::to_string(result.sequences) + " sequences)");
+    }
+    BinaryFileReader reader;
+    check(reader.open(results[2].output) && reader.sequenceCount() == 3 && reader.name(0).empty() &&
+          reader.name(1) == "long" && reader.length(1) == 50001,
+          "bases before the first header are kept, a header without bases is dropped");
+}
+
+static void testManyFiles(const std::string& directory) {
+    std::cout << "\n📚 Many files" << std::endl;
+
+    std::vector<FastaConversion> files;
+    for (int i = 0; i < 40; i++) {
+        std::string path = directory + "/many" + std::to_string(i) + ".fasta";
+        writeFile(path, fasta(100 + i, 1 + i % 7, 20000 + i * 1000, 60 + i % 21));
+        files.push_back(job(path));
+    }
+    FastaConverterConfig config;
+    config.jobs = 4;
+    config.maxOpenFiles = 3;
+    config.blockBytes = 16 << 10;
+    FastaConverter converter(config);
+    std::multiset<std::string> reported;
+    auto results = converter.convert(files, [&](const FastaConversion& file) { reported.insert(file.input); });
+
+    bool ordered = results.size() == files.size();
+    bool identical = ordered;
+    for (size_t i = 0; ordered && i < files.size(); i++) {
+        ordered = results[i].input == files[i].input && results[i].done;
+        identical = identical && sameAsSequential(results[i]) && results[i].bytesRead == results[i].inputBytes;
+    }
+    check(ordered, "results come back in the order given");
+    check(identical, "40 files on 4 threads, 3 open at once: every one identical to a sequential conversion");
+    bool once = reported.size() == files.size();
+    for (const auto& file : files) once = once && reported.count(file.input) == 1;
+    check(once, "done() is called once per file");
+
+    // One block for every file: the writers drain it in turn
+    config.maxBlocks = 1;
+    FastaConverter tight(config);
+    auto squeezed = tight.convert(std::vector<FastaConversion>(files.begin(), files.begin() + 8));
+    bool converted = squeezed.size() == 8;
+    for (const auto& file : squeezed) converted = converted && sameAsSequential(file);
+    check(converted, "a one-block budget still converts 3 open files");
+}
+
+static void testFailures(const std::string& directory) {
+    std::cout << "\n🚫 Failures" << std::endl;
+
+    writeFile(directory + "/good.fa", fasta(7, 3, 5000, 60));
+    writeFile(directory + "/headers.fa", ">one\n>two\n\n");
+    std::vector<FastaConversion> files = {job(directory + "/missing.fa"), job(directory + "/good.fa"),
+                                          job(directory + "/headers.fa")};
+    FastaConverterConfig config;
+    config.jobs = 2;
+    FastaConverter converter(config);
+    auto results = converter.convert(files);
+
+    check(!results[0].ok && results[0].error.find("cannot open") != std::string::npos &&
+          access(results[0].output.c_str(), F_OK) != 0,
+          "a missing input fails: " + results[0].error.substr(0, results[0].error.find(':')));
+    check(!results[2].ok && access(results[2].output.c_str(), F_OK) != 0,
+          "a file without sequences fails and leaves no output");
+    check(sameAsSequential(results[1]), "the other file converts");
+}
+
+static void testProgress(const std::string& directory) {
+    std::cout << "\n📈 Progress" << std::endl;
+
+    std::string path = directory + "/large.fa";
+    writeFile(path, fasta(3, 30, 400000, 80));
+    FastaConverterConfig config;
+    config.jobs = 2;
+    config.blockBytes = 64 << 10;
+    config.maxBlocks = 2;
+    config.progressMs = 1;
+    FastaConverter converter(config);
+    size_t calls = 0;
+    bool sane = true;
+    auto results = converter.convert({job(path)}, nullptr, [&](const std::vector<FastaConversion>& active) {
+        calls++;
+        for (const auto& file : active) sane = sane && !file.done && file.bytesRead <= file.inputBytes;
+    });
+    check(results[0].ok && sane, "progress reports files in flight, read bytes within the input (" +
+          std::to_string(calls) + " reports)");
+}
+
+static void testCollisions(const std::string& directory) {
+    std::cout << "\n🏷️  Output names" << std::endl;
+
+    std::string fa = fasta(21, 2, 3000, 60);
+    std::string fastaText = fasta(22, 3, 3000, 60);
+    writeFile(directory + "/x.fa", fa);
+    writeFile(directory + "/x.fasta", fastaText);
+    writeFile(directory + "/y.fasta", fasta(23, 1, 3000, 60));
+    auto files = planConversions({directory + "/x.fa", directory + "/x.fasta", directory + "/y.fasta",
+                                  directory + "/./y.fasta"});
+    check(files.size() == 3 && files[0].output == directory + "/x.fa.bin" &&
+          files[1].output == directory + "/x.fasta.bin" && files[2].output == directory + "/y.bin",
+          "x.fa and x.fasta keep their full names, y.fasta -> y.bin, the repeated y.fasta is dropped");
+
+    FastaConverterConfig config;
+    config.jobs = 2;
+    FastaConverter converter(config);
+    auto results = converter.convert(files);
+    bool converted = results.size() == 3;
+    for (const auto& file : results) converted = converted && sameAsSequential(file);
+    check(converted && results[0].sequences == 2 && results[1].sequences == 3,
+          "each colliding input converts into its own file");
+
+    // Built by hand: both to x.bin, and one onto an input
+    std::string before = readFile(directory + "/x.fasta.bin");
+    std::vector<FastaConversion> clashing = {job(directory + "/x.fa"), job(directory + "/x.fasta"),
+                                             job(directory + "/y.fasta")};
+    clashing[0].output = clashing[1].output = directory + "/x.fasta.bin";
+    clashing[2].output = directory + "/x.fa";
+    results = converter.convert(clashing);
+    check(results[0].ok && !results[1].ok && results[1].error.find("also written for") != std::string::npos,
+          "a repeated output fails, naming the file that writes it");
+    check(!results[2].ok && results[2].error.find("overwrite the input") != std::string::npos &&
+          readFile(directory + "/x.fa") == fa,
+          "an output onto an input fails and leaves the input alone");
+    check(readFile(directory + "/x.fasta.bin") != before && sameAsSequential(results[0]),
+          "the first claim on an output is the one written");
+}
+
+int main() {
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║              FASTA Converter Tests                           ║" << std::endl;
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+
+    std::string directory = tempDirectory();
+    testEdges(directory);
+    testManyFiles(directory);
+    testFailures(directory);
+    testProgress(directory);
+    testCollisions(directory);
+    removeDirectory(directory);
+
+    std::cout << "\n✅ Passed: " << passed << " / " << (passed + failed) << std::endl;
+    std::cout << "❌ Failed: " << failed << " / " << (passed + failed) << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n🎉 ALL TESTS PASSED\n" << std::endl;
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,218 @@
+/**
+ * @file test_latency_histogram.cpp
+ * @brief Tests for the latency histograms (dna_latency_histogram.hpp)
+ *
+ * - Percentiles within the 6.25% bucket error; weighted samples; since()
+ * - Concurrent recording from several threads loses no samples
+ * - Snapshots taken while threads record are consistent and monotonic
+ * - Pipeline stages are kept apart
+ * - ProcessorStats: counting a sequence records its latency
+ * - Prometheus export (dna_metrics.hpp): cumulative buckets, sliding rates
+ *
+ * @date 2025-11-24
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cmath>
+
+#include "dna_latency_histogram.hpp"
+#include "dna_metrics.hpp"
+#include "dna_serial_processor.hpp"
+
+using namespace DNASerialProcessor;
+
+static int passed = 0;
+static int failed = 0;
+
+static void check(bool condition, const std::string& name) {
+    if (condition) {
+        std::cout << "  ✅ " << name << std::endl;
+        passed++;
+    } else {
+        std::cout << "  ❌ " << name << std::endl;
+        failed++;
+    }
+}
+
+static bool within(uint64_t reported, double expected, double tolerance) {
+    return std::fabs(static_cast<double>(reported) - expected) <= expected * tolerance;
+}
+
+static void testPercentiles() {
+    std::cout << "\n📊 Percentiles" << std::endl;
+
+    LatencyHistogram histogram;
+    for (uint64_t ns = 1; ns <= 1000000; ns++) histogram.record(ns * 1000);
+    check(histogram.count() == 1000000, "count() matches the samples recorded");
+    check(within(histogram.percentile(50), 500e6, 0.0625) &&
+          within(histogram.percentile(99), 990e6, 0.0625) &&
+          within(histogram.percentile(99.9), 999e6, 0.0625),
+          "p50 / p99 / p99.9 of 1 us .. 1 s within 6.25%");
+    check(histogram.percentile(100) == histogram.max() && histogram.max() == 1000000000ull,
+          "p100 is the exact maximum");
+    check(within(static_cast<uint64_t>(histogram.mean()), 500.0005e6, 1e-9), "mean() is exact");
+
+    LatencyHistogram small;
+    for (uint64_t ns = 0; ns < 16; ns++) small.record(ns);
+    check(small.percentile(50) == 7, "values below 16 ns get their own bucket");
+
+    LatencyHistogram weighted;
+    weighted.record(1000, 99);
+    weighted.record(1000000, 1);
+    check(weighted.count() == 100 && within(weighted.percentile(99), 1000, 0.0625) &&
+          weighted.percentile(100) == 1000000,
+          "record(ns, count): a batch counts once per record");
+
+    LatencyHistogram earlier = weighted;
+    weighted.record(5000, 10);
+    LatencyHistogram delta = weighted.since(earlier);
+    check(delta.count() == 10 && within(delta.percentile(50), 5000, 0.0625),
+          "since() leaves only the samples after the earlier snapshot");
+
+    LatencyHistogram huge;
+    huge.record(~0ull);
+    check(huge.count() == 1 && huge.percentile(50) == ~0ull, "values past the range clamp, not overflow");
+}
+
+static void testConcurrentRecording() {
+    std::cout << "\n🧵 Concurrent recording" << std::endl;
+
+    constexpr int THREADS = 4;
+    constexpr uint64_t PER_THREAD = 500000;
+    ConcurrentHistogram histogram;
+
+    std::atomic<bool> done{false};
+    std::atomic<bool> monotonic{true};
+    std::atomic<bool> consistent{true};
+    std::thread reader([&] {
+        uint64_t last = 0;
+        while (!done.load()) {
+            LatencyHistogram snapshot = histogram.snapshot();
+            if (snapshot.count() < last) monotonic = false;
+            if (snapshot.count() > 0 && snapshot.percentile(100) > snapshot.max()) consistent = false;
+            last = snapshot.count();
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < THREADS; t++) {
+        writers.emplace_back([&, t] {
+            for (uint64_t i = 0; i < PER_THREAD; i++) {
+                histogram.record((t + 1) * 1000 + i % 100);
+            }
+        });
+    }
+    for (auto& writer : writers) writer.join();
+    done = true;
+    reader.join();
+
+    LatencyHistogram merged = histogram.snapshot();
+    check(merged.count() == THREADS * PER_THREAD, "2M samples from 4 threads, none lost");
+    check(merged.max() == THREADS * 1000 + 99, "max() merged across shards");
+    check(within(merged.percentile(25), 1099, 0.0625) && within(merged.percentile(99), 4099, 0.0625),
+          "each thread's samples land in the right buckets");
+    check(monotonic, "snapshots during recording never go backwards");
+    check(consistent, "snapshots during recording stay consistent");
+
+    ConcurrentHistogram other;
+    other.record(42);
+    check(other.snapshot().count() == 1 && histogram.snapshot().count() == THREADS * PER_THREAD,
+          "two histograms on one thread keep separate shards");
+}
+
+static void testPipelineStages() {
+    std::cout << "\n🏭 Pipeline stages" << std::endl;
+
+    PipelineLatency pipeline;
+    pipeline.record(PipelineStage::VALIDATE, 2000, 256);
+    pipeline.record(PipelineStage::STORE, 50000);
+    check(pipeline.snapshot(PipelineStage::VALIDATE).count() == 256 &&
+          pipeline.snapshot(PipelineStage::STORE).count() == 1 &&
+          pipeline.snapshot(PipelineStage::ENCODE).count() == 0,
+          "stages recorded separately");
+    check(std::string(stageName(PipelineStage::RECEIVE)) == "receive" &&
+          std::string(stageName(PipelineStage::TOTAL)) == "total",
+          "stage names");
+
+    uint64_t before = PipelineLatency::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    check(PipelineLatency::now() - before >= 2000000, "now() is a nanosecond steady clock");
+}
+
+static void testProcessorStats() {
+    std::cout << "\n📊 Processor statistics" << std::endl;
+
+    ProcessorStats stats;
+    check(stats.getLatencyPercentileMs(99) == 0 && stats.getAverageLatencyMs() == 0, "empty: no latency");
+
+    for (int i = 0; i < 20; i++) {
+        uint64_t received = PipelineLatency::now();
+        uint64_t stored = received;
+        while (PipelineLatency::now() - received < 1000000) {}   // ~1 ms from receipt to storage
+        stats.recordStage(PipelineStage::STORE, stored);
+        stats.recordSequence(4096, received);
+    }
+    check(stats.totalSequences.load() == 20 && stats.totalBytesProcessed.load() == 20 * 4096,
+          "recordSequence() counts sequences and bytes");
+    check(stats.getLatencyPercentileMs(50) >= 0.9 && stats.getLatencyPercentileMs(99) >= 0.9 &&
+          stats.getAverageLatencyMs() >= 0.9,
+          "end-to-end percentiles and mean come from the recorded sequences");
+    check(stats.getLatencyPercentileMs(50, PipelineStage::STORE) > 0 &&
+          stats.latency.snapshot(PipelineStage::STORE).count() == 20,
+          "recordStage() feeds the stage's percentiles");
+}
+
+static void testMetricsExport() {
+    std::cout << "\n📈 Prometheus export" << std::endl;
+
+    LatencyHistogram histogram;
+    histogram.record(5000, 3);        // 5 us
+    histogram.record(2000000, 2);     // 2 ms
+    check(histogram.countAtOrBelow(10000) == 3 && histogram.countAtOrBelow(1000000) == 3 &&
+          histogram.countAtOrBelow(10000000) == 5 && histogram.sum() == 4015000,
+          "countAtOrBelow() is cumulative; sum() in ns");
+
+    MetricsWriter writer;
+    writer.header("dna_test_seconds", "histogram", "Test.");
+    writer.histogram("dna_test_seconds", histogram, "stage=\"store\"");
+    writer.value("dna_test_total", 42);
+    const std::string& text = writer.str();
+    check(text.find("# TYPE dna_test_seconds histogram\n") != std::string::npos &&
+          text.find("dna_test_seconds_bucket{stage=\"store\",le=\"1e-05\"} 3\n") != std::string::npos &&
+          text.find("dna_test_seconds_bucket{stage=\"store\",le=\"+Inf\"} 5\n") != std::string::npos &&
+          text.find("dna_test_seconds_sum{stage=\"store\"} 0.004015\n") != std::string::npos &&
+          text.find("dna_test_seconds_count{stage=\"store\"} 5\n") != std::string::npos,
+          "histogram rendered as _bucket/_sum/_count in seconds");
+    check(text.find("dna_test_total 42\n") != std::string::npos, "unlabelled counter printed as an integer");
+
+    SlidingRate rate(10);
+    for (int second = 0; second <= 30; second++) {
+        rate.sample(second < 20 ? second * 100 : 2000 + (second - 20) * 10, second);
+    }
+    check(std::fabs(rate.perSecond() - 10.0) < 1e-9, "rate covers only the last 10 s of samples");
+}
+
+int main() {
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║              Latency Histogram Tests                         ║" << std::endl;
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+
+    testPercentiles();
+    testConcurrentRecording();
+    testPipelineStages();
+    testProcessorStats();
+    testMetricsExport();
+
+    std::cout << "\n✅ Passed: " << passed << " / " << (passed + failed) << std::endl;
+    std::cout << "❌ Failed: " << failed << " / " << (passed + failed) << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n🎉 ALL TESTS PASSED\n" << std::endl;
+        return 0;
+    }
+    return 1;
+}
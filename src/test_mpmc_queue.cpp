@@ -0,0 +1,213 @@
+/**
+ * @file test_mpmc_queue.cpp
+ * @brief Correctness tests for the bounded MPMC queue (dna_mpmc_queue.hpp)
+ *
+ * - FIFO order, full/empty behaviour and power-of-two capacity
+ * - Batch push/pop claiming several slots at once
+ * - Move-only elements (std::unique_ptr) and destruction of leftovers
+ * - Parking: blocked consumers wake on push, close() releases everyone
+ * - 4 producers x 4 consumers: every item delivered exactly once
+ *
+ * @date 2025-11-24
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <chrono>
+
+#include "dna_mpmc_queue.hpp"
+
+using DNASerialProcessor::BoundedMPMCQueue;
+
+static int passed = 0;
+static int failed = 0;
+
+static void check(bool condition, const std::string& name) {
+    if (condition) {
+        std::cout << "  ✅ " << name << std::endl;
+        passed++;
+    } else {
+        std::cout << "  ❌ " << name << std::endl;
+        failed++;
+    }
+}
+
+static void testBasics() {
+    std::cout << "\n📦 Basics" << std::endl;
+
+    BoundedMPMCQueue<int> queue(5);
+    check(queue.capacity() == 8, "capacity rounded up to power of two");
+
+    bool pushed = true;
+    for (int i = 0; i < 8; i++) {
+        pushed = pushed && queue.tryPush(int(i));
+    }
+    check(pushed && !queue.tryPush(99), "full queue rejects tryPush");
+    check(queue.size() == 8, "size() counts queued items");
+
+    bool ordered = true;
+    int value;
+    for (int i = 0; i < 8; i++) {
+        ordered = ordered && queue.tryPop(value) && value == i;
+    }
+    check(ordered, "FIFO order");
+    check(!queue.tryPop(value) && queue.empty(), "empty queue rejects tryPop");
+}
+
+static void testBatch() {
+    std::cout << "\n📚 Batch operations" << std::endl;
+
+    BoundedMPMCQueue<int> queue(16);
+    std::vector<int> in(20);
+    for (int i = 0; i < 20; i++) in[i] = i;
+
+    check(queue.tryPushBatch(in.data(), in.size()) == 16, "batch push stops at capacity");
+
+    std::vector<int> out(10);
+    size_t n = queue.tryPopBatch(out.data(), out.size());
+    check(n == 10 && out[0] == 0 && out[9] == 9, "batch pop returns oldest items in order");
+
+    // Wrap around the ring
+    check(queue.tryPushBatch(in.data() + 16, 4) == 4, "batch push across the wrap point");
+    std::vector<int> rest(32);
+    n = queue.tryPopBatch(rest.data(), rest.size());
+    bool ordered = n == 10;
+    for (size_t i = 0; ordered && i < n; i++) ordered = rest[i] == static_cast<int>(10 + i);
+    check(ordered, "remaining items drained in order");
+}
+
+struct Counted {
+    static std::atomic<int> alive;
+    Counted() { alive++; }
+    ~Counted() { alive--; }
+};
+std::atomic<int> Counted::alive{0};
+
+static void testMoveOnly() {
+    std::cout << "\n🚚 Move-only elements" << std::endl;
+
+    {
+        BoundedMPMCQueue<std::unique_ptr<Counted>> queue(4);
+        std::unique_ptr<Counted> a(new Counted), b(new Counted);
+        Counted* raw = a.get();
+        check(queue.tryPush(std::move(a)) && !a, "unique_ptr moved in");
+        check(queue.push(std::move(b)), "blocking push with room");
+
+        std::unique_ptr<Counted> out;
+        check(queue.tryPop(out) && out.get() == raw, "unique_ptr moved out");
+        check(Counted::alive == 2, "no copies made");
+    }
+    check(Counted::alive == 0, "destructor releases leftover items");
+}
+
+static void testParking() {
+    std::cout << "\n😴 Parking" << std::endl;
+
+    BoundedMPMCQueue<int> queue(8);
+    std::atomic<bool> got{false};
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration latency{};
+
+    std::thread consumer([&] {
+        int value;
+        if (queue.pop(value) && value == 42) {
+            latency = std::chrono::steady_clock::now() - start;
+            got = true;
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    start = std::chrono::steady_clock::now();
+    queue.push(42);
+    consumer.join();
+    check(got && latency < std::chrono::milliseconds(10), "parked consumer wakes on push");
+
+    int value;
+    auto t0 = std::chrono::steady_clock::now();
+    bool timedOut = !queue.pop(value, std::chrono::milliseconds(20));
+    check(timedOut && std::chrono::steady_clock::now() - t0 >= std::chrono::milliseconds(15),
+          "pop with timeout returns false");
+
+    std::atomic<int> released{0};
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < 3; i++) {
+        waiters.emplace_back([&] {
+            int v;
+            if (!queue.pop(v)) released++;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.close();
+    for (auto& t : waiters) t.join();
+    check(released == 3 && !queue.push(1), "close() wakes consumers and rejects pushes");
+}
+
+static void testConcurrent() {
+    std::cout << "\n🧵 4 producers x 4 consumers" << std::endl;
+
+    constexpr int PRODUCERS = 4;
+    constexpr int CONSUMERS = 4;
+    constexpr int PER_PRODUCER = 200000;
+
+    BoundedMPMCQueue<uint64_t> queue(1024);
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> count{0};
+
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < CONSUMERS; c++) {
+        consumers.emplace_back([&] {
+            uint64_t batch[32];
+            size_t n;
+            while ((n = queue.popBatch(batch, 32)) > 0) {
+                uint64_t local = 0;
+                for (size_t i = 0; i < n; i++) local += batch[i];
+                sum += local;
+                count += n;
+            }
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&, p] {
+            uint64_t batch[16];
+            for (int i = 0; i < PER_PRODUCER; i += 16) {
+                for (int j = 0; j < 16; j++) {
+                    batch[j] = static_cast<uint64_t>(p) * PER_PRODUCER + i + j + 1;
+                }
+                queue.pushBatch(batch, 16);
+            }
+        });
+    }
+    for (auto& t : producers) t.join();
+    queue.close();
+    for (auto& t : consumers) t.join();
+
+    uint64_t total = static_cast<uint64_t>(PRODUCERS) * PER_PRODUCER;
+    check(count == total, "every item delivered");
+    check(sum == total * (total + 1) / 2, "no item duplicated or lost");
+}
+
+int main() {
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║              Bounded MPMC Queue Tests                        ║" << std::endl;
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+
+    testBasics();
+    testBatch();
+    testMoveOnly();
+    testParking();
+    testConcurrent();
+
+    std::cout << "\n✅ Passed: " << passed << " / " << (passed + failed) << std::endl;
+    std::cout << "❌ Failed: " << failed << " / " << (passed + failed) << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n🎉 ALL TESTS PASSED\n" << std::endl;
+        return 0;
+    }
+    return 1;
+}
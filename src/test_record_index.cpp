@@ -0,0 +1,305 @@
+/**
+ * @file test_record_index.cpp
+ * @brief Tests for the persistent sorted record index (dna_record_index.hpp)
+ *
+ * - Lookups by ID, name and checksum match a brute-force scan of the log
+ * - Memtables flush into runs and runs merge level by level
+ * - Reopening finds every key again; covered() is where the log ended
+ * - Clean restarts re-add nothing and leave the runs as they were; after a
+ *   crash only the records past covered() are re-added
+ * - A log checkpoint writes the memtable and stores the index position with
+ *   the ID counter; a crash then re-adds only the tail after the checkpoint
+ * - Duplicate names give every match, oldest first; unknown keys give none
+ * - Re-adding already indexed records (crash catch-up) adds no duplicates
+ * - Resident fence tables stay a small fraction of the entries
+ *
+ * @date 2025-11-24
+ */
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+#include <unistd.h>
+
+#include "dna_record_index.hpp"
+
+using namespace DNASerialProcessor;
+
+static int passed = 0;
+static int failed = 0;
+
+static void check(bool condition, const std::string& name) {
+    if (condition) {
+        std::cout << "  ✅ " << name << std::endl;
+        passed++;
+    } else {
+        std::cout << "  ❌ " << name << std::endl;
+        failed++;
+    }
+}
+
+static std::string tempDirectory() {
+    char path[] = "/tmp/dna_record_index_XXXXXX";
+    return mkdtemp(path) ? std::string(path) : std::string();
+}
+
+static void removeDirectory(const std::string& directory) {
+    std::string command = "rm -rf '" + directory + "'";
+    if (system(command.c_str()) != 0) std::cerr << "could not remove " << directory << std::endl;
+}
+
+// Every 10th name repeats an earlier one
+static std::string nameOf(uint64_t id) {
+    return "seq_" + std::to_string(id % 10 == 0 ? id / 10 : id);
+}
+
+static uint32_t checksumOf(uint64_t id) {
+    return static_cast<uint32_t>(id * 2654435761u);
+}
+
+static std::string makeRecord(uint64_t id) {
+    char header[160];
+    snprintf(header, sizeof(header),
+             "INCHROSIL\nID: %llu\nName: %s\nClient: test\nFormat: FASTA\nLength: 8\nChecksum: 0x%x\n---\n",
+             static_cast<unsigned long long>(id), nameOf(id).c_str(), checksumOf(id));
+    return std::string(header) + "ACGTACGT";
+}
+
+/**
+ * @brief Log of `count` records, indexed through the publish hook
+ */
+static void fillLog(SegmentLog& log, RecordIndex& index, uint64_t first, uint64_t count) {
+    catchUpIndex(index, log);
+    LogBatch batch;
+    for (uint64_t id = first; id < first + count; id++) {
+        std::string record = makeRecord(id);
+        batch.add(id, record.data(), record.size());
+        if (batch.entries().size() == 50) {
+            log.append(batch);
+            batch.clear();
+        }
+    }
+    log.append(batch);
+}
+
+/**
+ * @brief Brute force: every (kind, key) of the log's records, oldest first
+ */
+static std::map<std::pair<IndexKind, uint64_t>, std::vector<uint64_t>> scanLog(const std::string& directory) {
+    std::map<std::pair<IndexKind, uint64_t>, std::vector<uint64_t>> keys;
+    SegmentLog::scanDirectory(directory, 1, [&](uint64_t id, const char* payload, size_t size, LogLocation where) {
+        IndexEntry entries[3];
+        size_t count = inchrosilIndexEntries(id, payload, size, where, entries);
+        for (size_t i = 0; i < count; i++) keys[{entries[i].kind, entries[i].key}].push_back(id);
+    });
+    return keys;
+}
+
+static bool matchesScan(const RecordIndex& index, const std::string& logDirectory) {
+    for (const auto& key : scanLog(logDirectory)) {
+        std::vector<IndexEntry> found = index.find(key.first.first, key.first.second);
+        if (found.size() != key.second.size()) return false;
+        for (size_t i = 0; i < found.size(); i++) {
+            if (found[i].id != key.second[i]) return false;
+        }
+    }
+    return true;
+}
+
+static void testLookups() {
+    std::cout << "\n🔍 Lookups" << std::endl;
+
+    std::string directory = tempDirectory();
+    SegmentLog log(SEGMENT_MIN_BYTES);
+    RecordIndex index(1000);
+    check(log.open(directory + "/log") && index.open(directory + "/index"), "log and index open");
+    fillLog(log, index, 1, 20000);
+    index.flush();
+
+    RecordIndex::Stats stats = index.stats();
+    check(stats.flushes > 10 && stats.merges > 0 && stats.runs < 20,
+          "memtables flushed and runs merged (" + std::to_string(stats.flushes) + " flushes, " +
+          std::to_string(stats.merges) + " merges, " + std::to_string(stats.runs) + " runs)");
+    check(matchesScan(index, directory + "/log"), "every ID, name and checksum matches a scan of the log");
+
+    LogLocation where, expected;
+    std::string payload;
+    check(index.locate(12345, where) && log.locate(12345, expected) && where.segment == expected.segment &&
+          where.offset == expected.offset && SegmentLog::readAt(directory + "/log", where, 12345, payload) &&
+          payload == makeRecord(12345),
+          "locate() points at the stored record");
+
+    std::string name = nameOf(70);
+    std::vector<IndexEntry> found = index.find(IndexKind::NAME, indexNameHash(name.data(), name.size()));
+    check(found.size() == 2 && found[0].id == 7 && found[1].id == 70, "a repeated name gives both records, oldest first");
+    check(index.find(IndexKind::ID, 20001).empty() && index.find(IndexKind::NAME, 42).empty(),
+          "unknown keys give nothing");
+
+    // 3 entries per record; 32 bytes of fence per 128 entries
+    check(stats.fenceBytes * 100 < stats.runEntries * 40,
+          "fences hold " + std::to_string(stats.fenceBytes) + " bytes for " + std::to_string(stats.runEntries) +
+          " entries (files: " + std::to_string(stats.fileBytes) + " bytes)");
+
+    index.close();
+    removeDirectory(directory);
+}
+
+static void testReopen() {
+    std::cout << "\n🔁 Reopen" << std::endl;
+
+    std::string directory = tempDirectory();
+    SegmentLog log(SEGMENT_MIN_BYTES);
+    {
+        RecordIndex index(700);
+        check(log.open(directory + "/log") && index.open(directory + "/index"), "log and index open");
+        fillLog(log, index, 1, 5000);
+        index.close();
+    }
+    log.onPublish(nullptr);
+
+    RecordIndex index(700);
+    check(index.open(directory + "/index") && matchesScan(index, directory + "/log"),
+          "close() writes the memtable; every key is found after reopening");
+
+    LogLocation end = log.published();
+    LogLocation covered = index.covered();
+    check(covered.segment == end.segment && covered.offset == end.offset,
+          "covered() is where the log ended at close()");
+    index.close();
+
+    // Clean restarts: nothing to re-add, no new run, no new entries
+    RecordIndex::Stats before = index.stats();
+    bool unchanged = true;
+    uint64_t added = 0;
+    for (int restart = 0; restart < 2; restart++) {
+        RecordIndex again(700);
+        again.open(directory + "/index");
+        added += catchUpIndex(again, log);
+        again.close();
+        RecordIndex::Stats after = again.stats();
+        unchanged = unchanged && after.runs == before.runs && after.runEntries == before.runEntries;
+    }
+    log.onPublish(nullptr);
+    check(added == 0 && unchanged, "two clean restarts re-add nothing; " + std::to_string(before.runs) +
+          " runs and " + std::to_string(before.runEntries) + " entries stay as they were");
+
+    // A crash loses the memtable: copy the index while 400 records are only in memory
+    {
+        RecordIndex running(1 << 20);
+        running.open(directory + "/index");
+        fillLog(log, running, 5001, 600);
+        running.flush();
+        fillLog(log, running, 5601, 400);
+        std::string command = "cp -r '" + directory + "/index' '" + directory + "/crashed'";
+        check(system(command.c_str()) == 0, "index copied with 400 records in its memtable");
+    }
+    log.onPublish(nullptr);
+    {
+        RecordIndex crashed(700);
+        crashed.open(directory + "/crashed");
+        added = catchUpIndex(crashed, log);
+        log.onPublish(nullptr);
+        check(added == 400 && crashed.find(IndexKind::ID, 5999).size() == 1 &&
+              matchesScan(crashed, directory + "/log"),
+              "after a crash only the records past covered() are re-added (" + std::to_string(added) + " of 6000)");
+    }
+    index.open(directory + "/index");
+
+    RecordIndex reader;
+    check(reader.open(directory + "/index", true) && reader.find(IndexKind::ID, 2500).size() == 1,
+          "a read-only open finds records beside the writer");
+
+    index.close();
+    removeDirectory(directory);
+}
+
+static void testCheckpoint() {
+    std::cout << "\n📌 Checkpoints" << std::endl;
+
+    std::string directory = tempDirectory();
+    SegmentLog::Checkpoint written;
+    LogLocation indexed;
+    {
+        SegmentLog log(SEGMENT_MIN_BYTES);
+        RecordIndex index(1 << 20);   // Never flushes by itself
+        log.open(directory + "/log");
+        index.open(directory + "/index");
+        fillLog(log, index, 1, 3000);
+        check(checkpointIndex(log, &index, 3001, &written) && index.stats().runs == 1,
+              "a checkpoint writes the memtable as a run");
+        indexed = index.covered();
+        fillLog(log, index, 3001, 200);
+        std::string command = "cp -r '" + directory + "/index' '" + directory + "/crashed'";
+        check(system(command.c_str()) == 0, "index copied with the 200 records since the checkpoint in memory");
+        log.onPublish(nullptr);
+    }
+
+    SegmentLog log(SEGMENT_MIN_BYTES);
+    RecordIndex index;
+    check(log.open(directory + "/log") && log.recovery().counter == 3001 &&
+          log.recovery().indexed.segment == indexed.segment && log.recovery().indexed.offset == indexed.offset &&
+          indexed.segment == written.segment && indexed.offset == written.offset,
+          "the checkpoint stores the index position beside the ID counter");
+    index.open(directory + "/crashed");
+    uint64_t added = catchUpIndex(index, log);
+    log.onPublish(nullptr);
+    check(added == 200 && matchesScan(index, directory + "/log"),
+          "a restart re-adds only the " + std::to_string(added) + " records since the checkpoint");
+
+    index.close();
+    removeDirectory(directory);
+}
+
+static void testCorruptRun() {
+    std::cout << "\n🩹 Damaged files" << std::endl;
+
+    std::string directory = tempDirectory();
+    {
+        RecordIndex index(1000);
+        index.open(directory);
+        for (uint64_t id = 1; id <= 300; id++) index.add({IndexKind::ID, id, id, LogLocation{1, 10, id * 64}});
+        index.close();
+    }
+    std::string path = RecordIndex::runPath(directory, 1);
+    check(access(path.c_str(), F_OK) == 0, "one run written");
+
+    FILE* file = fopen(path.c_str(), "r+b");
+    fseek(file, INDEX_HEADER_SIZE + 5, SEEK_SET);
+    fputc(0xFF, file);
+    fclose(file);
+    FILE* partial = fopen((path + ".tmp").c_str(), "wb");
+    fclose(partial);
+
+    RecordIndex index;
+    index.open(directory);
+    check(index.find(IndexKind::ID, 1).empty() && index.find(IndexKind::ID, 300).size() == 1,
+          "a block failing its CRC is skipped, the other blocks still answer");
+    check(access((path + ".tmp").c_str(), F_OK) != 0, "a half-written run is removed on open");
+
+    index.close();
+    removeDirectory(directory);
+}
+
+int main() {
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║              Record Index Tests                              ║" << std::endl;
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+
+    testLookups();
+    testReopen();
+    testCheckpoint();
+    testCorruptRun();
+
+    std::cout << "\n✅ Passed: " << passed << " / " << (passed + failed) << std::endl;
+    std::cout << "❌ Failed: " << failed << " / " << (passed + failed) << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n🎉 ALL TESTS PASSED\n" << std::endl;
+        return 0;
+    }
+    return 1;
+}
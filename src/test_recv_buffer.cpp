@@ -0,0 +1,185 @@
+/**
+ * @file test_recv_buffer.cpp
+ * @brief Tests for the reference-counted receive buffers (dna_recv_buffer.hpp)
+ *
+ * - Slices keep their block alive after the connection moves on
+ * - Last reference returns the block to the pool, from any thread
+ * - A record arriving in small pieces is relocated O(n), not O(n^2)
+ * - reserveContiguous(): a framed record moves at most once
+ *
+ * @date 2025-11-24
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+
+#include "dna_recv_buffer.hpp"
+
+using namespace DNASerialProcessor;
+
+static int passed = 0;
+static int failed = 0;
+
+static void check(bool condition, const std::string& name) {
+    if (condition) {
+        std::cout << "  ✅ " << name << std::endl;
+        passed++;
+    } else {
+        std::cout << "  ❌ " << name << std::endl;
+        failed++;
+    }
+}
+
+// Feed `data` the way a socket would: in pieces of at most `chunk` bytes
+static void feed(ReceiveBuffer& buffer, const std::string& data, size_t chunk) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        size_t length = std::min(chunk, data.size() - offset);
+        size_t space;
+        char* dst = buffer.prepareWrite(std::min(length, RECV_MIN_READ), space);
+        length = std::min(length, space);
+        std::memcpy(dst, data.data() + offset, length);
+        buffer.commitWrite(length);
+        offset += length;
+    }
+}
+
+static void testSlicesOutliveBuffer() {
+    std::cout << "\n🔗 Slice lifetime" << std::endl;
+
+    RecvBlockPool pool(1024, 8);
+    BufferSlice first;
+    {
+        ReceiveBuffer buffer(pool);
+        buffer.append("ACGT\nGGCC\n", 10);
+        first = buffer.slice(buffer.data(), 4);
+        BufferSlice second = buffer.slice(buffer.data() + 5, 4);
+        buffer.consume(10);
+
+        // Partial record, then enough data to force a new block
+        buffer.append("TTTT", 4);
+        feed(buffer, std::string(2000, 'A'), 300);
+        check(std::string(second.data(), second.size()) == "GGCC",
+              "slice intact after buffer moved to a new block");
+        check(buffer.size() == 2004 && std::memcmp(buffer.data(), "TTTTAAAA", 8) == 0,
+              "partial record kept contiguous across blocks");
+    }
+    check(std::string(first.data(), first.size()) == "ACGT", "slice outlives its connection");
+
+    size_t cachedBefore = pool.cached();
+    first.reset();
+    check(pool.cached() == cachedBefore + 1, "last reference returns block to the pool");
+
+    BufferSlice narrowed;
+    {
+        ReceiveBuffer buffer(pool);
+        buffer.append(">hdr\nACGT", 9);
+        narrowed = buffer.slice(buffer.data(), 9).sub(5, 4);
+    }
+    check(std::string(narrowed.data(), narrowed.size()) == "ACGT", "sub() narrows without copying");
+}
+
+static void testReuse() {
+    std::cout << "\n♻️  Block reuse" << std::endl;
+
+    RecvBlockPool pool(1024, 8);
+    ReceiveBuffer buffer(pool);
+    buffer.append("ACGT\n", 5);
+    const char* start = buffer.data();
+    buffer.consume(5);
+
+    size_t space;
+    check(buffer.prepareWrite(16, space) == start, "unreferenced block rewinds after full consume");
+
+    buffer.append("ACGT\n", 5);
+    BufferSlice held = buffer.slice(buffer.data(), 4);
+    buffer.consume(5);
+    check(buffer.prepareWrite(16, space) == held.data() + 5,
+          "referenced block keeps appending after the live record");
+
+    buffer.releaseIfIdle();
+    bool keptWhileReferenced = buffer.data() != nullptr;
+    held.reset();
+    size_t cached = pool.cached();
+    buffer.releaseIfIdle();
+    check(keptWhileReferenced && buffer.data() == nullptr && pool.cached() == cached + 1,
+          "idle buffer hands its block back once no record uses it");
+}
+
+static void testLinearRelocation() {
+    std::cout << "\n📈 Large records" << std::endl;
+
+    RecvBlockPool pool;
+    ReceiveBuffer buffer(pool);
+    const std::string line(10 * 1024 * 1024, 'G');
+    feed(buffer, line, 4096);
+    check(buffer.size() == line.size() && std::memcmp(buffer.data(), line.data(), line.size()) == 0,
+          "10 MB line reassembled contiguously from 4 KB reads");
+    check(buffer.relocatedBytes() < 2 * line.size(),
+          "bytes relocated < 2x record size (" + std::to_string(buffer.relocatedBytes() >> 20) + " MB)");
+
+    ReceiveBuffer framed(pool);
+    const std::string frame(300 * 1024, 'C');
+    feed(framed, frame.substr(0, 60 * 1024), 4096);
+    framed.reserveContiguous(frame.size());
+    uint64_t afterReserve = framed.relocatedBytes();
+    feed(framed, frame.substr(60 * 1024), 4096);
+    check(afterReserve <= 60 * 1024 && framed.relocatedBytes() == afterReserve,
+          "known frame length: prefix moved once, rest lands in place");
+}
+
+static void testCrossThreadRelease() {
+    std::cout << "\n🧵 Release from worker threads" << std::endl;
+
+    RecvBlockPool pool(4096, 64);
+    std::vector<BufferSlice> records;
+    {
+        ReceiveBuffer buffer(pool);
+        std::string record(100, 'A');
+        record.back() = '\n';
+        for (int i = 0; i < 4000; i++) {
+            buffer.append(record.data(), record.size());
+            records.push_back(buffer.slice(buffer.data(), record.size() - 1));
+            buffer.consume(record.size());
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::atomic<int> intact{0};
+    for (int t = 0; t < 4; t++) {
+        workers.emplace_back([&, t] {
+            for (size_t i = t; i < records.size(); i += 4) {
+                if (records[i].size() == 99 && records[i].data()[0] == 'A') intact++;
+                records[i].reset();
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    check(intact == 4000, "every record readable on its worker");
+    check(pool.cached() > 0 && pool.cached() <= 64, "blocks recycled into the bounded pool");
+}
+
+int main() {
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║              Receive Buffer Tests                            ║" << std::endl;
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+
+    testSlicesOutliveBuffer();
+    testReuse();
+    testLinearRelocation();
+    testCrossThreadRelease();
+
+    std::cout << "\n✅ Passed: " << passed << " / " << (passed + failed) << std::endl;
+    std::cout << "❌ Failed: " << failed << " / " << (passed + failed) << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n🎉 ALL TESTS PASSED\n" << std::endl;
+        return 0;
+    }
+    return 1;
+}
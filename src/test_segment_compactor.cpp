@@ -0,0 +1,478 @@
+/**
+ * @file test_segment_compactor.cpp
+ * @brief Tests for cold segment recompression (dna_segment_compactor.hpp)
+ *
+ * - Sequence blocks round-trip; random bases are stored, not expanded
+ * - A corrupt block fails its CRC checks instead of decoding wrongly
+ * - Compacted segments shrink, duplicates are stored once, and every record
+ *   reads back through read(), readAt() at its old location, and the scans
+ * - Reopening recovers the compacted segments; appends continue
+ * - A leftover rewrite is removed on open; a stopped compactor leaves the
+ *   original; damage to one block loses only that block's records
+ * - Rewrites stay within the I/O and CPU budgets
+ * - A cold read() allocates a few MB at most; its neighbours come from the block cache
+ *
+ * @date 2025-11-24
+ */
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <new>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dna_codec.hpp"
+#include "dna_segment_compactor.hpp"
+
+using namespace DNASerialProcessor;
+
+static int passed = 0;
+static int failed = 0;
+
+// Bytes allocated while counting (testColdRead)
+static std::atomic<bool> counting{false};
+static std::atomic<uint64_t> allocated{0};
+
+__attribute__((noinline)) void* operator new(size_t size) {
+    if (counting.load(std::memory_order_relaxed)) allocated.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static void check(bool condition, const std::string& name) {
+    if (condition) {
+        std::cout << "  ✅ " << name << std::endl;
+        passed++;
+    } else {
+        std::cout << "  ❌ " << name << std::endl;
+        failed++;
+    }
+}
+
+static std::string tempDirectory() {
+    char path[] = "/tmp/dna_segment_compactor_XXXXXX";
+    return mkdtemp(path) ? std::string(path) + "/log" : std::string();
+}
+
+static void removeDirectory(const std::string& directory) {
+    std::string command = "rm -rf '" + directory.substr(0, directory.rfind('/')) + "'";
+    if (system(command.c_str()) != 0) std::cerr << "could not remove " << directory << std::endl;
+}
+
+static uint64_t fileSize(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+}
+
+/**
+ * @brief Sample data: INCHROSIL payloads, mostly mutated copies of one reference
+ */
+class Samples {
+public:
+    Samples() : random_(42) {
+        for (int i = 0; i < 20000; i++) reference_ += "ACGT"[random_() % 4];
+    }
+
+    // Every 10th record repeats an earlier one; every 7th is unrelated random bases
+    std::string make(uint64_t id) {
+        if (id % 10 == 0 && id > 10) return made_[id] = made_[id - 7];
+        std::string bases;
+        if (id % 7 == 0) {
+            for (size_t i = 0; i < 1500 + random_() % 1500; i++) bases += "ACGT"[random_() % 4];
+        } else {
+            size_t start = random_() % (reference_.size() - 4000);
+            bases = reference_.substr(start, 1500 + random_() % 2500);
+            for (size_t i = 0; i < bases.size() / 100; i++) bases[random_() % bases.size()] = "ACGT"[random_() % 4];
+        }
+        char checksum[16];
+        snprintf(checksum, sizeof(checksum), "%08x", Crc32c::calculate(bases.data(), bases.size()));
+        std::string payload = "INCHROSIL v1\nName: seq_" + std::to_string(id) +
+                              "\nLength: " + std::to_string(bases.size()) +
+                              "\nChecksum: 0x" + checksum + "\n---\n" + NucleotideCodec::pack(bases);
+        made_[id] = payload;
+        return payload;
+    }
+
+    const std::map<uint64_t, std::string>& made() const { return made_; }
+
+private:
+    std::mt19937_64 random_;
+    std::string reference_;
+    std::map<uint64_t, std::string> made_;
+};
+
+// Records first..last, in batches of 8
+static void fill(SegmentLog& log, Samples& samples, uint64_t first, uint64_t last) {
+    LogBatch batch;
+    for (uint64_t id = first; id <= last; id++) {
+        std::string payload = samples.make(id);
+        batch.add(id, payload.data(), payload.size());
+        if (batch.entries().size() == 8 || id == last) {
+            log.append(batch);
+            batch.clear();
+        }
+    }
+}
+
+static bool scansBack(const SegmentLog& log, const Samples& samples) {
+    size_t matching = 0;
+    uint64_t scanned = log.scan([&](uint64_t id, const char* data, size_t size) {
+        auto it = samples.made().find(id);
+        matching += it != samples.made().end() && it->second == std::string(data, size);
+    });
+    return scanned == samples.made().size() && matching == scanned;
+}
+
+static void testCoder() {
+    std::cout << "\n🧬 Sequence blocks" << std::endl;
+
+    Samples samples;
+    std::vector<std::string> payloads;
+    for (uint64_t id = 1; id <= 60; id++) payloads.push_back(samples.make(id));
+    payloads.push_back("");
+    payloads.push_back("INCHROSIL v1\nName: header_only\n---\n");
+    payloads.push_back(std::string("\x00\xff\x10 no header at all", 19));
+
+    std::vector<SequenceBlockCoder::Record> records;
+    size_t raw = 0;
+    for (const std::string& payload : payloads) {
+        records.push_back({payload.data(), payload.size()});
+        raw += payload.size();
+    }
+    std::string block;
+    SequenceBlockCoder::encode(records, block);
+    std::vector<std::string> decoded;
+    check(SequenceBlockCoder::count(block.data(), block.size()) == payloads.size() &&
+          SequenceBlockCoder::decode(block.data(), block.size(), payloads.size() - 1, decoded) &&
+          decoded == payloads,
+          "block round-trips, including empty and headerless records");
+    check(block.size() < raw / 2,
+          "related sequences shrink below half of 2-bit packing (" + std::to_string(raw) + " -> " +
+          std::to_string(block.size()) + " bytes)");
+
+    decoded.clear();
+    check(SequenceBlockCoder::decode(block.data(), block.size(), 4, decoded) && decoded.size() == 5 &&
+          decoded[4] == payloads[4],
+          "decoding can stop at a record");
+
+    std::mt19937 random(7);
+    std::string noise(20000, '\0');
+    for (char& c : noise) c = static_cast<char>(random());
+    std::string stored;
+    SequenceBlockCoder::encode({{noise.data(), noise.size()}}, stored);
+    decoded.clear();
+    check(static_cast<uint8_t>(stored[0]) == SEQUENCE_BLOCK_STORED && stored.size() < noise.size() + 64 &&
+          SequenceBlockCoder::decode(stored.data(), stored.size(), 0, decoded) && decoded[0] == noise,
+          "random bytes are stored as they are");
+
+    block[block.size() / 2] ^= 0x10;
+    decoded.clear();
+    check(!SequenceBlockCoder::decode(block.data(), block.size(), payloads.size() - 1, decoded),
+          "a flipped bit fails the record checksums");
+}
+
+static void testCompaction() {
+    std::cout << "\n🗜️  Compaction" << std::endl;
+
+    std::string directory = tempDirectory();
+    Samples samples;
+    SegmentLog log(256 << 10);
+    log.open(directory);
+    fill(log, samples, 1, 1200);
+
+    std::map<uint64_t, LogLocation> locations;
+    for (const auto& entry : samples.made()) log.locate(entry.first, locations[entry.first]);
+    size_t sealed = log.sealedSegments().size();
+    uint64_t before = 0;
+    for (const auto& segment : log.sealedSegments()) before += fileSize(segment->path);
+
+    CompactionConfig config;
+    config.minAgeSeconds = 0;
+    config.blockBytes = 32 << 10;
+    config.ioBytesPerSecond = 0;
+    config.cpuPercent = 100;
+    std::vector<CompactionReport> reports;
+    SegmentCompactor compactor(log, config, [&](const CompactionReport& report) { reports.push_back(report); });
+    auto start = std::chrono::steady_clock::now();
+    size_t compacted = compactor.compactCold();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    SegmentCompactor::Stats stats = compactor.stats();
+    uint64_t after = 0;
+    bool allCompacted = true;
+    for (const auto& segment : log.sealedSegments()) {
+        after += fileSize(segment->path);
+        allCompacted = allCompacted && segment->compacted();
+    }
+    check(sealed >= 3 && compacted == sealed && allCompacted && reports.size() == sealed && stats.failures == 0,
+          "every sealed segment compacted (" + std::to_string(compacted) + "), the open one left alone");
+    check(after == stats.bytesAfter && before == stats.bytesBefore && stats.bytesSaved() > before / 2,
+          "bytes saved reported: " + std::to_string(before >> 10) + " KB -> " + std::to_string(after >> 10) + " KB");
+    check(stats.duplicates > 50, "duplicate payloads stored once (" + std::to_string(stats.duplicates) + ")");
+    std::cout << "     (" << static_cast<uint64_t>(before / seconds / 1024) << " KB/s unthrottled)" << std::endl;
+
+    check(compactor.compactCold() == 0, "compacted segments are not rewritten again");
+    check(scansBack(log, samples), "scan() returns every record, unchanged");
+
+    std::string payload;
+    bool reads = true, readsAt = true;
+    for (uint64_t id = 1; id <= 1200; id += 37) {
+        reads = reads && log.read(id, payload) && payload == samples.made().at(id);
+        readsAt = readsAt && SegmentLog::readAt(directory, locations[id], id, payload) &&
+                  payload == samples.made().at(id);
+    }
+    check(reads, "read() by id decodes the record");
+    check(readsAt, "readAt() at the location from before compaction still finds it");
+    LogLocation wrong = locations[100];
+    check(!SegmentLog::readAt(directory, wrong, 101, payload), "readAt() with the wrong id fails");
+
+    size_t matching = 0;
+    uint64_t scanned = SegmentLog::scanDirectory(directory, 1,
+        [&](uint64_t id, const char* data, size_t size, LogLocation where) {
+            matching += where.offset == locations[id].offset && where.segment == locations[id].segment &&
+                        samples.made().at(id) == std::string(data, size);
+        });
+    check(scanned == 1200 && matching == 1200, "scanDirectory() reports the original locations");
+
+    fill(log, samples, 1201, 1300);
+    check(log.read(1300, payload) && payload == samples.made().at(1300), "appends continue");
+
+    SegmentLog reopened(256 << 10);
+    check(reopened.open(directory) && reopened.recordCount() == 1300 && reopened.recovery().skippedBytes == 0,
+          "reopen recovers compacted segments from their tables");
+    check(scansBack(reopened, samples), "and every record reads back");
+    fill(reopened, samples, 1301, 1310);
+    check(reopened.read(1310, payload) && payload == samples.made().at(1310), "appends continue after reopen");
+
+    removeDirectory(directory);
+}
+
+static void testFailures() {
+    std::cout << "\n🩹 Crashes and damage" << std::endl;
+
+    std::string directory = tempDirectory();
+    Samples samples;
+    {
+        SegmentLog log(256 << 10);
+        log.open(directory);
+        fill(log, samples, 1, 400);
+
+        // A crash mid-rewrite
+        std::string leftover = SegmentLog::segmentPath(directory, 1) + ".tmp";
+        int fd = ::open(leftover.c_str(), O_WRONLY | O_CREAT, 0644);
+        check(fd >= 0 && write(fd, "partial", 7) == 7, "left a partial rewrite behind");
+        if (fd >= 0) close(fd);
+    }
+
+    SegmentLog log(256 << 10);
+    log.open(directory);
+    check(access((SegmentLog::segmentPath(directory, 1) + ".tmp").c_str(), F_OK) != 0,
+          "open() removes the leftover");
+
+    // Stop while a slow rewrite is under way
+    CompactionConfig slow;
+    slow.minAgeSeconds = 0;
+    slow.intervalMs = 10;
+    slow.blockBytes = 16 << 10;
+    slow.ioBytesPerSecond = 64 << 10;
+    {
+        SegmentCompactor compactor(log, slow);
+        compactor.start();
+        usleep(200000);
+        compactor.stop();
+        check(compactor.stats().segments == 0 && compactor.stats().failures == 0 &&
+              !log.sealedSegments().front()->compacted() &&
+              access((SegmentLog::segmentPath(directory, 1) + ".tmp").c_str(), F_OK) != 0,
+              "stop() abandons the rewrite and keeps the original");
+    }
+    check(scansBack(log, samples), "every record still reads back");
+
+    CompactionConfig config;
+    config.minAgeSeconds = 0;
+    config.blockBytes = 16 << 10;
+    config.ioBytesPerSecond = 0;
+    config.cpuPercent = 100;
+    SegmentCompactor compactor(log, config);
+    CompactionReport report;
+    check(compactor.compactSegment(1, report) && report.blocks > 2, "segment 1 compacted");
+
+    // Flip a byte in the middle of its second block
+    auto segment = log.sealedSegments().front();
+    std::set<uint64_t> offsets;
+    for (const CompactedRecord& record : segment->relocated) offsets.insert(record.block);
+    std::vector<uint64_t> blocks(offsets.begin(), offsets.end());
+    {
+        int fd = ::open(segment->path.c_str(), O_RDWR);
+        char byte = 0;
+        uint64_t offset = blocks[1] + (blocks[2] - blocks[1]) / 2;
+        bool flipped = pread(fd, &byte, 1, offset) == 1;
+        byte ^= 0x01;
+        flipped = flipped && pwrite(fd, &byte, 1, offset) == 1;
+        close(fd);
+        check(flipped, "damaged one block");
+    }
+
+    std::string payload;
+    size_t lost = 0, intact = 0;
+    for (const CompactedRecord& record : segment->relocated) {
+        bool read = log.read(record.id, payload) && payload == samples.made().at(record.id);
+        if (record.block == blocks[1]) lost += !read;
+        else intact += read;
+    }
+    size_t inBlock = 0;
+    for (const CompactedRecord& record : segment->relocated) inBlock += record.block == blocks[1];
+    check(lost == inBlock && intact == segment->relocated.size() - inBlock,
+          "only that block's " + std::to_string(inBlock) + " records fail to read");
+
+    uint64_t scanned = log.scan([](uint64_t, const char*, size_t) {});
+    check(scanned == samples.made().size() - inBlock, "scan() skips them and returns the rest");
+
+    removeDirectory(directory);
+}
+
+static double threadCpuSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<double>(now.tv_sec) + now.tv_nsec / 1e9;
+}
+
+static void testBudget() {
+    std::cout << "\n⏱️  Budgets" << std::endl;
+
+    std::string directory = tempDirectory();
+    Samples samples;
+    SegmentLog log(256 << 10);
+    log.open(directory);
+    fill(log, samples, 1, 1000);
+
+    CompactionConfig config;
+    config.minAgeSeconds = 0;
+    config.blockBytes = 16 << 10;
+    config.ioBytesPerSecond = 512 << 10;
+    config.cpuPercent = 100;
+    SegmentCompactor io(log, config);
+    CompactionReport report;
+    auto start = std::chrono::steady_clock::now();
+    bool compacted = io.compactSegment(1, report);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // The last block is written after the last pause: allow it
+    double budget = static_cast<double>(report.bytesBefore + report.bytesAfter - (32 << 10)) /
+                    config.ioBytesPerSecond;
+    check(compacted && seconds >= budget,
+          "I/O budget: " + std::to_string((report.bytesBefore + report.bytesAfter) >> 10) + " KB in " +
+          std::to_string(seconds).substr(0, 4) + " s at 512 KB/s");
+
+    config.ioBytesPerSecond = 0;
+    config.cpuPercent = 50;
+    SegmentCompactor cpu(log, config);
+    start = std::chrono::steady_clock::now();
+    double cpuStart = threadCpuSeconds();
+    compacted = cpu.compactSegment(2, report);
+    double cpuSeconds = threadCpuSeconds() - cpuStart;
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    check(compacted && seconds >= cpuSeconds * 2 * 0.8,
+          "CPU budget: " + std::to_string(cpuSeconds).substr(0, 4) + " s of CPU over " +
+          std::to_string(seconds).substr(0, 4) + " s at 50%");
+
+    removeDirectory(directory);
+}
+
+static uint64_t allocatedBy(const std::function<void()>& fn) {
+    allocated = 0;
+    counting = true;
+    fn();
+    counting = false;
+    return allocated;
+}
+
+static void testColdRead() {
+    std::cout << "\n🧊 Cold reads" << std::endl;
+
+    std::string directory = tempDirectory();
+    Samples samples;
+    SegmentLog log(256 << 10);
+    log.open(directory);
+    fill(log, samples, 1, 500);
+
+    CompactionConfig config;
+    config.minAgeSeconds = 0;
+    config.ioBytesPerSecond = 0;
+    config.cpuPercent = 100;
+    SegmentCompactor compactor(log, config);
+    CompactionReport report;
+    bool compacted = compactor.compactSegment(1, report);
+    check(compacted, "segment 1 compacted in " + std::to_string(report.blocks) + " blocks of " +
+          std::to_string(compactor.config().blockBytes >> 10) + " KB");
+
+    // The worst case: the last record of the block with the most records
+    auto segment = log.sealedSegments().front();
+    std::map<uint64_t, std::vector<uint64_t>> blocks;
+    for (const CompactedRecord& record : segment->relocated) {
+        if (record.entry >= blocks[record.block].size()) blocks[record.block].resize(record.entry + 1);
+        blocks[record.block][record.entry] = record.id;
+    }
+    const std::vector<uint64_t>* largest = &blocks.begin()->second;
+    for (const auto& block : blocks) {
+        if (block.second.size() > largest->size()) largest = &block.second;
+    }
+
+    std::string payload;
+    bool read = false;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t cold = allocatedBy([&] { read = log.read(largest->back(), payload); });
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    check(read && payload == samples.made().at(largest->back()) && cold < (6 << 20),
+          "one cold read(): " + std::to_string(cold >> 10) + " KB allocated, " +
+          std::to_string(ms).substr(0, 4) + " ms, " + std::to_string(largest->size()) + " records decoded");
+
+    bool same = true;
+    uint64_t warm = allocatedBy([&] {
+        for (uint64_t id : *largest) same = same && log.read(id, payload) && payload == samples.made().at(id);
+    });
+    check(same && warm < largest->size() * (16 << 10),
+          "the rest of its block comes from the cache: " + std::to_string(warm >> 10) + " KB allocated");
+
+    CompactionConfig large = config;
+    large.blockBytes = 1 << 20;
+    check(SegmentCompactor(log, large).config().blockBytes == COMPACTION_MAX_BLOCK_BYTES,
+          "blockBytes is capped at " + std::to_string(COMPACTION_MAX_BLOCK_BYTES >> 10) + " KB");
+
+    removeDirectory(directory);
+}
+
+int main() {
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║              Segment Compactor Tests                         ║" << std::endl;
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+
+    testCoder();
+    testCompaction();
+    testFailures();
+    testBudget();
+    testColdRead();
+
+    std::cout << "\n✅ Passed: " << passed << " / " << (passed + failed) << std::endl;
+    std::cout << "❌ Failed: " << failed << " / " << (passed + failed) << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n🎉 ALL TESTS PASSED\n" << std::endl;
+        return 0;
+    }
+    return 1;
+}
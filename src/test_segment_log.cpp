@@ -0,0 +1,415 @@
+/**
+ * @file test_segment_log.cpp
+ * @brief Tests for the append-only segment log (dna_segment_log.hpp)
+ *
+ * - CRC32C matches the reference check value
+ * - Records read back by id; batches roll over into new segments
+ * - Concurrent appends from several threads lose nothing
+ * - Reopening rebuilds the index and keeps appending after the old tail
+ * - A torn tail is truncated; a corrupt record is skipped, later ones kept
+ * - Group commit: every submission is committed, many per fdatasync; stop() drains
+ * - Checkpoints: reopen loads the tables and scans only the tail; a write
+ *   still in flight is not covered; a damaged checkpoint falls back to a scan
+ *
+ * @date 2025-11-24
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "dna_segment_log.hpp"
+
+using namespace DNASerialProcessor;
+
+static int passed = 0;
+static int failed = 0;
+
+static void check(bool condition, const std::string& name) {
+    if (condition) {
+        std::cout << "  ✅ " << name << std::endl;
+        passed++;
+    } else {
+        std::cout << "  ❌ " << name << std::endl;
+        failed++;
+    }
+}
+
+static std::string makePayload(uint64_t id) {
+    std::string payload(1 + (id * 7919) % 3000, '\0');
+    for (size_t i = 0; i < payload.size(); i++) payload[i] = "ACGT"[(id + i) % 4];
+    return payload;
+}
+
+static std::string tempDirectory() {
+    char path[] = "/tmp/dna_segment_log_XXXXXX";
+    return mkdtemp(path) ? std::string(path) + "/log" : std::string();
+}
+
+static void removeDirectory(const std::string& directory) {
+    std::string command = "rm -rf '" + directory.substr(0, directory.rfind('/')) + "'";
+    if (system(command.c_str()) != 0) std::cerr << "could not remove " << directory << std::endl;
+}
+
+static bool readsBack(const SegmentLog& log, uint64_t first, uint64_t last) {
+    std::string payload;
+    for (uint64_t id = first; id <= last; id++) {
+        if (!log.read(id, payload) || payload != makePayload(id)) return false;
+    }
+    return true;
+}
+
+static void testCrc32c() {
+    std::cout << "\n🔢 CRC32C" << std::endl;
+
+    check(Crc32c::calculate("123456789", 9) == 0xE3069283, "check value of \"123456789\"");
+    std::string data(1000, 'G');
+    check(Crc32c::extend(Crc32c::calculate(data.data(), 333), data.data() + 333, 667) ==
+          Crc32c::calculate(data.data(), data.size()),
+          "extend() continues a running CRC");
+}
+
+static void testAppendAndRead() {
+    std::cout << "\n📝 Append, read, rollover" << std::endl;
+
+    std::string directory = tempDirectory();
+    SegmentLog log(SEGMENT_MIN_BYTES);
+    check(log.open(directory) && log.segmentCount() == 1, "open() creates the directory and a segment");
+
+    LogBatch batch;
+    for (uint64_t id = 1; id <= 500; id++) {
+        if (id % 3 == 0) {
+            // Streamed: header reserved, payload appended in place
+            batch.begin(id);
+            batch.buffer() += makePayload(id);
+            batch.end();
+        } else {
+            std::string payload = makePayload(id);
+            batch.add(id, payload.data(), payload.size());
+        }
+        if (batch.size() >= 16 << 10) {
+            log.append(batch);
+            batch.clear();
+        }
+    }
+    log.append(batch);
+
+    check(log.recordCount() == 500 && readsBack(log, 1, 500), "500 records read back by id");
+    check(log.segmentCount() > 5, "64 KB segments rolled over (" + std::to_string(log.segmentCount()) + ")");
+
+    LogLocation where;
+    check(log.locate(250, where) && where.offset % LOG_RECORD_ALIGN == 0 &&
+          where.length == makePayload(250).size(),
+          "locate() gives an aligned offset and the payload length");
+
+    std::string payload;
+    check(!log.read(501, payload), "unknown id is not found");
+
+    uint64_t expected = 1;
+    bool ordered = true;
+    uint64_t scanned = log.scan([&](uint64_t id, const char* data, size_t size) {
+        ordered = ordered && id == expected++ && std::string(data, size) == makePayload(id);
+    });
+    check(scanned == 500 && ordered, "scan() visits every record in log order");
+
+    LogBatch huge;
+    std::string big(SEGMENT_MIN_BYTES * 2, 'T');
+    huge.add(1000, big.data(), big.size());
+    check(log.append(huge) && log.read(1000, payload) && payload == big,
+          "a record larger than a segment gets one of its own");
+
+    removeDirectory(directory);
+}
+
+static void testConcurrentAppends() {
+    std::cout << "\n🧵 Concurrent appends" << std::endl;
+
+    constexpr int THREADS = 4;
+    constexpr uint64_t PER_THREAD = 2000;
+    std::string directory = tempDirectory();
+    SegmentLog log(1 << 20);
+    if (!log.open(directory)) {
+        check(false, "open()");
+        return;
+    }
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < THREADS; t++) {
+        writers.emplace_back([&, t] {
+            LogBatch batch;
+            for (uint64_t i = 0; i < PER_THREAD; i++) {
+                uint64_t id = 1 + i * THREADS + t;
+                std::string payload = makePayload(id);
+                batch.add(id, payload.data(), payload.size());
+                if (batch.entries().size() == 16) {
+                    log.append(batch);
+                    batch.clear();
+                }
+            }
+            log.append(batch);
+        });
+    }
+    for (auto& writer : writers) writer.join();
+
+    check(log.recordCount() == THREADS * PER_THREAD && readsBack(log, 1, THREADS * PER_THREAD),
+          "8000 records from 4 threads, all intact");
+
+    // Reopen: the index comes back from disk and appends land after it
+    uint32_t segments = static_cast<uint32_t>(log.segmentCount());
+    SegmentLog reopened(1 << 20);
+    check(reopened.open(directory) && reopened.recordCount() == THREADS * PER_THREAD &&
+          reopened.recovery().skippedBytes == 0 && reopened.segmentCount() == segments,
+          "reopen rebuilds the index from the segments");
+
+    LogBatch more;
+    std::string payload = makePayload(9000);
+    more.add(9000, payload.data(), payload.size());
+    check(reopened.append(more) && readsBack(reopened, 1, THREADS * PER_THREAD) &&
+          reopened.read(9000, payload) && payload == makePayload(9000),
+          "appends after reopen leave the old records alone");
+
+    removeDirectory(directory);
+}
+
+static void testRecovery() {
+    std::cout << "\n🩹 Recovery" << std::endl;
+
+    std::string directory = tempDirectory();
+    {
+        SegmentLog log;
+        log.open(directory);
+        LogBatch batch;
+        for (uint64_t id = 1; id <= 100; id++) {
+            std::string payload = makePayload(id);
+            batch.add(id, payload.data(), payload.size());
+        }
+        log.append(batch);
+    }
+    std::string path = SegmentLog::segmentPath(directory, 1);
+
+    // Flip a payload byte of record 50
+    LogLocation where;
+    bool located;
+    {
+        SegmentLog probe;
+        located = probe.open(directory) && probe.locate(50, where);
+    }
+    int fd = open(path.c_str(), O_WRONLY);
+    char flipped = 'X';
+    bool corrupted = located && fd >= 0 &&
+                     pwrite(fd, &flipped, 1, where.offset + sizeof(LogRecordHeader) + 10) == 1;
+    if (fd >= 0) close(fd);
+
+    // Half a record at the end, as if the process died mid-write
+    LogBatch torn;
+    std::string payload = makePayload(101);
+    torn.add(101, payload.data(), payload.size());
+    fd = open(path.c_str(), O_WRONLY | O_APPEND);
+    bool written = fd >= 0 && write(fd, torn.buffer().data(), torn.size() / 2) > 0;
+    off_t before = fd >= 0 ? lseek(fd, 0, SEEK_END) : 0;
+    if (fd >= 0) close(fd);
+
+    SegmentLog log;
+    check(written && corrupted && log.open(directory), "log with a torn tail and a bad record opens");
+    check(log.recovery().truncatedBytes == torn.size() / 2, "torn tail truncated");
+
+    struct stat info;
+    check(stat(path.c_str(), &info) == 0 && info.st_size == before - static_cast<off_t>(torn.size() / 2),
+          "segment file cut back to the last intact record");
+    check(log.recordCount() == 99 && !log.read(50, payload) && readsBack(log, 1, 49) &&
+          readsBack(log, 51, 100),
+          "corrupt record skipped, the records after it recovered");
+
+    LogBatch next;
+    payload = makePayload(101);
+    next.add(101, payload.data(), payload.size());
+    check(log.append(next) && log.read(101, payload) && payload == makePayload(101),
+          "appends continue where the intact log ends");
+
+    removeDirectory(directory);
+}
+
+static void testGroupCommit() {
+    std::cout << "\n💾 Group commit" << std::endl;
+
+    constexpr int THREADS = 4;
+    constexpr uint64_t PER_THREAD = 500;
+    std::string directory = tempDirectory();
+    SegmentLog log(1 << 20);
+    if (!log.open(directory)) {
+        check(false, "open()");
+        return;
+    }
+
+    GroupCommitConfig config;
+    config.maxRecords = 64;
+    config.maxDelayUs = 2000;
+    std::atomic<uint64_t> syncs{0};
+    std::atomic<uint64_t> committed{0};
+    std::atomic<uint64_t> failures{0};
+    GroupCommitter committer(config, &syncs);
+    committer.start();
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < THREADS; t++) {
+        writers.emplace_back([&, t] {
+            for (uint64_t i = 0; i < PER_THREAD; i++) {
+                uint64_t id = 1 + i * THREADS + t;
+                std::string payload = makePayload(id);
+                LogBatch batch;
+                batch.add(id, payload.data(), payload.size());
+                SegmentLog::Reservation where;
+                if (!log.append(batch, &where)) {
+                    failures++;
+                    continue;
+                }
+                committer.submit(where.segment, 1, batch.size(), [&](bool durable) {
+                    (durable ? committed : failures)++;
+                });
+            }
+        });
+    }
+    for (auto& writer : writers) writer.join();
+    committer.stop();
+
+    check(committed == THREADS * PER_THREAD && failures == 0,
+          "every append committed (" + std::to_string(committed.load()) + ")");
+    check(syncs > 0 && syncs < THREADS * PER_THREAD / 4,
+          "appends share fdatasyncs (" + std::to_string(syncs.load()) + " for " +
+          std::to_string(THREADS * PER_THREAD) + ")");
+    check(committer.committedRecords() == THREADS * PER_THREAD && committer.commits() <= syncs,
+          "commit counters add up");
+
+    // A long window: stop() must not wait it out, nor drop what is pending
+    GroupCommitConfig slow;
+    slow.maxDelayUs = 10000000;
+    GroupCommitter lazy(slow);
+    lazy.start();
+    LogBatch batch;
+    std::string payload = makePayload(9999);
+    batch.add(9999, payload.data(), payload.size());
+    SegmentLog::Reservation where;
+    bool done = false;
+    if (log.append(batch, &where)) {
+        lazy.submit(where.segment, 1, batch.size(), [&](bool durable) { done = durable; });
+    }
+    auto started = std::chrono::steady_clock::now();
+    lazy.stop();
+    check(done && std::chrono::steady_clock::now() - started < std::chrono::seconds(1),
+          "stop() commits the open window at once");
+
+    removeDirectory(directory);
+}
+
+// Records first..last, 8 per append
+static void fill(SegmentLog& log, uint64_t first, uint64_t last) {
+    LogBatch batch;
+    for (uint64_t id = first; id <= last; id++) {
+        std::string payload = makePayload(id);
+        batch.add(id, payload.data(), payload.size());
+        if (batch.entries().size() == 8 || id == last) {
+            log.append(batch);
+            batch.clear();
+        }
+    }
+}
+
+static void testCheckpoint() {
+    std::cout << "\n📍 Checkpoints" << std::endl;
+
+    std::string directory = tempDirectory();
+    SegmentLog::Checkpoint written;
+    {
+        SegmentLog log(SEGMENT_MIN_BYTES);
+        log.open(directory);
+        fill(log, 1, 400);
+        bool checkpointed = log.checkpoint(1234, &written);
+        check(checkpointed && written.tables > 0 && written.tables == log.segmentCount() - 1 &&
+              written.segment == log.segmentCount(),
+              "checkpoint() writes a table per sealed segment (" + std::to_string(written.tables) + ")");
+        SegmentLog::Checkpoint again;
+        check(log.checkpoint(1234, &again) && again.tables == 0 && again.entries == written.entries,
+              "a second checkpoint rewrites only the open segment's table");
+        fill(log, 401, 420);   // The tail after the checkpoint
+    }
+
+    SegmentLog reopened(SEGMENT_MIN_BYTES);
+    check(reopened.open(directory) && reopened.recordCount() == 420 && readsBack(reopened, 1, 420),
+          "reopen recovers every record");
+    const SegmentLog::RecoveryStats& recovered = reopened.recovery();
+    check(recovered.tabledRecords == 400 && recovered.counter == 1234 && recovered.maxId == 420,
+          "400 records from the tables, the counter and the highest ID");
+    check(recovered.scannedBytes > 0 && recovered.scannedBytes < 20 * 3100,
+          "only the tail was scanned (" + std::to_string(recovered.scannedBytes) + " bytes)");
+
+    // A write in flight: the checkpoint stops short of it, so recovery finds it
+    SegmentLog::Reservation slow;
+    LogBatch late;
+    std::string payload = makePayload(500);
+    late.add(500, payload.data(), payload.size());
+    check(reopened.reserve(late.size(), slow), "reserved a range and left it unwritten");
+    fill(reopened, 501, 510);
+    check(reopened.checkpoint(99, &written) && written.offset == slow.offset,
+          "checkpoint() covers up to the write in flight");
+    bool published = pwrite(slow.segment->fd, late.buffer().data(), late.size(), slow.offset) ==
+                     static_cast<ssize_t>(late.size());
+    reopened.publish(slow, late);
+    slow = SegmentLog::Reservation();
+    {
+        SegmentLog after(SEGMENT_MIN_BYTES);
+        check(published && after.open(directory) && after.recordCount() == 431 &&
+              after.read(500, payload) && payload == makePayload(500) && readsBack(after, 501, 510),
+              "the late record and those after it are recovered");
+    }
+
+    // Abandoned writes do not hold checkpoints back
+    SegmentLog::Reservation failed;
+    reopened.reserve(64, failed);
+    reopened.abandon(failed);
+    failed = SegmentLog::Reservation();
+    fill(reopened, 511, 520);
+    check(reopened.checkpoint(100, &written) && written.offset > slow.offset,
+          "an abandoned reservation is passed");
+
+    // Damaged checkpoint: ignored, the open segment is scanned instead
+    std::string path = directory + "/checkpoint";
+    int fd = open(path.c_str(), O_WRONLY);
+    char flipped = 0x55;
+    bool damaged = fd >= 0 && pwrite(fd, &flipped, 1, sizeof(RecordTableHeader) + 5) == 1;
+    if (fd >= 0) close(fd);
+    SegmentLog scanned(SEGMENT_MIN_BYTES);
+    check(damaged && scanned.open(directory) && scanned.recordCount() == 441 && scanned.recovery().counter == 0 &&
+          readsBack(scanned, 1, 420) && readsBack(scanned, 500, 520),
+          "a damaged checkpoint is ignored and the segment scanned");
+
+    removeDirectory(directory);
+}
+
+int main() {
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║              Segment Log Tests                               ║" << std::endl;
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+
+    testCrc32c();
+    testAppendAndRead();
+    testConcurrentAppends();
+    testRecovery();
+    testGroupCommit();
+    testCheckpoint();
+
+    std::cout << "\n✅ Passed: " << passed << " / " << (passed + failed) << std::endl;
+    std::cout << "❌ Failed: " << failed << " / " << (passed + failed) << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n🎉 ALL TESTS PASSED\n" << std::endl;
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,296 @@
+/**
+ * @file test_shm_ring.cpp
+ * @brief Tests for the shared-memory ring transport (dna_shm_ring.hpp)
+ *
+ * - Frames come back in order, in place, across the wrap-around point
+ * - A full ring refuses writes until the consumer releases space
+ * - The doorbell rings only when the consumer announced it would sleep
+ * - Handshake over a Unix socket; attach() rejects foreign or unsealed memfds
+ * - Producer and consumer on separate threads: every frame arrives intact
+ *
+ * @date 2025-11-24
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstring>
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "dna_shm_ring.hpp"
+
+using namespace DNASerialProcessor;
+
+static int passed = 0;
+static int failed = 0;
+
+static void check(bool condition, const std::string& name) {
+    if (condition) {
+        std::cout << "  ✅ " << name << std::endl;
+        passed++;
+    } else {
+        std::cout << "  ❌ " << name << std::endl;
+        failed++;
+    }
+}
+
+// Consumer and producer ends of one ring, as the server and client hold them
+struct RingPair {
+    std::unique_ptr<ShmRing> producer;
+    std::unique_ptr<ShmRing> consumer;
+};
+
+static RingPair makePair(size_t capacity) {
+    RingPair pair;
+    pair.producer = ShmRing::create(capacity);
+    if (pair.producer) {
+        pair.consumer = ShmRing::attach(dup(pair.producer->memfd()), dup(pair.producer->doorbell()));
+    }
+    return pair;
+}
+
+static bool doorbellRung(const ShmRing& ring) {
+    struct pollfd pfd{ring.doorbell(), POLLIN, 0};
+    return poll(&pfd, 1, 0) == 1;
+}
+
+static void testOrderAndWrap() {
+    std::cout << "\n🔁 Ordering and wrap-around" << std::endl;
+
+    RingPair ring = makePair(SHM_RING_MIN_SIZE);
+    check(ring.producer && ring.consumer && ring.consumer->capacity() == SHM_RING_MIN_SIZE,
+          "create() + attach() map the same ring");
+    if (!ring.consumer) return;
+
+    // 3 KB frames do not divide 64 KB: the 22nd entry needs a wrap marker
+    bool inOrder = true;
+    bool inPlace = true;
+    for (int i = 0; i < 100; i++) {
+        std::string frame(3000 + i % 7, static_cast<char>('A' + i % 26));
+        if (!ring.producer->tryWrite(frame.data(), frame.size())) {
+            inOrder = false;
+            break;
+        }
+        size_t length = 0;
+        const char* data = ring.consumer->next(length);
+        inOrder = inOrder && data && std::string(data, length) == frame;
+        inPlace = inPlace && data && reinterpret_cast<uintptr_t>(data) % 8 == 0;
+        ring.consumer->release(ring.consumer->readPosition());
+    }
+    check(inOrder, "100 frames read back in order across several wraps");
+    check(inPlace, "frames returned 8-byte aligned, straight from the mapping");
+    check(ring.producer->drained(), "drained() once the consumer released everything");
+
+    size_t length;
+    check(ring.consumer->next(length) == nullptr && !ring.consumer->corrupt(),
+          "empty ring returns nullptr without flagging corruption");
+}
+
+static void testBackpressure() {
+    std::cout << "\n🚧 Full ring" << std::endl;
+
+    RingPair ring = makePair(SHM_RING_MIN_SIZE);
+    if (!ring.consumer) return;
+
+    std::string frame(ring.producer->maxFrame(), 'G');
+    check(ring.producer->tryWrite(frame.data(), frame.size()),
+          "maxFrame() bytes fit in one entry");
+
+    std::string small(1000, 'C');
+    size_t written = 0;
+    while (ring.producer->tryWrite(small.data(), small.size())) written++;
+    check(written > 0 && !ring.producer->tryWrite(small.data(), small.size()),
+          "writes refused once the ring is full");
+
+    size_t length;
+    ring.consumer->next(length);
+    check(!ring.producer->tryWrite(small.data(), small.size()),
+          "parsed but unreleased bytes stay reserved");
+
+    ring.consumer->release(ring.consumer->readPosition());
+    check(ring.producer->tryWrite(small.data(), small.size()), "release() frees space for the producer");
+
+    bool intact = true;
+    for (size_t i = 0; i <= written; i++) {
+        const char* data = ring.consumer->next(length);
+        intact = intact && data && length == small.size() && data[0] == 'C';
+    }
+    check(intact && !ring.consumer->corrupt(), "queued frames intact after the big one");
+}
+
+static void testDoorbell() {
+    std::cout << "\n🔔 Doorbell" << std::endl;
+
+    RingPair ring = makePair(SHM_RING_MIN_SIZE);
+    if (!ring.consumer) return;
+
+    const char frame[] = "ACGT";
+    ring.producer->tryWrite(frame, sizeof(frame));
+    check(!doorbellRung(*ring.consumer), "busy consumer: no doorbell write");
+
+    check(!ring.consumer->prepareWait(), "prepareWait() refuses to sleep with frames pending");
+    size_t length;
+    ring.consumer->next(length);
+    check(ring.consumer->prepareWait(), "prepareWait() agrees once caught up");
+
+    ring.producer->tryWrite(frame, sizeof(frame));
+    check(doorbellRung(*ring.consumer), "waiting consumer: doorbell rung");
+    ring.consumer->clearDoorbell();
+
+    ring.producer->tryWrite(frame, sizeof(frame));
+    check(!doorbellRung(*ring.consumer), "rung once per wait, not per frame");
+}
+
+static void testHandshake() {
+    std::cout << "\n🤝 Handshake" << std::endl;
+
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) < 0) {
+        check(false, "socketpair()");
+        return;
+    }
+
+    int memfd, doorbell;
+    check(ShmRing::receiveFrom(sockets[1], memfd, doorbell) == 0, "nothing sent yet: receiveFrom() returns 0");
+
+    auto producer = ShmRing::create(100000);
+    check(producer && producer->capacity() == 128 << 10, "capacity rounded up to a power of two");
+    check(producer && producer->sendTo(sockets[0]), "sendTo() passes memfd and doorbell");
+
+    std::unique_ptr<ShmRing> consumer;
+    if (ShmRing::receiveFrom(sockets[1], memfd, doorbell) == 1) {
+        consumer = ShmRing::attach(memfd, doorbell);
+    }
+    const char frame[] = "GATTACA";
+    size_t length = 0;
+    const char* data = nullptr;
+    if (producer && consumer) {
+        producer->tryWrite(frame, sizeof(frame));
+        data = consumer->next(length);
+    }
+    check(data && length == sizeof(frame) && std::memcmp(data, frame, length) == 0,
+          "server reads what the client wrote through the passed fds");
+
+    int bogus = 0;
+    ssize_t rc = send(sockets[0], &bogus, sizeof(bogus), 0);
+    check(rc == sizeof(bogus) && ShmRing::receiveFrom(sockets[1], memfd, doorbell) == -1,
+          "message without fds is rejected");
+
+    close(sockets[0]);
+    close(sockets[1]);
+
+    // Right size, wrong contents
+    int foreign = memfd_create("foreign", MFD_ALLOW_SEALING);
+    bool sized = ftruncate(foreign, SHM_HEADER_SIZE + SHM_RING_MIN_SIZE) == 0 &&
+                 fcntl(foreign, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) == 0;
+    check(sized && !ShmRing::attach(foreign, -1), "memfd without a ring header is rejected");
+
+    // Valid ring, but the client could still shrink it under the server
+    int unsealed = memfd_create("unsealed", 0);
+    bool mapped = false;
+    if (ftruncate(unsealed, SHM_HEADER_SIZE + SHM_RING_MIN_SIZE) == 0) {
+        void* base = mmap(nullptr, SHM_HEADER_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, unsealed, 0);
+        if (base != MAP_FAILED) {
+            auto* header = static_cast<ShmRingHeader*>(base);
+            header->magic = SHM_RING_MAGIC;
+            header->version = SHM_RING_VERSION;
+            header->capacity = SHM_RING_MIN_SIZE;
+            munmap(base, SHM_HEADER_SIZE);
+            mapped = true;
+        }
+    }
+    check(mapped && !ShmRing::attach(unsealed, -1), "unsealed memfd is rejected");
+}
+
+static void testCorruptEntry() {
+    std::cout << "\n🛡️  Hostile producer" << std::endl;
+
+    RingPair ring = makePair(SHM_RING_MIN_SIZE);
+    if (!ring.consumer) return;
+
+    // An entry claiming more bytes than were published
+    const char frame[] = "ACGT";
+    ring.producer->tryWrite(frame, sizeof(frame));
+    void* base = mmap(nullptr, SHM_HEADER_SIZE + SHM_RING_MIN_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, ring.producer->memfd(), 0);
+    if (base == MAP_FAILED) {
+        check(false, "map ring for tampering");
+        return;
+    }
+    ShmEntryHeader forged{1 << 20, 0};
+    std::memcpy(static_cast<char*>(base) + SHM_HEADER_SIZE, &forged, sizeof(forged));
+    munmap(base, SHM_HEADER_SIZE + SHM_RING_MIN_SIZE);
+
+    size_t length;
+    check(ring.consumer->next(length) == nullptr && ring.consumer->corrupt(),
+          "oversized entry flagged corrupt instead of read out of bounds");
+}
+
+static void testConcurrent() {
+    std::cout << "\n🧵 Producer vs consumer threads" << std::endl;
+
+    constexpr int FRAMES = 200000;
+    RingPair ring = makePair(SHM_RING_MIN_SIZE);
+    if (!ring.consumer) return;
+
+    std::thread producer([&] {
+        std::string frame;
+        for (int i = 0; i < FRAMES; i++) {
+            frame.assign(8 + i % 500, static_cast<char>(i & 0x7F));
+            std::memcpy(&frame[0], &i, sizeof(i));
+            while (!ring.producer->tryWrite(frame.data(), frame.size())) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int received = 0;
+    bool intact = true;
+    while (received < FRAMES && intact) {
+        size_t length;
+        const char* data = ring.consumer->next(length);
+        if (!data) {
+            std::this_thread::yield();
+            continue;
+        }
+        int index;
+        std::memcpy(&index, data, sizeof(index));
+        intact = index == received && length == static_cast<size_t>(8 + index % 500) &&
+                 data[length - 1] == static_cast<char>(index & 0x7F);
+        received++;
+        // Release in batches, as the server does once workers finish
+        if (received % 64 == 0) ring.consumer->release(ring.consumer->readPosition());
+    }
+    ring.consumer->release(ring.consumer->readPosition());
+    producer.join();
+
+    check(intact && received == FRAMES, "200000 frames received intact and in order");
+    check(ring.producer->drained(), "ring drained at the end");
+}
+
+int main() {
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║              Shared-Memory Ring Tests                        ║" << std::endl;
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+
+    testOrderAndWrap();
+    testBackpressure();
+    testDoorbell();
+    testHandshake();
+    testCorruptEntry();
+    testConcurrent();
+
+    std::cout << "\n✅ Passed: " << passed << " / " << (passed + failed) << std::endl;
+    std::cout << "❌ Failed: " << failed << " / " << (passed + failed) << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n🎉 ALL TESTS PASSED\n" << std::endl;
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,278 @@
+/**
+ * @file test_wire_protocol.cpp
+ * @brief Round-trip tests for the client/server binary framing
+ *
+ * Exercises include/dna_wire_protocol.hpp without a network:
+ * - Encode/decode of every frame type
+ * - Partial frames (NEED_MORE) at every split point
+ * - Corruption detection (magic, version, CRC, oversized length)
+ * - BATCH containers holding several record frames
+ * - RecordMeta priority/deadline prefixes on record frames
+ * - 2-bit codec used for RECORD_PACKED (dna_codec.hpp), whole and in slices
+ * - RECORD_PACKED payloads keep the header name and FASTQ qualities
+ *
+ * @date 2025-11-24
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "dna_codec.hpp"
+#include "dna_wire_protocol.hpp"
+
+using namespace DNASerialProcessor;
+
+static int passed = 0;
+static int failed = 0;
+
+static void check(bool condition, const std::string& name) {
+    if (condition) {
+        std::cout << "  ✅ " << name << std::endl;
+        passed++;
+    } else {
+        std::cout << "  ❌ " << name << std::endl;
+        failed++;
+    }
+}
+
+static void testRoundTrip() {
+    std::cout << "\n📦 Round trip" << std::endl;
+
+    const std::string fasta = ">chr1 test\nACGTACGT\nTTGGCCAA\n";
+    std::string wire = FrameEncoder::encode(FrameType::RECORD_FASTA, fasta);
+    check(wire.size() == sizeof(FrameHeader) + fasta.size(), "frame size = header + payload");
+
+    FrameView frame;
+    DecodeStatus status = FrameDecoder::decode(wire.data(), wire.size(), frame);
+    check(status == DecodeStatus::FRAME, "complete frame decodes");
+    check(frame.type == FrameType::RECORD_FASTA, "type preserved");
+    check(std::string(frame.payload, frame.length) == fasta, "multi-line payload preserved");
+    check(frame.frameSize == wire.size(), "frameSize points at next frame");
+
+    std::string empty = FrameEncoder::encode(FrameType::PING, "");
+    status = FrameDecoder::decode(empty.data(), empty.size(), frame);
+    check(status == DecodeStatus::FRAME && frame.length == 0, "empty payload frame");
+
+    std::string hello = FrameEncoder::hello(1, 3, CAP_BATCH);
+    status = FrameDecoder::decode(hello.data(), hello.size(), frame);
+    HelloPayload payload;
+    std::memcpy(&payload, frame.payload, sizeof(payload));
+    check(status == DecodeStatus::FRAME && frame.type == FrameType::HELLO &&
+          payload.minVersion == 1 && payload.maxVersion == 3 && payload.capabilities == CAP_BATCH,
+          "HELLO payload");
+
+    std::string named = FrameEncoder::hello(1, 1, CAP_BATCH, "loader-2");
+    status = FrameDecoder::decode(named.data(), named.size(), frame);
+    check(status == DecodeStatus::FRAME && frame.length == sizeof(HelloPayload) + 8 &&
+          std::string(frame.payload + sizeof(HelloPayload), 8) == "loader-2",
+          "HELLO carries the client name after the payload");
+    check(validClientName("loader-2", 8) && !validClientName("", 0) && !validClientName("a b", 3) &&
+          !validClientName(std::string(HELLO_MAX_CLIENT_NAME + 1, 'x').c_str(), HELLO_MAX_CLIENT_NAME + 1),
+          "client names: printable, no spaces, at most 64 bytes");
+}
+
+static void testPartialFrames() {
+    std::cout << "\n✂️  Partial frames" << std::endl;
+
+    std::string wire = FrameEncoder::encode(FrameType::RECORD_RAW, "ACGTNACGT");
+    bool allNeedMore = true;
+    FrameView frame;
+    for (size_t split = 0; split < wire.size(); split++) {
+        if (FrameDecoder::decode(wire.data(), split, frame) != DecodeStatus::NEED_MORE) {
+            allNeedMore = false;
+        }
+    }
+    check(allNeedMore, "every truncated prefix reports NEED_MORE");
+}
+
+static void testCorruption() {
+    std::cout << "\n🛡️  Corruption detection" << std::endl;
+
+    const std::string good = FrameEncoder::encode(FrameType::RECORD_RAW, "ACGTACGT");
+    FrameView frame;
+
+    auto corrupt = [&](std::function<void(std::string&)> mutate) {
+        std::string wire = good;
+        mutate(wire);
+        std::string error;
+        DecodeStatus status = FrameDecoder::decode(wire.data(), wire.size(), frame, &error);
+        return status == DecodeStatus::ERROR && !error.empty();
+    };
+
+    check(corrupt([](std::string& w) { w[0] = '>'; }),
+          "bad magic rejected");
+    check(corrupt([](std::string& w) { w[4] = 9; }),
+          "unknown version rejected");
+    check(corrupt([](std::string& w) { w[sizeof(FrameHeader)] = 'T'; }),
+          "payload bit flip rejected");
+    check(corrupt([](std::string& w) {
+              uint32_t huge = WIRE_MAX_PAYLOAD + 1;
+              std::memcpy(&w[8], &huge, sizeof(huge));
+          }),
+          "oversized length rejected before buffering");
+    check(!isBinaryProtocol(">seq\nACGT\n", 10) && !isBinaryProtocol("ACGT\n", 5) &&
+          isBinaryProtocol(good.data(), good.size()),
+          "first byte separates binary from text protocol");
+}
+
+static void testBatch() {
+    std::cout << "\n📚 BATCH container" << std::endl;
+
+    std::vector<std::string> records = {"ACGT", "GGGGCCCC", std::string(10000, 'T')};
+    std::string inner;
+    for (const auto& record : records) {
+        FrameEncoder::append(inner, FrameType::RECORD_RAW, record);
+    }
+    std::string wire = FrameEncoder::encode(FrameType::BATCH, inner);
+
+    FrameView batch;
+    check(FrameDecoder::decode(wire.data(), wire.size(), batch) == DecodeStatus::FRAME &&
+          batch.type == FrameType::BATCH, "batch frame decodes");
+
+    size_t offset = 0;
+    size_t index = 0;
+    bool match = true;
+    FrameView frame;
+    while (offset < batch.length) {
+        if (FrameDecoder::decode(batch.payload + offset, batch.length - offset, frame) != DecodeStatus::FRAME ||
+            index >= records.size() || std::string(frame.payload, frame.length) != records[index]) {
+            match = false;
+            break;
+        }
+        offset += frame.frameSize;
+        index++;
+    }
+    check(match && index == records.size(), "inner records walk back out in order");
+}
+
+static void testRecordMeta() {
+    std::cout << "\n🚦 Priority prefix" << std::endl;
+
+    FrameView frame;
+    RecordMeta meta;
+    const char* payload;
+    uint32_t length;
+
+    std::string plain = FrameEncoder::encode(FrameType::RECORD_RAW, "ACGT");
+    FrameDecoder::decode(plain.data(), plain.size(), frame);
+    check(splitRecordMeta(frame, meta, payload, length) && meta.priority == PRIORITY_NORMAL &&
+          meta.deadlineMs == 0 && std::string(payload, length) == "ACGT",
+          "no flag: NORMAL, no deadline, payload untouched");
+
+    RecordMeta critical{PRIORITY_CRITICAL, {0, 0, 0}, 10};
+    std::string body(reinterpret_cast<const char*>(&critical), sizeof(critical));
+    body += "GATTACA";
+    std::string tagged = FrameEncoder::encode(FrameType::RECORD_FASTA, body, RECORD_FLAG_META);
+    FrameDecoder::decode(tagged.data(), tagged.size(), frame);
+    check(frame.flags == RECORD_FLAG_META && splitRecordMeta(frame, meta, payload, length) &&
+          meta.priority == PRIORITY_CRITICAL && meta.deadlineMs == 10 &&
+          std::string(payload, length) == "GATTACA",
+          "flag set: prefix stripped, priority and deadline read");
+
+    std::string truncated = FrameEncoder::encode(FrameType::RECORD_RAW, "ACG", RECORD_FLAG_META);
+    FrameDecoder::decode(truncated.data(), truncated.size(), frame);
+    check(!splitRecordMeta(frame, meta, payload, length), "truncated prefix rejected");
+
+    RecordMeta bogus{7, {0, 0, 0}, 0};
+    std::string badLane = FrameEncoder::encode(
+        FrameType::RECORD_RAW, std::string(reinterpret_cast<const char*>(&bogus), sizeof(bogus)),
+        RECORD_FLAG_META);
+    FrameDecoder::decode(badLane.data(), badLane.size(), frame);
+    check(!splitRecordMeta(frame, meta, payload, length), "unknown priority rejected");
+}
+
+static void testPackedCodec() {
+    std::cout << "\n🧬 2-bit packing" << std::endl;
+
+    check(NucleotideCodec::pack("ACGT") == std::string(1, '\x1B'), "ACGT packs to 0b00011011");
+    check(NucleotideCodec::pack("ACGTA") == std::string("\x1B\x00", 2), "tail byte zero-padded");
+
+    bool roundTrip = true;
+    std::string sequence;
+    for (size_t length = 0; length < 67; length++) {
+        std::string packed = NucleotideCodec::pack(sequence);
+        if (packed.size() != NucleotideCodec::packedSize(length) ||
+            NucleotideCodec::unpack(packed.data(), length) != sequence) {
+            roundTrip = false;
+        }
+        sequence.push_back("ACGT"[(length * 7) % 4]);
+    }
+    check(roundTrip, "pack/unpack round trip for lengths 0..66");
+
+    std::string packedTen = NucleotideCodec::pack("GATTACAGTC");
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(packedTen.data());
+    std::string sliced(10, '?');
+    NucleotideCodec::unpackInto(bytes, 4, &sliced[0]);
+    NucleotideCodec::unpackInto(bytes + 1, 6, &sliced[4]);
+    check(sliced == "GATTACAGTC", "byte-aligned slices unpack independently");
+
+    std::string out;
+    check(NucleotideCodec::pack("ACGTNNAC", 8, out) && out == NucleotideCodec::pack("ACGTAAAC"),
+          "N accepted and stored as A");
+    check(!NucleotideCodec::pack("ACGTX", 5, out) && !NucleotideCodec::pack("acgt", 4, out),
+          "invalid and lowercase bases rejected");
+}
+
+static void testPackedRecord() {
+    std::cout << "\n📦 Packed records" << std::endl;
+
+    std::string bases = "GATTACAGATTACANNACGT";
+    std::string quality(bases.size(), 'I');
+    quality[3] = '#';
+    PackedRecordHeader header{};
+    header.baseCount = bases.size();
+    header.sourceType = static_cast<uint8_t>(FrameType::RECORD_FASTQ);
+    std::string wire = FrameEncoder::encode(
+        FrameType::RECORD_PACKED,
+        FrameEncoder::packedRecord(header, "read_17 lane=2", NucleotideCodec::pack(bases), quality));
+
+    FrameView frame;
+    RecordMeta meta;
+    const char* payload;
+    uint32_t length;
+    PackedRecordView record;
+    bool split = FrameDecoder::decode(wire.data(), wire.size(), frame) == DecodeStatus::FRAME &&
+                 splitRecordMeta(frame, meta, payload, length) && splitPackedRecord(payload, length, record);
+    check(split && std::string(record.name, record.nameLength) == "read_17 lane=2",
+          "header name round-trips");
+    check(split && NucleotideCodec::unpack(record.packed, record.header.baseCount) == "GATTACAGATTACAAAACGT",
+          "bases round-trip (N stored as A)");
+    check(split && record.quality && std::string(record.quality, bases.size()) == quality,
+          "FASTQ quality round-trips");
+
+    std::string raw = FrameEncoder::packedRecord(header, "", NucleotideCodec::pack("ACGT"));
+    check(splitPackedRecord(raw.data(), 0, record) == false, "truncated header rejected");
+    PackedRecordHeader bare{};
+    bare.baseCount = 4;
+    raw = FrameEncoder::packedRecord(bare, "", NucleotideCodec::pack("ACGT"));
+    check(splitPackedRecord(raw.data(), raw.size(), record) && record.nameLength == 0 && !record.quality,
+          "no name, no quality: the original 16-byte header layout");
+    check(!splitPackedRecord(raw.data(), raw.size() - 1, record) &&
+          !splitPackedRecord((raw + "Q").data(), raw.size() + 1, record),
+          "length must match name + packed bases + qualities");
+}
+
+int main() {
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║              Wire Protocol Framing Tests                     ║" << std::endl;
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+
+    testRoundTrip();
+    testPartialFrames();
+    testCorruption();
+    testBatch();
+    testRecordMeta();
+    testPackedCodec();
+    testPackedRecord();
+
+    std::cout << "\n✅ Passed: " << passed << " / " << (passed + failed) << std::endl;
+    std::cout << "❌ Failed: " << failed << " / " << (passed + failed) << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n🎉 ALL TESTS PASSED\n" << std::endl;
+        return 0;
+    }
+    return 1;
+}
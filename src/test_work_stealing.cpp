@@ -0,0 +1,158 @@
+/**
+ * @file test_work_stealing.cpp
+ * @brief Correctness tests for the Chase-Lev deque (dna_work_stealing.hpp)
+ *
+ * - Owner pops newest first, thieves steal oldest first
+ * - Fixed capacity: push fails when full, slots reused after wrap-around
+ * - Owner pushing/popping against 3 thieves: every task runs exactly once
+ * - 2-bit slice packing used by the server's encode sub-tasks
+ *
+ * @date 2025-11-24
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include "dna_codec.hpp"
+#include "dna_work_stealing.hpp"
+
+using DNASerialProcessor::NucleotideCodec;
+using DNASerialProcessor::WorkStealingDeque;
+
+static int passed = 0;
+static int failed = 0;
+
+static void check(bool condition, const std::string& name) {
+    if (condition) {
+        std::cout << "  ✅ " << name << std::endl;
+        passed++;
+    } else {
+        std::cout << "  ❌ " << name << std::endl;
+        failed++;
+    }
+}
+
+static void testOrdering() {
+    std::cout << "\n📦 Ordering" << std::endl;
+
+    WorkStealingDeque<int> deque(8);
+    int items[4] = {0, 1, 2, 3};
+    for (int& item : items) deque.push(&item);
+
+    check(deque.size() == 4, "size() counts pushed tasks");
+    check(deque.pop() == &items[3], "owner pops newest");
+    check(deque.steal() == &items[0], "thief steals oldest");
+    check(deque.pop() == &items[2] && deque.pop() == &items[1], "owner drains the rest");
+    check(deque.pop() == nullptr && deque.steal() == nullptr && deque.empty(),
+          "empty deque returns nullptr");
+}
+
+static void testCapacity() {
+    std::cout << "\n📏 Capacity" << std::endl;
+
+    WorkStealingDeque<int> deque(3);
+    check(deque.capacity() == 4, "capacity rounded up to power of two");
+
+    int items[5];
+    bool pushed = true;
+    for (int i = 0; i < 4; i++) pushed = pushed && deque.push(&items[i]);
+    check(pushed && !deque.push(&items[4]), "full deque rejects push");
+
+    // Steal two, push two more: slots wrap around
+    deque.steal();
+    deque.steal();
+    check(deque.push(&items[4]) && deque.push(&items[0]), "stolen slots are reused");
+    check(deque.steal() == &items[2] && deque.pop() == &items[0], "order kept across wrap");
+}
+
+static void testConcurrentSteal() {
+    std::cout << "\n🧵 Owner vs 3 thieves" << std::endl;
+
+    constexpr int TASKS = 200000;
+    std::vector<int> tasks(TASKS);
+    std::vector<std::atomic<int>> runs(TASKS);
+    for (int i = 0; i < TASKS; i++) {
+        tasks[i] = i;
+        runs[i].store(0);
+    }
+
+    WorkStealingDeque<int> deque(256);
+    std::atomic<bool> done{false};
+    std::atomic<int> stolen{0};
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; t++) {
+        thieves.emplace_back([&] {
+            while (!done.load(std::memory_order_acquire) || !deque.empty()) {
+                if (int* task = deque.steal()) {
+                    runs[*task]++;
+                    stolen++;
+                }
+            }
+        });
+    }
+
+    // The owner pushes in bursts and pops some back, as a splitting worker does
+    int next = 0;
+    while (next < TASKS) {
+        for (int i = 0; i < 8 && next < TASKS; i++) {
+            if (deque.push(&tasks[next])) {
+                next++;
+            } else if (int* task = deque.pop()) {
+                runs[*task]++;
+            }
+        }
+        if (int* task = deque.pop()) runs[*task]++;
+    }
+    while (int* task = deque.pop()) runs[*task]++;
+    done.store(true, std::memory_order_release);
+    for (auto& t : thieves) t.join();
+
+    bool exactlyOnce = true;
+    for (int i = 0; i < TASKS; i++) {
+        if (runs[i].load() != 1) exactlyOnce = false;
+    }
+    check(exactlyOnce, "every task taken exactly once");
+    std::cout << "     (" << stolen.load() << " of " << TASKS << " stolen)" << std::endl;
+}
+
+static void testSlicePacking() {
+    std::cout << "\n🧬 Slice packing" << std::endl;
+
+    std::string sequence;
+    for (int i = 0; i < 1003; i++) sequence.push_back("ACGTN"[(i * 7) % 5]);
+
+    // Slices on 4-base boundaries, packed out of order into one buffer
+    std::string packed(NucleotideCodec::packedSize(sequence.size()), '\0');
+    uint8_t* out = reinterpret_cast<uint8_t*>(&packed[0]);
+    bool ok = true;
+    for (size_t offset : {800u, 0u, 400u}) {
+        size_t length = std::min<size_t>(400, sequence.size() - offset);
+        ok = ok && NucleotideCodec::packInto(sequence.data() + offset, length, out + offset / 4);
+    }
+    check(ok && packed == NucleotideCodec::pack(sequence), "slices match whole-sequence packing");
+}
+
+int main() {
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║              Work-Stealing Deque Tests                       ║" << std::endl;
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+
+    testOrdering();
+    testCapacity();
+    testConcurrentSteal();
+    testSlicePacking();
+
+    std::cout << "\n✅ Passed: " << passed << " / " << (passed + failed) << std::endl;
+    std::cout << "❌ Failed: " << failed << " / " << (passed + failed) << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n🎉 ALL TESTS PASSED\n" << std::endl;
+        return 0;
+    }
+    return 1;
+}